@@ -0,0 +1,259 @@
+// Parser benchmark: generates programs that stress different parts of the
+// grammar, then reports throughput, allocations and AST memory per NodeType.
+//
+//   bin/parser_bench [scale] [iterations]
+#include "../src/Lexer/lexer.hpp"
+#include "../src/SynParser/ast_visitor.hpp"
+#include "../src/SynParser/ast_dumper.hpp"
+#include <sys/resource.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+
+// === Allocation Tracking ===
+// Every allocation carries a small header with its size so frees can be
+// subtracted from the live total and a true heap peak can be kept
+
+namespace {
+
+std::atomic<size_t> allocation_count{0};
+std::atomic<size_t> allocated_bytes{0};
+std::atomic<size_t> live_bytes{0};
+std::atomic<size_t> peak_live_bytes{0};
+
+constexpr size_t header_size = alignof(std::max_align_t);
+
+void* tracked_alloc(size_t size) {
+    auto* block = static_cast<unsigned char*>(std::malloc(size + header_size));
+    if (block == nullptr) throw std::bad_alloc();
+    *reinterpret_cast<size_t*>(block) = size;
+
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    size_t live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = peak_live_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live)) {}
+    return block + header_size;
+}
+
+void tracked_free(void* pointer) {
+    if (pointer == nullptr) return;
+    auto* block = static_cast<unsigned char*>(pointer) - header_size;
+    live_bytes.fetch_sub(*reinterpret_cast<size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+} // namespace
+
+void* operator new(size_t size) { return tracked_alloc(size); }
+void* operator new[](size_t size) { return tracked_alloc(size); }
+void operator delete(void* pointer) noexcept { tracked_free(pointer); }
+void operator delete[](void* pointer) noexcept { tracked_free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { tracked_free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { tracked_free(pointer); }
+
+namespace {
+
+// === Program Generators ===
+
+std::string deep_nesting(int scale) {
+    int depth = std::min(scale, 400); // the parser recurses once per level
+    std::string source = "function nested(int n) -> int {\n";
+    for (int i = 0; i < depth; ++i) {
+        source += "if (n > " + std::to_string(i) + ") {\nwhile (n < 100) {\n";
+    }
+    source += "n = n - 1;\n";
+    for (int i = 0; i < depth; ++i) {
+        source += "}\n}\n";
+    }
+    source += "return n;\n}\n";
+    return source;
+}
+
+std::string long_expressions(int scale) {
+    std::string source;
+    for (int line = 0; line < 50; ++line) {
+        source += "int e" + std::to_string(line) + " = a";
+        for (int i = 0; i < scale * 4; ++i) {
+            static const char* ops[] = {" + ", " * ", " - ", " // ", " ** ", " && ", " <= "};
+            source += ops[i % 7];
+            source += (i % 3 == 0) ? "(b - " + std::to_string(i) + ")" : "c" + std::to_string(i % 10);
+        }
+        source += ";\n";
+    }
+    return source;
+}
+
+std::string many_functions(int scale) {
+    std::string source;
+    for (int i = 0; i < scale * 20; ++i) {
+        std::string n = std::to_string(i);
+        source += "function f" + n + "(int a, float b) -> int {\n"
+                  "    int c = a * 2 + " + n + ";\n"
+                  "    if (c > 10) { return c - 1; } else { print(\"small\"); }\n"
+                  "    int t[4];\n"
+                  "    while (c > 0) { t[c % 4] = t[0] + c; if (c > 100) { break; } c = c - 1; }\n"
+                  "    return f" + n + "(c, b);\n}\n";
+    }
+    return source;
+}
+
+// === AST Census ===
+
+struct TypeStats {
+    size_t count = 0;
+    size_t object_bytes = 0;    // sizeof the node itself
+    size_t owned_bytes = 0;     // strings and vectors the node owns on the heap
+};
+
+size_t string_heap(const std::string& value) {
+    // a string living in its own small buffer owns no heap memory
+    const char* data = value.data();
+    const char* object = reinterpret_cast<const char*>(&value);
+    bool inline_buffer = data >= object && data < object + sizeof(std::string);
+    return inline_buffer ? 0 : value.capacity() + 1;
+}
+
+template <typename T>
+size_t vector_heap(const std::vector<T>& values) {
+    return values.capacity() * sizeof(T);
+}
+
+class NodeCensus : public ASTWalker<NodeCensus> {
+public:
+    TypeStats stats[static_cast<int>(NodeType::Error) + 1];
+
+    void visit_program(ProgramNode& node) { add(node, vector_heap(node.children)); ASTWalker::visit_program(node); }
+    void visit_function(FunctionNode& node) {
+        add(node, string_heap(node.name) + string_heap(node.returnType) +
+                  vector_heap(node.parameters) + vector_heap(node.body));
+        ASTWalker::visit_function(node);
+    }
+    void visit_parameter(ParameterNode& node) { add(node, string_heap(node.type) + string_heap(node.name)); }
+    void visit_declaration(DeclarationNode& node) {
+        add(node, string_heap(node.type) + string_heap(node.name));
+        ASTWalker::visit_declaration(node);
+    }
+    void visit_assignment(AssignmentNode& node) { add(node, string_heap(node.name)); ASTWalker::visit_assignment(node); }
+    void visit_if(IfNode& node) { add(node, vector_heap(node.body) + vector_heap(node.elseBody)); ASTWalker::visit_if(node); }
+    void visit_while(WhileNode& node) { add(node, vector_heap(node.body)); ASTWalker::visit_while(node); }
+    void visit_return(ReturnNode& node) { add(node, 0); ASTWalker::visit_return(node); }
+    void visit_break(BreakNode& node) { add(node, 0); }
+    void visit_block(BlockNode& node) { add(node, vector_heap(node.statements)); ASTWalker::visit_block(node); }
+    void visit_binary_op(BinaryOpNode& node) { add(node, string_heap(node.op)); ASTWalker::visit_binary_op(node); }
+    void visit_unary_op(UnaryOpNode& node) { add(node, string_heap(node.op)); ASTWalker::visit_unary_op(node); }
+    void visit_literal(LiteralNode& node) { add(node, string_heap(node.value) + string_heap(node.literalType)); }
+    void visit_variable(VariableNode& node) { add(node, string_heap(node.name)); }
+    void visit_function_call(FunctionCallNode& node) {
+        add(node, string_heap(node.name) + vector_heap(node.arguments));
+        ASTWalker::visit_function_call(node);
+    }
+    void visit_index(IndexNode& node) { add(node, 0); ASTWalker::visit_index(node); }
+    void visit_error(ErrorNode& node) { add(node, string_heap(node.message)); }
+
+private:
+    template <typename Node>
+    void add(Node& node, size_t owned) {
+        // Declaration/Parameter shadow ASTNode::type with their declared type
+        TypeStats& entry = stats[static_cast<int>(node.ASTNode::type)];
+        entry.count++;
+        entry.object_bytes += sizeof(Node);
+        entry.owned_bytes += owned;
+    }
+};
+
+// === Measurement ===
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+size_t peak_rss_kb() {
+    struct rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss);
+}
+
+void run_case(const char* name, const std::string& source, int iterations) {
+    const char* path = "parser_bench_input.turd";
+    {
+        std::ofstream file(path);
+        file << source;
+    }
+
+    auto lex_start = std::chrono::steady_clock::now();
+    Lexer lexer(path);
+    std::vector<Token> tokens = lexer.tokenize();
+    double lex_time = seconds_since(lex_start);
+    std::remove(path);
+
+    // best of N; allocation counters are taken from the last run and include
+    // the parser's own copy of the token stream
+    double best = 1e30;
+    size_t allocations = 0, bytes = 0, heap_peak = 0;
+    ASTNodePTR ast;
+    for (int i = 0; i < iterations; ++i) {
+        ast.reset();
+        size_t count_before = allocation_count.load();
+        size_t bytes_before = allocated_bytes.load();
+        size_t live_before = live_bytes.load();
+        peak_live_bytes.store(live_before);
+
+        auto start = std::chrono::steady_clock::now();
+        SyntaxParser parser(tokens);
+        ast = parser.parse_program();
+        best = std::min(best, seconds_since(start));
+
+        allocations = allocation_count.load() - count_before;
+        bytes = allocated_bytes.load() - bytes_before;
+        heap_peak = peak_live_bytes.load() - live_before;
+    }
+
+    NodeCensus census;
+    census.visit(*ast);
+    size_t nodes = 0, node_bytes = 0;
+    for (const TypeStats& entry : census.stats) {
+        nodes += entry.count;
+        node_bytes += entry.object_bytes + entry.owned_bytes;
+    }
+
+    std::printf("\n=== %s ===\n", name);
+    std::printf("source %zu bytes, %zu tokens, %zu nodes (lexing took %.3f ms)\n",
+                source.size(), tokens.size(), nodes, lex_time * 1e3);
+    std::printf("parse      %10.3f ms   %12.0f tokens/s   %12.0f nodes/s\n",
+                best * 1e3, tokens.size() / best, nodes / best);
+    std::printf("allocs     %10zu       %12.2f per node    %12zu bytes (%.1f per node)\n",
+                allocations, double(allocations) / nodes, bytes, double(bytes) / nodes);
+    std::printf("heap peak  %10zu bytes during parse, tree holds %zu bytes (%.1f per node)\n",
+                heap_peak, node_bytes, double(node_bytes) / nodes);
+
+    std::printf("%-14s %10s %8s %12s %12s\n", "NodeType", "count", "sizeof", "owned/node", "total bytes");
+    for (int type = 0; type <= static_cast<int>(NodeType::Error); ++type) {
+        const TypeStats& entry = census.stats[type];
+        if (entry.count == 0) continue;
+        std::printf("%-14s %10zu %8zu %12.1f %12zu\n", nodeTypeToString(static_cast<NodeType>(type)),
+                    entry.count, entry.object_bytes / entry.count,
+                    double(entry.owned_bytes) / entry.count, entry.object_bytes + entry.owned_bytes);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int scale = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100;
+    int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+    std::printf("parser benchmark: scale %d, best of %d\n", scale, iterations);
+
+    run_case("deep nesting", deep_nesting(scale), iterations);
+    run_case("long expression chains", long_expressions(scale), iterations);
+    run_case("many small functions", many_functions(scale), iterations);
+
+    std::printf("\npeak RSS %zu KiB\n", peak_rss_kb());
+    return 0;
+}
@@ -0,0 +1,374 @@
+#include "linear_scan.hpp"
+#include "../IR/loops.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+bool needs_place(const IRInstruction& instruction) {
+    return instruction.type != TypeId::Void && instruction.op != Opcode::Const &&
+           instruction.op != Opcode::Undef && instruction.op != Opcode::Nop;
+}
+
+struct Interval {
+    ValueId value;
+    uint32_t start;
+    uint32_t end;
+    double cost = 0.0;          // loop-weighted uses and definition
+    bool crosses_call = false;
+};
+
+class Allocator {
+public:
+    Allocator(const IRFunction& function, const RegisterClass& gp, const RegisterClass& fp,
+              const LinearScanAllocator::ClobberQuery& clobbers, const AllocationHints& hints,
+              RegisterAllocationStats& stats)
+        : function(function), gp(gp), fp(fp), clobbers(clobbers), hints(hints), stats(stats),
+          interval_of(function.values.size(), no_interval) {}
+
+    RegisterAllocation run() {
+        result.reg.assign(function.values.size(), RegisterAllocation::no_register);
+        result.slot.assign(function.values.size(), RegisterAllocation::no_slot);
+        number_instructions();
+        build_intervals();
+        scan();
+        return std::move(result);
+    }
+
+private:
+    static constexpr uint32_t no_interval = UINT32_MAX;
+
+    // === Live Intervals ===
+
+    void number_instructions() {
+        size_t count = function.blocks.size();
+        block_start.resize(count);
+        block_end.resize(count);
+        position.assign(function.values.size(), 0);
+        uint32_t next = 0;
+        for (BlockId block = 0; block < count; ++block) {
+            block_start[block] = next;
+            for (ValueId value : function.blocks[block].code) {
+                position[value] = next;
+                Clobber clobber = clobbers(function, value);
+                // live from before the call until after it: the call point sits between read and write
+                if (clobber == Clobber::Call) clobber_points.push_back(next + 1);
+                if (clobber == Clobber::CallBetween) clobber_points.push_back(next);
+                next += 2;
+            }
+            block_end[block] = next == block_start[block] ? next : next - 1;
+        }
+    }
+
+    uint32_t definition(ValueId value) const {
+        const IRInstruction& instruction = function.values[value];
+        if (instruction.op == Opcode::Param) return 0;
+        if (instruction.op == Opcode::Phi) return block_start[instruction.block];
+        return position[value] + 1;
+    }
+
+    Interval& interval(ValueId value) {
+        return intervals[interval_of[value]];
+    }
+
+    void build_intervals() {
+        DominatorTree dominators(function);
+        LoopInfo loops(function, dominators);
+        auto weight = [&](BlockId block) {
+            static const double powers[] = {1.0, 10.0, 100.0, 1e3, 1e4, 1e5, 1e6};
+            return powers[std::min<uint32_t>(loops.depth(block), 6)];
+        };
+
+        for (const auto& block : function.blocks) {
+            for (ValueId value : block.code) {
+                const IRInstruction& instruction = function.values[value];
+                if (!needs_place(instruction) || hints.unplaced[value]) continue;
+                interval_of[value] = static_cast<uint32_t>(intervals.size());
+                uint32_t start = definition(value);
+                intervals.push_back({value, start, start, weight(instruction.block)});
+            }
+        }
+
+        visited.assign(function.blocks.size(), no_value);
+        for (BlockId block = 0; block < function.blocks.size(); ++block) {
+            for (ValueId value : function.blocks[block].code) {
+                const IRInstruction& instruction = function.values[value];
+                for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+                    ValueId operand = function.operand(value, i);
+                    if (interval_of[operand] == no_interval) continue;
+                    if (instruction.op == Opcode::Phi) {
+                        BlockId pred = function.blocks[block].preds[i];
+                        live_out(operand, pred);
+                        interval(operand).cost += weight(pred);
+                    } else {
+                        extend(operand, position[value]);
+                        if (function.values[operand].block != block) live_in(operand, block);
+                        interval(operand).cost += weight(block);
+                    }
+                }
+            }
+        }
+
+        // a call's own result starts at its (odd) clobber point without crossing it; an
+        // interval starting at a print's (even) point is live into its block, so it does
+        for (auto& live : intervals) {
+            auto next = std::lower_bound(clobber_points.begin(), clobber_points.end(), live.start);
+            if (next != clobber_points.end() && *next == live.start && (*next & 1)) ++next;
+            live.crosses_call = next != clobber_points.end() && *next <= live.end;
+        }
+    }
+
+    void extend(ValueId value, uint32_t point) {
+        Interval& live = interval(value);
+        live.start = std::min(live.start, point);
+        live.end = std::max(live.end, point);
+    }
+
+    // walks back from a block the value is live into, up to its definition
+    void live_in(ValueId value, BlockId block) {
+        std::vector<BlockId> work{block};
+        while (!work.empty()) {
+            BlockId current = work.back();
+            work.pop_back();
+            if (visited[current] == value) continue;
+            visited[current] = value;
+            extend(value, block_start[current]);
+            for (BlockId pred : function.blocks[current].preds) {
+                extend(value, block_end[pred]);
+                if (function.values[value].block != pred) work.push_back(pred);
+            }
+        }
+    }
+
+    void live_out(ValueId value, BlockId block) {
+        extend(value, block_end[block]);
+        if (function.values[value].block != block) live_in(value, block);
+    }
+
+    // === Scan ===
+
+    struct ClassState {
+        const RegisterClass* registers;
+        std::vector<uint32_t> owner;    // interval holding each register, or no_interval
+    };
+
+    void scan() {
+        std::vector<uint32_t> order(intervals.size());
+        for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return intervals[a].start != intervals[b].start ? intervals[a].start < intervals[b].start : a < b;
+        });
+
+        ClassState classes[2] = {{&gp, {}}, {&fp, {}}};
+        for (auto& state : classes) {
+            uint8_t highest = 0;
+            for (uint8_t reg : state.registers->caller_saved) highest = std::max<uint8_t>(highest, reg + 1);
+            for (uint8_t reg : state.registers->callee_saved) highest = std::max<uint8_t>(highest, reg + 1);
+            state.owner.assign(highest, no_interval);
+        }
+        std::vector<bool> saved(256, false);
+
+        for (uint32_t current : order) {
+            Interval& live = intervals[current];
+            release_slots(live.start);
+            ClassState& state = classes[function.values[live.value].type == TypeId::Float ? 1 : 0];
+            for (uint32_t& holder : state.owner) {
+                if (holder != no_interval && intervals[holder].end < live.start) holder = no_interval;
+            }
+
+            int reg = pick_free(state, live);
+            if (reg < 0) reg = evict(state, live);
+            if (reg < 0) {
+                spill(live);
+                continue;
+            }
+            state.owner[reg] = current;
+            result.reg[live.value] = static_cast<int16_t>(reg);
+            if (is_callee_saved(state, reg) && !saved[reg]) {
+                saved[reg] = true;
+                result.saved.push_back(static_cast<uint8_t>(reg));
+            }
+        }
+
+        for (const auto& live : intervals) {
+            if (result.reg[live.value] != RegisterAllocation::no_register) ++stats.in_registers;
+        }
+        stats.intervals += intervals.size();
+        stats.callee_saved += result.saved.size();
+        std::sort(result.saved.begin(), result.saved.end());
+    }
+
+    static bool is_callee_saved(const ClassState& state, int reg) {
+        const auto& callee = state.registers->callee_saved;
+        return std::find(callee.begin(), callee.end(), reg) != callee.end();
+    }
+
+    bool allowed(const ClassState& state, const Interval& live, int reg) const {
+        return !live.crosses_call || is_callee_saved(state, reg);
+    }
+
+    int pick_free(const ClassState& state, const Interval& live) {
+        // a hinted register avoids a move
+        auto try_hint = [&](ValueId other) {
+            int reg = result.reg[other];
+            return reg >= 0 && state.owner[reg] == no_interval && allowed(state, live, reg) ? reg : -1;
+        };
+        int preferred = try_preferred(state, live);
+        if (preferred >= 0) return preferred;
+        const IRInstruction& instruction = function.values[live.value];
+        if (instruction.op == Opcode::Phi || instruction.op == Opcode::Copy) {
+            for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+                ValueId operand = function.operand(live.value, i);
+                if (interval_of[operand] == no_interval) continue;
+                if (instruction.op == Opcode::Copy && function.values[operand].type != instruction.type) continue;
+                int reg = try_hint(operand);
+                if (reg >= 0) return reg;
+            }
+        }
+        for (ValueId user : phi_users(live.value)) {
+            int reg = try_hint(user);
+            if (reg >= 0) return reg;
+        }
+
+        if (!live.crosses_call) {
+            for (uint8_t reg : state.registers->caller_saved) {
+                if (state.owner[reg] == no_interval) return reg;
+            }
+        }
+        for (uint8_t reg : state.registers->callee_saved) {
+            if (state.owner[reg] == no_interval) return reg;
+        }
+        return -1;
+    }
+
+    int try_preferred(const ClassState& state, const Interval& live) const {
+        int reg = hints.preferred[live.value];
+        if (reg < 0 || static_cast<size_t>(reg) >= state.owner.size() || state.owner[reg] != no_interval) return -1;
+        const auto& caller = state.registers->caller_saved;
+        bool in_class = is_callee_saved(state, reg) || std::find(caller.begin(), caller.end(), reg) != caller.end();
+        return in_class && allowed(state, live, reg) ? reg : -1;
+    }
+
+    // the phis this value flows into, computed once for all values
+    const std::vector<ValueId>& phi_users(ValueId value) {
+        if (phi_uses.empty()) {
+            phi_uses.resize(function.values.size());
+            for (const auto& block : function.blocks) {
+                for (ValueId phi : block.code) {
+                    if (function.values[phi].op != Opcode::Phi) break;
+                    for (uint32_t i = 0; i < function.values[phi].operand_count; ++i) {
+                        phi_uses[function.operand(phi, i)].push_back(phi);
+                    }
+                }
+            }
+        }
+        return phi_uses[value];
+    }
+
+    // takes the register of the cheapest active interval it may use when
+    // that one costs less than the current interval; the loser is spilled
+    int evict(ClassState& state, const Interval& live) {
+        int best = -1;
+        for (size_t reg = 0; reg < state.owner.size(); ++reg) {
+            uint32_t holder = state.owner[reg];
+            if (holder == no_interval || !allowed(state, live, static_cast<int>(reg))) continue;
+            if (best < 0) {
+                best = static_cast<int>(reg);
+                continue;
+            }
+            const Interval& candidate = intervals[holder];
+            const Interval& chosen = intervals[state.owner[best]];
+            if (candidate.cost < chosen.cost || (candidate.cost == chosen.cost && candidate.end > chosen.end)) {
+                best = static_cast<int>(reg);
+            }
+        }
+        if (best < 0 || intervals[state.owner[best]].cost >= live.cost) return -1;
+
+        Interval& loser = intervals[state.owner[best]];
+        result.reg[loser.value] = RegisterAllocation::no_register;
+        spill(loser);
+        state.owner[best] = no_interval;
+        return best;
+    }
+
+    // === Stack Slots ===
+
+    void spill(const Interval& live) {
+        ++stats.spilled;
+        // a slot whose last owner ended before this interval began
+        int32_t slot = RegisterAllocation::no_slot;
+        for (size_t i = 0; i < free_slots.size(); ++i) {
+            if (slot_free_after[free_slots[i]] < live.start) {
+                slot = free_slots[i];
+                free_slots.erase(free_slots.begin() + static_cast<std::ptrdiff_t>(i));
+                break;
+            }
+        }
+        if (slot == RegisterAllocation::no_slot) {
+            slot = static_cast<int32_t>(result.slot_count++);
+            slot_free_after.push_back(0);
+        }
+        result.slot[live.value] = slot;
+        spilled_active.push_back(interval_of[live.value]);
+    }
+
+    void release_slots(uint32_t point) {
+        for (size_t i = 0; i < spilled_active.size();) {
+            const Interval& live = intervals[spilled_active[i]];
+            if (live.end < point) {
+                int32_t slot = result.slot[live.value];
+                slot_free_after[slot] = live.end;
+                free_slots.push_back(slot);
+                spilled_active[i] = spilled_active.back();
+                spilled_active.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    const IRFunction& function;
+    const RegisterClass& gp;
+    const RegisterClass& fp;
+    const LinearScanAllocator::ClobberQuery& clobbers;
+    const AllocationHints& hints;
+    RegisterAllocationStats& stats;
+    RegisterAllocation result;
+
+    std::vector<uint32_t> block_start, block_end, position;
+    std::vector<uint32_t> clobber_points;   // ascending
+    std::vector<Interval> intervals;
+    std::vector<uint32_t> interval_of;
+    std::vector<ValueId> visited;           // per block: the value last walked through it
+    std::vector<std::vector<ValueId>> phi_uses;
+
+    std::vector<uint32_t> spilled_active;
+    std::vector<int32_t> free_slots;
+    std::vector<uint32_t> slot_free_after;
+};
+
+} // namespace
+
+RegisterAllocation LinearScanAllocator::allocate(const IRFunction& function, const AllocationHints& hints,
+                                                 RegisterAllocationStats& stats) const {
+    ++stats.functions;
+    return Allocator(function, gp, fp, clobbers, hints, stats).run();
+}
+
+void RegisterAllocationStats::print(std::ostream& out) const {
+    char line[128];
+    auto row = [&](const char* name, size_t count) {
+        std::snprintf(line, sizeof(line), "%-16s %10zu\n", name, count);
+        out << line;
+    };
+    row("functions", functions);
+    row("intervals", intervals);
+    row("in registers", in_registers);
+    row("spilled", spilled);
+    row("spill stores", spill_stores);
+    row("reloads", reloads);
+    row("moves", moves);
+    row("moves coalesced", coalesced);
+    row("callee-saved", callee_saved);
+    row("tail calls", tail_calls);
+}
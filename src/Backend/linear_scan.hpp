@@ -0,0 +1,90 @@
+#pragma once
+#include "../IR/ir.hpp"
+#include <functional>
+#include <ostream>
+
+// Registers are small integers the backend gives meaning to.
+struct RegisterClass {
+    std::vector<uint8_t> caller_saved;  // tried first: free to use, lost across calls
+    std::vector<uint8_t> callee_saved;  // survive calls, cost a save and a restore per function
+};
+
+// What an instruction does to the caller-saved registers.
+enum class Clobber : uint8_t {
+    None,
+    Call,           // calls out after reading all of its operands
+    CallBetween     // calls out several times and reads operands in between (print)
+};
+
+struct RegisterAllocation {
+    static constexpr int16_t no_register = -1;
+    static constexpr int32_t no_slot = -1;
+
+    std::vector<int16_t> reg;           // per value: its register, or no_register
+    std::vector<int32_t> slot;          // per value: its stack slot, or no_slot
+    uint32_t slot_count = 0;
+    std::vector<uint8_t> saved;         // callee-saved registers the function uses
+};
+
+// What the backend knows about one function before allocation.
+struct AllocationHints {
+    std::vector<int16_t> preferred;     // per value: the register it would like, or no_register
+    std::vector<bool> unplaced;         // per value: computed where it is used, needs no place
+};
+
+// Static counts over the emitted code: a reload is a read of a spilled
+// value's slot, a spill store a write to one. A move is a register or slot
+// copy for a phi, a Copy, an argument or a parameter; it is coalesced when
+// both ends got the same place and no code was needed.
+struct RegisterAllocationStats {
+    size_t functions = 0;
+    size_t intervals = 0;       // values that needed a place
+    size_t in_registers = 0;
+    size_t spilled = 0;
+    size_t spill_stores = 0;
+    size_t reloads = 0;
+    size_t moves = 0;
+    size_t coalesced = 0;
+    size_t callee_saved = 0;    // registers saved in prologues
+    size_t tail_calls = 0;      // calls emitted as jumps
+
+    void print(std::ostream& out) const;
+};
+
+// === Linear Scan Register Allocation ===
+// Poletto and Sarkar's linear scan over one live interval per value.
+// Instructions are numbered in block order, two positions each: operands
+// are read at the first and the result written at the second, so a value
+// whose last use is an instruction can share a register with its result.
+// An interval runs from the definition to the furthest point the value is
+// live, found by walking back from every use to the definition; a phi
+// operand is used at the end of its predecessor.
+//
+// Intervals are visited by start. A value live across an instruction that
+// calls out only gets callee-saved registers; floats, having none, are
+// spilled there. Otherwise caller-saved registers go first. When nothing is
+// free, the interval with the lowest spill cost, its uses and definition
+// weighted 10x per enclosing loop, gives way and lives in a stack slot for
+// its whole life. Slots are reused once their interval has ended.
+//
+// Moves are coalesced through hints. A value first tries the register the
+// backend prefers for it, such as the one a parameter arrives in. A phi
+// and its operands, and a Copy and its source, then try each other's
+// register, so a loop counter and its increment usually share one and the
+// back edge needs no move.
+// Constants and Undef get no place; the backend rematerializes them.
+class LinearScanAllocator {
+public:
+    using ClobberQuery = std::function<Clobber(const IRFunction&, ValueId)>;
+
+    LinearScanAllocator(RegisterClass gp, RegisterClass fp, ClobberQuery clobbers)
+        : gp(std::move(gp)), fp(std::move(fp)), clobbers(std::move(clobbers)) {}
+
+    // values of TypeId::Float take fp registers, all others gp registers
+    RegisterAllocation allocate(const IRFunction& function, const AllocationHints& hints,
+                                RegisterAllocationStats& stats) const;
+
+private:
+    RegisterClass gp, fp;
+    ClobberQuery clobbers;
+};
@@ -0,0 +1,60 @@
+#include "native_toolchain.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+// the directory holding the running compiler, "." when it can't be found
+std::string executable_directory() {
+    char path[4096];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length <= 0) return ".";
+    std::string executable(path, static_cast<size_t>(length));
+    size_t slash = executable.rfind('/');
+    return slash == std::string::npos ? "." : executable.substr(0, slash);
+}
+
+std::string shell_quote(const std::string& text) {
+    std::string quoted = "'";
+    for (char c : text) {
+        if (c == '\'') quoted += "'\\''";
+        else quoted += c;
+    }
+    return quoted + "'";
+}
+
+} // namespace
+
+NativeToolchain::NativeToolchain() {
+    const char* runtime = std::getenv("TURD_RUNTIME");
+    runtime_path = runtime ? runtime : executable_directory() + "/libturd_runtime.a";
+    const char* cc = std::getenv("CC");
+    driver = cc ? cc : "cc";
+}
+
+void NativeToolchain::link(const std::string& assembly, const std::string& output) const {
+    if (access(runtime_path.c_str(), R_OK) != 0) {
+        throw std::runtime_error("runtime library not found: " + runtime_path);
+    }
+
+    char temporary[] = "/tmp/turd-XXXXXX.s";
+    int fd = mkstemps(temporary, 2);
+    if (fd < 0) throw std::runtime_error("cannot create a temporary assembly file");
+    close(fd);
+    {
+        std::ofstream file(temporary);
+        file << assembly;
+        if (!file) {
+            unlink(temporary);
+            throw std::runtime_error(std::string("cannot write ") + temporary);
+        }
+    }
+
+    std::string command = driver + " " + shell_quote(temporary) + " " + shell_quote(runtime_path) +
+                          " -lm -o " + shell_quote(output);
+    int status = std::system(command.c_str());
+    unlink(temporary);
+    if (status != 0) throw std::runtime_error("linking failed: " + command);
+}
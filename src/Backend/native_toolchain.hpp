@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+
+// === Native Toolchain ===
+// Assembles and links generated assembly with the system C compiler driver
+// (cc, overridable with $CC), which runs as and ld and supplies the C
+// library. The runtime comes from libturd_runtime.a next to the compiler
+// executable, or from $TURD_RUNTIME.
+class NativeToolchain {
+public:
+    NativeToolchain();
+
+    const std::string& runtime_library() const { return runtime_path; }
+
+    // writes the assembly to a temporary file and links it into `output`;
+    // throws std::runtime_error when the toolchain fails
+    void link(const std::string& assembly, const std::string& output) const;
+
+private:
+    std::string runtime_path;
+    std::string driver;
+};
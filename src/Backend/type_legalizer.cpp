@@ -0,0 +1,190 @@
+#include "type_legalizer.hpp"
+#include <stdexcept>
+
+namespace {
+
+bool is_arithmetic(Opcode op) {
+    switch (op) {
+        case Opcode::Add: case Opcode::Sub: case Opcode::Mul: case Opcode::Div: case Opcode::Mod:
+        case Opcode::FloorDiv: case Opcode::Pow: case Opcode::Shr: case Opcode::Neg:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool is_comparison(Opcode op) {
+    return op >= Opcode::Eq && op <= Opcode::Ge;
+}
+
+class Legalizer {
+public:
+    Legalizer(const IRModule& module, IRFunction& function) : module(module), function(function) {}
+
+    void run() {
+        split_edges_into_phis();
+        unbox_dynamic_results();
+        for (BlockId block = 0; block < function.blocks.size(); ++block) convert_operands(block);
+        convert_phi_operands();
+    }
+
+private:
+    void split_edges_into_phis() {
+        size_t count = function.blocks.size();
+        for (BlockId block = 0; block < count; ++block) {
+            if (function.blocks[block].succs.size() < 2) continue;
+            for (size_t i = 0; i < function.blocks[block].succs.size(); ++i) {
+                BlockId succ = function.blocks[block].succs[i];
+                const auto& code = function.blocks[succ].code;
+                if (!code.empty() && function.values[code.front()].op == Opcode::Phi) function.split_edge(block, succ);
+            }
+        }
+    }
+
+    // arithmetic touching an Unknown value computes a boxed result; a typed
+    // result is unboxed right after, and its users read the unboxed copy
+    void unbox_dynamic_results() {
+        std::vector<ValueId> dynamic;
+        for (const auto& block : function.blocks) {
+            for (ValueId value : block.code) {
+                const IRInstruction& instruction = function.values[value];
+                if (!is_arithmetic(instruction.op) || instruction.type == TypeId::Unknown) continue;
+                for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+                    if (function.values[function.operand(value, i)].type == TypeId::Unknown) {
+                        dynamic.push_back(value);
+                        break;
+                    }
+                }
+            }
+        }
+        if (dynamic.empty()) return;
+
+        std::vector<ValueId> forward(function.values.size(), no_value);
+        std::vector<ValueId> unboxes;
+        for (ValueId value : dynamic) {
+            IRInstruction& instruction = function.values[value];
+            TypeId type = instruction.type;
+            instruction.type = TypeId::Unknown;
+            ValueId unbox = function.create(Opcode::Copy, type, {value}, 0, instruction.line);
+            insert_after(value, unbox);
+            forward.resize(function.values.size(), no_value);
+            forward[value] = unbox;
+            unboxes.push_back(unbox);
+        }
+        function.forward_operands(forward);
+        for (size_t i = 0; i < dynamic.size(); ++i) function.operands_of(unboxes[i])[0] = dynamic[i];
+    }
+
+    void convert_operands(BlockId block) {
+        std::vector<ValueId> code;
+        code.swap(function.blocks[block].code);
+        auto& rebuilt = function.blocks[block].code;
+        rebuilt.reserve(code.size());
+
+        for (ValueId value : code) {
+            IRInstruction instruction = function.values[value];
+            auto convert = [&](uint32_t index, TypeId to) {
+                ValueId operand = function.operand(value, index);
+                ValueId converted = conversion(operand, to, instruction.line);
+                if (converted == operand) return;
+                function.values[converted].block = block;
+                rebuilt.push_back(converted);
+                function.operands_of(value)[index] = converted;
+            };
+
+            if (is_arithmetic(instruction.op) && instruction.type == TypeId::Unknown) {
+                for (uint32_t i = 0; i < instruction.operand_count; ++i) convert(i, TypeId::Unknown);
+            } else if (is_comparison(instruction.op)) {
+                bool dynamic = false;
+                for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+                    dynamic |= function.values[function.operand(value, i)].type == TypeId::Unknown;
+                }
+                if (dynamic) {
+                    for (uint32_t i = 0; i < instruction.operand_count; ++i) convert(i, TypeId::Unknown);
+                }
+            } else {
+                switch (instruction.op) {
+                    case Opcode::Not:
+                    case Opcode::Branch:
+                        convert(0, TypeId::Bool);
+                        break;
+                    case Opcode::IntToFloat:
+                    case Opcode::NewArray:
+                        convert(0, TypeId::Int);
+                        break;
+                    case Opcode::BoundsCheck:
+                    case Opcode::LoadElement:
+                        convert(1, TypeId::Int);
+                        break;
+                    case Opcode::StoreElement:
+                        convert(1, TypeId::Int);
+                        convert(2, element_type(function.values[function.operand(value, 0)].type));
+                        break;
+                    case Opcode::Return:
+                        if (instruction.operand_count == 1) convert(0, function.returnType);
+                        break;
+                    case Opcode::StoreGlobal:
+                        convert(0, module.globals[instruction.immediate]);
+                        break;
+                    case Opcode::Call: {
+                        const IRFunction& callee = module.functions[instruction.immediate];
+                        for (uint32_t i = 0; i < instruction.operand_count; ++i) convert(i, callee.paramTypes[i]);
+                        break;
+                    }
+                    default:
+                        break;
+                }
+            }
+            rebuilt.push_back(value);
+        }
+    }
+
+    // a converted phi operand is computed at the end of its predecessor, which
+    // has no other successor once edges into phis are split
+    void convert_phi_operands() {
+        for (BlockId block = 0; block < function.blocks.size(); ++block) {
+            for (ValueId phi : function.blocks[block].code) {
+                const IRInstruction& instruction = function.values[phi];
+                if (instruction.op != Opcode::Phi) break;
+                for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+                    ValueId operand = function.operand(phi, i);
+                    ValueId converted = conversion(operand, instruction.type, instruction.line);
+                    if (converted == operand) continue;
+                    BlockId pred = function.blocks[block].preds[i];
+                    function.values[converted].block = pred;
+                    auto& code = function.blocks[pred].code;
+                    code.insert(code.end() - 1, converted);
+                    function.operands_of(phi)[i] = converted;
+                }
+            }
+        }
+    }
+
+    // the instruction turning value into type `to`, not yet placed; value itself when it fits
+    ValueId conversion(ValueId value, TypeId to, int line) {
+        TypeId from = function.values[value].type;
+        if (from == to || to == TypeId::Void) return value;
+        if (from == TypeId::Int && to == TypeId::Float) return function.create(Opcode::IntToFloat, to, {value}, 0, line);
+        if (from == TypeId::Unknown || to == TypeId::Unknown) return function.create(Opcode::Copy, to, {value}, 0, line);
+        throw std::logic_error(std::string("cannot convert ") + typeIdToString(from) + " to " + typeIdToString(to) +
+                               " in '" + function.name + "'");
+    }
+
+    void insert_after(ValueId value, ValueId inserted) {
+        BlockId block = function.values[value].block;
+        auto& code = function.blocks[block].code;
+        size_t position = 0;
+        while (code[position] != value) ++position;
+        code.insert(code.begin() + position + 1, inserted);
+        function.values[inserted].block = block;
+    }
+
+    const IRModule& module;
+    IRFunction& function;
+};
+
+} // namespace
+
+void legalize_types(IRModule& module) {
+    for (auto& function : module.functions) Legalizer(module, function).run();
+}
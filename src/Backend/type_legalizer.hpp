@@ -0,0 +1,17 @@
+#pragma once
+#include "../IR/ir.hpp"
+
+// === Type Legalization ===
+// Prepares optimized IR for a backend that keeps values unboxed. IR lets
+// an Unknown (dynamically typed) value meet a typed one anywhere; after
+// legalization every such meeting is an explicit Copy whose type differs
+// from its operand's, which the backend turns into a box or an unbox:
+//  - an arithmetic instruction with an Unknown operand or result works on
+//    boxed operands only, and a typed result is unboxed right after it
+//  - a comparison with an Unknown operand gets both operands boxed
+//  - branch conditions, Not operands, returns, call arguments, stores,
+//    array sizes, indices and elements and phi operands are converted to
+//    the type their user expects
+// Edges from a block with several successors into a block with phis are
+// split, so a backend can place phi moves at the end of the predecessor.
+void legalize_types(IRModule& module);
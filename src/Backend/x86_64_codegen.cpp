@@ -0,0 +1,1045 @@
+#include "x86_64_codegen.hpp"
+#include "type_legalizer.hpp"
+#include "../Runtime/runtime.hpp"
+#include <cstdarg>
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+
+enum GpRegister : uint8_t { RAX, RCX, RDX, RBX, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+const char* const gp64[] = {"%rax", "%rcx", "%rdx", "%rbx", "%rsi", "%rdi", "%r8",
+                            "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15"};
+const char* const gp32[] = {"%eax", "%ecx", "%edx", "%ebx", "%esi", "%edi", "%r8d",
+                            "%r9d", "%r10d", "%r11d", "%r12d", "%r13d", "%r14d", "%r15d"};
+const char* const xmm_names[] = {"%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4", "%xmm5", "%xmm6", "%xmm7",
+                                 "%xmm8", "%xmm9", "%xmm10", "%xmm11", "%xmm12", "%xmm13", "%xmm14", "%xmm15"};
+
+const GpRegister gp_arguments[] = {RDI, RSI, RDX, RCX, R8, R9};
+constexpr uint32_t gp_argument_count = 6;
+constexpr uint32_t float_argument_count = 8;
+
+// rax, rcx, rdx, xmm0 and xmm1 are scratch inside an instruction; r11 and
+// xmm15 break cycles in parallel moves. The argument registers that are
+// not scratch are allocated; argument setup is a parallel move.
+RegisterClass gp_registers() {
+    return {{RSI, RDI, R8, R9, R10}, {RBX, R12, R13, R14, R15}};
+}
+
+RegisterClass float_registers() {
+    return {{2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14}, {}};
+}
+
+bool is_float(TypeId type) {
+    return type == TypeId::Float;
+}
+
+bool is_comparison(Opcode op) {
+    return op >= Opcode::Eq && op <= Opcode::Ge;
+}
+
+// the instructions emitted as a call, from the same rules emit_instruction follows
+Clobber clobber_of(const IRFunction& function, ValueId value) {
+    const IRInstruction& instruction = function.values[value];
+    auto operand_type = [&](uint32_t i) { return function.values[function.operand(value, i)].type; };
+    switch (instruction.op) {
+        case Opcode::Call: case Opcode::Read: case Opcode::NewArray:
+            return Clobber::Call;
+        case Opcode::Print:
+            return instruction.operand_count > 1 ? Clobber::CallBetween : Clobber::Call;
+        case Opcode::Copy:
+            return instruction.type == operand_type(0) ? Clobber::None : Clobber::Call;
+        case Opcode::Neg:
+            return instruction.type == TypeId::Unknown ? Clobber::Call : Clobber::None;
+        case Opcode::Add: case Opcode::Sub: case Opcode::Mul: case Opcode::Div: case Opcode::Mod:
+        case Opcode::FloorDiv: case Opcode::Pow: case Opcode::Shr: {
+            TypeId operands = operand_type(0);
+            bool calls = instruction.type == TypeId::Unknown || operands == TypeId::String ||
+                         instruction.op == Opcode::Pow ||
+                         (is_float(operands) && (instruction.op == Opcode::Mod || instruction.op == Opcode::FloorDiv));
+            return calls ? Clobber::Call : Clobber::None;
+        }
+        case Opcode::Eq: case Opcode::Ne: case Opcode::Lt: case Opcode::Le: case Opcode::Gt: case Opcode::Ge:
+            return operand_type(0) == TypeId::Unknown || operand_type(0) == TypeId::String ? Clobber::Call
+                                                                                             : Clobber::None;
+        default:
+            return Clobber::None;
+    }
+}
+
+int32_t runtime_operator(Opcode op) {
+    switch (op) {
+        case Opcode::Add: return TURD_ADD;
+        case Opcode::Sub: return TURD_SUB;
+        case Opcode::Mul: return TURD_MUL;
+        case Opcode::Div: return TURD_DIV;
+        case Opcode::Mod: return TURD_MOD;
+        case Opcode::FloorDiv: return TURD_FLOOR_DIV;
+        case Opcode::Pow: return TURD_POW;
+        case Opcode::Shr: return TURD_SHR;
+        case Opcode::Eq: return TURD_EQ;
+        case Opcode::Ne: return TURD_NE;
+        case Opcode::Lt: return TURD_LT;
+        case Opcode::Le: return TURD_LE;
+        case Opcode::Gt: return TURD_GT;
+        case Opcode::Ge: return TURD_GE;
+        default: throw std::logic_error(std::string("no runtime operator for ") + opcodeToString(op));
+    }
+}
+
+// setcc/jcc suffix for a signed integer comparison, or for its negation
+const char* condition_code(Opcode op, bool negated = false) {
+    switch (op) {
+        case Opcode::Eq: return negated ? "ne" : "e";
+        case Opcode::Ne: return negated ? "e" : "ne";
+        case Opcode::Lt: return negated ? "ge" : "l";
+        case Opcode::Le: return negated ? "g" : "le";
+        case Opcode::Gt: return negated ? "le" : "g";
+        default: return negated ? "l" : "ge";
+    }
+}
+
+const char* type_suffix(TypeId type) {
+    switch (type) {
+        case TypeId::Int: return "int";
+        case TypeId::Float: return "float";
+        case TypeId::Bool: return "bool";
+        case TypeId::Char: return "char";
+        case TypeId::String: return "string";
+        default: return "dynamic";
+    }
+}
+
+// how the runtime lays out an array's elements
+int32_t array_element(TypeId array) {
+    switch (element_type(array)) {
+        case TypeId::Float: return TURD_ELEMENT_FLOAT;
+        case TypeId::Bool: return TURD_ELEMENT_BOOL;
+        case TypeId::Char: return TURD_ELEMENT_CHAR;
+        case TypeId::String: return TURD_ELEMENT_STRING;
+        default: return TURD_ELEMENT_INT;
+    }
+}
+
+std::string function_symbol(const IRModule& module, size_t index) {
+    return index == module.entry ? "turd_main" : "T_" + module.functions[index].name;
+}
+
+class Assembly {
+public:
+    void line(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char buffer[256];
+        va_list args;
+        va_start(args, format);
+        std::vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        text += buffer;
+        text += '\n';
+    }
+    void raw(const std::string& content) { text += content; }
+    void blank() { text += '\n'; }
+
+    std::string text;
+};
+
+// Where a value is, or where a move goes.
+struct Place {
+    enum Kind : uint8_t { Gp, Xmm, Frame, Constant } kind;
+    int32_t index;              // register number, rbp offset, or the Const/Undef value
+    bool spill_slot = false;    // a spilled value's slot rather than an incoming stack argument
+
+    bool operator==(const Place& other) const { return kind == other.kind && index == other.index; }
+};
+
+Place gp(GpRegister reg) {
+    return {Place::Gp, reg};
+}
+
+Place xmm(int reg) {
+    return {Place::Xmm, reg};
+}
+
+// === Function Emission ===
+
+class FunctionEmitter {
+public:
+    FunctionEmitter(const IRModule& module, const IRFunction& function, size_t index,
+                    const LinearScanAllocator& allocator, RegisterAllocationStats& stats, Assembly& out)
+        : module(module), function(function), index(index), stats(stats), out(out),
+          uses(count_uses(function)), allocation(allocator.allocate(function, hints(), stats)) {}
+
+    void emit() {
+        std::string symbol = function_symbol(module, index);
+        out.blank();
+        out.line("    .p2align 4");
+        out.line("    .type %s, @function", symbol.c_str());
+        out.line("%s:", symbol.c_str());
+        emit_prologue();
+
+        for (BlockId block = 0; block < function.blocks.size(); ++block) {
+            out.line(".LF%zuB%u:", index, block);
+            const auto& code = function.blocks[block].code;
+            for (size_t i = 0; i < code.size(); ++i) {
+                if (i + 1 < code.size() && fuses_with_branch(code[i], code[i + 1])) continue;
+                if (i + 2 == code.size() && is_tail_call(code[i], code[i + 1])) {
+                    emit_tail_call(code[i]);
+                    break;
+                }
+                emit_instruction(block, code[i]);
+            }
+        }
+        for (const auto& trap : traps) {
+            out.line(".LF%zuT%zu:", index, &trap - traps.data());
+            out.line("    movl $%d, %%esi", trap.line);
+            out.line("    movl $%d, %%edi", trap.error);
+            out.line("    call turd_error@PLT");
+        }
+        out.line("    .size %s, .-%s", symbol.c_str(), symbol.c_str());
+    }
+
+private:
+    struct Trap {
+        int32_t error;
+        int line;
+    };
+
+    static std::vector<uint32_t> count_uses(const IRFunction& function) {
+        std::vector<uint32_t> uses(function.values.size(), 0);
+        for (const auto& block : function.blocks) {
+            for (ValueId value : block.code) {
+                for (uint32_t i = 0; i < function.values[value].operand_count; ++i) ++uses[function.operand(value, i)];
+            }
+        }
+        return uses;
+    }
+
+    // parameters would like the register they arrive in, and call arguments
+    // the one they leave in; comparisons fused into a branch need no place
+    AllocationHints hints() const {
+        AllocationHints hints;
+        hints.preferred.assign(function.values.size(), RegisterAllocation::no_register);
+        hints.unplaced.assign(function.values.size(), false);
+        for (ValueId value : function.blocks[0].code) {
+            const IRInstruction& instruction = function.values[value];
+            if (instruction.op != Opcode::Param || is_float(instruction.type)) continue;
+            uint32_t position = 0;
+            for (int64_t i = 0; i < instruction.immediate; ++i) position += !is_float(function.paramTypes[i]);
+            if (position < gp_argument_count) hints.preferred[value] = gp_arguments[position];
+        }
+        for (const auto& block : function.blocks) {
+            for (size_t i = 0; i < block.code.size(); ++i) {
+                ValueId value = block.code[i];
+                const IRInstruction& instruction = function.values[value];
+                if (i + 1 < block.code.size() && fuses_with_branch(value, block.code[i + 1])) hints.unplaced[value] = true;
+                if (instruction.op != Opcode::Call) continue;
+                const IRFunction& callee = module.functions[instruction.immediate];
+                uint32_t position = 0;
+                for (uint32_t k = 0; k < instruction.operand_count; ++k) {
+                    if (is_float(callee.paramTypes[k])) continue;
+                    ValueId argument = function.operand(value, k);
+                    if (position < gp_argument_count && hints.preferred[argument] == RegisterAllocation::no_register) {
+                        hints.preferred[argument] = gp_arguments[position];
+                    }
+                    ++position;
+                }
+            }
+        }
+        return hints;
+    }
+
+    // === Frame ===
+    // rbp, then the callee-saved registers in use, then the spill slots
+
+    void emit_prologue() {
+        out.line("    pushq %%rbp");
+        out.line("    movq %%rsp, %%rbp");
+        for (uint8_t reg : allocation.saved) out.line("    pushq %s", gp64[reg]);
+        uint32_t saved = 8 * static_cast<uint32_t>(allocation.saved.size());
+        uint32_t frame = ((saved + 8 * allocation.slot_count + 15) & ~15u) - saved;
+        if (frame > 0) out.line("    subq $%u, %%rsp", frame);
+
+        // parameters move from where the ABI puts them to where the allocator did
+        std::vector<std::pair<Place, Place>> moves;
+        uint32_t gp_used = 0, xmm_used = 0, stack = 0;
+        std::vector<Place> arrival;
+        for (TypeId type : function.paramTypes) {
+            if (is_float(type) && xmm_used < float_argument_count) arrival.push_back(xmm(xmm_used++));
+            else if (!is_float(type) && gp_used < gp_argument_count) arrival.push_back(gp(gp_arguments[gp_used++]));
+            else arrival.push_back({Place::Frame, static_cast<int32_t>(16 + 8 * stack++)});
+        }
+        for (ValueId value : function.blocks[0].code) {
+            const IRInstruction& instruction = function.values[value];
+            if (instruction.op == Opcode::Param && has_place(value)) {
+                moves.push_back({place_of(value), arrival[instruction.immediate]});
+            }
+        }
+        parallel_move(moves);
+    }
+
+    void emit_epilogue() {
+        emit_frame_teardown();
+        out.line("    ret");
+    }
+
+    // leaves rsp at the return address, as it was on entry
+    void emit_frame_teardown() {
+        if (allocation.saved.empty()) {
+            out.line("    leave");
+        } else {
+            out.line("    leaq -%zu(%%rbp), %%rsp", 8 * allocation.saved.size());
+            for (size_t i = allocation.saved.size(); i-- > 0;) out.line("    popq %s", gp64[allocation.saved[i]]);
+            out.line("    popq %%rbp");
+        }
+    }
+
+    // === Places ===
+
+    bool has_place(ValueId value) const {
+        return allocation.reg[value] != RegisterAllocation::no_register ||
+               allocation.slot[value] != RegisterAllocation::no_slot;
+    }
+
+    Place place_of(ValueId value) const {
+        const IRInstruction& instruction = function.values[value];
+        if (instruction.op == Opcode::Const || instruction.op == Opcode::Undef) return {Place::Constant, static_cast<int32_t>(value)};
+        if (allocation.reg[value] != RegisterAllocation::no_register) {
+            return {is_float(instruction.type) ? Place::Xmm : Place::Gp, allocation.reg[value]};
+        }
+        if (allocation.slot[value] == RegisterAllocation::no_slot) {
+            throw std::logic_error("value %" + std::to_string(value) + " in '" + function.name + "' has no place");
+        }
+        int32_t offset = -8 * static_cast<int32_t>(allocation.saved.size() + allocation.slot[value] + 1);
+        return {Place::Frame, offset, true};
+    }
+
+    std::string text(const Place& place, bool wide = true) {
+        switch (place.kind) {
+            case Place::Gp: return wide ? gp64[place.index] : gp32[place.index];
+            case Place::Xmm: return xmm_names[place.index];
+            case Place::Frame:
+                if (place.spill_slot) ++stats.reloads;
+                return std::to_string(place.index) + "(%rbp)";
+            case Place::Constant:
+                return "$" + std::to_string(static_cast<int32_t>(function.values[place.index].immediate));
+        }
+        return "";
+    }
+
+    // a 32-bit source operand: register, slot, or an int/bool/char immediate
+    std::string operand32(ValueId value) {
+        if (function.values[value].op == Opcode::Undef) return "$0";
+        return text(place_of(value), false);
+    }
+
+    // the register holding a value, loaded into `scratch` when it lives elsewhere
+    GpRegister in_gp(ValueId value, GpRegister scratch) {
+        Place place = place_of(value);
+        if (place.kind == Place::Gp) return static_cast<GpRegister>(place.index);
+        move(gp(scratch), place);
+        return scratch;
+    }
+
+    // === Moves ===
+
+    void move(const Place& to, const Place& from) {
+        if (to == from) return;
+        if (from.kind == Place::Constant) {
+            materialize(to, function.values[from.index]);
+            return;
+        }
+        if (to.kind == Place::Frame && from.kind == Place::Frame) {
+            move(gp(RAX), from);
+            move(to, gp(RAX));
+            return;
+        }
+        const char* mnemonic = "movq";
+        if (to.kind == Place::Xmm && from.kind == Place::Xmm) mnemonic = "movapd";
+        else if ((to.kind == Place::Xmm && from.kind == Place::Frame) ||
+                 (to.kind == Place::Frame && from.kind == Place::Xmm)) mnemonic = "movsd";
+        if (to.spill_slot) ++stats.spill_stores;
+        std::string source = text(from);
+        std::string target = to.kind == Place::Frame ? std::to_string(to.index) + "(%rbp)" : text(to);
+        out.line("    %s %s, %s", mnemonic, source.c_str(), target.c_str());
+    }
+
+    void materialize(const Place& to, const IRInstruction& constant) {
+        if (to.kind == Place::Frame) {
+            if (to.spill_slot) ++stats.spill_stores;
+            if (constant.op == Opcode::Const && constant.type != TypeId::String && !is_float(constant.type)) {
+                out.line("    movq $%d, %d(%%rbp)", static_cast<int32_t>(constant.immediate), to.index);
+                return;
+            }
+            materialize(gp(RAX), constant);
+            out.line("    movq %%rax, %d(%%rbp)", to.index);
+            return;
+        }
+        if (to.kind == Place::Xmm) {
+            if (constant.op == Opcode::Undef || constant.immediate == 0) {
+                out.line("    pxor %s, %s", xmm_names[to.index], xmm_names[to.index]);
+            } else {
+                out.line("    movabsq $%lld, %%rax", static_cast<long long>(constant.immediate));
+                out.line("    movq %%rax, %s", xmm_names[to.index]);
+            }
+            return;
+        }
+        if (constant.op == Opcode::Undef && is_array(constant.type)) {
+            out.line("    leaq turd_empty_array(%%rip), %s", gp64[to.index]);
+        } else if (constant.op == Opcode::Undef) {
+            out.line("    xorl %s, %s", gp32[to.index], gp32[to.index]);
+        } else if (constant.type == TypeId::String) {
+            out.line("    leaq .LS%lld(%%rip), %s", static_cast<long long>(constant.immediate), gp64[to.index]);
+        } else if (is_float(constant.type)) {
+            out.line("    movabsq $%lld, %s", static_cast<long long>(constant.immediate), gp64[to.index]);
+        } else {
+            out.line("    movl $%d, %s", static_cast<int32_t>(constant.immediate), gp32[to.index]);
+        }
+    }
+
+    // performs every (to, from) move as if all sources were read first
+    void parallel_move(std::vector<std::pair<Place, Place>> moves) {
+        std::vector<std::pair<Place, Place>> pending;
+        for (const auto& pair : moves) {
+            if (pair.first == pair.second) ++stats.coalesced;
+            else pending.push_back(pair);
+        }
+        stats.moves += pending.size();
+
+        while (!pending.empty()) {
+            bool progress = false;
+            for (size_t i = 0; i < pending.size() && !progress; ++i) {
+                bool still_read = false;
+                for (size_t j = 0; j < pending.size(); ++j) still_read |= j != i && pending[j].second == pending[i].first;
+                if (still_read) continue;
+                move(pending[i].first, pending[i].second);
+                pending.erase(pending.begin() + static_cast<std::ptrdiff_t>(i));
+                progress = true;
+            }
+            if (progress) continue;
+
+            // only cycles are left: park one destination's old value and read it from there
+            Place parked = pending[0].first;
+            Place temporary = parked.kind == Place::Xmm ? xmm(15) : gp(R11);
+            move(temporary, parked);
+            for (auto& pair : pending) {
+                if (pair.second == parked) pair.second = temporary;
+            }
+        }
+    }
+
+    void store_result(ValueId value, const Place& from) {
+        move(place_of(value), from);
+    }
+
+    Place return_register(TypeId type) const {
+        return is_float(type) ? xmm(0) : gp(RAX);
+    }
+
+    // loads arguments in parallel, then immediates into their registers, then calls
+    void call_runtime(const char* name, const std::vector<std::pair<Place, ValueId>>& arguments = {},
+                      const std::vector<std::pair<GpRegister, int32_t>>& immediates = {}) {
+        std::vector<std::pair<Place, Place>> moves;
+        for (const auto& [to, value] : arguments) moves.push_back({to, place_of(value)});
+        parallel_move(moves);
+        for (const auto& [reg, immediate] : immediates) out.line("    movl $%d, %s", immediate, gp32[reg]);
+        out.line("    call %s@PLT", name);
+    }
+
+    size_t trap(int32_t error, int line) {
+        traps.push_back({error, line});
+        return traps.size() - 1;
+    }
+
+    // === Instructions ===
+
+    // an integer comparison whose only use is the branch right after it sets the flags for that branch
+    bool fuses_with_branch(ValueId value, ValueId next) const {
+        const IRInstruction& instruction = function.values[value];
+        if (!is_comparison(instruction.op) || uses[value] != 1) return false;
+        TypeId operands = function.values[function.operand(value, 0)].type;
+        if (operands != TypeId::Int && operands != TypeId::Bool && operands != TypeId::Char) return false;
+        return function.values[next].op == Opcode::Branch && function.operand(next, 0) == value;
+    }
+
+    void emit_instruction(BlockId block, ValueId value) {
+        const IRInstruction& instruction = function.values[value];
+        auto arg = [&](uint32_t i) { return function.operand(value, i); };
+
+        switch (instruction.op) {
+            case Opcode::Nop: case Opcode::Const: case Opcode::Undef: case Opcode::Param: case Opcode::Phi:
+                break;
+            case Opcode::Copy:
+                emit_copy(value, arg(0));
+                break;
+            case Opcode::IntToFloat: {
+                Place to = place_of(value);
+                int work = to.kind == Place::Xmm ? to.index : 0;
+                std::string source = operand32(arg(0));
+                if (source[0] == '$') {
+                    move(gp(RAX), place_of(arg(0)));
+                    source = "%eax";
+                }
+                out.line("    cvtsi2sdl %s, %s", source.c_str(), xmm_names[work]);
+                store_result(value, xmm(work));
+                break;
+            }
+            case Opcode::Add: case Opcode::Sub: case Opcode::Mul: case Opcode::Div: case Opcode::Mod:
+            case Opcode::FloorDiv: case Opcode::Pow: case Opcode::Shr:
+                emit_binary(value);
+                break;
+            case Opcode::Neg:
+                if (instruction.type == TypeId::Unknown) {
+                    call_runtime("turd_dynamic_negate", {{gp(RDI), arg(0)}}, {{RSI, instruction.line}});
+                    store_result(value, gp(RAX));
+                } else if (is_float(instruction.type)) {
+                    move(xmm(0), place_of(arg(0)));
+                    out.line("    movabsq $-9223372036854775808, %%rax");
+                    out.line("    movq %%rax, %%xmm1");
+                    out.line("    xorpd %%xmm1, %%xmm0");
+                    store_result(value, xmm(0));
+                } else {
+                    GpRegister work = result_register(value, no_value);
+                    move(gp(work), place_of(arg(0)));
+                    out.line("    negl %s", gp32[work]);
+                    store_result(value, gp(work));
+                }
+                break;
+            case Opcode::Not: {
+                GpRegister work = result_register(value, no_value);
+                move(gp(work), place_of(arg(0)));
+                out.line("    xorl $1, %s", gp32[work]);
+                store_result(value, gp(work));
+                break;
+            }
+            case Opcode::Eq: case Opcode::Ne: case Opcode::Lt: case Opcode::Le: case Opcode::Gt: case Opcode::Ge:
+                emit_comparison(value);
+                break;
+            case Opcode::LoadGlobal: {
+                Place to = place_of(value);
+                long long global = static_cast<long long>(instruction.immediate);
+                if (to.kind == Place::Xmm) {
+                    out.line("    movsd TG%lld(%%rip), %s", global, xmm_names[to.index]);
+                } else {
+                    GpRegister work = to.kind == Place::Gp ? static_cast<GpRegister>(to.index) : RAX;
+                    out.line("    movq TG%lld(%%rip), %s", global, gp64[work]);
+                    store_result(value, gp(work));
+                }
+                break;
+            }
+            case Opcode::StoreGlobal: {
+                Place from = place_of(arg(0));
+                long long global = static_cast<long long>(instruction.immediate);
+                if (from.kind == Place::Xmm) {
+                    out.line("    movsd %s, TG%lld(%%rip)", xmm_names[from.index], global);
+                } else {
+                    out.line("    movq %s, TG%lld(%%rip)", gp64[in_gp(arg(0), RAX)], global);
+                }
+                break;
+            }
+            case Opcode::Call:
+                emit_call(value);
+                break;
+            case Opcode::Print:
+                for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+                    if (i > 0) call_runtime("turd_print_separator");
+                    TypeId type = function.values[arg(i)].type;
+                    std::string name = std::string("turd_print_") + type_suffix(type);
+                    call_runtime(name.c_str(), {{is_float(type) ? xmm(0) : gp(RDI), arg(i)}});
+                }
+                call_runtime("turd_print_newline");
+                break;
+            case Opcode::Read:
+                if (instruction.type == TypeId::String || instruction.type == TypeId::Unknown) {
+                    call_runtime("turd_read_string");
+                    if (instruction.type == TypeId::Unknown) {
+                        out.line("    movq %%rax, %%rdi");
+                        call_runtime("turd_box_string");
+                    }
+                } else {
+                    std::string name = std::string("turd_read_") + type_suffix(instruction.type);
+                    call_runtime(name.c_str(), {}, {{RDI, instruction.line}});
+                }
+                store_result(value, return_register(instruction.type));
+                break;
+            case Opcode::NewArray:
+                call_runtime("turd_array_new", {{gp(RDI), arg(0)}},
+                             {{RSI, array_element(instruction.type)}, {RDX, instruction.line}});
+                store_result(value, gp(RAX));
+                break;
+            case Opcode::ArrayLength: {
+                GpRegister array = in_gp(arg(0), RAX);
+                GpRegister work = result_register(value, no_value);
+                out.line("    movl (%s), %s", gp64[array], gp32[work]);
+                store_result(value, gp(work));
+                break;
+            }
+            case Opcode::BoundsCheck: {
+                // unsigned, so a negative index is out of range too
+                GpRegister array = in_gp(arg(0), RAX);
+                std::string subscript = operand32(arg(1));
+                if (place_of(arg(1)).kind == Place::Frame) {
+                    out.line("    movl %s, %%ecx", subscript.c_str());
+                    subscript = "%ecx";
+                }
+                out.line("    cmpl %s, (%s)", subscript.c_str(), gp64[array]);
+                out.line("    jbe .LF%zuT%zu", index, trap(TURD_INDEX_OUT_OF_RANGE, instruction.line));
+                break;
+            }
+            case Opcode::LoadElement:
+            case Opcode::StoreElement:
+                emit_element_access(value);
+                break;
+            case Opcode::Jump:
+                emit_phi_moves(block, function.blocks[block].succs[0]);
+                jump_unless_next(block, function.blocks[block].succs[0]);
+                break;
+            case Opcode::Branch:
+                emit_branch(block, value);
+                break;
+            case Opcode::Return:
+                if (instruction.operand_count == 1) move(return_register(function.returnType), place_of(arg(0)));
+                emit_epilogue();
+                break;
+        }
+    }
+
+    // element i of an array sits at 8 + i * size(%array); the index goes to
+    // rcx, already known to be in range
+    void emit_element_access(ValueId value) {
+        const IRInstruction& instruction = function.values[value];
+        ValueId array_value = function.operand(value, 0);
+        TypeId element = element_type(function.values[array_value].type);
+        GpRegister array = in_gp(array_value, RAX);
+        std::string subscript = operand32(function.operand(value, 1));
+        if (subscript[0] == '$') out.line("    movl %s, %%ecx", subscript.c_str());
+        else out.line("    movslq %s, %%rcx", subscript.c_str());
+        char address[32];
+        std::snprintf(address, sizeof(address), "8(%s,%%rcx,%d)", gp64[array],
+                      element == TypeId::Float || element == TypeId::String ? 8 : 4);
+
+        if (instruction.op == Opcode::LoadElement) {
+            Place to = place_of(value);
+            if (is_float(element)) {
+                int work = to.kind == Place::Xmm ? to.index : 0;
+                out.line("    movsd %s, %s", address, xmm_names[work]);
+                store_result(value, xmm(work));
+            } else {
+                GpRegister work = result_register(value, no_value);
+                out.line("    %s %s, %s", element == TypeId::String ? "movq" : "movl", address,
+                         element == TypeId::String ? gp64[work] : gp32[work]);
+                store_result(value, gp(work));
+            }
+            return;
+        }
+
+        ValueId stored = function.operand(value, 2);
+        Place from = place_of(stored);
+        if (is_float(element)) {
+            if (from.kind != Place::Xmm) move(xmm(0), from);
+            out.line("    movsd %s, %s", xmm_names[from.kind == Place::Xmm ? from.index : 0], address);
+        } else if (element == TypeId::String) {
+            out.line("    movq %s, %s", gp64[in_gp(stored, RDX)], address);
+        } else if (from.kind == Place::Constant) {
+            out.line("    movl %s, %s", operand32(stored).c_str(), address);
+        } else {
+            out.line("    movl %s, %s", gp32[in_gp(stored, RDX)], address);
+        }
+    }
+
+    void jump_unless_next(BlockId block, BlockId target) {
+        if (target != block + 1) out.line("    jmp .LF%zuB%u", index, target);
+    }
+
+    void emit_branch(BlockId block, ValueId value) {
+        BlockId taken = function.blocks[block].succs[0], other = function.blocks[block].succs[1];
+        ValueId condition = function.operand(value, 0);
+        Opcode test = Opcode::Ne;     // condition != 0
+        const auto& code = function.blocks[block].code;
+        if (code.size() >= 2 && code[code.size() - 2] == condition && fuses_with_branch(condition, value)) {
+            compare_integers(condition);
+            test = function.values[condition].op;
+        } else if (place_of(condition).kind == Place::Frame) {
+            out.line("    cmpl $0, %s", operand32(condition).c_str());
+        } else {
+            GpRegister reg = in_gp(condition, RAX);
+            out.line("    testl %s, %s", gp32[reg], gp32[reg]);
+        }
+        if (taken == block + 1) {
+            out.line("    j%s .LF%zuB%u", condition_code(test, true), index, other);
+        } else {
+            out.line("    j%s .LF%zuB%u", condition_code(test), index, taken);
+            jump_unless_next(block, other);
+        }
+    }
+
+    // where an int result is computed: its own register unless an operand
+    // still to be read lives there, rax otherwise
+    GpRegister result_register(ValueId value, ValueId later_operand) const {
+        Place to = place_of(value);
+        if (to.kind != Place::Gp) return RAX;
+        if (later_operand != no_value && place_of(later_operand) == to) return RAX;
+        return static_cast<GpRegister>(to.index);
+    }
+
+    // same type: a move; otherwise a box into or an unbox out of a dynamic value
+    void emit_copy(ValueId value, ValueId source) {
+        TypeId to = function.values[value].type, from = function.values[source].type;
+        if (to == from) {
+            parallel_move({{place_of(value), place_of(source)}});
+            return;
+        }
+        if (to == TypeId::Unknown) {
+            std::string name = std::string("turd_box_") + type_suffix(from);
+            call_runtime(name.c_str(), {{is_float(from) ? xmm(0) : gp(RDI), source}});
+            store_result(value, gp(RAX));
+            return;
+        }
+        std::string name = std::string("turd_unbox_") + type_suffix(to);
+        call_runtime(name.c_str(), {{gp(RDI), source}}, {{RSI, function.values[value].line}});
+        store_result(value, return_register(to));
+    }
+
+    void emit_binary(ValueId value) {
+        const IRInstruction& instruction = function.values[value];
+        ValueId left = function.operand(value, 0), right = function.operand(value, 1);
+        TypeId operands = function.values[left].type;
+
+        if (instruction.type == TypeId::Unknown) {
+            call_runtime("turd_dynamic_binary", {{gp(RSI), left}, {gp(RDX), right}},
+                         {{RDI, runtime_operator(instruction.op)}, {RCX, instruction.line}});
+            store_result(value, gp(RAX));
+            return;
+        }
+        if (operands == TypeId::String) {
+            call_runtime("turd_string_concat", {{gp(RDI), left}, {gp(RSI), right}});
+            store_result(value, gp(RAX));
+            return;
+        }
+        if (is_float(operands)) {
+            emit_float_binary(value, left, right);
+            return;
+        }
+
+        if (instruction.op == Opcode::Pow) {
+            call_runtime("turd_pow_int", {{gp(RDI), left}, {gp(RSI), right}}, {{RDX, instruction.line}});
+            store_result(value, gp(RAX));
+            return;
+        }
+        if (instruction.op == Opcode::Div || instruction.op == Opcode::Mod || instruction.op == Opcode::FloorDiv) {
+            move(gp(RAX), place_of(left));
+            move(gp(RCX), place_of(right));
+            emit_division(value, right);
+            store_result(value, gp(RAX));
+            return;
+        }
+
+        // a commutative operation reads the operand already in the result register as its left
+        if ((instruction.op == Opcode::Add || instruction.op == Opcode::Mul) && place_of(right) == place_of(value)) {
+            std::swap(left, right);
+        }
+        GpRegister work = result_register(value, right);
+        move(gp(work), place_of(left));
+        if (instruction.op == Opcode::Shr) {
+            Place amount = place_of(right);
+            if (amount.kind == Place::Constant && function.values[right].op == Opcode::Const) {
+                out.line("    sarl $%d, %s", static_cast<int32_t>(function.values[right].immediate) & 31, gp32[work]);
+            } else {
+                move(gp(RCX), amount);
+                out.line("    sarl %%cl, %s", gp32[work]);
+            }
+        } else {
+            const char* mnemonic = instruction.op == Opcode::Add ? "addl" : instruction.op == Opcode::Sub ? "subl" : "imull";
+            out.line("    %s %s, %s", mnemonic, operand32(right).c_str(), gp32[work]);
+        }
+        store_result(value, gp(work));
+    }
+
+    void emit_float_binary(ValueId value, ValueId left, ValueId right) {
+        const IRInstruction& instruction = function.values[value];
+        switch (instruction.op) {
+            case Opcode::Mod: case Opcode::Pow:
+                call_runtime(instruction.op == Opcode::Mod ? "fmod" : "pow", {{xmm(0), left}, {xmm(1), right}});
+                store_result(value, xmm(0));
+                return;
+            case Opcode::FloorDiv:
+                call_runtime("turd_floor_div_float", {{xmm(0), left}, {xmm(1), right}}, {{RDI, instruction.line}});
+                store_result(value, gp(RAX));
+                return;
+            default:
+                break;
+        }
+
+        Place to = place_of(value), source = place_of(right);
+        int work = to.kind == Place::Xmm && !(source == to) ? to.index : 0;
+        move(xmm(work), place_of(left));
+        if (source.kind == Place::Constant) {
+            move(xmm(1), source);
+            source = xmm(1);
+        }
+        const char* mnemonic = instruction.op == Opcode::Add   ? "addsd"
+                               : instruction.op == Opcode::Sub ? "subsd"
+                               : instruction.op == Opcode::Mul ? "mulsd"
+                                                               : "divsd";
+        out.line("    %s %s, %s", mnemonic, text(source).c_str(), xmm_names[work]);
+        store_result(value, xmm(work));
+    }
+
+    // %eax / %ecx; quotient or remainder left in %eax
+    void emit_division(ValueId value, ValueId divisor) {
+        const IRInstruction& instruction = function.values[value];
+        const IRInstruction& known = function.values[divisor];
+        bool constant = known.op == Opcode::Const;
+        if (!constant || known.immediate == 0) {
+            out.line("    testl %%ecx, %%ecx");
+            out.line("    je .LF%zuT%zu", index, trap(TURD_DIVISION_BY_ZERO, instruction.line));
+        }
+        if (!constant || known.immediate == -1) {
+            size_t overflow = trap(TURD_DIVISION_OVERFLOW, instruction.line);
+            out.line("    cmpl $-1, %%ecx");
+            out.line("    jne .LF%zuD%u", index, value);
+            out.line("    cmpl $-2147483648, %%eax");
+            out.line("    je .LF%zuT%zu", index, overflow);
+            out.line(".LF%zuD%u:", index, value);
+        }
+        out.line("    cltd");
+        out.line("    idivl %%ecx");
+        if (instruction.op == Opcode::Mod) {
+            out.line("    movl %%edx, %%eax");
+        } else if (instruction.op == Opcode::FloorDiv) {
+            // truncation rounded up when the remainder and divisor differ in sign
+            out.line("    testl %%edx, %%edx");
+            out.line("    je .LF%zuF%u", index, value);
+            out.line("    xorl %%ecx, %%edx");
+            out.line("    jns .LF%zuF%u", index, value);
+            out.line("    decl %%eax");
+            out.line(".LF%zuF%u:", index, value);
+        }
+    }
+
+    // sets the flags for an int, bool or char comparison
+    void compare_integers(ValueId value) {
+        ValueId left = function.operand(value, 0), right = function.operand(value, 1);
+        GpRegister lhs = in_gp(left, RAX);
+        out.line("    cmpl %s, %s", operand32(right).c_str(), gp32[lhs]);
+    }
+
+    void emit_comparison(ValueId value) {
+        const IRInstruction& instruction = function.values[value];
+        ValueId left = function.operand(value, 0), right = function.operand(value, 1);
+        TypeId operands = function.values[left].type;
+
+        if (operands == TypeId::Unknown) {
+            call_runtime("turd_dynamic_compare", {{gp(RSI), left}, {gp(RDX), right}},
+                         {{RDI, runtime_operator(instruction.op)}, {RCX, instruction.line}});
+            store_result(value, gp(RAX));
+            return;
+        }
+        if (is_float(operands)) {
+            // ucomisd sets CF/ZF like an unsigned compare and PF for NaN
+            bool swap = instruction.op == Opcode::Lt || instruction.op == Opcode::Le;
+            move(xmm(0), place_of(swap ? right : left));
+            move(xmm(1), place_of(swap ? left : right));
+            out.line("    ucomisd %%xmm1, %%xmm0");
+            switch (instruction.op) {
+                case Opcode::Eq:
+                    out.line("    sete %%al");
+                    out.line("    setnp %%cl");
+                    out.line("    andb %%cl, %%al");
+                    break;
+                case Opcode::Ne:
+                    out.line("    setne %%al");
+                    out.line("    setp %%cl");
+                    out.line("    orb %%cl, %%al");
+                    break;
+                case Opcode::Lt: case Opcode::Gt: out.line("    seta %%al"); break;
+                default: out.line("    setae %%al"); break;
+            }
+        } else if (operands == TypeId::String && (instruction.op == Opcode::Eq || instruction.op == Opcode::Ne)) {
+            call_runtime("turd_string_equal", {{gp(RDI), left}, {gp(RSI), right}});
+            out.line("    testl %%eax, %%eax");
+            out.line("    set%s %%al", instruction.op == Opcode::Eq ? "ne" : "e");
+        } else if (operands == TypeId::String) {
+            call_runtime("turd_string_compare", {{gp(RDI), left}, {gp(RSI), right}});
+            out.line("    testl %%eax, %%eax");
+            out.line("    set%s %%al", condition_code(instruction.op));
+        } else {
+            compare_integers(value);
+            out.line("    set%s %%al", condition_code(instruction.op));
+        }
+        out.line("    movzbl %%al, %%eax");
+        store_result(value, gp(RAX));
+    }
+
+    // the moves of a call's arguments into their ABI registers; arguments
+    // beyond those go to stack_arguments, first argument first
+    std::vector<std::pair<Place, Place>> argument_moves(ValueId value, std::vector<ValueId>& stack_arguments) {
+        const IRInstruction& instruction = function.values[value];
+        const IRFunction& callee = module.functions[instruction.immediate];
+        std::vector<std::pair<Place, Place>> register_arguments;
+        uint32_t gp_used = 0, xmm_used = 0;
+        for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+            ValueId argument = function.operand(value, i);
+            if (is_float(callee.paramTypes[i]) && xmm_used < float_argument_count) {
+                register_arguments.push_back({xmm(xmm_used++), place_of(argument)});
+            } else if (!is_float(callee.paramTypes[i]) && gp_used < gp_argument_count) {
+                register_arguments.push_back({gp(gp_arguments[gp_used++]), place_of(argument)});
+            } else {
+                stack_arguments.push_back(argument);
+            }
+        }
+        return register_arguments;
+    }
+
+    void emit_call(ValueId value) {
+        const IRInstruction& instruction = function.values[value];
+        std::vector<ValueId> stack_arguments;
+        auto register_arguments = argument_moves(value, stack_arguments);
+
+        // the stack must be 16-byte aligned at the call
+        size_t padding = stack_arguments.size() % 2 ? 8 : 0;
+        if (padding) out.line("    subq $8, %%rsp");
+        for (size_t i = stack_arguments.size(); i-- > 0;) {
+            move(gp(RAX), place_of(stack_arguments[i]));
+            out.line("    pushq %%rax");
+        }
+        parallel_move(register_arguments);
+        out.line("    call %s", function_symbol(module, instruction.immediate).c_str());
+        size_t popped = 8 * stack_arguments.size() + padding;
+        if (popped) out.line("    addq $%zu, %%rsp", popped);
+        if (instruction.type != TypeId::Void) store_result(value, return_register(instruction.type));
+    }
+
+    // A call whose result is returned as it is, or a void call before a void
+    // return, with every argument in a register. Its callee can return
+    // straight to our caller, so the call becomes a jump and recursion
+    // through tail calls, mutual or not, runs in constant stack.
+    bool is_tail_call(ValueId value, ValueId end) const {
+        const IRInstruction& call = function.values[value];
+        const IRInstruction& ret = function.values[end];
+        if (call.op != Opcode::Call || ret.op != Opcode::Return || call.type != function.returnType) return false;
+        if (ret.operand_count == 0 ? call.type != TypeId::Void : function.operand(end, 0) != value) return false;
+
+        const IRFunction& callee = module.functions[call.immediate];
+        uint32_t gp_used = 0, xmm_used = 0;
+        for (TypeId type : callee.paramTypes) (is_float(type) ? xmm_used : gp_used)++;
+        return gp_used <= gp_argument_count && xmm_used <= float_argument_count;
+    }
+
+    // the arguments go where the callee expects them, then our frame goes
+    // and the callee takes over our return address
+    void emit_tail_call(ValueId value) {
+        std::vector<ValueId> stack_arguments;
+        parallel_move(argument_moves(value, stack_arguments));
+        emit_frame_teardown();
+        out.line("    jmp %s", function_symbol(module, function.values[value].immediate).c_str());
+        ++stats.tail_calls;
+    }
+
+    // phis of `succ` take their value for the edge from `block`, all at once
+    void emit_phi_moves(BlockId block, BlockId succ) {
+        const auto& preds = function.blocks[succ].preds;
+        uint32_t edge = 0;
+        while (preds[edge] != block) ++edge;
+
+        std::vector<std::pair<Place, Place>> moves;
+        for (ValueId phi : function.blocks[succ].code) {
+            if (function.values[phi].op != Opcode::Phi) break;
+            ValueId incoming = function.operand(phi, edge);
+            if (incoming != phi && has_place(phi)) moves.push_back({place_of(phi), place_of(incoming)});
+        }
+        parallel_move(moves);
+    }
+
+    const IRModule& module;
+    const IRFunction& function;
+    size_t index;
+    RegisterAllocationStats& stats;
+    Assembly& out;
+    std::vector<uint32_t> uses;
+    RegisterAllocation allocation;
+    std::vector<Trap> traps;
+};
+
+// a literal's TurdString: interned, its length known; the characters
+// follow in .rodata under .LTn
+void emit_string_object(Assembly& out, size_t index, const std::string& text) {
+    uint32_t length = static_cast<uint32_t>(text.size());
+    out.line(".LS%zu:", index);
+    out.line("    .quad .LT%zu", index);
+    out.line("    .long %u, %u", length, static_cast<unsigned>(TURD_STRING_INTERNED));
+    out.line("    .zero %d", TURD_SMALL_STRING);
+}
+
+void emit_string_text(Assembly& out, size_t index, const std::string& text) {
+    std::string escaped;
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\' || c < 0x20 || c >= 0x7f) {
+            char octal[8];
+            std::snprintf(octal, sizeof(octal), "\\%03o", c);
+            escaped += octal;
+        } else {
+            escaped += static_cast<char>(c);
+        }
+    }
+    out.line(".LT%zu:", index);
+    out.raw("    .string \"" + escaped + "\"\n");
+}
+
+} // namespace
+
+std::string X86CodeGen::generate(IRModule& module) {
+    legalize_types(module);
+
+    Assembly out;
+    out.line("# generated by the Turd compiler");
+    out.line("    .text");
+    LinearScanAllocator allocator(gp_registers(), float_registers(), clobber_of);
+    for (size_t i = 0; i < module.functions.size(); ++i) {
+        FunctionEmitter(module, module.functions[i], i, allocator, stats, out).emit();
+    }
+
+    out.blank();
+    out.line("    .globl main");
+    out.line("    .type main, @function");
+    out.line("main:");
+    out.line("    pushq %%rbp");
+    out.line("    movq %%rsp, %%rbp");
+    out.line("    call turd_runtime_init@PLT");
+    out.line("    call turd_main");
+    out.line("    call turd_runtime_exit@PLT");
+    out.line("    xorl %%eax, %%eax");
+    out.line("    popq %%rbp");
+    out.line("    ret");
+    out.line("    .size main, .-main");
+
+    if (!module.strings.empty()) {
+        out.blank();
+        // the objects hold a pointer, so they are read-only once relocated
+        out.line("    .section .data.rel.ro,\"aw\"");
+        out.line("    .p2align 3");
+        for (size_t i = 0; i < module.strings.size(); ++i) emit_string_object(out, i, module.strings[i]);
+        out.line("    .section .rodata");
+        for (size_t i = 0; i < module.strings.size(); ++i) emit_string_text(out, i, module.strings[i]);
+    }
+    if (!module.globals.empty()) {
+        // zero reads as 0, 0.0, false, '\0' and ""; an array starts out as the empty array
+        out.blank();
+        out.line("    .bss");
+        out.line("    .p2align 3");
+        for (size_t i = 0; i < module.globals.size(); ++i) {
+            if (is_array(module.globals[i])) continue;
+            out.line("TG%zu:", i);
+            out.line("    .zero 8");
+        }
+        out.line("    .data");
+        out.line("    .p2align 3");
+        for (size_t i = 0; i < module.globals.size(); ++i) {
+            if (!is_array(module.globals[i])) continue;
+            out.line("TG%zu:", i);
+            out.line("    .quad turd_empty_array");
+        }
+    }
+    out.blank();
+    out.line("    .section .note.GNU-stack,\"\",@progbits");
+    return out.text;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "linear_scan.hpp"
+#include <string>
+
+// === x86-64 Code Generation ===
+// Turns an IR module into GNU as (AT&T syntax) text for x86-64 Linux,
+// linked against libturd_runtime.a (see Runtime/runtime.hpp):
+//  - every Turd function becomes a local symbol T_<name> using the System V
+//    calling convention: float parameters in %xmm0-7, everything else in
+//    %rdi, %rsi, %rdx, %rcx, %r8, %r9, the rest on the stack; results in
+//    %rax or %xmm0
+//  - top-level code becomes turd_main, and the emitted main() wraps it in
+//    turd_runtime_init/turd_runtime_exit
+//  - int, bool and char are 32-bit values in 64-bit slots, floats are
+//    doubles in SSE registers, strings and dynamic values are pointers
+//  - int division checks its divisor inline and jumps to an out-of-line
+//    call to turd_error; print, read, strings, '**' and dynamically typed
+//    operations call the runtime
+//  - globals live in .bss, string literals in .rodata
+// Values live where LinearScanAllocator puts them: rsi, rdi, r8-r10 and
+// xmm2-14 are caller-saved, rbx and r12-r15 callee-saved and pushed by the
+// prologues that use them. rax, rcx, rdx, r11, xmm0, xmm1 and xmm15 stay
+// free as scratch. Phi moves, call arguments and parameters are parallel
+// moves. An int comparison feeding only the branch after it becomes a
+// cmp/jcc pair. Constants are rematerialized at their uses. The code is
+// position independent, so it links as PIE or not.
+class X86CodeGen {
+public:
+    // legalizes the module's types in place (see type_legalizer.hpp), then emits it
+    std::string generate(IRModule& module);
+
+    // accumulated over every generate() call
+    const RegisterAllocationStats& get_stats() const { return stats; }
+
+private:
+    RegisterAllocationStats stats;
+};
@@ -0,0 +1,120 @@
+#include "ast_cache.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// === Mapped AST ===
+
+MappedAST::~MappedAST() {
+    if (address != nullptr) {
+        munmap(const_cast<void*>(address), size);
+    }
+}
+
+MappedAST::MappedAST(MappedAST&& other) noexcept : address(other.address), size(other.size) {
+    other.address = nullptr;
+    other.size = 0;
+}
+
+MappedAST& MappedAST::operator=(MappedAST&& other) noexcept {
+    if (this != &other) {
+        if (address != nullptr) {
+            munmap(const_cast<void*>(address), size);
+        }
+        address = other.address;
+        size = other.size;
+        other.address = nullptr;
+        other.size = 0;
+    }
+    return *this;
+}
+
+// === AST Cache ===
+
+ASTCache::ASTCache(std::string directory) : directory(std::move(directory)) {
+    mkdir(this->directory.c_str(), 0755);
+}
+
+uint64_t ASTCache::compiler_hash() {
+    static const uint64_t hash = fnv1a_hash(&ast_format::format_version, sizeof(ast_format::format_version),
+                                            fnv1a_hash(compiler_version,
+                                                       std::char_traits<char>::length(compiler_version)));
+    return hash;
+}
+
+uint64_t ASTCache::hash_file(const std::string& path, bool& ok) {
+    std::ifstream file(path, std::ios::binary);
+    ok = file.is_open();
+    if (!ok) return 0;
+
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return fnv1a_hash(contents.data(), contents.size());
+}
+
+std::string ASTCache::entry_path(uint64_t source_hash) const {
+    char name[64];
+    std::snprintf(name, sizeof(name), "/%016llx-%016llx.tast",
+                  static_cast<unsigned long long>(source_hash),
+                  static_cast<unsigned long long>(compiler_hash()));
+    return directory + name;
+}
+
+/**
+ * Map the cached tree for a source file, if there is a current one
+ * @param source_path file the tree was parsed from
+ * @return the mapping, or an empty MappedAST when the source must be parsed
+ */
+MappedAST ASTCache::load(const std::string& source_path) const {
+    bool ok;
+    uint64_t source_hash = hash_file(source_path, ok);
+    if (!ok) return {};
+
+    int fd = open(entry_path(source_hash).c_str(), O_RDONLY);
+    if (fd < 0) return {};
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(ast_format::ImageHeader))) {
+        close(fd);
+        return {};
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) return {};
+
+    MappedAST mapped(address, size);
+    ASTImage image = mapped.image();
+    // the file name already encodes both hashes; the header guards against collisions
+    if (!image.valid() || image.header().source_hash != source_hash ||
+        image.header().compiler_hash != compiler_hash()) {
+        return {};
+    }
+    return mapped;
+}
+
+bool ASTCache::store(const std::string& source_path, const ProgramNode& program) const {
+    bool ok;
+    uint64_t source_hash = hash_file(source_path, ok);
+    if (!ok) return false;
+
+    std::vector<uint8_t> image = serialize_ast(program, source_hash, compiler_hash());
+
+    // write then rename, so a reader never maps a half written entry
+    std::string path = entry_path(source_hash);
+    std::string temp_path = path + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+        if (!file) {
+            std::remove(temp_path.c_str());
+            return false;
+        }
+    }
+    return std::rename(temp_path.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "ast_serializer.hpp"
+#include "../Support/hash.hpp"
+#include <string>
+
+// bump whenever lexing or parsing changes what tree a given source
+// produces, new keywords included; the image layout has its own
+// ast_format::format_version, and the cache key covers both
+constexpr const char* compiler_version = "turdc 0.3.0";
+
+// === Mapped AST ===
+// Read-only mmap of a cache entry. Move-only, unmaps on destruction
+class MappedAST {
+public:
+    MappedAST() = default;
+    MappedAST(const void* address, size_t size) : address(address), size(size) {}
+    ~MappedAST();
+
+    MappedAST(MappedAST&& other) noexcept;
+    MappedAST& operator=(MappedAST&& other) noexcept;
+    MappedAST(const MappedAST&) = delete;
+    MappedAST& operator=(const MappedAST&) = delete;
+
+    explicit operator bool() const { return address != nullptr; }
+    ASTImage image() const { return ASTImage(static_cast<const uint8_t*>(address), size); }
+
+private:
+    const void* address = nullptr;
+    size_t size = 0;
+};
+
+// === AST Cache ===
+// On-disk cache of parsed trees. An entry is keyed by the hash of the
+// source text plus compiler_hash() of compiler_version and the image
+// format version, so editing the file, changing the grammar or changing
+// the layout all miss. Hits are mmapped, never read
+class ASTCache {
+public:
+    explicit ASTCache(std::string directory);
+
+    // an empty MappedAST on a miss, a stale entry or a corrupt file
+    MappedAST load(const std::string& source_path) const;
+    bool store(const std::string& source_path, const ProgramNode& program) const;
+
+    static uint64_t hash_file(const std::string& path, bool& ok);
+    static uint64_t compiler_hash();
+
+private:
+    std::string entry_path(uint64_t source_hash) const;
+
+    std::string directory;
+};
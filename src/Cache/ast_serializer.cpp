@@ -0,0 +1,492 @@
+#include "ast_serializer.hpp"
+#include "../SynParser/ast_visitor.hpp"
+#include <unordered_map>
+
+using ast_format::ImageHeader;
+using ast_format::NodeRecord;
+
+namespace {
+
+uint32_t load_u32(const uint8_t* base, uint32_t offset) {
+    uint32_t value;
+    std::memcpy(&value, base + offset, sizeof(value));
+    return value;
+}
+
+// how many of str[] a node type reads; the other slots are left at 0
+int strings_used(NodeType type) {
+    switch (type) {
+        case NodeType::Function:
+        case NodeType::Parameter:
+        case NodeType::Declaration:
+        case NodeType::Literal:      return 2;
+        case NodeType::Assignment:
+        case NodeType::BinaryOp:
+        case NodeType::UnaryOp:
+        case NodeType::Variable:
+        case NodeType::FunctionCall:
+        case NodeType::Error:        return 1;
+        case NodeType::Program:
+        case NodeType::If:
+        case NodeType::While:
+        case NodeType::Return:
+        case NodeType::Break:
+        case NodeType::Block:
+        case NodeType::Index:        return 0;
+    }
+    return 0;
+}
+
+// Builds the image in two steps: the visitor fills node records whose
+// child/list fields hold 1-based indices, then layout() turns those
+// indices into image offsets once every section's size is known
+class ASTSerializer : public ASTVisitor<ASTSerializer, uint32_t> {
+public:
+    std::vector<uint8_t> layout(uint32_t root, uint64_t source_hash, uint64_t compiler_hash);
+
+    uint32_t visit_program(ProgramNode& node) {
+        NodeRecord record = make_record(node);
+        record.list[0] = add_list(node.children);
+        return add_record(record);
+    }
+    uint32_t visit_function(FunctionNode& node) {
+        NodeRecord record = make_record(node);
+        record.str[0] = intern(node.name);
+        record.str[1] = intern(node.returnType);
+        std::vector<uint32_t> parameters;
+        for (auto& parameter : node.parameters) {
+            parameters.push_back(visit(*parameter));
+        }
+        record.list[0] = add_list_indices(parameters);
+        record.list[1] = add_list(node.body);
+        return add_record(record);
+    }
+    uint32_t visit_parameter(ParameterNode& node) {
+        NodeRecord record = make_record(node);
+        record.str[0] = intern(node.name);
+        record.str[1] = intern(node.type);
+        return add_record(record);
+    }
+    uint32_t visit_declaration(DeclarationNode& node) {
+        NodeRecord record = make_record(node);
+        record.str[0] = intern(node.name);
+        record.str[1] = intern(node.type);
+        record.child[0] = add_child(node.initializer);
+        record.child[1] = add_child(node.size);
+        return add_record(record);
+    }
+    uint32_t visit_assignment(AssignmentNode& node) {
+        NodeRecord record = make_record(node);
+        record.str[0] = intern(node.name);
+        record.child[0] = add_child(node.expression);
+        record.child[1] = add_child(node.index);
+        return add_record(record);
+    }
+    uint32_t visit_if(IfNode& node) {
+        NodeRecord record = make_record(node);
+        record.child[0] = add_child(node.condition);
+        record.list[0] = add_list(node.body);
+        record.list[1] = add_list(node.elseBody);
+        return add_record(record);
+    }
+    uint32_t visit_while(WhileNode& node) {
+        NodeRecord record = make_record(node);
+        record.child[0] = add_child(node.condition);
+        record.list[0] = add_list(node.body);
+        return add_record(record);
+    }
+    uint32_t visit_return(ReturnNode& node) {
+        NodeRecord record = make_record(node);
+        record.child[0] = add_child(node.expression);
+        return add_record(record);
+    }
+    uint32_t visit_break(BreakNode& node) {
+        return add_record(make_record(node));
+    }
+    uint32_t visit_block(BlockNode& node) {
+        NodeRecord record = make_record(node);
+        record.list[0] = add_list(node.statements);
+        return add_record(record);
+    }
+    uint32_t visit_binary_op(BinaryOpNode& node) {
+        NodeRecord record = make_record(node);
+        record.str[0] = intern(node.op);
+        record.child[0] = add_child(node.left);
+        record.child[1] = add_child(node.right);
+        return add_record(record);
+    }
+    uint32_t visit_unary_op(UnaryOpNode& node) {
+        NodeRecord record = make_record(node);
+        record.str[0] = intern(node.op);
+        record.child[0] = add_child(node.operand);
+        return add_record(record);
+    }
+    uint32_t visit_literal(LiteralNode& node) {
+        NodeRecord record = make_record(node);
+        record.str[0] = intern(node.value);
+        record.str[1] = intern(node.literalType);
+        return add_record(record);
+    }
+    uint32_t visit_variable(VariableNode& node) {
+        NodeRecord record = make_record(node);
+        record.str[0] = intern(node.name);
+        return add_record(record);
+    }
+    uint32_t visit_function_call(FunctionCallNode& node) {
+        NodeRecord record = make_record(node);
+        record.str[0] = intern(node.name);
+        record.list[0] = add_list(node.arguments);
+        return add_record(record);
+    }
+    uint32_t visit_index(IndexNode& node) {
+        NodeRecord record = make_record(node);
+        record.child[0] = add_child(node.array);
+        record.child[1] = add_child(node.index);
+        return add_record(record);
+    }
+    uint32_t visit_error(ErrorNode& node) {
+        NodeRecord record = make_record(node);
+        record.str[0] = intern(node.message);
+        return add_record(record);
+    }
+
+private:
+    static NodeRecord make_record(const ASTNode& node) {
+        NodeRecord record{};
+        record.type = static_cast<uint8_t>(node.type);
+        record.line = node.line;
+        record.column = node.column;
+        return record;
+    }
+
+    uint32_t add_record(const NodeRecord& record) {
+        records.push_back(record);
+        return static_cast<uint32_t>(records.size());
+    }
+
+    uint32_t add_child(const ASTNodePTR& node) {
+        return node ? visit(*node) : 0;
+    }
+
+    uint32_t add_list(const std::vector<ASTNodePTR>& nodes) {
+        std::vector<uint32_t> indices;
+        indices.reserve(nodes.size());
+        for (const auto& node : nodes) {
+            indices.push_back(visit(*node));
+        }
+        return add_list_indices(indices);
+    }
+
+    uint32_t add_list_indices(const std::vector<uint32_t>& indices) {
+        if (indices.empty()) return 0;
+        list_words.push_back(static_cast<uint32_t>(indices.size()));
+        uint32_t start = static_cast<uint32_t>(list_words.size());
+        list_words.insert(list_words.end(), indices.begin(), indices.end());
+        return start; // 1-based: index of the count word + 1
+    }
+
+    uint32_t intern(const std::string& value) {
+        auto [it, inserted] = string_ids.try_emplace(value, static_cast<uint32_t>(strings.size()));
+        if (inserted) {
+            strings.push_back(&it->first);
+        }
+        return it->second;
+    }
+
+    std::vector<NodeRecord> records;
+    std::vector<uint32_t> list_words;
+    std::unordered_map<std::string, uint32_t> string_ids;
+    std::vector<const std::string*> strings;   // by id, points into string_ids
+};
+
+std::vector<uint8_t> ASTSerializer::layout(uint32_t root, uint64_t source_hash, uint64_t compiler_hash) {
+    auto align4 = [](size_t n) { return (n + 3) & ~size_t(3); };
+
+    size_t strings_offset = sizeof(ImageHeader);
+    size_t blob_offset = strings_offset + 4 + strings.size() * 8;
+    size_t blob_size = 0;
+    for (const std::string* value : strings) {
+        blob_size += value->size() + 1;
+    }
+    size_t nodes_offset = align4(blob_offset + blob_size);
+    size_t lists_offset = nodes_offset + records.size() * sizeof(NodeRecord);
+    size_t total_size = lists_offset + list_words.size() * 4;
+
+    std::vector<uint8_t> image(total_size, 0);
+    auto node_offset = [&](uint32_t index) -> uint32_t {
+        return index == 0 ? 0 : static_cast<uint32_t>(nodes_offset + (index - 1) * sizeof(NodeRecord));
+    };
+    auto list_offset = [&](uint32_t index) -> uint32_t {
+        return index == 0 ? 0 : static_cast<uint32_t>(lists_offset + (index - 1) * 4);
+    };
+    auto store_u32 = [&](size_t offset, uint32_t value) {
+        std::memcpy(image.data() + offset, &value, sizeof(value));
+    };
+
+    ImageHeader header{};
+    std::memcpy(header.magic, ast_format::magic, sizeof(header.magic));
+    header.format_version = ast_format::format_version;
+    header.total_size = static_cast<uint32_t>(total_size);
+    header.source_hash = source_hash;
+    header.compiler_hash = compiler_hash;
+    header.strings_offset = static_cast<uint32_t>(strings_offset);
+    header.nodes_offset = static_cast<uint32_t>(nodes_offset);
+    header.node_count = static_cast<uint32_t>(records.size());
+    header.root_offset = node_offset(root);
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    // string table + blob
+    store_u32(strings_offset, static_cast<uint32_t>(strings.size()));
+    size_t cursor = blob_offset;
+    for (size_t i = 0; i < strings.size(); ++i) {
+        const std::string& value = *strings[i];
+        store_u32(strings_offset + 4 + i * 8, static_cast<uint32_t>(cursor));
+        store_u32(strings_offset + 8 + i * 8, static_cast<uint32_t>(value.size()));
+        std::memcpy(image.data() + cursor, value.data(), value.size());
+        cursor += value.size() + 1;
+    }
+
+    // node records, indices patched to offsets
+    for (size_t i = 0; i < records.size(); ++i) {
+        NodeRecord record = records[i];
+        for (auto& child : record.child) child = node_offset(child);
+        for (auto& list : record.list) list = list_offset(list);
+        std::memcpy(image.data() + nodes_offset + i * sizeof(NodeRecord), &record, sizeof(record));
+    }
+
+    // lists: count words stay as they are, entries become node offsets
+    for (size_t i = 0; i < list_words.size();) {
+        uint32_t count = list_words[i];
+        store_u32(lists_offset + i * 4, count);
+        for (uint32_t j = 1; j <= count; ++j) {
+            store_u32(lists_offset + (i + j) * 4, node_offset(list_words[i + j]));
+        }
+        i += count + 1;
+    }
+    return image;
+}
+
+// Rebuilds shared_ptr nodes from an image; the inverse of ASTSerializer
+ASTNodePTR materialize_node(NodeView view);
+
+std::vector<ASTNodePTR> materialize_list(ListView list) {
+    std::vector<ASTNodePTR> nodes;
+    nodes.reserve(list.size());
+    for (uint32_t i = 0; i < list.size(); ++i) {
+        nodes.push_back(materialize_node(list[i]));
+    }
+    return nodes;
+}
+
+ASTNodePTR materialize_node(NodeView view) {
+    if (!view) return nullptr;
+
+    ASTNodePTR node;
+    switch (view.type()) {
+        case NodeType::Program: {
+            auto program = std::make_shared<ProgramNode>();
+            program->children = materialize_list(view.list(0));
+            node = program;
+            break;
+        }
+        case NodeType::Function: {
+            auto function = std::make_shared<FunctionNode>();
+            function->name = view.str(0);
+            function->returnType = view.str(1);
+            ListView parameters = view.list(0);
+            for (uint32_t i = 0; i < parameters.size(); ++i) {
+                function->parameters.push_back(
+                    std::static_pointer_cast<ParameterNode>(materialize_node(parameters[i])));
+            }
+            function->body = materialize_list(view.list(1));
+            node = function;
+            break;
+        }
+        case NodeType::Parameter:
+            node = std::make_shared<ParameterNode>(std::string(view.str(1)), std::string(view.str(0)));
+            break;
+        case NodeType::Declaration: {
+            auto declaration = std::make_shared<DeclarationNode>();
+            declaration->name = view.str(0);
+            declaration->type = view.str(1);
+            declaration->initializer = materialize_node(view.child(0));
+            declaration->size = materialize_node(view.child(1));
+            node = declaration;
+            break;
+        }
+        case NodeType::Assignment: {
+            auto assignment = std::make_shared<AssignmentNode>();
+            assignment->name = view.str(0);
+            assignment->expression = materialize_node(view.child(0));
+            assignment->index = materialize_node(view.child(1));
+            node = assignment;
+            break;
+        }
+        case NodeType::If: {
+            auto ifNode = std::make_shared<IfNode>();
+            ifNode->condition = materialize_node(view.child(0));
+            ifNode->body = materialize_list(view.list(0));
+            ifNode->elseBody = materialize_list(view.list(1));
+            node = ifNode;
+            break;
+        }
+        case NodeType::While: {
+            auto whileNode = std::make_shared<WhileNode>();
+            whileNode->condition = materialize_node(view.child(0));
+            whileNode->body = materialize_list(view.list(0));
+            node = whileNode;
+            break;
+        }
+        case NodeType::Return: {
+            auto returnNode = std::make_shared<ReturnNode>();
+            returnNode->expression = materialize_node(view.child(0));
+            node = returnNode;
+            break;
+        }
+        case NodeType::Break:
+            node = std::make_shared<BreakNode>();
+            break;
+        case NodeType::Block: {
+            auto block = std::make_shared<BlockNode>();
+            block->statements = materialize_list(view.list(0));
+            node = block;
+            break;
+        }
+        case NodeType::BinaryOp:
+            node = std::make_shared<BinaryOpNode>(std::string(view.str(0)),
+                materialize_node(view.child(0)), materialize_node(view.child(1)));
+            break;
+        case NodeType::UnaryOp:
+            node = std::make_shared<UnaryOpNode>(std::string(view.str(0)), materialize_node(view.child(0)));
+            break;
+        case NodeType::Literal:
+            node = std::make_shared<LiteralNode>(std::string(view.str(0)), std::string(view.str(1)));
+            break;
+        case NodeType::Variable:
+            node = std::make_shared<VariableNode>(std::string(view.str(0)));
+            break;
+        case NodeType::FunctionCall: {
+            auto call = std::make_shared<FunctionCallNode>(std::string(view.str(0)));
+            call->arguments = materialize_list(view.list(0));
+            node = call;
+            break;
+        }
+        case NodeType::Index:
+            node = std::make_shared<IndexNode>(materialize_node(view.child(0)), materialize_node(view.child(1)));
+            break;
+        case NodeType::Error:
+            node = std::make_shared<ErrorNode>(std::string(view.str(0)));
+            break;
+    }
+
+    node->line = view.line();
+    node->column = view.column();
+    return node;
+}
+
+} // namespace
+
+// === Views ===
+
+uint32_t ListView::size() const {
+    return offset == 0 ? 0 : load_u32(base, offset);
+}
+
+NodeView ListView::operator[](uint32_t index) const {
+    return NodeView(base, load_u32(base, offset + 4 + index * 4));
+}
+
+std::string_view NodeView::str(int slot) const {
+    const auto& header = *reinterpret_cast<const ast_format::ImageHeader*>(base);
+    uint32_t entry = header.strings_offset + 4 + record().str[slot] * 8;
+    return std::string_view(reinterpret_cast<const char*>(base + load_u32(base, entry)),
+                            load_u32(base, entry + 4));
+}
+
+// === Image ===
+
+bool ASTImage::valid() const {
+    if (data == nullptr || size < sizeof(ImageHeader)) return false;
+
+    const ImageHeader& h = header();
+    if (std::memcmp(h.magic, ast_format::magic, sizeof(h.magic)) != 0) return false;
+    if (h.format_version != ast_format::format_version) return false;
+    if (h.total_size > size) return false;
+    const uint64_t end = h.total_size;
+
+    // string table, and every string body with its NUL inside the image
+    if (h.strings_offset < sizeof(ImageHeader) || h.strings_offset % 4 != 0 || h.strings_offset + 4ULL > end) {
+        return false;
+    }
+    const uint32_t string_count = load_u32(data, h.strings_offset);
+    const uint64_t table_end = h.strings_offset + 4ULL + string_count * 8ULL;
+    if (table_end > end) return false;
+    for (uint32_t i = 0; i < string_count; ++i) {
+        const uint32_t entry = h.strings_offset + 4 + i * 8;
+        const uint64_t start = load_u32(data, entry);
+        if (start < table_end || start + load_u32(data, entry + 4) + 1 > end) return false;
+    }
+
+    // node records
+    const uint64_t nodes_end = uint64_t(h.nodes_offset) + uint64_t(h.node_count) * sizeof(NodeRecord);
+    if (h.nodes_offset < table_end || h.nodes_offset % 4 != 0 || nodes_end > end) return false;
+    auto is_node = [&](uint64_t offset) {
+        return offset >= h.nodes_offset && offset < nodes_end && (offset - h.nodes_offset) % sizeof(NodeRecord) == 0;
+    };
+    if (!is_node(h.root_offset)) return false;
+
+    // The serializer writes children before their parent, so a child always
+    // sits below the node that refers to it and no chain of references can
+    // loop. Counting references as well keeps a corrupt image from sharing a
+    // subtree, so materialize() sees a tree
+    std::vector<uint8_t> referenced(h.node_count, 0);
+    auto refer = [&](uint32_t offset, uint32_t parent) {
+        if (!is_node(offset) || offset >= parent) return false;
+        uint8_t& count = referenced[(offset - h.nodes_offset) / sizeof(NodeRecord)];
+        return count++ == 0;
+    };
+
+    for (uint32_t i = 0; i < h.node_count; ++i) {
+        const uint32_t offset = h.nodes_offset + i * static_cast<uint32_t>(sizeof(NodeRecord));
+        NodeRecord record;
+        std::memcpy(&record, data + offset, sizeof(record));
+        if (record.type > static_cast<uint8_t>(NodeType::Error)) return false;
+        const auto type = static_cast<NodeType>(record.type);
+
+        for (int slot = 0; slot < strings_used(type); ++slot) {
+            if (record.str[slot] >= string_count) return false;
+        }
+        for (uint32_t child : record.child) {
+            if (child != 0 && !refer(child, offset)) return false;
+        }
+        for (int slot = 0; slot < 2; ++slot) {
+            const uint32_t list = record.list[slot];
+            if (list == 0) continue;
+            if (list < nodes_end || list % 4 != 0 || list + 4ULL > end) return false;
+            const uint32_t count = load_u32(data, list);
+            if (list + 4ULL + count * 4ULL > end) return false;
+            for (uint32_t j = 0; j < count; ++j) {
+                const uint32_t item = load_u32(data, list + 4 + j * 4);
+                if (!refer(item, offset)) return false;
+                // materialize() casts a function's first list to parameters
+                if (type == NodeType::Function && slot == 0 &&
+                    data[item] != static_cast<uint8_t>(NodeType::Parameter)) {
+                    return false;
+                }
+            }
+        }
+    }
+    const bool root_referenced = referenced[(h.root_offset - h.nodes_offset) / sizeof(NodeRecord)] != 0;
+    return data[h.root_offset] == static_cast<uint8_t>(NodeType::Program) && !root_referenced;
+}
+
+ASTNodePTR ASTImage::materialize() const {
+    return materialize_node(root());
+}
+
+std::vector<uint8_t> serialize_ast(const ProgramNode& program, uint64_t source_hash, uint64_t compiler_hash) {
+    ASTSerializer serializer;
+    // the visitor takes non-const nodes but never modifies them
+    uint32_t root = serializer.visit(const_cast<ProgramNode&>(program));
+    return serializer.layout(root, source_hash, compiler_hash);
+}
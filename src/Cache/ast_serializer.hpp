@@ -0,0 +1,138 @@
+#pragma once
+#include "../SynParser/syntax_parser.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// === Binary AST Format ===
+// Layout of a serialized tree ("image"), all fields little endian and
+// 4-byte aligned so the image can be used straight out of an mmap:
+//
+//   ImageHeader
+//   string table    uint32 count, then count x {uint32 offset, uint32 length}
+//   string blob     NUL terminated, every distinct string stored once
+//   node records    NodeRecord[node_count]
+//   lists           uint32 count, then count x uint32 node offset
+//
+// Every reference is a byte offset from the start of the image, never a
+// pointer, and 0 means "none" (the header lives at 0). Reading a field
+// is a bounds-free load, there is no per-node deserialization step, so
+// an image from disk must pass ASTImage::valid() before it is read.
+
+namespace ast_format {
+
+constexpr char magic[8] = {'T', 'U', 'R', 'D', 'A', 'S', 'T', '\0'};
+constexpr uint32_t format_version = 3;
+
+struct ImageHeader {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t total_size;        // whole image in bytes
+    uint64_t source_hash;       // hash of the source the tree was parsed from
+    uint64_t compiler_hash;     // hash of the compiler version that wrote it
+    uint32_t strings_offset;    // string table
+    uint32_t nodes_offset;      // first NodeRecord
+    uint32_t node_count;
+    uint32_t root_offset;       // the ProgramNode
+};
+
+// Field use per node type:
+//   Program       list0 children
+//   Function      str0 name, str1 returnType, list0 parameters, list1 body
+//   Parameter     str0 name, str1 type
+//   Declaration   str0 name, str1 type, child0 initializer, child1 size
+//   Assignment    str0 name, child0 expression, child1 index
+//   If            child0 condition, list0 body, list1 elseBody
+//   While         child0 condition, list0 body
+//   Return        child0 expression
+//   Break         (no fields)
+//   Block         list0 statements
+//   BinaryOp      str0 op, child0 left, child1 right
+//   UnaryOp       str0 op, child0 operand
+//   Literal       str0 value, str1 literalType
+//   Variable      str0 name
+//   FunctionCall  str0 name, list0 arguments
+//   Index         child0 array, child1 index
+//   Error         str0 message
+struct NodeRecord {
+    uint8_t type;               // NodeType
+    uint8_t reserved[3];
+    int32_t line;
+    int32_t column;
+    uint32_t str[2];            // string ids
+    uint32_t child[3];          // node offsets
+    uint32_t list[2];           // list offsets
+};
+
+static_assert(sizeof(ImageHeader) == 48, "ImageHeader layout changed");
+static_assert(sizeof(NodeRecord) == 40, "NodeRecord layout changed");
+
+} // namespace ast_format
+
+class NodeView;
+
+// A contiguous list of child nodes inside an image
+class ListView {
+public:
+    ListView() = default;
+    ListView(const uint8_t* base, uint32_t offset) : base(base), offset(offset) {}
+
+    uint32_t size() const;
+    bool empty() const { return size() == 0; }
+    NodeView operator[](uint32_t index) const;
+
+private:
+    const uint8_t* base = nullptr;
+    uint32_t offset = 0;
+};
+
+// Read-only handle to one node of an image. Cheap to copy, holds two words
+class NodeView {
+public:
+    NodeView() = default;
+    NodeView(const uint8_t* base, uint32_t offset) : base(base), offset(offset) {}
+
+    explicit operator bool() const { return offset != 0; }
+
+    NodeType type() const { return static_cast<NodeType>(record().type); }
+    int line() const { return record().line; }
+    int column() const { return record().column; }
+
+    std::string_view str(int slot) const;
+    NodeView child(int slot) const { return NodeView(base, record().child[slot]); }
+    ListView list(int slot) const { return ListView(base, record().list[slot]); }
+
+private:
+    const ast_format::NodeRecord& record() const {
+        return *reinterpret_cast<const ast_format::NodeRecord*>(base + offset);
+    }
+
+    const uint8_t* base = nullptr;
+    uint32_t offset = 0;
+};
+
+// A serialized tree in memory, owned elsewhere (vector, mmap, ...)
+class ASTImage {
+public:
+    ASTImage() = default;
+    ASTImage(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    // checks the header, that every string, child and list offset stays
+    // inside the image, and that the nodes form one tree under a Program
+    bool valid() const;
+
+    const ast_format::ImageHeader& header() const {
+        return *reinterpret_cast<const ast_format::ImageHeader*>(data);
+    }
+    NodeView root() const { return NodeView(data, header().root_offset); }
+
+    // rebuild the shared_ptr tree, for consumers that need ASTNodePTR
+    ASTNodePTR materialize() const;
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+std::vector<uint8_t> serialize_ast(const ProgramNode& program, uint64_t source_hash = 0,
+                                   uint64_t compiler_hash = 0);
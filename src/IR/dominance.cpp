@@ -0,0 +1,82 @@
+#include "dominance.hpp"
+#include <algorithm>
+#include <utility>
+
+DominatorTree::DominatorTree(const IRFunction& function) {
+    size_t count = function.blocks.size();
+    order.assign(count, unvisited);
+    idoms.assign(count, no_block);
+    tree.assign(count, {});
+    enter.assign(count, 0);
+    leave.assign(count, 0);
+    if (count == 0) return;
+
+    // postorder with an explicit stack, deep loop nests must not recurse
+    std::vector<bool> seen(count, false);
+    std::vector<std::pair<BlockId, size_t>> stack{{0, 0}};
+    seen[0] = true;
+    while (!stack.empty()) {
+        auto& [block, next] = stack.back();
+        const auto& succs = function.blocks[block].succs;
+        if (next < succs.size()) {
+            BlockId succ = succs[next++];
+            if (!seen[succ]) {
+                seen[succ] = true;
+                stack.push_back({succ, 0});
+            }
+        } else {
+            rpo.push_back(block);
+            stack.pop_back();
+        }
+    }
+    std::reverse(rpo.begin(), rpo.end());
+    for (uint32_t i = 0; i < rpo.size(); ++i) order[rpo[i]] = i;
+
+    auto intersect = [&](BlockId a, BlockId b) {
+        while (a != b) {
+            while (order[a] > order[b]) a = idoms[a];
+            while (order[b] > order[a]) b = idoms[b];
+        }
+        return a;
+    };
+
+    idoms[0] = 0;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = 1; i < rpo.size(); ++i) {
+            BlockId block = rpo[i];
+            BlockId candidate = no_block;
+            for (BlockId pred : function.blocks[block].preds) {
+                if (idoms[pred] == no_block) continue;
+                candidate = candidate == no_block ? pred : intersect(pred, candidate);
+            }
+            if (candidate != idoms[block]) {
+                idoms[block] = candidate;
+                changed = true;
+            }
+        }
+    }
+
+    for (size_t i = 1; i < rpo.size(); ++i) tree[idoms[rpo[i]]].push_back(rpo[i]);
+
+    // preorder numbering of the tree: a dominates b iff b's interval nests in a's
+    uint32_t clock = 0;
+    std::vector<std::pair<BlockId, size_t>> walk{{0, 0}};
+    enter[0] = clock++;
+    while (!walk.empty()) {
+        auto& [block, next] = walk.back();
+        if (next < tree[block].size()) {
+            BlockId child = tree[block][next++];
+            enter[child] = clock++;
+            walk.push_back({child, 0});
+        } else {
+            leave[block] = clock++;
+            walk.pop_back();
+        }
+    }
+}
+
+bool DominatorTree::dominates(BlockId a, BlockId b) const {
+    if (!reachable(a) || !reachable(b)) return false;
+    return enter[a] <= enter[b] && leave[b] <= leave[a];
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "ir.hpp"
+
+// === Dominator Tree ===
+// Immediate dominators by the iterative algorithm of Cooper, Harvey and
+// Kennedy over reverse postorder, which is faster than Lengauer-Tarjan at
+// the block counts Turd functions have. Blocks unreachable from the
+// entry have no idom and dominate nothing.
+class DominatorTree {
+public:
+    explicit DominatorTree(const IRFunction& function);
+
+    bool reachable(BlockId block) const { return order[block] != unvisited; }
+    BlockId idom(BlockId block) const { return idoms[block]; }     // entry is its own idom
+    bool dominates(BlockId a, BlockId b) const;                     // reflexive
+    const std::vector<BlockId>& reverse_postorder() const { return rpo; }
+    const std::vector<BlockId>& children(BlockId block) const { return tree[block]; }
+
+private:
+    static constexpr uint32_t unvisited = UINT32_MAX;
+
+    std::vector<BlockId> rpo;
+    std::vector<uint32_t> order;            // position in rpo
+    std::vector<BlockId> idoms;
+    std::vector<std::vector<BlockId>> tree; // dominator tree children
+    std::vector<uint32_t> enter, leave;     // preorder interval per block, for O(1) dominates()
+};
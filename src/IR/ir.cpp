@@ -0,0 +1,349 @@
+#include "ir.hpp"
+#include <algorithm>
+#include <cstring>
+
+const char* opcodeToString(Opcode op) {
+    switch (op) {
+        case Opcode::Nop: return "nop";
+        case Opcode::Const: return "const";
+        case Opcode::Undef: return "undef";
+        case Opcode::Param: return "param";
+        case Opcode::Phi: return "phi";
+        case Opcode::Copy: return "copy";
+        case Opcode::IntToFloat: return "itof";
+        case Opcode::Add: return "add";
+        case Opcode::Sub: return "sub";
+        case Opcode::Mul: return "mul";
+        case Opcode::Div: return "div";
+        case Opcode::Mod: return "mod";
+        case Opcode::FloorDiv: return "floordiv";
+        case Opcode::Pow: return "pow";
+        case Opcode::Shr: return "shr";
+        case Opcode::Neg: return "neg";
+        case Opcode::Not: return "not";
+        case Opcode::Eq: return "eq";
+        case Opcode::Ne: return "ne";
+        case Opcode::Lt: return "lt";
+        case Opcode::Le: return "le";
+        case Opcode::Gt: return "gt";
+        case Opcode::Ge: return "ge";
+        case Opcode::LoadGlobal: return "load";
+        case Opcode::StoreGlobal: return "store";
+        case Opcode::Call: return "call";
+        case Opcode::Print: return "print";
+        case Opcode::Read: return "read";
+        case Opcode::NewArray: return "newarray";
+        case Opcode::ArrayLength: return "length";
+        case Opcode::BoundsCheck: return "boundscheck";
+        case Opcode::LoadElement: return "loadelem";
+        case Opcode::StoreElement: return "storeelem";
+        case Opcode::Jump: return "jmp";
+        case Opcode::Branch: return "br";
+        case Opcode::Return: return "ret";
+    }
+    return "unknown";
+}
+
+bool is_terminator(Opcode op) {
+    return op == Opcode::Jump || op == Opcode::Branch || op == Opcode::Return;
+}
+
+bool has_side_effects(Opcode op) {
+    switch (op) {
+        case Opcode::StoreGlobal:
+        case Opcode::Call:
+        case Opcode::Print:
+        case Opcode::Read:
+        case Opcode::BoundsCheck:
+        case Opcode::StoreElement:
+        case Opcode::Jump:
+        case Opcode::Branch:
+        case Opcode::Return:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool is_commutative(Opcode op, TypeId type) {
+    switch (op) {
+        case Opcode::Add:
+        case Opcode::Mul:
+            return type == TypeId::Int || type == TypeId::Float;   // string '+' is not
+        case Opcode::Eq:
+        case Opcode::Ne:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// === IRFunction ===
+
+BlockId IRFunction::add_block() {
+    blocks.emplace_back();
+    return static_cast<BlockId>(blocks.size() - 1);
+}
+
+void IRFunction::add_edge(BlockId from, BlockId to) {
+    blocks[from].succs.push_back(to);
+    blocks[to].preds.push_back(from);
+}
+
+ValueId IRFunction::create(Opcode op, TypeId type, const std::vector<ValueId>& args, int64_t immediate, int line) {
+    IRInstruction instruction;
+    instruction.op = op;
+    instruction.type = type;
+    instruction.first_operand = static_cast<uint32_t>(operands.size());
+    instruction.operand_count = static_cast<uint32_t>(args.size());
+    instruction.immediate = immediate;
+    instruction.line = line;
+    operands.insert(operands.end(), args.begin(), args.end());
+
+    values.push_back(instruction);
+    return static_cast<ValueId>(values.size() - 1);
+}
+
+ValueId IRFunction::append(BlockId block, Opcode op, TypeId type, const std::vector<ValueId>& args,
+                           int64_t immediate, int line) {
+    ValueId value = create(op, type, args, immediate, line);
+    values[value].block = block;
+
+    auto& code = blocks[block].code;
+    if (op == Opcode::Phi) {
+        auto position = std::find_if(code.begin(), code.end(),
+                                     [&](ValueId v) { return values[v].op != Opcode::Phi; });
+        code.insert(position, value);
+    } else {
+        code.push_back(value);
+    }
+    return value;
+}
+
+void IRFunction::set_operands(ValueId value, const std::vector<ValueId>& args) {
+    IRInstruction& instruction = values[value];
+    if (args.size() > instruction.operand_count) {
+        instruction.first_operand = static_cast<uint32_t>(operands.size());
+        operands.insert(operands.end(), args.begin(), args.end());
+    } else {
+        std::copy(args.begin(), args.end(), operands.begin() + instruction.first_operand);
+    }
+    instruction.operand_count = static_cast<uint32_t>(args.size());
+}
+
+ValueId IRFunction::terminator(BlockId block) const {
+    const auto& code = blocks[block].code;
+    if (code.empty() || !is_terminator(values[code.back()].op)) return no_value;
+    return code.back();
+}
+
+void IRFunction::remove(ValueId value) {
+    IRInstruction& instruction = values[value];
+    if (instruction.block != no_block) {
+        auto& code = blocks[instruction.block].code;
+        code.erase(std::find(code.begin(), code.end(), value));
+    }
+    instruction.op = Opcode::Nop;
+    instruction.block = no_block;
+    instruction.operand_count = 0;
+}
+
+void IRFunction::replace_all_uses(ValueId from, ValueId to) {
+    for (const auto& block : blocks) {
+        for (ValueId user : block.code) {
+            ValueId* args = operands_of(user);
+            for (uint32_t i = 0; i < values[user].operand_count; ++i) {
+                if (args[i] == from) args[i] = to;
+            }
+        }
+    }
+}
+
+void IRFunction::forward_operands(const std::vector<ValueId>& forward) {
+    auto resolve = [&](ValueId value) {
+        while (value < forward.size() && forward[value] != no_value) value = forward[value];
+        return value;
+    };
+    for (const auto& block : blocks) {
+        for (ValueId user : block.code) {
+            ValueId* args = operands_of(user);
+            for (uint32_t i = 0; i < values[user].operand_count; ++i) args[i] = resolve(args[i]);
+        }
+    }
+}
+
+void IRFunction::apply_forwarding(const std::vector<ValueId>& forward) {
+    forward_operands(forward);
+    for (auto& block : blocks) {
+        size_t kept = 0;
+        for (ValueId value : block.code) {
+            if (value >= forward.size() || forward[value] == no_value) {
+                block.code[kept++] = value;
+                continue;
+            }
+            values[value].op = Opcode::Nop;
+            values[value].block = no_block;
+            values[value].operand_count = 0;
+        }
+        block.code.resize(kept);
+    }
+}
+
+void IRFunction::move_before_terminator(ValueId value, BlockId block) {
+    IRInstruction& instruction = values[value];
+    auto& from = blocks[instruction.block].code;
+    from.erase(std::find(from.begin(), from.end(), value));
+
+    auto& to = blocks[block].code;
+    to.insert(terminator(block) == no_value ? to.end() : to.end() - 1, value);
+    instruction.block = block;
+}
+
+bool IRFunction::may_trap(ValueId value) const {
+    const IRInstruction& instruction = values[value];
+    switch (instruction.op) {
+        case Opcode::Phi:
+        case Opcode::Copy:
+        case Opcode::Eq:
+        case Opcode::Ne:
+        case Opcode::Const:
+        case Opcode::Undef:
+        case Opcode::Param:
+        case Opcode::LoadGlobal:
+        case Opcode::ArrayLength:
+        case Opcode::LoadElement:
+        case Opcode::StoreElement:
+            return false;
+        case Opcode::BoundsCheck:
+            return true;
+        default:
+            break;
+    }
+
+    for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+        if (values[operand(value, i)].type == TypeId::Unknown) return true;
+    }
+
+    auto constant = [&](uint32_t i, int64_t& out) {
+        const IRInstruction& def = values[operand(value, i)];
+        out = def.immediate;
+        return def.op == Opcode::Const;
+    };
+    int64_t divisor, base, exponent, length;
+    switch (instruction.op) {
+        case Opcode::Div:
+        case Opcode::Mod:
+            if (values[operand(value, 1)].type == TypeId::Float) return false;
+            return !constant(1, divisor) || divisor == 0 || divisor == -1;
+        case Opcode::FloorDiv:
+            // float // float traps when the quotient doesn't fit an int
+            if (values[operand(value, 1)].type == TypeId::Float) return true;
+            return !constant(1, divisor) || divisor == 0 || divisor == -1;
+        case Opcode::Pow:
+            if (instruction.type != TypeId::Int) return false;
+            return !((constant(1, exponent) && exponent >= 0) || (constant(0, base) && base != 0));
+        case Opcode::NewArray:
+            return !constant(0, length) || length < 0;
+        default:
+            return false;
+    }
+}
+
+// === CFG edits ===
+
+void IRFunction::remove_edge(BlockId from, BlockId to) {
+    auto& succs = blocks[from].succs;
+    succs.erase(std::find(succs.begin(), succs.end(), to));
+
+    auto& preds = blocks[to].preds;
+    size_t slot = std::find(preds.begin(), preds.end(), from) - preds.begin();
+    preds.erase(preds.begin() + slot);
+
+    for (ValueId value : blocks[to].code) {
+        if (values[value].op != Opcode::Phi) break;
+        std::vector<ValueId> args(operands_of(value), operands_of(value) + values[value].operand_count);
+        args.erase(args.begin() + slot);
+        set_operands(value, args);
+    }
+}
+
+BlockId IRFunction::split_edge(BlockId from, BlockId to) {
+    BlockId middle = add_block();
+    *std::find(blocks[from].succs.begin(), blocks[from].succs.end(), to) = middle;
+    *std::find(blocks[to].preds.begin(), blocks[to].preds.end(), from) = middle;
+    blocks[middle].preds.push_back(from);
+    blocks[middle].succs.push_back(to);
+    append(middle, Opcode::Jump, TypeId::Void);
+    return middle;
+}
+
+size_t IRFunction::remove_unreachable_blocks() {
+    std::vector<bool> reachable(blocks.size(), false);
+    std::vector<BlockId> stack{0};
+    reachable[0] = true;
+    while (!stack.empty()) {
+        BlockId block = stack.back();
+        stack.pop_back();
+        for (BlockId succ : blocks[block].succs) {
+            if (!reachable[succ]) {
+                reachable[succ] = true;
+                stack.push_back(succ);
+            }
+        }
+    }
+
+    size_t removed = 0;
+    for (BlockId block = 0; block < blocks.size(); ++block) {
+        if (reachable[block]) continue;
+        ++removed;
+        while (!blocks[block].succs.empty()) remove_edge(block, blocks[block].succs.back());
+        for (ValueId value : blocks[block].code) {
+            values[value].op = Opcode::Nop;
+            values[value].block = no_block;
+            values[value].operand_count = 0;
+        }
+        blocks[block].code.clear();
+    }
+    if (removed == 0) return 0;
+
+    // compact the survivors and renumber every reference to them
+    std::vector<BlockId> renumber(blocks.size(), no_block);
+    std::vector<IRBlock> kept;
+    kept.reserve(blocks.size() - removed);
+    for (BlockId block = 0; block < blocks.size(); ++block) {
+        if (!reachable[block]) continue;
+        renumber[block] = static_cast<BlockId>(kept.size());
+        kept.push_back(std::move(blocks[block]));
+    }
+    for (auto& block : kept) {
+        for (BlockId& pred : block.preds) pred = renumber[pred];
+        for (BlockId& succ : block.succs) succ = renumber[succ];
+        for (ValueId value : block.code) values[value].block = renumber[values[value].block];
+    }
+    blocks = std::move(kept);
+    return removed;
+}
+
+// === IRModule ===
+
+uint32_t IRModule::intern_string(const std::string& text) {
+    auto found = string_ids.find(text);
+    if (found != string_ids.end()) return found->second;
+
+    uint32_t id = static_cast<uint32_t>(strings.size());
+    strings.push_back(text);
+    string_ids.emplace(text, id);
+    return id;
+}
+
+int64_t float_bits(double value) {
+    int64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bits_to_float(int64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include "../SynParser/syntax_parser.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// === SSA Intermediate Representation ===
+// Sits between the checked AST and the backends. A function is a set of
+// basic blocks over typed virtual registers in SSA form, with every
+// piece stored in a flat array owned by the function:
+//  - values      one IRInstruction per value, indexed by ValueId; ids are
+//                stable, an instruction removed by a pass stays in the
+//                array as a Nop and simply drops out of its block
+//  - operands    one shared pool, each instruction owns a contiguous slice
+//  - blocks      instruction order plus predecessor/successor lists
+//
+// Phis come first in their block and have one operand per predecessor,
+// in the order of IRBlock::preds. Every block ends in exactly one
+// terminator: Jump (succs[0]), Branch (true -> succs[0], false -> succs[1])
+// or Return. IRVerifier checks all of this.
+//
+// Types are TypeIds. Operands of an arithmetic op have the result's type,
+// except FloorDiv (float operands give an int) and comparisons (result is
+// bool); lowering inserts IntToFloat where an int meets a float. An
+// instruction with an Unknown operand is dynamically typed and backends
+// check its operands at runtime.
+//
+// Arrays are never Unknown. a[i] lowers to a BoundsCheck followed by the
+// unchecked LoadElement or StoreElement, so a pass that proves the index in
+// range (BoundsCheckElimination) only has to remove the check.
+
+using ValueId = uint32_t;
+using BlockId = uint32_t;
+
+constexpr ValueId no_value = UINT32_MAX;
+constexpr BlockId no_block = UINT32_MAX;
+
+enum class Opcode : uint8_t {
+    Nop,            // removed instruction, never in a block
+    // values
+    Const,          // immediate: int, char code, bool 0/1, float bits, or string index
+    Undef,          // read of a variable no path has written
+    Param,          // immediate: parameter index
+    Phi,
+    Copy,
+    IntToFloat,
+    // arithmetic
+    Add,            // also string concatenation
+    Sub,
+    Mul,
+    Div,
+    Mod,
+    FloorDiv,
+    Pow,
+    Shr,            // arithmetic shift right, from folded '//'
+    Neg,
+    Not,
+    // comparisons
+    Eq,
+    Ne,
+    Lt,
+    Le,
+    Gt,
+    Ge,
+    // memory and calls
+    LoadGlobal,     // immediate: global slot
+    StoreGlobal,    // immediate: global slot, operand: value
+    Call,           // immediate: function index, operands: arguments
+    Print,          // operands: values printed on one line
+    Read,           // reads one value of the instruction's type from stdin
+    NewArray,       // operand: int length; a zeroed array of the instruction's type
+    ArrayLength,    // operand: array
+    BoundsCheck,    // operands: array, int index; raises unless 0 <= index < length
+    LoadElement,    // operands: array, int index, already checked
+    StoreElement,   // operands: array, int index, value of the element type, already checked
+    // terminators
+    Jump,
+    Branch,         // operand: bool condition
+    Return          // operand: value, none for void
+};
+
+const char* opcodeToString(Opcode op);
+
+bool is_terminator(Opcode op);
+bool has_side_effects(Opcode op);   // must stay even when its value is unused
+bool is_commutative(Opcode op, TypeId type);
+
+struct IRInstruction {
+    Opcode op = Opcode::Nop;
+    TypeId type = TypeId::Void;
+    BlockId block = no_block;
+    uint32_t first_operand = 0;     // slice of IRFunction::operands
+    uint32_t operand_count = 0;
+    int64_t immediate = 0;
+    int line = -1;                  // source line, for diagnostics
+};
+
+struct IRBlock {
+    std::vector<ValueId> code;      // phis first, terminator last
+    std::vector<BlockId> preds;
+    std::vector<BlockId> succs;
+};
+
+class IRFunction {
+public:
+    std::string name;
+    TypeId returnType = TypeId::Void;
+    std::vector<TypeId> paramTypes;
+
+    std::vector<IRInstruction> values;
+    std::vector<ValueId> operands;
+    std::vector<IRBlock> blocks;       // block 0 is the entry
+
+    BlockId add_block();
+    void add_edge(BlockId from, BlockId to);
+
+    // creates an instruction and appends it to block (phis go after the existing phis)
+    ValueId append(BlockId block, Opcode op, TypeId type, const std::vector<ValueId>& args = {},
+                   int64_t immediate = 0, int line = -1);
+    // creates an instruction that is not in any block yet
+    ValueId create(Opcode op, TypeId type, const std::vector<ValueId>& args = {},
+                   int64_t immediate = 0, int line = -1);
+
+    const ValueId* operands_of(ValueId value) const { return operands.data() + values[value].first_operand; }
+    ValueId* operands_of(ValueId value) { return operands.data() + values[value].first_operand; }
+    ValueId operand(ValueId value, uint32_t index) const { return operands[values[value].first_operand + index]; }
+    void set_operands(ValueId value, const std::vector<ValueId>& args); // reuses the slice when it fits
+
+    ValueId terminator(BlockId block) const;   // no_value while the block is still open
+    void remove(ValueId value);                 // drop from its block and turn into a Nop
+    void replace_all_uses(ValueId from, ValueId to);
+    // rewrites every operand v with forward[v] != no_value, following chains;
+    // lets a pass collect many replacements and apply them in one sweep
+    void forward_operands(const std::vector<ValueId>& forward);
+    // forward_operands, then removes every forwarded instruction in one pass
+    void apply_forwarding(const std::vector<ValueId>& forward);
+    void move_before_terminator(ValueId value, BlockId block);
+    // can raise a runtime error: int division by a possibly bad divisor, 0 ** -n,
+    // an array of a possibly negative size, a bounds check, or anything but
+    // (in)equality on a dynamically typed operand
+    bool may_trap(ValueId value) const;
+
+    // === CFG edits ===
+    void remove_edge(BlockId from, BlockId to);        // also drops the matching phi operands
+    BlockId split_edge(BlockId from, BlockId to);       // new block on the edge, phis keep their slot
+    size_t remove_unreachable_blocks();                 // renumbers the survivors, returns how many went
+};
+
+struct IRModule {
+    std::vector<IRFunction> functions;  // in SymbolRef::index order, then the entry
+    size_t entry = 0;                   // top-level code, run as a function
+    std::vector<TypeId> globals;
+    std::vector<std::string> strings;   // string constants, deduplicated
+
+    uint32_t intern_string(const std::string& text);
+
+private:
+    std::unordered_map<std::string, uint32_t> string_ids;
+};
+
+// float constants travel in the immediate as their bit pattern
+int64_t float_bits(double value);
+double bits_to_float(int64_t bits);
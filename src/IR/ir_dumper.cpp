@@ -0,0 +1,152 @@
+#include "ir_dumper.hpp"
+#include "../Support/output_buffer.hpp"
+#include <cctype>
+
+namespace {
+
+void write_value(OutputBuffer& buffer, ValueId value) {
+    buffer.put('%');
+    buffer.write_int(value);
+}
+
+void write_block(OutputBuffer& buffer, BlockId block) {
+    buffer.write("bb");
+    buffer.write_int(block);
+}
+
+void write_constant(OutputBuffer& buffer, const IRModule& module, const IRInstruction& instruction) {
+    switch (instruction.type) {
+        case TypeId::Float:
+            buffer.write_float(bits_to_float(instruction.immediate));
+            break;
+        case TypeId::String:
+            buffer.write_json_string(module.strings[instruction.immediate]);
+            break;
+        case TypeId::Bool:
+            buffer.write(instruction.immediate ? "true" : "false");
+            break;
+        case TypeId::Char:
+            // printable characters quoted, anything else as its code
+            if (std::isprint(static_cast<int>(instruction.immediate)) && instruction.immediate != '\'' &&
+                instruction.immediate != '\\') {
+                buffer.put('\'');
+                buffer.put(static_cast<char>(instruction.immediate));
+                buffer.put('\'');
+            } else {
+                buffer.write_int(instruction.immediate);
+            }
+            break;
+        case TypeId::Int:
+        case TypeId::Unknown:
+        case TypeId::Void:
+        case TypeId::IntArray: case TypeId::FloatArray: case TypeId::StringArray:
+        case TypeId::BoolArray: case TypeId::CharArray:
+            buffer.write_int(instruction.immediate);
+            break;
+    }
+}
+
+void dump_function(OutputBuffer& buffer, const IRModule& module, const IRFunction& function) {
+    buffer.write("function ");
+    buffer.write(function.name);
+    buffer.put('(');
+    for (size_t i = 0; i < function.paramTypes.size(); ++i) {
+        if (i) buffer.write(", ");
+        buffer.write(typeIdToString(function.paramTypes[i]));
+    }
+    buffer.write(") -> ");
+    buffer.write(typeIdToString(function.returnType));
+    buffer.put('\n');
+
+    for (BlockId b = 0; b < function.blocks.size(); ++b) {
+        const IRBlock& block = function.blocks[b];
+        write_block(buffer, b);
+        buffer.put(':');
+        if (!block.preds.empty()) {
+            buffer.write("  ; preds ");
+            for (size_t i = 0; i < block.preds.size(); ++i) {
+                if (i) buffer.write(", ");
+                write_block(buffer, block.preds[i]);
+            }
+        }
+        buffer.put('\n');
+
+        for (ValueId value : block.code) {
+            const IRInstruction& instruction = function.values[value];
+            const ValueId* args = function.operands_of(value);
+            buffer.indent(4);
+            if (instruction.type != TypeId::Void) {
+                write_value(buffer, value);
+                buffer.put(':');
+                buffer.write(typeIdToString(instruction.type));
+                buffer.write(" = ");
+            }
+            buffer.write(opcodeToString(instruction.op));
+
+            switch (instruction.op) {
+                case Opcode::Const:
+                    buffer.put(' ');
+                    write_constant(buffer, module, instruction);
+                    break;
+                case Opcode::Param:
+                    buffer.put(' ');
+                    buffer.write_int(instruction.immediate);
+                    break;
+                case Opcode::LoadGlobal:
+                case Opcode::StoreGlobal:
+                    buffer.write(" @g");
+                    buffer.write_int(instruction.immediate);
+                    break;
+                case Opcode::Call:
+                    buffer.write(" @");
+                    buffer.write(module.functions[instruction.immediate].name);
+                    buffer.put('(');
+                    for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+                        if (i) buffer.write(", ");
+                        write_value(buffer, args[i]);
+                    }
+                    buffer.write(")\n");
+                    continue;
+                case Opcode::Phi:
+                    for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+                        buffer.write(i ? ", [" : " [");
+                        write_value(buffer, args[i]);
+                        buffer.write(", ");
+                        write_block(buffer, block.preds[i]);
+                        buffer.put(']');
+                    }
+                    buffer.put('\n');
+                    continue;
+                default:
+                    break;
+            }
+
+            for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+                buffer.write(i || instruction.op == Opcode::StoreGlobal ? ", " : " ");
+                write_value(buffer, args[i]);
+            }
+            if (instruction.op == Opcode::Jump || instruction.op == Opcode::Branch) {
+                for (size_t i = 0; i < block.succs.size(); ++i) {
+                    buffer.write(i || instruction.operand_count ? ", " : " ");
+                    write_block(buffer, block.succs[i]);
+                }
+            }
+            buffer.put('\n');
+        }
+    }
+}
+
+} // namespace
+
+void dump_ir(const IRModule& module, std::ostream& out) {
+    OutputBuffer buffer(out);
+    for (size_t i = 0; i < module.functions.size(); ++i) {
+        if (i) buffer.put('\n');
+        dump_function(buffer, module, module.functions[i]);
+    }
+}
+
+void dump_ir(const IRModule& module, const IRFunction& function, std::ostream& out) {
+    OutputBuffer buffer(out);
+    dump_function(buffer, module, function);
+}
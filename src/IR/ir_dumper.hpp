@@ -0,0 +1,16 @@
+#pragma once
+#include "ir.hpp"
+#include <ostream>
+
+// Textual form of the IR, one instruction per line:
+//
+//   function factorial(unknown) -> int
+//   bb0:
+//       %0:unknown = param 0
+//       %1:int = const 1
+//       %2:bool = le %0, %1
+//       br %2, bb1, bb2
+//   bb3:  ; preds bb1, bb2
+//       %7:int = phi [%4, bb1], [%6, bb2]
+void dump_ir(const IRModule& module, std::ostream& out);
+void dump_ir(const IRModule& module, const IRFunction& function, std::ostream& out);
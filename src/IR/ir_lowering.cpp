@@ -0,0 +1,523 @@
+#include "ir_lowering.hpp"
+#include "../SynParser/ast_visitor.hpp"
+#include "../Support/arithmetic.hpp"
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+Opcode binary_opcode(const std::string& op) {
+    if (op == "+") return Opcode::Add;
+    if (op == "-") return Opcode::Sub;
+    if (op == "*") return Opcode::Mul;
+    if (op == "/") return Opcode::Div;
+    if (op == "%") return Opcode::Mod;
+    if (op == "//") return Opcode::FloorDiv;
+    if (op == "**") return Opcode::Pow;
+    if (op == ">>") return Opcode::Shr;
+    if (op == "==") return Opcode::Eq;
+    if (op == "!=") return Opcode::Ne;
+    if (op == "<") return Opcode::Lt;
+    if (op == "<=") return Opcode::Le;
+    if (op == ">") return Opcode::Gt;
+    if (op == ">=") return Opcode::Ge;
+    throw std::runtime_error("cannot lower operator '" + op + "'");
+}
+
+bool is_comparison(Opcode op) {
+    return op >= Opcode::Eq && op <= Opcode::Ge;
+}
+
+// Lowers one body into one IRFunction. Expression handlers return the
+// value computed; statement handlers return no_value.
+class FunctionLowering : public ASTVisitor<FunctionLowering, ValueId> {
+public:
+    FunctionLowering(IRModule& module, IRFunction& function, const std::vector<TypeId>& slotTypes)
+        : module(module), function(function), slotTypes(slotTypes), slots(slotTypes.size()) {}
+
+    void lower(const std::vector<ASTNodePTR>& body, size_t parameters) {
+        current = new_block();
+        seal(current);
+        for (size_t i = 0; i < parameters; ++i) {
+            write_variable(i, current, emit(Opcode::Param, slotTypes[i], {}, static_cast<int64_t>(i)));
+        }
+
+        lower_body(body);
+        if (current != no_block) {
+            if (function.returnType == TypeId::Void) {
+                emit(Opcode::Return, TypeId::Void);
+            } else {
+                emit(Opcode::Return, TypeId::Void, {undef(function.returnType)});
+            }
+        }
+        finish();
+    }
+
+    // === Statements ===
+    ValueId visit_program(ProgramNode&) { return no_value; }
+    ValueId visit_function(FunctionNode&) { return no_value; }     // lowered as its own IRFunction
+    ValueId visit_parameter(ParameterNode&) { return no_value; }
+
+    ValueId visit_declaration(DeclarationNode& node) {
+        line = node.line;
+        TypeId type = slot_type(node.symbol);
+        ValueId value;
+        if (node.size) {
+            value = emit(Opcode::NewArray, type, {visit(*node.size)});
+        } else {
+            value = node.initializer ? convert(visit(*node.initializer), type) : zero(type);
+        }
+        store(node.symbol, value);
+        return no_value;
+    }
+
+    ValueId visit_assignment(AssignmentNode& node) {
+        line = node.line;
+        if (node.index) {
+            ValueId array = load(node.symbol, node);
+            ValueId index = visit(*node.index);
+            ValueId value = convert(visit(*node.expression), element_type(type_of(array)));
+            emit(Opcode::BoundsCheck, TypeId::Void, {array, index});
+            emit(Opcode::StoreElement, TypeId::Void, {array, index, value});
+            return no_value;
+        }
+        ValueId value = convert(visit(*node.expression), slot_type(node.symbol));
+        store(node.symbol, value);
+        return no_value;
+    }
+
+    ValueId visit_if(IfNode& node) {
+        line = node.line;
+        ValueId condition = visit(*node.condition);
+        BlockId from = current;
+        BlockId then_block = new_block();
+        BlockId else_block = node.elseBody.empty() ? no_block : new_block();
+        BlockId join = else_block == no_block ? new_block() : no_block;
+
+        emit(Opcode::Branch, TypeId::Void, {condition});
+        function.add_edge(from, then_block);
+        function.add_edge(from, else_block == no_block ? join : else_block);
+        seal(then_block);
+
+        // an arm that falls through jumps to the join, which is only made if someone reaches it
+        auto lower_arm = [&](BlockId arm, const std::vector<ASTNodePTR>& body) {
+            current = arm;
+            lower_body(body);
+            if (current == no_block) return;
+            if (join == no_block) join = new_block();
+            emit(Opcode::Jump, TypeId::Void);
+            function.add_edge(current, join);
+        };
+
+        lower_arm(then_block, node.body);
+        if (else_block != no_block) {
+            seal(else_block);
+            lower_arm(else_block, node.elseBody);
+        }
+
+        current = join;
+        if (join != no_block) seal(join);
+        return no_value;
+    }
+
+    ValueId visit_while(WhileNode& node) {
+        line = node.line;
+        BlockId header = new_block();
+        emit(Opcode::Jump, TypeId::Void);
+        function.add_edge(current, header);
+
+        // the header stays unsealed until the back edge exists
+        current = header;
+        ValueId condition = visit(*node.condition);
+        BlockId body = new_block();
+        BlockId exit = new_block();
+        emit(Opcode::Branch, TypeId::Void, {condition});
+        function.add_edge(current, body);
+        function.add_edge(current, exit);
+        seal(body);
+
+        // the exit stays unsealed too: every break in the body is a predecessor
+        current = body;
+        loop_exits.push_back(exit);
+        lower_body(node.body);
+        loop_exits.pop_back();
+        if (current != no_block) {
+            emit(Opcode::Jump, TypeId::Void);
+            function.add_edge(current, header);
+        }
+        seal(header);
+        seal(exit);
+        current = exit;
+        return no_value;
+    }
+
+    ValueId visit_return(ReturnNode& node) {
+        line = node.line;
+        if (node.expression) {
+            ValueId value = convert(visit(*node.expression), function.returnType);
+            emit(Opcode::Return, TypeId::Void, {value});
+        } else {
+            emit(Opcode::Return, TypeId::Void);
+        }
+        current = no_block;
+        return no_value;
+    }
+
+    ValueId visit_break(BreakNode& node) {
+        line = node.line;
+        emit(Opcode::Jump, TypeId::Void);
+        function.add_edge(current, loop_exits.back());
+        current = no_block;
+        return no_value;
+    }
+
+    ValueId visit_block(BlockNode& node) {
+        lower_body(node.statements);
+        return no_value;
+    }
+
+    ValueId visit_error(ErrorNode& node) {
+        throw std::runtime_error("cannot lower a tree with errors (line " + std::to_string(node.line) + ")");
+    }
+
+    // === Expressions ===
+    ValueId visit_binary_op(BinaryOpNode& node) {
+        if (node.op == "&&" || node.op == "||") return short_circuit(node);
+
+        ValueId left = visit(*node.left);
+        ValueId right = visit(*node.right);
+        Opcode op = binary_opcode(node.op);
+        TypeId left_type = type_of(left), right_type = type_of(right);
+
+        // numeric operands meet at float; '//' and comparisons keep their own result type
+        if ((left_type == TypeId::Float && right_type == TypeId::Int) ||
+            (left_type == TypeId::Int && right_type == TypeId::Float)) {
+            left = convert(left, TypeId::Float);
+            right = convert(right, TypeId::Float);
+        }
+        TypeId result = is_comparison(op) ? TypeId::Bool : node.valueType;
+        return emit(op, result, {left, right}, 0, node.line);
+    }
+
+    ValueId visit_unary_op(UnaryOpNode& node) {
+        ValueId operand = visit(*node.operand);
+        if (node.op == "!") return emit(Opcode::Not, TypeId::Bool, {operand}, 0, node.line);
+        return emit(Opcode::Neg, node.valueType, {operand}, 0, node.line);
+    }
+
+    ValueId visit_literal(LiteralNode& node) {
+        TypeId type = type_from_name(node.literalType);
+        int64_t immediate = 0;
+        switch (type) {
+            case TypeId::Int:
+                immediate = turd::wrap(std::stoll(node.value));
+                break;
+            case TypeId::Float:  immediate = float_bits(std::stod(node.value)); break;
+            case TypeId::Bool:   immediate = node.value == "true"; break;
+            case TypeId::Char:   immediate = node.value.empty() ? 0 : static_cast<unsigned char>(node.value[0]); break;
+            case TypeId::String: immediate = module.intern_string(node.value); break;
+            case TypeId::Unknown:
+            case TypeId::Void:
+            case TypeId::IntArray: case TypeId::FloatArray: case TypeId::StringArray:
+            case TypeId::BoolArray: case TypeId::CharArray:
+                throw std::runtime_error("literal without a type at line " + std::to_string(node.line));
+        }
+        return emit(Opcode::Const, type, {}, immediate, node.line);
+    }
+
+    ValueId visit_variable(VariableNode& node) {
+        return load(node.symbol, node);
+    }
+
+    ValueId visit_index(IndexNode& node) {
+        ValueId array = visit(*node.array);
+        ValueId index = visit(*node.index);
+        emit(Opcode::BoundsCheck, TypeId::Void, {array, index}, 0, node.line);
+        return emit(Opcode::LoadElement, element_type(type_of(array)), {array, index}, 0, node.line);
+    }
+
+    ValueId visit_function_call(FunctionCallNode& node) {
+        if (node.symbol.kind == SymbolKind::Builtin) {
+            if (node.name == "len") {
+                return emit(Opcode::ArrayLength, TypeId::Int, {visit(*node.arguments[0])}, 0, node.line);
+            }
+            if (node.name == "read") {
+                for (const auto& argument : node.arguments) {
+                    const auto& variable = static_cast<const VariableNode&>(*argument);
+                    TypeId type = slot_type(variable.symbol);
+                    if (type == TypeId::Unknown) type = TypeId::String;
+                    store(variable.symbol, emit(Opcode::Read, type, {}, 0, node.line));
+                }
+                return no_value;
+            }
+            std::vector<ValueId> arguments;
+            for (const auto& argument : node.arguments) arguments.push_back(visit(*argument));
+            emit(Opcode::Print, TypeId::Void, arguments, 0, node.line);
+            return no_value;
+        }
+        if (node.symbol.kind != SymbolKind::Function) {
+            throw std::runtime_error("call to unresolved function '" + node.name + "'");
+        }
+
+        const IRFunction& callee = module.functions[node.symbol.index];
+        std::vector<ValueId> arguments;
+        for (size_t i = 0; i < node.arguments.size(); ++i) {
+            arguments.push_back(convert(visit(*node.arguments[i]), callee.paramTypes[i]));
+        }
+        return emit(Opcode::Call, callee.returnType, arguments, node.symbol.index, node.line);
+    }
+
+private:
+    // === Blocks ===
+    BlockId new_block() {
+        BlockId block = function.add_block();
+        defs.resize(function.blocks.size() * slots, no_value);
+        sealed.push_back(false);
+        incomplete.emplace_back();
+        return block;
+    }
+
+    void lower_body(const std::vector<ASTNodePTR>& body) {
+        for (const auto& statement : body) {
+            if (current == no_block) return;   // after a return: unreachable
+            visit(*statement);
+        }
+    }
+
+    ValueId emit(Opcode op, TypeId type, const std::vector<ValueId>& args = {}, int64_t immediate = 0, int at = -1) {
+        return function.append(current, op, type, args, immediate, at < 0 ? line : at);
+    }
+
+    // a && b: b only runs when a is true, and the phi picks a itself on the short path
+    ValueId short_circuit(BinaryOpNode& node) {
+        bool is_and = node.op == "&&";
+        ValueId left = visit(*node.left);
+        BlockId from = current;
+        BlockId rhs = new_block();
+        BlockId join = new_block();
+
+        emit(Opcode::Branch, TypeId::Void, {left}, 0, node.line);
+        function.add_edge(from, is_and ? rhs : join);
+        function.add_edge(from, is_and ? join : rhs);
+        seal(rhs);
+
+        current = rhs;
+        ValueId right = visit(*node.right);
+        emit(Opcode::Jump, TypeId::Void);
+        function.add_edge(current, join);
+        seal(join);
+
+        // join.preds is {from, rhs end} whichever way the branch is ordered
+        current = join;
+        return emit(Opcode::Phi, TypeId::Bool, {left, right}, 0, node.line);
+    }
+
+    // === Variables ===
+    TypeId slot_type(SymbolRef symbol) const {
+        if (symbol.kind == SymbolKind::Local) return slotTypes[symbol.index];
+        if (symbol.kind == SymbolKind::Global) return module.globals[symbol.index];
+        return TypeId::Unknown;
+    }
+
+    ValueId load(SymbolRef symbol, const ASTNode& at) {
+        if (symbol.kind == SymbolKind::Local) return read_variable(symbol.index, current);
+        if (symbol.kind == SymbolKind::Global) {
+            return emit(Opcode::LoadGlobal, module.globals[symbol.index], {}, symbol.index, at.line);
+        }
+        throw std::runtime_error("use of an unresolved name at line " + std::to_string(at.line));
+    }
+
+    void store(SymbolRef symbol, ValueId value) {
+        if (symbol.kind == SymbolKind::Local) {
+            write_variable(symbol.index, current, value);
+        } else if (symbol.kind == SymbolKind::Global) {
+            emit(Opcode::StoreGlobal, TypeId::Void, {value}, symbol.index);
+        } else {
+            throw std::runtime_error("assignment to an unresolved name at line " + std::to_string(line));
+        }
+    }
+
+    void write_variable(size_t slot, BlockId block, ValueId value) {
+        defs[block * slots + slot] = value;
+    }
+
+    ValueId read_variable(size_t slot, BlockId block) {
+        ValueId value = defs[block * slots + slot];
+        return value != no_value ? resolve(value) : read_variable_recursive(slot, block);
+    }
+
+    ValueId read_variable_recursive(size_t slot, BlockId block) {
+        const auto& preds = function.blocks[block].preds;
+        ValueId value;
+        if (!sealed[block]) {
+            value = function.append(block, Opcode::Phi, slotTypes[slot], {}, 0, line);
+            incomplete[block].push_back({slot, value});
+        } else if (preds.size() == 1) {
+            value = read_variable(slot, preds[0]);
+        } else if (preds.empty()) {
+            value = undef(slotTypes[slot]);
+        } else {
+            // written first, so a cycle through this block finds the phi and stops
+            value = function.append(block, Opcode::Phi, slotTypes[slot], {}, 0, line);
+            write_variable(slot, block, value);
+            value = add_phi_operands(slot, value);
+        }
+        write_variable(slot, block, value);
+        return value;
+    }
+
+    ValueId add_phi_operands(size_t slot, ValueId phi) {
+        BlockId block = function.values[phi].block;
+        std::vector<ValueId> args;
+        for (BlockId pred : function.blocks[block].preds) args.push_back(read_variable(slot, pred));
+        function.set_operands(phi, args);
+        return try_remove_trivial_phi(phi);
+    }
+
+    ValueId try_remove_trivial_phi(ValueId phi) {
+        ValueId same = no_value;
+        const IRInstruction& instruction = function.values[phi];
+        for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+            ValueId operand = resolve(function.operand(phi, i));
+            if (operand == same || operand == phi) continue;
+            if (same != no_value) return phi;    // merges at least two values
+            same = operand;
+        }
+        if (same == no_value) same = undef(instruction.type);
+
+        // users are patched through the forwarding table instead of a use list
+        forward.resize(function.values.size(), no_value);
+        forward[phi] = same;
+        function.remove(phi);
+        return same;
+    }
+
+    void seal(BlockId block) {
+        auto pending = std::move(incomplete[block]);
+        incomplete[block].clear();
+        for (const auto& [slot, phi] : pending) add_phi_operands(slot, phi);
+        sealed[block] = true;
+    }
+
+    ValueId resolve(ValueId value) const {
+        while (value < forward.size() && forward[value] != no_value) value = forward[value];
+        return value;
+    }
+
+    // Rewrites operands through the forwarding table, then removes the phis
+    // that only became trivial after one of their operands was forwarded
+    void finish() {
+        for (bool changed = true; changed;) {
+            for (const auto& block : function.blocks) {
+                for (ValueId user : block.code) {
+                    ValueId* args = function.operands_of(user);
+                    for (uint32_t i = 0; i < function.values[user].operand_count; ++i) args[i] = resolve(args[i]);
+                }
+            }
+
+            changed = false;
+            for (BlockId block = 0; block < function.blocks.size(); ++block) {
+                std::vector<ValueId> phis;
+                for (ValueId value : function.blocks[block].code) {
+                    if (function.values[value].op == Opcode::Phi) phis.push_back(value);
+                }
+                for (ValueId phi : phis) changed |= try_remove_trivial_phi(phi) != phi;
+            }
+        }
+    }
+
+    // === Values ===
+    TypeId type_of(ValueId value) const { return function.values[value].type; }
+
+    ValueId convert(ValueId value, TypeId target) {
+        if (target == TypeId::Float && type_of(value) == TypeId::Int) {
+            return emit(Opcode::IntToFloat, TypeId::Float, {value});
+        }
+        return value;
+    }
+
+    ValueId zero(TypeId type) {
+        switch (type) {
+            case TypeId::Float:  return emit(Opcode::Const, type, {}, float_bits(0.0));
+            case TypeId::String: return emit(Opcode::Const, type, {}, module.intern_string(""));
+            // an array variable nobody assigned holds the empty array, which is what an undef array reads as
+            case TypeId::Unknown:
+            case TypeId::Void:
+            case TypeId::IntArray: case TypeId::FloatArray: case TypeId::StringArray:
+            case TypeId::BoolArray: case TypeId::CharArray:
+                return undef(type);
+            case TypeId::Int:
+            case TypeId::Bool:
+            case TypeId::Char:   return emit(Opcode::Const, type, {}, 0);
+        }
+        // only reachable with a corrupted type tag
+        throw std::runtime_error("zero value of an unknown type at line " + std::to_string(line));
+    }
+
+    // one undef per type, at the top of the entry block so it dominates every use
+    ValueId undef(TypeId type) {
+        ValueId& cached = undefs[static_cast<size_t>(type)];
+        if (cached == no_value) {
+            cached = function.create(Opcode::Undef, type);
+            function.values[cached].block = 0;
+            auto& code = function.blocks[0].code;
+            code.insert(code.begin(), cached);
+        }
+        return cached;
+    }
+
+    IRModule& module;
+    IRFunction& function;
+    const std::vector<TypeId>& slotTypes;
+    size_t slots;
+
+    BlockId current = no_block;     // no_block after a return or break
+    std::vector<BlockId> loop_exits; // where a break in each enclosing loop goes
+    int line = -1;                  // line of the statement being lowered
+
+    std::vector<ValueId> defs;      // current definition per [block * slots + slot]
+    std::vector<bool> sealed;       // all predecessors known
+    std::vector<std::vector<std::pair<size_t, ValueId>>> incomplete; // phis waiting for a seal
+    std::vector<ValueId> forward;   // removed phi -> the value that replaced it
+    ValueId undefs[type_count] = {no_value, no_value, no_value, no_value, no_value, no_value,
+                                  no_value, no_value, no_value, no_value, no_value, no_value};
+};
+
+} // namespace
+
+IRModule IRLowering::lower(ProgramNode& program) {
+    IRModule module;
+    module.globals = program.globalTypes;
+
+    // headers first, so calls see every callee's signature
+    std::vector<FunctionNode*> sources;
+    for (const auto& child : program.children) {
+        if (child->type != NodeType::Function) continue;
+        auto& node = static_cast<FunctionNode&>(*child);
+        IRFunction function;
+        function.name = node.name;
+        function.returnType = node.returnType.empty() ? TypeId::Void : type_from_name(node.returnType);
+        for (size_t i = 0; i < node.parameters.size(); ++i) function.paramTypes.push_back(node.localTypes[i]);
+        module.functions.push_back(std::move(function));
+        sources.push_back(&node);
+    }
+
+    for (size_t i = 0; i < sources.size(); ++i) {
+        FunctionLowering lowering(module, module.functions[i], sources[i]->localTypes);
+        lowering.lower(sources[i]->body, sources[i]->parameters.size());
+    }
+
+    // top-level statements, in order, as the entry function
+    std::vector<ASTNodePTR> statements;
+    for (const auto& child : program.children) {
+        if (child->type != NodeType::Function) statements.push_back(child);
+    }
+    module.entry = module.functions.size();
+    module.functions.emplace_back();
+    module.functions.back().name = "<top-level>";
+
+    static const std::vector<TypeId> no_slots;
+    FunctionLowering lowering(module, module.functions.back(), no_slots);
+    lowering.lower(statements, 0);
+    return module;
+}
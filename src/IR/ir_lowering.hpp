@@ -0,0 +1,21 @@
+#pragma once
+#include "ir.hpp"
+
+// === AST Lowering ===
+// Translates a resolved, type-checked and error-free tree into an
+// IRModule, building SSA form on the fly with the algorithm of Braun et
+// al. ("Simple and Efficient Construction of Static Single Assignment
+// Form"). Each local slot has one current definition per block, kept in
+// a flat blocks x slots array. A read with no local definition looks
+// through the predecessors, and a phi is placed only where they disagree.
+// Loop headers stay unsealed until their back edge is known, so their
+// phis start incomplete. A phi whose operands all turn out to be the same
+// value is removed again. No dominance frontiers or copy of the program
+// are needed.
+//
+// Globals stay in memory (LoadGlobal/StoreGlobal) because any call may
+// change them. Top-level code becomes the module's entry function.
+class IRLowering {
+public:
+    IRModule lower(ProgramNode& program);   // throws std::runtime_error on trees with errors
+};
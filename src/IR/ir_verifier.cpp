@@ -0,0 +1,246 @@
+#include "ir_verifier.hpp"
+#include "dominance.hpp"
+#include <algorithm>
+
+namespace {
+
+bool same_or_dynamic(TypeId a, TypeId b) {
+    return a == b || a == TypeId::Unknown || b == TypeId::Unknown;
+}
+
+size_t expected_successors(Opcode op) {
+    return op == Opcode::Jump ? 1 : op == Opcode::Branch ? 2 : 0;
+}
+
+} // namespace
+
+bool IRVerifier::verify(const IRModule& module) {
+    errors.clear();
+    for (const auto& function : module.functions) {
+        std::vector<std::string> kept = std::move(errors);
+        verify(module, function);
+        kept.insert(kept.end(), errors.begin(), errors.end());
+        errors = std::move(kept);
+    }
+    return errors.empty();
+}
+
+bool IRVerifier::verify(const IRModule& module, const IRFunction& function) {
+    errors.clear();
+    if (function.blocks.empty()) {
+        report(function, no_block, "function has no blocks");
+        return false;
+    }
+    if (!function.blocks[0].preds.empty()) report(function, 0, "entry block has predecessors");
+
+    // position of each live value in its block, -1 for values not in a block
+    std::vector<int64_t> position(function.values.size(), -1);
+
+    // === Shape ===
+    for (BlockId b = 0; b < function.blocks.size(); ++b) {
+        const IRBlock& block = function.blocks[b];
+        if (block.code.empty()) {
+            report(function, b, "empty block");
+            continue;
+        }
+
+        bool phis_done = false;
+        for (size_t i = 0; i < block.code.size(); ++i) {
+            ValueId value = block.code[i];
+            if (value >= function.values.size()) {
+                report(function, b, "instruction %" + std::to_string(value) + " does not exist");
+                continue;
+            }
+            const IRInstruction& instruction = function.values[value];
+            std::string name = "%" + std::to_string(value);
+
+            if (position[value] != -1) report(function, b, name + " appears twice");
+            position[value] = static_cast<int64_t>(i);
+
+            if (instruction.op == Opcode::Nop) report(function, b, name + " is a removed instruction");
+            if (instruction.block != b) report(function, b, name + " thinks it lives in another block");
+            if (instruction.op == Opcode::Phi) {
+                if (phis_done) report(function, b, name + " is a phi after a non-phi");
+                if (instruction.operand_count != block.preds.size()) {
+                    report(function, b, name + " has " + std::to_string(instruction.operand_count) +
+                                        " operands for " + std::to_string(block.preds.size()) + " predecessors");
+                }
+            } else {
+                phis_done = true;
+            }
+            bool last = i + 1 == block.code.size();
+            if (is_terminator(instruction.op) != last) {
+                report(function, b, last ? "block does not end in a terminator" : name + " is a terminator mid-block");
+            }
+        }
+
+        const IRInstruction& end = function.values[block.code.back()];
+        if (is_terminator(end.op) && block.succs.size() != expected_successors(end.op)) {
+            report(function, b, std::string(opcodeToString(end.op)) + " with " +
+                                std::to_string(block.succs.size()) + " successors");
+        }
+        for (BlockId succ : block.succs) {
+            if (succ >= function.blocks.size()) {
+                report(function, b, "successor bb" + std::to_string(succ) + " does not exist");
+                continue;
+            }
+            const auto& preds = function.blocks[succ].preds;
+            if (std::count(preds.begin(), preds.end(), b) != std::count(block.succs.begin(), block.succs.end(), succ)) {
+                report(function, b, "edge to bb" + std::to_string(succ) + " is missing from its predecessors");
+            }
+        }
+        for (BlockId pred : block.preds) {
+            if (pred >= function.blocks.size()) {
+                report(function, b, "predecessor bb" + std::to_string(pred) + " does not exist");
+                continue;
+            }
+            const auto& succs = function.blocks[pred].succs;
+            if (std::find(succs.begin(), succs.end(), b) == succs.end()) {
+                report(function, b, "predecessor bb" + std::to_string(pred) + " has no edge here");
+            }
+        }
+    }
+    if (!errors.empty()) return false;   // the checks below assume a well-formed CFG
+
+    // === Operands, dominance and types ===
+    DominatorTree dominators(function);
+    for (BlockId b = 0; b < function.blocks.size(); ++b) {
+        const IRBlock& block = function.blocks[b];
+        for (ValueId value : block.code) {
+            const IRInstruction& instruction = function.values[value];
+            const ValueId* args = function.operands_of(value);
+            std::string name = "%" + std::to_string(value);
+
+            for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+                ValueId arg = args[i];
+                if (arg >= function.values.size() || position[arg] == -1) {
+                    report(function, b, name + " uses %" + std::to_string(arg) + ", which is not in any block");
+                    continue;
+                }
+                const IRInstruction& def = function.values[arg];
+                if (def.type == TypeId::Void) {
+                    report(function, b, name + " uses %" + std::to_string(arg) + ", which has no result");
+                }
+                if (!dominators.reachable(b)) continue;
+
+                // a phi operand is used at the end of its predecessor
+                BlockId use_block = instruction.op == Opcode::Phi ? block.preds[i] : b;
+                bool dominated = def.block == use_block
+                    ? (instruction.op == Opcode::Phi || position[arg] < position[value])
+                    : dominators.dominates(def.block, use_block);
+                if (!dominated) {
+                    report(function, b, name + " uses %" + std::to_string(arg) + " before its definition dominates it");
+                }
+            }
+
+            auto type_of = [&](uint32_t i) { return function.values[args[i]].type; };
+            switch (instruction.op) {
+                case Opcode::Add: case Opcode::Sub: case Opcode::Mul: case Opcode::Div:
+                case Opcode::Mod: case Opcode::Pow: case Opcode::Shr:
+                    if (!same_or_dynamic(type_of(0), instruction.type) || !same_or_dynamic(type_of(1), instruction.type)) {
+                        report(function, b, name + " mixes operand types");
+                    }
+                    break;
+                case Opcode::FloorDiv:
+                    if (!same_or_dynamic(type_of(0), type_of(1))) report(function, b, name + " mixes operand types");
+                    break;
+                case Opcode::Eq: case Opcode::Ne: case Opcode::Lt:
+                case Opcode::Le: case Opcode::Gt: case Opcode::Ge:
+                    if (!same_or_dynamic(type_of(0), type_of(1))) report(function, b, name + " compares different types");
+                    if (instruction.type != TypeId::Bool) report(function, b, name + " comparison is not a bool");
+                    break;
+                case Opcode::Neg: case Opcode::Copy:
+                    if (!same_or_dynamic(type_of(0), instruction.type)) report(function, b, name + " changes type");
+                    break;
+                case Opcode::IntToFloat:
+                    if (type_of(0) != TypeId::Int || instruction.type != TypeId::Float) {
+                        report(function, b, name + " converts something other than an int");
+                    }
+                    break;
+                case Opcode::Branch:
+                    if (!same_or_dynamic(type_of(0), TypeId::Bool)) report(function, b, "branch on a non-bool");
+                    break;
+                case Opcode::Return:
+                    if (function.returnType == TypeId::Void && instruction.operand_count != 0) {
+                        report(function, b, "void function returns a value");
+                    } else if (function.returnType != TypeId::Void &&
+                               (instruction.operand_count != 1 || !same_or_dynamic(type_of(0), function.returnType))) {
+                        report(function, b, "return value does not match the return type");
+                    }
+                    break;
+                case Opcode::Param:
+                    if (instruction.immediate < 0 || static_cast<size_t>(instruction.immediate) >= function.paramTypes.size()) {
+                        report(function, b, name + " reads a parameter that does not exist");
+                    }
+                    break;
+                case Opcode::LoadGlobal:
+                case Opcode::StoreGlobal:
+                    if (instruction.immediate < 0 || static_cast<size_t>(instruction.immediate) >= module.globals.size()) {
+                        report(function, b, name + " uses global slot " + std::to_string(instruction.immediate) +
+                                            ", which does not exist");
+                    }
+                    break;
+                case Opcode::Call: {
+                    if (instruction.immediate < 0 || static_cast<size_t>(instruction.immediate) >= module.functions.size()) {
+                        report(function, b, name + " calls a function that does not exist");
+                        break;
+                    }
+                    const IRFunction& callee = module.functions[instruction.immediate];
+                    if (callee.paramTypes.size() != instruction.operand_count) {
+                        report(function, b, name + " passes the wrong number of arguments to '" + callee.name + "'");
+                        break;
+                    }
+                    for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+                        if (!same_or_dynamic(type_of(i), callee.paramTypes[i])) {
+                            report(function, b, name + " argument " + std::to_string(i + 1) + " has the wrong type");
+                        }
+                    }
+                    break;
+                }
+                case Opcode::Const:
+                    if (instruction.type == TypeId::String &&
+                        (instruction.immediate < 0 || static_cast<size_t>(instruction.immediate) >= module.strings.size())) {
+                        report(function, b, name + " refers to a string constant that does not exist");
+                    }
+                    break;
+                case Opcode::NewArray:
+                    if (!is_array(instruction.type) || instruction.operand_count != 1 ||
+                        !same_or_dynamic(type_of(0), TypeId::Int)) {
+                        report(function, b, name + " is not an int-sized array");
+                    }
+                    break;
+                case Opcode::ArrayLength:
+                    if (instruction.operand_count != 1 || !is_array(type_of(0)) || instruction.type != TypeId::Int) {
+                        report(function, b, name + " takes the length of something other than an array");
+                    }
+                    break;
+                case Opcode::BoundsCheck:
+                case Opcode::LoadElement:
+                case Opcode::StoreElement: {
+                    uint32_t count = instruction.op == Opcode::StoreElement ? 3 : 2;
+                    if (instruction.operand_count != count || !is_array(type_of(0)) ||
+                        !same_or_dynamic(type_of(1), TypeId::Int)) {
+                        report(function, b, name + " does not index an array with an int");
+                        break;
+                    }
+                    TypeId element = element_type(type_of(0));
+                    if ((instruction.op == Opcode::LoadElement && instruction.type != element) ||
+                        (instruction.op == Opcode::StoreElement && !same_or_dynamic(type_of(2), element))) {
+                        report(function, b, name + " does not match the array's element type");
+                    }
+                    break;
+                }
+                case Opcode::Nop: case Opcode::Undef: case Opcode::Phi: case Opcode::Not:
+                case Opcode::Print: case Opcode::Read: case Opcode::Jump:
+                    break;
+            }
+        }
+    }
+    return errors.empty();
+}
+
+void IRVerifier::report(const IRFunction& function, BlockId block, const std::string& message) {
+    std::string where = "IR error in '" + function.name + "'";
+    if (block != no_block) where += ", bb" + std::to_string(block);
+    errors.push_back(where + ": " + message);
+}
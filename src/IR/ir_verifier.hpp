@@ -0,0 +1,27 @@
+#pragma once
+#include "ir.hpp"
+
+// === IR Verifier ===
+// Checks the invariants every pass may rely on and must preserve:
+//  - blocks end in exactly one terminator with the matching successor
+//    count, and preds/succs agree with each other
+//  - phis lead their block with one operand per predecessor
+//  - every operand is a live value that produces a result, and its
+//    definition dominates the use (for a phi operand: the end of the
+//    matching predecessor)
+//  - operand types fit the opcode, calls match the callee's signature,
+//    and global slots exist
+// Unreachable blocks are allowed (passes remove them), but they are still
+// checked for shape.
+class IRVerifier {
+public:
+    bool verify(const IRModule& module);
+    bool verify(const IRModule& module, const IRFunction& function);
+
+    const std::vector<std::string>& get_errors() const { return errors; }
+
+private:
+    void report(const IRFunction& function, BlockId block, const std::string& message);
+
+    std::vector<std::string> errors;
+};
@@ -0,0 +1,63 @@
+#include "loops.hpp"
+#include <algorithm>
+
+LoopInfo::LoopInfo(const IRFunction& function, const DominatorTree& dominators) {
+    size_t count = function.blocks.size();
+    inner.assign(count, no_loop);
+
+    // one loop per header, collecting every latch that jumps back to it
+    std::vector<size_t> loop_of_header(count, no_loop);
+    for (BlockId block : dominators.reverse_postorder()) {
+        for (BlockId succ : function.blocks[block].succs) {
+            if (!dominators.dominates(succ, block)) continue;
+            if (loop_of_header[succ] == no_loop) {
+                loop_of_header[succ] = all.size();
+                all.push_back({succ, {succ}, {}, no_loop, 0});
+            }
+            all[loop_of_header[succ]].latches.push_back(block);
+        }
+    }
+
+    // body: everything that reaches a latch backwards without passing the header
+    std::vector<size_t> mark(count, no_loop);
+    for (size_t i = 0; i < all.size(); ++i) {
+        Loop& loop = all[i];
+        mark[loop.header] = i;
+        std::vector<BlockId> stack(loop.latches.begin(), loop.latches.end());
+        while (!stack.empty()) {
+            BlockId block = stack.back();
+            stack.pop_back();
+            if (mark[block] == i || !dominators.reachable(block)) continue;
+            mark[block] = i;
+            loop.blocks.push_back(block);
+            for (BlockId pred : function.blocks[block].preds) stack.push_back(pred);
+        }
+    }
+
+    // innermost first; a loop's parent is the smallest other loop holding its header
+    std::stable_sort(all.begin(), all.end(), [](const Loop& a, const Loop& b) {
+        return a.blocks.size() < b.blocks.size();
+    });
+    for (size_t i = 0; i < all.size(); ++i) {
+        for (BlockId block : all[i].blocks) {
+            if (inner[block] == no_loop) inner[block] = i;
+        }
+    }
+    for (size_t i = 0; i < all.size(); ++i) {
+        for (size_t j = i + 1; j < all.size(); ++j) {
+            if (contains(j, all[i].header)) {
+                all[i].parent = j;
+                break;
+            }
+        }
+    }
+    // parents come later in the order, so walk outermost to innermost
+    for (size_t i = all.size(); i-- > 0;) {
+        all[i].depth = all[i].parent == no_loop ? 1 : all[all[i].parent].depth + 1;
+    }
+}
+
+bool LoopInfo::contains(size_t loop, BlockId block) const {
+    const auto& blocks = all[loop].blocks;
+    return std::find(blocks.begin(), blocks.end(), block) != blocks.end();
+}
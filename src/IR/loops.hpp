@@ -0,0 +1,31 @@
+#pragma once
+#include "dominance.hpp"
+
+struct Loop {
+    BlockId header;
+    std::vector<BlockId> blocks;    // header first, then the rest in no particular order
+    std::vector<BlockId> latches;   // sources of the back edges
+    size_t parent;                  // enclosing loop, or no_loop
+    uint32_t depth;                 // 1 for an outermost loop
+};
+
+// === Loop Info ===
+// Natural loops from the back edges of the dominator tree: an edge b -> h
+// where h dominates b. Back edges sharing a header form one loop. Loops
+// are ordered innermost first, so a pass that hoists code out of a loop
+// sees the inner loop before the one around it.
+class LoopInfo {
+public:
+    static constexpr size_t no_loop = SIZE_MAX;
+
+    LoopInfo(const IRFunction& function, const DominatorTree& dominators);
+
+    const std::vector<Loop>& loops() const { return all; }
+    size_t innermost(BlockId block) const { return inner[block]; }  // no_loop outside every loop
+    uint32_t depth(BlockId block) const { return inner[block] == no_loop ? 0 : all[inner[block]].depth; }
+    bool contains(size_t loop, BlockId block) const;
+
+private:
+    std::vector<Loop> all;
+    std::vector<size_t> inner;
+};
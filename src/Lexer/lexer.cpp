@@ -9,10 +9,11 @@ const std::unordered_map<std::string, TokenType> Lexer::keywords_ = {
     {"else", TokenType::KEY_ELSE}, {"read", TokenType::KEY_READ},
     {"while", TokenType::KEY_WHILE}, {"for", TokenType::KEY_FOR},
     {"function", TokenType::KEY_FUNCTION}, {"var", TokenType::KEY_VAR},
-    {"return", TokenType::KEY_RETURN}, {"true", TokenType::KEY_TRUE},
-    {"false", TokenType::KEY_FALSE},
+    {"return", TokenType::KEY_RETURN}, {"break", TokenType::KEY_BREAK},
+    {"true", TokenType::KEY_TRUE}, {"false", TokenType::KEY_FALSE},
     {"int", TokenType::DATATYPE_INT}, {"float", TokenType::DATATYPE_FLOAT},
-    {"string", TokenType::DATATYPE_STRING}
+    {"string", TokenType::DATATYPE_STRING}, {"bool", TokenType::DATATYPE_BOOL},
+    {"char", TokenType::DATATYPE_CHAR}
 };
 
 // === Operator tokens ===
@@ -20,7 +21,8 @@ const std::unordered_map<std::string, TokenType> Lexer::operators_ = {
     {"**", TokenType::POW_OP}, {"&&", TokenType::AND_OP},
     {"||", TokenType::OR_OP}, {"==", TokenType::EQUAL_OP},
     {"!=", TokenType::NOT_EQUAL_OP}, {">=", TokenType::GEQUAL_OP},
-    {"<=", TokenType::LEQUAL_OP}, {"//", TokenType::INT_DIV_OP}
+    {"<=", TokenType::LEQUAL_OP}, {"//", TokenType::INT_DIV_OP},
+    {"++", TokenType::INC_OP}, {"--", TokenType::DEC_OP}
 };
 
 // === Single char tokens
@@ -74,22 +76,21 @@ std::vector<Token> Lexer::tokenize() {
             else if (std::isdigit(current) || current == '.') {
                 tokens_.push_back(read_number());
             }
-            else if (auto it = single_char_tokens_.find(current); it != single_char_tokens_.end()) {
+            else {
                 advance(); // consume the first character
-                const char next = peek();
+                const char next = is_at_end() ? '\0' : peek();
                 std::string two_char = std::string(1, current) + next;
 
+                // two-char operators first: '&&' and '||' have no single char form
                 if (auto op_it = operators_.find(two_char); op_it != operators_.end()) {
                     advance(); // consume the second character
                     tokens_.push_back(make_token(op_it->second, two_char));
-                } else {
+                } else if (auto it = single_char_tokens_.find(current); it != single_char_tokens_.end()) {
                     tokens_.push_back(make_token(it->second, std::string(1, current)));
+                } else {
+                    tokens_.push_back(make_token(TokenType::UNKNOWN, std::string(1, current)));
                 }
             }
-            else {
-                advance(); // consume the unknown character
-                tokens_.push_back(make_token(TokenType::UNKNOWN, std::string(1, current)));
-            }
         }
         catch (const std::runtime_error& e) {
             // Re-throw the error to maintain the original error handling
@@ -118,7 +119,8 @@ Token Lexer::read_string_literal(char quote_char) {
                 lexer_error("Character literal cannot be empty", line_, start_column);
             }
             
-            TokenType token_type = (quote_char == '\'') ? TokenType::DATATYPE_CHAR : TokenType::STR_LIT;
+            // Single quotes around exactly one character form a char literal, anything longer is a string
+            TokenType token_type = (quote_char == '\'' && lexeme.size() == 1) ? TokenType::CHAR_LIT : TokenType::STR_LIT;
             return Token(lexeme, token_type, line_, start_column);
         }
 
@@ -241,9 +243,116 @@ TokenType Lexer::classify_identifier(const std::string& lexeme) {
 }
 
 void Lexer::print_tokens() const {
-    for (const auto& token : tokens_) {
-        std::cout << "Line " << token.line << ", Col " << token.column
-                << ": Lexeme: '" << token.lexeme << "'\t TokenType: "
-                << static_cast<int>(token.type) << std::endl;
+    dump_tokens(tokens_, DumpFormat::Text, std::cout);
+}
+
+// Helper function to convert TokenType to string
+std::string tokenTypeToString(TokenType type) {
+    switch (type) {
+        case TokenType::IDENTIFIER: return "IDENTIFIER";
+        case TokenType::INT_LIT: return "INT_LIT";
+        case TokenType::FLOAT_LIT: return "FLOAT_LIT";
+        case TokenType::STR_LIT: return "STR_LIT";
+        case TokenType::CHAR_LIT: return "CHAR_LIT";
+        case TokenType::KEY_IF: return "KEY_IF";
+        case TokenType::KEY_ELSE: return "KEY_ELSE";
+        case TokenType::KEY_WHILE: return "KEY_WHILE";
+        case TokenType::KEY_FOR: return "KEY_FOR";
+        case TokenType::KEY_PRINT: return "KEY_PRINT";
+        case TokenType::KEY_READ: return "KEY_READ";
+        case TokenType::KEY_FUNCTION: return "KEY_FUNCTION";
+        case TokenType::KEY_VAR: return "KEY_VAR";
+        case TokenType::KEY_RETURN: return "KEY_RETURN";
+        case TokenType::KEY_BREAK: return "KEY_BREAK";
+        case TokenType::KEY_TRUE: return "KEY_TRUE";
+        case TokenType::KEY_FALSE: return "KEY_FALSE";
+        case TokenType::DATATYPE_INT: return "DATATYPE_INT";
+        case TokenType::DATATYPE_FLOAT: return "DATATYPE_FLOAT";
+        case TokenType::DATATYPE_STRING: return "DATATYPE_STRING";
+        case TokenType::DATATYPE_BOOL: return "DATATYPE_BOOL";
+        case TokenType::DATATYPE_CHAR: return "DATATYPE_CHAR";
+        case TokenType::LEFT_PAREN: return "LEFT_PAREN";
+        case TokenType::RIGHT_PAREN: return "RIGHT_PAREN";
+        case TokenType::LEFT_BRACE: return "LEFT_BRACE";
+        case TokenType::RIGHT_BRACE: return "RIGHT_BRACE";
+        case TokenType::LEFT_BRACKET: return "LEFT_BRACKET";
+        case TokenType::RIGHT_BRACKET: return "RIGHT_BRACKET";
+        case TokenType::SEMICOLON: return "SEMICOLON";
+        case TokenType::COLON: return "COLON";
+        case TokenType::COMMA: return "COMMA";
+        case TokenType::ASSIGN_OP: return "ASSIGN_OP";
+        case TokenType::EQUAL_OP: return "EQUAL_OP";
+        case TokenType::NOT_EQUAL_OP: return "NOT_EQUAL_OP";
+        case TokenType::LESSER_OP: return "LESSER_OP";
+        case TokenType::LEQUAL_OP: return "LEQUAL_OP";
+        case TokenType::GREATER_OP: return "GREATER_OP";
+        case TokenType::GEQUAL_OP: return "GEQUAL_OP";
+        case TokenType::ADD_OP: return "ADD_OP";
+        case TokenType::SUB_OP: return "SUB_OP";
+        case TokenType::MUL_OP: return "MUL_OP";
+        case TokenType::DIV_OP: return "DIV_OP";
+        case TokenType::MOD_OP: return "MOD_OP";
+        case TokenType::POW_OP: return "POW_OP";
+        case TokenType::AND_OP: return "AND_OP";
+        case TokenType::OR_OP: return "OR_OP";
+        case TokenType::NOT_OP: return "NOT_OP";
+        case TokenType::INT_DIV_OP: return "INT_DIV_OP";
+        case TokenType::INC_OP: return "INC_OP";
+        case TokenType::DEC_OP: return "DEC_OP";
+        case TokenType::END_OF_FILE: return "END_OF_FILE";
+        case TokenType::UNKNOWN: return "UNKNOWN";
+        default: return "UNKNOWN";
+    }
+}
+
+/**
+ * Write a token stream through one preallocated buffer
+ * @param tokens tokens to dump
+ * @param format Text keeps print_tokens' historical layout, Json is an array
+ *               of objects, Compact is "line:col TYPE lexeme" per line
+ * @param out destination stream
+ */
+void dump_tokens(const std::vector<Token>& tokens, DumpFormat format, std::ostream& out) {
+    OutputBuffer buffer(out);
+
+    if (format == DumpFormat::Json) buffer.put('[');
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const Token& token = tokens[i];
+        switch (format) {
+            case DumpFormat::Text:
+                buffer.write("Line ");
+                buffer.write_int(token.line);
+                buffer.write(", Col ");
+                buffer.write_int(token.column);
+                buffer.write(": Lexeme: '");
+                buffer.write(token.lexeme);
+                buffer.write("'\t TokenType: ");
+                buffer.write_int(static_cast<int>(token.type));
+                buffer.put('\n');
+                break;
+            case DumpFormat::Json:
+                if (i > 0) buffer.put(',');
+                buffer.write("{\"type\":\"");
+                buffer.write(tokenTypeToString(token.type));
+                buffer.write("\",\"lexeme\":");
+                buffer.write_json_string(token.lexeme);
+                buffer.write(",\"line\":");
+                buffer.write_int(token.line);
+                buffer.write(",\"column\":");
+                buffer.write_int(token.column);
+                buffer.put('}');
+                break;
+            case DumpFormat::Compact:
+                buffer.write_int(token.line);
+                buffer.put(':');
+                buffer.write_int(token.column);
+                buffer.put(' ');
+                buffer.write(tokenTypeToString(token.type));
+                buffer.put(' ');
+                buffer.write_json_string(token.lexeme);
+                buffer.put('\n');
+                break;
+        }
     }
+    if (format == DumpFormat::Json) buffer.write("]\n");
 }
\ No newline at end of file
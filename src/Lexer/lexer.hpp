@@ -3,11 +3,12 @@
 #include <vector>
 #include <fstream>
 #include <unordered_map>
+#include "../Support/output_buffer.hpp"
 
 enum TokenType {
     // Keywords
     KEY_PRINT, KEY_IF, KEY_ELSE, KEY_READ, KEY_WHILE, KEY_FOR,
-    KEY_FUNCTION, KEY_VAR, KEY_RETURN, KEY_TRUE, KEY_FALSE,
+    KEY_FUNCTION, KEY_VAR, KEY_RETURN, KEY_BREAK, KEY_TRUE, KEY_FALSE,
 
     // Delimiters
     LEFT_PAREN, RIGHT_PAREN, LEFT_BRACE, RIGHT_BRACE,
@@ -15,7 +16,7 @@ enum TokenType {
 
     // Operators
     ADD_OP, SUB_OP, MUL_OP, DIV_OP, MOD_OP, POW_OP,
-    AND_OP, OR_OP, NOT_OP, INT_DIV_OP,
+    AND_OP, OR_OP, NOT_OP, INT_DIV_OP, INC_OP, DEC_OP,
     ASSIGN_OP, EQUAL_OP, NOT_EQUAL_OP,
     GREATER_OP, GEQUAL_OP, LESSER_OP, LEQUAL_OP,
 
@@ -26,7 +27,7 @@ enum TokenType {
     DATATYPE_INT, DATATYPE_FLOAT, DATATYPE_STRING, DATATYPE_BOOL, DATATYPE_CHAR,
 
     // Literals / identifiers
-    IDENTIFIER, INT_LIT, FLOAT_LIT, STR_LIT,
+    IDENTIFIER, INT_LIT, FLOAT_LIT, STR_LIT, CHAR_LIT,
 
     // Special
     END_OF_FILE, UNKNOWN
@@ -46,6 +47,8 @@ struct Token {
         : lexeme(std::move(lex)), type(t), line(l), column(c) {}
 };
 
+std::string tokenTypeToString(TokenType type);
+void dump_tokens(const std::vector<Token>& tokens, DumpFormat format, std::ostream& out);
 
 class Lexer {
 public:
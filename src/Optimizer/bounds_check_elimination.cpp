@@ -0,0 +1,602 @@
+#include "ir_passes.hpp"
+#include "../IR/dominance.hpp"
+#include "../Support/arithmetic.hpp"
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
+namespace {
+
+constexpr int64_t int_min = INT32_MIN;
+constexpr int64_t int_max = INT32_MAX;
+
+// The int values a value can take: an interval, and optionally a bound
+// relative to an array's length, value <= length(array) + offset, which is
+// what `i < len(a)` proves when the length isn't a constant.
+struct Range {
+    int64_t lo = int_min;
+    int64_t hi = int_max;
+    ValueId array = no_value;
+    int64_t offset = 0;
+
+    static Range exact(int64_t value) {
+        Range range;
+        range.lo = range.hi = value;
+        return range;
+    }
+    static Range between(int64_t lo, int64_t hi) {
+        Range range;
+        if (lo < int_min || hi > int_max) return range;     // could wrap
+        range.lo = lo;
+        range.hi = hi;
+        return range;
+    }
+    bool is_exact() const { return lo == hi; }
+    bool operator==(const Range& other) const {
+        return lo == other.lo && hi == other.hi && array == other.array && offset == other.offset;
+    }
+    bool operator!=(const Range& other) const { return !(*this == other); }
+
+    void bound_by(ValueId by, int64_t by_offset) {
+        if (by == no_value) return;
+        offset = by == array ? std::min(offset, by_offset) : by_offset;
+        array = by;
+    }
+};
+
+Range join(const Range& a, const Range& b) {
+    Range range = Range::between(std::min(a.lo, b.lo), std::max(a.hi, b.hi));
+    if (a.array != no_value && a.array == b.array) {
+        range.array = a.array;
+        range.offset = std::max(a.offset, b.offset);
+    }
+    return range;
+}
+
+// a range that keeps growing is pushed out to the int limits, so loops converge
+Range widen(const Range& old, const Range& next) {
+    Range range = next;
+    if (next.lo < old.lo) range.lo = int_min;
+    if (next.hi > old.hi) range.hi = int_max;
+    if (next.array != old.array || next.offset > old.offset) range.array = no_value;
+    return range;
+}
+
+Opcode negated(Opcode op) {
+    switch (op) {
+        case Opcode::Lt: return Opcode::Ge;
+        case Opcode::Le: return Opcode::Gt;
+        case Opcode::Gt: return Opcode::Le;
+        case Opcode::Ge: return Opcode::Lt;
+        case Opcode::Eq: return Opcode::Ne;
+        default: return Opcode::Eq;
+    }
+}
+
+// `a op b` as `b op' a`
+Opcode swapped(Opcode op) {
+    switch (op) {
+        case Opcode::Lt: return Opcode::Gt;
+        case Opcode::Le: return Opcode::Ge;
+        case Opcode::Gt: return Opcode::Lt;
+        case Opcode::Ge: return Opcode::Le;
+        default: return op;
+    }
+}
+
+// What the whole module knows about its globals. An int global starts at 0
+// and holds whatever any function stores to it, so its range is solved
+// over all functions together.
+struct Globals {
+    std::vector<Range> ranges;                  // per slot, int slots only
+    std::vector<std::vector<bool>> stores;      // [function][slot]: it or a callee may store the slot
+    std::vector<ValueId> only_store;            // the slot's one StoreGlobal, when that is in the entry
+
+    explicit Globals(const IRModule& module)
+        : ranges(module.globals.size(), Range::exact(0)),
+          stores(module.functions.size(), std::vector<bool>(module.globals.size(), false)),
+          only_store(module.globals.size(), no_value) {
+        std::vector<size_t> count(module.globals.size(), 0);
+        for (size_t index = 0; index < module.functions.size(); ++index) {
+            const IRFunction& function = module.functions[index];
+            for (const IRBlock& block : function.blocks) {
+                for (ValueId value : block.code) {
+                    const IRInstruction& instruction = function.values[value];
+                    if (instruction.op != Opcode::StoreGlobal) continue;
+                    stores[index][instruction.immediate] = true;
+                    if (++count[instruction.immediate] == 1 && index == module.entry) {
+                        only_store[instruction.immediate] = value;
+                    }
+                }
+            }
+        }
+        for (size_t slot = 0; slot < count.size(); ++slot) {
+            if (count[slot] != 1) only_store[slot] = no_value;
+        }
+
+        // calls store whatever their callees store
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (size_t index = 0; index < module.functions.size(); ++index) {
+                const IRFunction& function = module.functions[index];
+                for (const IRBlock& block : function.blocks) {
+                    for (ValueId value : block.code) {
+                        if (function.values[value].op != Opcode::Call) continue;
+                        const auto& callee = stores[function.values[value].immediate];
+                        for (size_t slot = 0; slot < callee.size(); ++slot) {
+                            if (callee[slot] && !stores[index][slot]) changed = stores[index][slot] = true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+};
+
+// Something known to hold from a point on, for every use it dominates:
+// the comparison on the edge into a block with a single predecessor, or a
+// bounds check that passed.
+struct Fact {
+    ValueId subject;
+    Opcode relation;        // subject relation bound; Nop for a passed check on array `bound`
+    ValueId bound;
+    BlockId holds;          // the block it holds in,
+    int64_t after;          // after this position there, -1 for all of it
+    BlockId guard;          // the block whose branch it comes from, or no_block
+};
+
+// Value ranges for one function's int values, as an abstract
+// interpretation in reverse postorder, widened until the loops settle and
+// then narrowed again. A use sees its operand's range cut down by the
+// facts that dominate it.
+class RangeAnalysis {
+public:
+    RangeAnalysis(const IRModule& module, const IRFunction& function, size_t index, const Globals& globals)
+        : module(module), function(function), index(index), globals(globals), dominators(function),
+          position(function.values.size(), 0), sized(function.values.size(), no_value),
+          first_load(module.globals.size(), no_value), on_global(module.globals.size()) {
+        for (BlockId block : dominators.reverse_postorder()) {
+            const auto& code = function.blocks[block].code;
+            for (size_t i = 0; i < code.size(); ++i) {
+                const IRInstruction& instruction = function.values[code[i]];
+                position[code[i]] = i;
+                if (instruction.op == Opcode::NewArray && sized[function.operand(code[i], 0)] == no_value) {
+                    sized[function.operand(code[i], 0)] = code[i];
+                }
+                if (instruction.op == Opcode::LoadGlobal && first_load[instruction.immediate] == no_value) {
+                    first_load[instruction.immediate] = code[i];
+                }
+                if (instruction.op == Opcode::BoundsCheck) {
+                    add({function.operand(code[i], 1), Opcode::Nop, function.operand(code[i], 0), block,
+                         static_cast<int64_t>(i), no_block});
+                }
+            }
+            add_edge_facts(block);
+        }
+    }
+
+    void solve() {
+        ranges.assign(function.values.size(), Range());
+        known.assign(function.values.size(), false);
+        std::vector<uint32_t> changes(function.values.size(), 0);
+        for (bool changed = true; changed;) {
+            changed = false;
+            for_each_int([&](ValueId value) {
+                Range next;
+                if (!evaluate(value, next)) return;
+                if (known[value]) {
+                    next = join(ranges[value], next);
+                    if (next == ranges[value]) return;
+                    if (++changes[value] > 2) next = widen(ranges[value], next);
+                }
+                ranges[value] = next;
+                known[value] = true;
+                changed = true;
+            });
+        }
+        for (int pass = 0; pass < 2; ++pass) {
+            for_each_int([&](ValueId value) {
+                Range next;
+                if (evaluate(value, next)) ranges[value] = next;
+            });
+        }
+    }
+
+    // the range of a value as seen at position `at` in `block`
+    Range refined(ValueId value, BlockId block, size_t at) const {
+        Range range = known[value] ? ranges[value] : Range();
+        auto own = on_value.find(value);
+        if (own != on_value.end()) {
+            for (const Fact& fact : own->second) {
+                if (dominates(fact, block, at)) apply(range, fact);
+            }
+        }
+
+        // another load of the same global, compared before this one
+        const IRInstruction& load = function.values[value];
+        if (load.op == Opcode::LoadGlobal) {
+            for (const Fact& fact : on_global[load.immediate]) {
+                if (fact.subject != value && dominates(fact, load.block, position[value]) &&
+                    unchanged(fact.subject, fact.holds, value)) {
+                    apply(range, fact);
+                }
+            }
+        }
+        return range;
+    }
+
+    bool reachable(BlockId block) const { return dominators.reachable(block); }
+
+    Range at(ValueId value, ValueId user) const {
+        return refined(value, function.values[user].block, position[user]);
+    }
+
+    // the array value itself, looking through copies and loads of globals
+    ValueId array_of(ValueId value) const {
+        for (;;) {
+            const IRInstruction& instruction = function.values[value];
+            if (instruction.op == Opcode::Copy) {
+                value = function.operand(value, 0);
+                continue;
+            }
+            if (instruction.op != Opcode::LoadGlobal) return value;
+            ValueId store = stored_before(value);
+            if (store != no_value) {
+                value = function.operand(store, 0);
+                continue;
+            }
+            // nothing the function runs stores it, so every load gives the same array
+            return globals.stores[index][instruction.immediate] ? value : first_load[instruction.immediate];
+        }
+    }
+
+    // the lengths an array can have
+    Range length(ValueId array) const {
+        if (function.values[array].op != Opcode::NewArray) return Range::between(0, int_max);
+        Range size = at(function.operand(array, 0), array);
+        return Range::between(std::max<int64_t>(size.lo, 0), size.hi);
+    }
+
+    bool in_bounds(ValueId check) const {
+        Range index = at(function.operand(check, 1), check);
+        ValueId array = array_of(function.operand(check, 0));
+        if (index.lo < 0) return false;
+        return index.hi < length(array).lo || (index.array == array && index.offset < 0);
+    }
+
+private:
+    const IRModule& module;
+    const IRFunction& function;
+    size_t index;
+    const Globals& globals;
+    DominatorTree dominators;
+    std::vector<size_t> position;               // index in its block
+    std::vector<ValueId> sized;                 // the NewArray an int value is the length of
+    std::vector<ValueId> first_load;            // per global slot
+    std::unordered_map<ValueId, std::vector<Fact>> on_value;   // by subject
+    std::vector<std::vector<Fact>> on_global;   // branch facts on a load of the global in the branching block
+    std::vector<Range> ranges;
+    std::vector<bool> known;                    // false until a value has a range
+    mutable std::unordered_map<uint64_t, bool> unchanged_cache;
+
+    template <typename F>
+    void for_each_int(F visit) {
+        for (BlockId block : dominators.reverse_postorder()) {
+            for (ValueId value : function.blocks[block].code) {
+                if (function.values[value].type == TypeId::Int) visit(value);
+            }
+        }
+    }
+
+    // a branch on an int comparison tells each side which way it went
+    void add_edge_facts(BlockId block) {
+        ValueId end = function.terminator(block);
+        if (end == no_value || function.values[end].op != Opcode::Branch) return;
+        ValueId condition = function.operand(end, 0);
+        Opcode op = function.values[condition].op;
+        if (op < Opcode::Eq || op > Opcode::Ge) return;
+        ValueId left = function.operand(condition, 0), right = function.operand(condition, 1);
+        if (function.values[left].type != TypeId::Int || function.values[right].type != TypeId::Int) return;
+
+        const auto& succs = function.blocks[block].succs;
+        if (succs[0] == succs[1]) return;
+        for (size_t edge = 0; edge < 2; ++edge) {
+            if (function.blocks[succs[edge]].preds.size() != 1) continue;
+            Opcode relation = edge == 0 ? op : negated(op);
+            if (relation == Opcode::Ne) continue;
+            add({left, relation, right, succs[edge], -1, block});
+            add({right, swapped(relation), left, succs[edge], -1, block});
+        }
+    }
+
+    void add(const Fact& fact) {
+        on_value[fact.subject].push_back(fact);
+        const IRInstruction& subject = function.values[fact.subject];
+        if (fact.guard != no_block && subject.op == Opcode::LoadGlobal && subject.block == fact.guard) {
+            on_global[subject.immediate].push_back(fact);
+        }
+    }
+
+    bool dominates(const Fact& fact, BlockId block, size_t at) const {
+        if (fact.holds == block) return fact.after < static_cast<int64_t>(at);
+        return dominators.dominates(fact.holds, block);
+    }
+
+    void apply(Range& range, const Fact& fact) const {
+        if (fact.relation == Opcode::Nop) {
+            ValueId array = array_of(fact.bound);
+            range.lo = std::max<int64_t>(range.lo, 0);
+            range.hi = std::min(range.hi, length(array).hi - 1);
+            range.bound_by(array, -1);
+            return;
+        }
+        Range bound = known[fact.bound] ? ranges[fact.bound] : Range();
+        switch (fact.relation) {
+            case Opcode::Lt:
+                range.hi = std::min(range.hi, bound.hi - 1);
+                range.bound_by(bound.array, bound.offset - 1);
+                break;
+            case Opcode::Le:
+                range.hi = std::min(range.hi, bound.hi);
+                range.bound_by(bound.array, bound.offset);
+                break;
+            case Opcode::Gt:
+                range.lo = std::max(range.lo, bound.lo + 1);
+                break;
+            case Opcode::Ge:
+                range.lo = std::max(range.lo, bound.lo);
+                break;
+            default:    // Eq
+                range.lo = std::max(range.lo, bound.lo);
+                range.hi = std::min(range.hi, bound.hi);
+                range.bound_by(bound.array, bound.offset);
+                break;
+        }
+    }
+
+    // the global's only store when this load of it comes after that store:
+    // the load gives back the value stored
+    ValueId stored_before(ValueId load) const {
+        if (index != module.entry) return no_value;
+        ValueId store = globals.only_store[function.values[load].immediate];
+        return store != no_value && before(store, load) ? store : no_value;
+    }
+
+    bool before(ValueId first, ValueId second) const {
+        BlockId a = function.values[first].block, b = function.values[second].block;
+        if (!dominators.reachable(a) || !dominators.reachable(b)) return false;
+        return a == b ? position[first] < position[second] : dominators.dominates(a, b);
+    }
+
+    bool clobbers(ValueId value, int64_t slot) const {
+        const IRInstruction& instruction = function.values[value];
+        if (instruction.op == Opcode::StoreGlobal) return instruction.immediate == slot;
+        return instruction.op == Opcode::Call && globals.stores[instruction.immediate][slot];
+    }
+
+    bool clean(BlockId block, size_t from, size_t to, int64_t slot) const {
+        const auto& code = function.blocks[block].code;
+        for (size_t i = from; i < std::min(to, code.size()); ++i) {
+            if (clobbers(code[i], slot)) return false;
+        }
+        return true;
+    }
+
+    // blocks reachable from `from`'s successors (or predecessors) without
+    // passing `wall`; a way from `wall` to a block it dominates only runs
+    // through blocks it dominates, so the search stays among those
+    std::vector<BlockId> reach(BlockId from, BlockId wall, bool forward, std::vector<bool>& seen) const {
+        seen.assign(function.blocks.size(), false);
+        std::vector<BlockId> found, work{from};
+        while (!work.empty()) {
+            BlockId block = work.back();
+            work.pop_back();
+            for (BlockId next : forward ? function.blocks[block].succs : function.blocks[block].preds) {
+                if (next == wall || seen[next] || !dominators.dominates(wall, next)) continue;
+                seen[next] = true;
+                found.push_back(next);
+                work.push_back(next);
+            }
+        }
+        return found;
+    }
+
+    // whether `later` loads what `first` loaded, in the block that ends in
+    // the branch, when the fact from that branch holds in `holds`: no store
+    // to the global, and no call to a function that may store it, on any
+    // way from `first` through `holds` to `later`
+    bool unchanged(ValueId first, BlockId holds, ValueId later) const {
+        uint64_t key = static_cast<uint64_t>(first) << 32 | later;
+        auto cached = unchanged_cache.find(key);
+        if (cached != unchanged_cache.end()) return cached->second;
+
+        int64_t slot = function.values[first].immediate;
+        BlockId guard = function.values[first].block, block = function.values[later].block;
+        bool result = clean(guard, position[first] + 1, SIZE_MAX, slot);
+        if (result && block == holds) {
+            result = clean(holds, 0, position[later], slot);
+        } else if (result) {
+            std::vector<bool> from_holds, to_block;
+            reach(holds, holds, true, from_holds);
+            result = clean(holds, 0, SIZE_MAX, slot);
+            for (BlockId between : reach(block, holds, false, to_block)) {
+                if (result && between != block && from_holds[between]) result = clean(between, 0, SIZE_MAX, slot);
+            }
+            // around a loop back to `later` without passing `holds` again
+            result = result && clean(block, 0, to_block[block] ? SIZE_MAX : position[later], slot);
+        }
+        unchanged_cache[key] = result;
+        return result;
+    }
+
+    // false for a phi none of whose incoming values has a range yet
+    bool evaluate(ValueId value, Range& out) const {
+        if (!compute(value, out)) return false;
+        // the length of an array made from it, from where that array exists
+        if (sized[value] != no_value && out.array == no_value) out.bound_by(sized[value], 0);
+        return true;
+    }
+
+    bool compute(ValueId value, Range& out) const {
+        const IRInstruction& instruction = function.values[value];
+        auto operand = [&](uint32_t i) { return at(function.operand(value, i), value); };
+        auto int_operands = [&] {
+            return function.values[function.operand(value, 0)].type == TypeId::Int &&
+                   function.values[function.operand(value, 1)].type == TypeId::Int;
+        };
+        switch (instruction.op) {
+            case Opcode::Const:
+                out = Range::exact(instruction.immediate);
+                return true;
+            case Opcode::Copy:
+                out = operand(0);
+                return true;
+            case Opcode::Phi: {
+                bool any = false;
+                const auto& preds = function.blocks[instruction.block].preds;
+                for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+                    ValueId incoming = function.operand(value, i);
+                    // an incoming value not reached yet comes round a back edge
+                    if (!dominators.reachable(preds[i]) || !known[incoming]) continue;
+                    Range range = refined(incoming, preds[i], function.blocks[preds[i]].code.size());
+                    out = any ? join(out, range) : range;
+                    any = true;
+                }
+                return any;
+            }
+            case Opcode::Add: case Opcode::Sub: {
+                if (!int_operands()) break;
+                Range a = operand(0), b = operand(1);
+                bool add = instruction.op == Opcode::Add;
+                out = add ? Range::between(a.lo + b.lo, a.hi + b.hi) : Range::between(a.lo - b.hi, a.hi - b.lo);
+                if (out.lo == int_min && out.hi == int_max) return true;
+                // no wrap, so the bound moves by as much as the other operand can
+                if (a.array != no_value) out.bound_by(a.array, add ? a.offset + b.hi : a.offset - b.lo);
+                else if (add) out.bound_by(b.array, b.offset + a.hi);
+                return true;
+            }
+            case Opcode::Mul: {
+                if (!int_operands()) break;
+                Range a = operand(0), b = operand(1);
+                int64_t corners[] = {a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi};
+                out = Range::between(*std::min_element(corners, corners + 4), *std::max_element(corners, corners + 4));
+                return true;
+            }
+            case Opcode::Div: case Opcode::FloorDiv: case Opcode::Mod: case Opcode::Shr: {
+                if (!int_operands()) break;
+                Range a = operand(0), b = operand(1);
+                if (b.lo <= 0 || a.lo > a.hi) break;
+                if (instruction.op == Opcode::Mod) {
+                    int64_t most = b.hi - 1;
+                    out = Range::between(a.lo >= 0 ? 0 : std::max(a.lo, -most), a.hi <= 0 ? 0 : std::min(a.hi, most));
+                } else if (!b.is_exact()) {
+                    break;
+                } else if (instruction.op == Opcode::Shr) {
+                    if (b.lo > 31) break;
+                    out = Range::between(a.lo >> b.lo, a.hi >> b.lo);
+                } else if (instruction.op == Opcode::Div) {
+                    out = Range::between(a.lo / b.lo, a.hi / b.lo);
+                } else {
+                    int32_t divisor = static_cast<int32_t>(b.lo);
+                    out = Range::between(turd::int_floor_div(static_cast<int32_t>(a.lo), divisor),
+                                         turd::int_floor_div(static_cast<int32_t>(a.hi), divisor));
+                }
+                return true;
+            }
+            case Opcode::Neg: {
+                Range a = operand(0);
+                out = a.lo > int_min ? Range::between(-a.hi, -a.lo) : Range();
+                return true;
+            }
+            case Opcode::ArrayLength: {
+                ValueId array = array_of(function.operand(value, 0));
+                out = length(array);
+                out.bound_by(array, 0);
+                return true;
+            }
+            case Opcode::LoadGlobal: {
+                if (module.globals[instruction.immediate] != TypeId::Int) break;
+                ValueId store = stored_before(value);
+                out = store != no_value ? at(function.operand(store, 0), store) : globals.ranges[instruction.immediate];
+                return true;
+            }
+            default:
+                break;
+        }
+        out = Range();
+        return true;
+    }
+};
+
+} // namespace
+
+// Int globals start at 0 and take every value stored to them, from any
+// function, so their ranges are solved around all functions: widened until
+// they settle, then narrowed once. Then every check whose index the ranges
+// put inside the array is removed, and lengths of constant-size arrays
+// become constants.
+bool BoundsCheckElimination::run(IRModule& module) {
+    Globals globals(module);
+    std::vector<std::unique_ptr<RangeAnalysis>> analyses;
+    for (size_t index = 0; index < module.functions.size(); ++index) {
+        analyses.push_back(std::make_unique<RangeAnalysis>(module, module.functions[index], index, globals));
+    }
+
+    auto stored = [&] {
+        std::vector<Range> ranges(module.globals.size(), Range::exact(0));
+        for (size_t index = 0; index < module.functions.size(); ++index) {
+            const IRFunction& function = module.functions[index];
+            for (BlockId block = 0; block < function.blocks.size(); ++block) {
+                if (!analyses[index]->reachable(block)) continue;
+                for (ValueId value : function.blocks[block].code) {
+                    const IRInstruction& instruction = function.values[value];
+                    if (instruction.op != Opcode::StoreGlobal || module.globals[instruction.immediate] != TypeId::Int) continue;
+                    Range range = analyses[index]->at(function.operand(value, 0), value);
+                    range.array = no_value;
+                    ranges[instruction.immediate] = join(ranges[instruction.immediate], range);
+                }
+            }
+        }
+        return ranges;
+    };
+    for (int round = 0;; ++round) {
+        for (auto& analysis : analyses) analysis->solve();
+        std::vector<Range> next = stored();
+        bool changed = false;
+        for (size_t slot = 0; slot < next.size(); ++slot) {
+            Range range = join(globals.ranges[slot], next[slot]);
+            if (range == globals.ranges[slot]) continue;
+            globals.ranges[slot] = round >= 2 ? widen(globals.ranges[slot], range) : range;
+            changed = true;
+        }
+        if (!changed) break;
+    }
+    globals.ranges = stored();
+    for (auto& analysis : analyses) analysis->solve();
+
+    bool changed = false;
+    for (size_t index = 0; index < module.functions.size(); ++index) {
+        IRFunction& function = module.functions[index];
+        const RangeAnalysis& analysis = *analyses[index];
+        std::vector<ValueId> checks, lengths;
+        for (BlockId block = 0; block < function.blocks.size(); ++block) {
+            if (!analysis.reachable(block)) continue;
+            for (ValueId value : function.blocks[block].code) {
+                Opcode op = function.values[value].op;
+                if (op == Opcode::BoundsCheck && analysis.in_bounds(value)) checks.push_back(value);
+                if (op == Opcode::ArrayLength && analysis.length(analysis.array_of(function.operand(value, 0))).is_exact()) {
+                    lengths.push_back(value);
+                }
+            }
+        }
+        for (ValueId length : lengths) {
+            int64_t constant = analysis.length(analysis.array_of(function.operand(length, 0))).lo;
+            function.values[length].op = Opcode::Const;
+            function.values[length].immediate = constant;
+            function.set_operands(length, {});
+        }
+        for (ValueId check : checks) function.remove(check);
+        changed |= !checks.empty() || !lengths.empty();
+    }
+    return changed;
+}
@@ -0,0 +1,481 @@
+#include "constant_folder.hpp"
+#include "../SynParser/ast_visitor.hpp"
+#include "../Support/arithmetic.hpp"
+#include "../Support/output_buffer.hpp"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace {
+
+// === Constants ===
+// A literal's value, decoded once so every operator folds on real numbers
+struct Constant {
+    TypeId type = TypeId::Unknown;
+    int32_t i = 0;
+    double f = 0.0;
+    bool b = false;
+    std::string s;  // string and char
+
+    double as_float() const { return type == TypeId::Int ? static_cast<double>(i) : f; }
+};
+
+bool read_constant(const ASTNodePTR& node, Constant& out) {
+    if (!node || node->type != NodeType::Literal) return false;
+    const auto& literal = static_cast<const LiteralNode&>(*node);
+
+    // TypeChecker rejected literals that do not fit, so the conversions below cannot throw
+    out.type = type_from_name(literal.literalType);
+    switch (out.type) {
+        case TypeId::Int:    out.i = turd::wrap(std::stoll(literal.value)); return true;
+        case TypeId::Float:  out.f = std::stod(literal.value); return true;
+        case TypeId::Bool:   out.b = literal.value == "true"; return true;
+        case TypeId::String:
+        case TypeId::Char:   out.s = literal.value; return true;
+        case TypeId::Unknown:
+        case TypeId::Void:
+        case TypeId::IntArray:
+        case TypeId::FloatArray:
+        case TypeId::StringArray:
+        case TypeId::BoolArray:
+        case TypeId::CharArray: return false;
+    }
+    return false;
+}
+
+ASTNodePTR make_literal(const Constant& value, const ASTNode& at) {
+    std::string text;
+    switch (value.type) {
+        case TypeId::Int:    text = std::to_string(value.i); break;
+        case TypeId::Float:  text = format_float(value.f); break;
+        case TypeId::Bool:   text = value.b ? "true" : "false"; break;
+        case TypeId::String:
+        case TypeId::Char:   text = value.s; break;
+        case TypeId::Unknown:
+        case TypeId::Void:
+        case TypeId::IntArray:
+        case TypeId::FloatArray:
+        case TypeId::StringArray:
+        case TypeId::BoolArray:
+        case TypeId::CharArray: break;
+    }
+
+    auto literal = std::make_shared<LiteralNode>(text, typeIdToString(value.type));
+    literal->valueType = value.type;
+    literal->line = at.line;
+    literal->column = at.column;
+    return literal;
+}
+
+Constant int_constant(int32_t value) {
+    Constant constant;
+    constant.type = TypeId::Int;
+    constant.i = value;
+    return constant;
+}
+
+Constant float_constant(double value) {
+    Constant constant;
+    constant.type = TypeId::Float;
+    constant.f = value;
+    return constant;
+}
+
+Constant bool_constant(bool value) {
+    Constant constant;
+    constant.type = TypeId::Bool;
+    constant.b = value;
+    return constant;
+}
+
+// === Operator Semantics ===
+// Each returns false when the operation has no compile-time value
+// (division by zero, overflowing conversions, non-finite results)
+
+bool fold_int(const std::string& op, int32_t a, int32_t b, Constant& out) {
+    int64_t x = a, y = b;
+    bool traps = turd::int_division_traps(a, b);
+
+    if (op == "+") { out = int_constant(turd::wrap(x + y)); return true; }
+    if (op == "-") { out = int_constant(turd::wrap(x - y)); return true; }
+    if (op == "*") { out = int_constant(turd::wrap(x * y)); return true; }
+    if (op == "/" && !traps) { out = int_constant(a / b); return true; }
+    if (op == "%" && !traps) { out = int_constant(a % b); return true; }
+    if (op == "//" && !traps) { out = int_constant(turd::int_floor_div(a, b)); return true; }
+    if (op == "**" && !turd::int_pow_traps(a, b)) { out = int_constant(turd::int_pow(a, b)); return true; }
+    if (op == ">>") { out = int_constant(a >> (b & 31)); return true; }
+    return false;
+}
+
+bool fold_float(const std::string& op, double a, double b, Constant& out) {
+    double result;
+    if (op == "+") result = a + b;
+    else if (op == "-") result = a - b;
+    else if (op == "*") result = a * b;
+    else if (op == "/") result = a / b;
+    else if (op == "%") result = std::fmod(a, b);
+    else if (op == "**") result = std::pow(a, b);
+    else if (op == "//") {
+        int32_t quotient;
+        if (!turd::float_floor_div(a, b, quotient)) return false;
+        out = int_constant(quotient);
+        return true;
+    }
+    else return false;
+
+    if (!std::isfinite(result)) return false;
+    out = float_constant(result);
+    return true;
+}
+
+template <typename T>
+bool compare(const std::string& op, const T& a, const T& b, Constant& out) {
+    if (op == "==") out = bool_constant(a == b);
+    else if (op == "!=") out = bool_constant(a != b);
+    else if (op == "<") out = bool_constant(a < b);
+    else if (op == "<=") out = bool_constant(a <= b);
+    else if (op == ">") out = bool_constant(a > b);
+    else if (op == ">=") out = bool_constant(a >= b);
+    else return false;
+    return true;
+}
+
+bool is_comparison(const std::string& op) {
+    return op == "==" || op == "!=" || op == "<" || op == "<=" || op == ">" || op == ">=";
+}
+
+bool fold_binary(const std::string& op, const Constant& a, const Constant& b, Constant& out) {
+    bool numeric = (a.type == TypeId::Int || a.type == TypeId::Float) &&
+                   (b.type == TypeId::Int || b.type == TypeId::Float);
+
+    if (numeric) {
+        bool floats = a.type == TypeId::Float || b.type == TypeId::Float;
+        if (is_comparison(op)) {
+            return floats ? compare(op, a.as_float(), b.as_float(), out) : compare(op, a.i, b.i, out);
+        }
+        return floats ? fold_float(op, a.as_float(), b.as_float(), out) : fold_int(op, a.i, b.i, out);
+    }
+
+    if (a.type != b.type) return false;
+    switch (a.type) {
+        case TypeId::Bool:
+            if (op == "&&") { out = bool_constant(a.b && b.b); return true; }
+            if (op == "||") { out = bool_constant(a.b || b.b); return true; }
+            if (op == "==" || op == "!=") return compare(op, a.b, b.b, out);
+            return false;
+        case TypeId::String:
+            if (op == "+") {
+                out.type = TypeId::String;
+                out.s = a.s + b.s;
+                return true;
+            }
+            return is_comparison(op) && compare(op, a.s, b.s, out);
+        case TypeId::Char:
+            return is_comparison(op) && compare(op, a.s, b.s, out);
+        default:
+            return false;
+    }
+}
+
+bool fold_unary(const std::string& op, const Constant& a, Constant& out) {
+    if (op == "!" && a.type == TypeId::Bool) {
+        out = bool_constant(!a.b);
+        return true;
+    }
+    if (op == "-" && a.type == TypeId::Int) {
+        out = int_constant(turd::wrap(-static_cast<int64_t>(a.i)));
+        return true;
+    }
+    if (op == "-" && a.type == TypeId::Float) {
+        out = float_constant(-a.f);
+        return true;
+    }
+    return false;
+}
+
+// === Folder ===
+// Expression handlers return the node that replaces the visited one, or
+// nullptr to keep it. Statement lists are rebuilt by fold_body so dead
+// statements can be dropped and live arms spliced in.
+class Folder : public ASTVisitor<Folder, ASTNodePTR> {
+public:
+    explicit Folder(FoldStats& stats) : stats(stats) {}
+
+    void fold_body(std::vector<ASTNodePTR>& body) {
+        std::vector<ASTNodePTR> kept;
+        kept.reserve(body.size());
+
+        for (size_t i = 0; i < body.size(); ++i) {
+            ASTNodePTR& statement = body[i];
+            if (statement->type == NodeType::If) {
+                auto& node = static_cast<IfNode&>(*statement);
+                visit(node);
+                Constant condition;
+                if (read_constant(node.condition, condition) && condition.type == TypeId::Bool) {
+                    ++stats.branches_removed;
+                    splice(kept, condition.b ? node.body : node.elseBody, node);
+                    continue;
+                }
+            } else if (statement->type == NodeType::While) {
+                auto& node = static_cast<WhileNode&>(*statement);
+                visit(node);
+                Constant condition;
+                if (read_constant(node.condition, condition) && condition.type == TypeId::Bool && !condition.b) {
+                    ++stats.branches_removed;
+                    continue;
+                }
+            } else {
+                fold(statement);
+            }
+            kept.push_back(statement);
+
+            if ((statement->type == NodeType::Return && in_function) || statement->type == NodeType::Break) {
+                stats.dead_statements += body.size() - i - 1;
+                break;
+            }
+        }
+        body = std::move(kept);
+    }
+
+    // === Statements ===
+    ASTNodePTR visit_program(ProgramNode& node) {
+        fold_body(node.children);
+        return nullptr;
+    }
+
+    ASTNodePTR visit_function(FunctionNode& node) {
+        in_function = true;
+        fold_body(node.body);
+        in_function = false;
+        return nullptr;
+    }
+
+    ASTNodePTR visit_parameter(ParameterNode&) { return nullptr; }
+
+    ASTNodePTR visit_declaration(DeclarationNode& node) {
+        fold(node.size);
+        fold(node.initializer);
+        return nullptr;
+    }
+
+    ASTNodePTR visit_assignment(AssignmentNode& node) {
+        fold(node.index);
+        fold(node.expression);
+        return nullptr;
+    }
+
+    ASTNodePTR visit_if(IfNode& node) {
+        fold(node.condition);
+        fold_body(node.body);
+        fold_body(node.elseBody);
+        return nullptr;
+    }
+
+    ASTNodePTR visit_while(WhileNode& node) {
+        fold(node.condition);
+        fold_body(node.body);
+        return nullptr;
+    }
+
+    ASTNodePTR visit_return(ReturnNode& node) {
+        fold(node.expression);
+        return nullptr;
+    }
+
+    ASTNodePTR visit_break(BreakNode&) { return nullptr; }
+
+    ASTNodePTR visit_block(BlockNode& node) {
+        fold_body(node.statements);
+        return nullptr;
+    }
+
+    ASTNodePTR visit_error(ErrorNode&) { return nullptr; }
+
+    // === Expressions ===
+    ASTNodePTR visit_binary_op(BinaryOpNode& node) {
+        fold(node.left);
+        fold(node.right);
+
+        Constant left, right, result;
+        bool left_constant = read_constant(node.left, left);
+        bool right_constant = read_constant(node.right, right);
+
+        if (left_constant && right_constant) {
+            if (fold_binary(node.op, left, right, result)) {
+                ++stats.folded;
+                return make_literal(result, node);
+            }
+            return nullptr;
+        }
+
+        ASTNodePTR simpler = simplify(node, left_constant ? &left : nullptr, right_constant ? &right : nullptr);
+        if (simpler) ++stats.simplified;
+        return simpler;
+    }
+
+    ASTNodePTR visit_unary_op(UnaryOpNode& node) {
+        fold(node.operand);
+
+        Constant operand, result;
+        if (read_constant(node.operand, operand)) {
+            if (fold_unary(node.op, operand, result)) {
+                ++stats.folded;
+                return make_literal(result, node);
+            }
+            return nullptr;
+        }
+
+        // --x and !!x
+        if (node.operand->type == NodeType::UnaryOp) {
+            auto& inner = static_cast<UnaryOpNode&>(*node.operand);
+            TypeId type = value_type(inner.operand);
+            bool cancels = inner.op == node.op &&
+                           (node.op == "-" ? (type == TypeId::Int || type == TypeId::Float) : type == TypeId::Bool);
+            if (cancels) {
+                ++stats.simplified;
+                return inner.operand;
+            }
+        }
+        return nullptr;
+    }
+
+    ASTNodePTR visit_literal(LiteralNode&) { return nullptr; }
+    ASTNodePTR visit_variable(VariableNode&) { return nullptr; }
+
+    ASTNodePTR visit_function_call(FunctionCallNode& node) {
+        for (auto& argument : node.arguments) fold(argument);
+        return nullptr;
+    }
+
+    ASTNodePTR visit_index(IndexNode& node) {
+        fold(node.array);
+        fold(node.index);
+        return nullptr;
+    }
+
+private:
+    void fold(ASTNodePTR& slot) {
+        if (!slot) return;
+        if (ASTNodePTR replacement = visit(*slot)) slot = std::move(replacement);
+    }
+
+    // the live arm of a folded if: spliced in directly, or kept in a block
+    // when it declares something, so its names stay scoped to the arm
+    static void splice(std::vector<ASTNodePTR>& into, std::vector<ASTNodePTR>& arm, const ASTNode& at) {
+        bool declares = false;
+        for (const auto& statement : arm) declares |= statement->type == NodeType::Declaration;
+
+        if (!declares) {
+            into.insert(into.end(), arm.begin(), arm.end());
+        } else {
+            auto block = std::make_shared<BlockNode>();
+            block->statements = std::move(arm);
+            block->line = at.line;
+            block->column = at.column;
+            into.push_back(std::move(block));
+        }
+    }
+
+    static TypeId value_type(const ASTNodePTR& node) {
+        switch (node->type) {
+            case NodeType::BinaryOp:
+            case NodeType::UnaryOp:
+            case NodeType::Literal:
+            case NodeType::Variable:
+            case NodeType::FunctionCall:
+            case NodeType::Index:
+                return static_cast<const ExpressionNode&>(*node).valueType;
+            default:
+                return TypeId::Unknown;
+        }
+    }
+
+    // evaluating it has no effect, so it may be dropped or evaluated twice
+    static bool is_pure(const ASTNodePTR& node) {
+        return node->type == NodeType::Variable || node->type == NodeType::Literal;
+    }
+
+    static ASTNodePTR clone_leaf(const ASTNodePTR& node) {
+        if (node->type == NodeType::Variable) {
+            return std::make_shared<VariableNode>(static_cast<const VariableNode&>(*node));
+        }
+        return std::make_shared<LiteralNode>(static_cast<const LiteralNode&>(*node));
+    }
+
+    static bool is_value(const Constant* constant, double value) {
+        return constant && (constant->type == TypeId::Int || constant->type == TypeId::Float) &&
+               constant->as_float() == value;
+    }
+
+    // one side is an operator tree; rewrite the node if an identity applies
+    ASTNodePTR simplify(BinaryOpNode& node, const Constant* left, const Constant* right) {
+        const std::string& op = node.op;
+        TypeId type = node.valueType;
+        TypeId left_type = value_type(node.left);
+        TypeId right_type = value_type(node.right);
+        bool numeric = type == TypeId::Int || type == TypeId::Float;
+
+        // short-circuit operators with a constant left side
+        if ((op == "&&" || op == "||") && left && left->type == TypeId::Bool) {
+            bool decides = op == "&&" ? !left->b : left->b;
+            if (decides) return make_literal(bool_constant(left->b), node);
+            return right_type == TypeId::Bool ? node.right : nullptr;
+        }
+        if (!numeric) return nullptr;
+
+        // x + 0 and 0 + x are exact for ints only: -0.0 + 0 is +0.0
+        if (op == "+" && type == TypeId::Int) {
+            if (is_value(right, 0) && left_type == type) return node.left;
+            if (is_value(left, 0) && right_type == type) return node.right;
+        }
+        if (op == "-" && is_value(right, 0) && left_type == type) return node.left;
+        if (op == "*") {
+            if (is_value(right, 1) && left_type == type) return node.left;
+            if (is_value(left, 1) && right_type == type) return node.right;
+            if (type == TypeId::Int && is_value(right, 0) && is_pure(node.left)) return make_literal(int_constant(0), node);
+            if (type == TypeId::Int && is_value(left, 0) && is_pure(node.right)) return make_literal(int_constant(0), node);
+        }
+        if (op == "/" && is_value(right, 1) && left_type == type) return node.left;
+
+        if (op == "**" && right && right->type == TypeId::Int) {
+            if (right->i == 1 && left_type == type) return node.left;
+            if (right->i == 0 && is_pure(node.left)) {
+                return make_literal(type == TypeId::Int ? int_constant(1) : float_constant(1.0), node);
+            }
+            if (right->i == 2 && left_type == type && is_pure(node.left)) {
+                auto square = std::make_shared<BinaryOpNode>("*", node.left, clone_leaf(node.left));
+                square->valueType = type;
+                square->line = node.line;
+                square->column = node.column;
+                return square;
+            }
+        }
+
+        // floor division by 2^k is an arithmetic shift right, negative ints included
+        if (op == "//" && left_type == TypeId::Int && right && right->type == TypeId::Int &&
+            right->i > 0 && (right->i & (right->i - 1)) == 0) {
+            int shift = 0;
+            while ((1 << shift) != right->i) ++shift;
+            if (shift == 0) return node.left;
+
+            auto amount = make_literal(int_constant(shift), *node.right);
+            auto shifted = std::make_shared<BinaryOpNode>(">>", node.left, amount);
+            shifted->valueType = TypeId::Int;
+            shifted->line = node.line;
+            shifted->column = node.column;
+            return shifted;
+        }
+        return nullptr;
+    }
+
+    FoldStats& stats;
+    bool in_function = false;
+};
+
+} // namespace
+
+void ConstantFolder::fold(ProgramNode& program) {
+    stats = FoldStats{};
+    Folder folder(stats);
+    folder.visit(program);
+}
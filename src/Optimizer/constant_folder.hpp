@@ -0,0 +1,32 @@
+#pragma once
+#include "../SynParser/syntax_parser.hpp"
+
+struct FoldStats {
+    size_t folded = 0;              // operator trees replaced by a literal
+    size_t simplified = 0;          // algebraic identities applied
+    size_t branches_removed = 0;    // if/while arms dropped for a constant condition
+    size_t dead_statements = 0;     // statements after a return or break
+};
+
+// === Constant Folding ===
+// Runs after TypeChecker and rewrites the tree in place:
+//  - operators whose operands are all literals become one literal
+//  - identities that keep the value: x*1, x+0, x-0, x/1, x**1, x**0, x**2 -> x*x,
+//    and int x // 2^k -> x >> k ('>>' only appears in optimized trees)
+//  - if/while with a constant condition lose their dead arm
+//  - statements after a return are dropped
+//
+// Folding follows the runtime semantics exactly, so results never depend
+// on the optimization level: ints are 32-bit and wrap, '/' and '%'
+// truncate toward zero, '//' floors, and division by zero is left for the
+// program to raise at runtime. An operand is only dropped or duplicated
+// when it is a variable or literal, so no call is lost or repeated.
+class ConstantFolder {
+public:
+    void fold(ProgramNode& program);
+
+    const FoldStats& get_stats() const { return stats; }
+
+private:
+    FoldStats stats;
+};
@@ -0,0 +1,354 @@
+#include "ir_passes.hpp"
+#include "../Support/arithmetic.hpp"
+#include <algorithm>
+
+namespace {
+
+// === Lattice ===
+// Top: no executable definition seen yet; Constant: one value on every
+// executable path; Bottom: varies at runtime
+struct Lattice {
+    enum State : uint8_t { Top, Constant, Bottom };
+
+    State state = Top;
+    TypeId type = TypeId::Unknown;
+    int64_t bits = 0;
+
+    static Lattice bottom() { return {Bottom, TypeId::Unknown, 0}; }
+    static Lattice constant(TypeId type, int64_t bits) { return {Constant, type, bits}; }
+
+    bool operator==(const Lattice& other) const {
+        return state == other.state && (state != Constant || (type == other.type && bits == other.bits));
+    }
+    bool operator!=(const Lattice& other) const { return !(*this == other); }
+};
+
+Lattice meet(const Lattice& a, const Lattice& b) {
+    if (a.state == Lattice::Top) return b;
+    if (b.state == Lattice::Top) return a;
+    return a == b ? a : Lattice::bottom();
+}
+
+bool is_numeric(TypeId type) {
+    return type == TypeId::Int || type == TypeId::Float;
+}
+
+double as_float(const Lattice& value) {
+    return value.type == TypeId::Int ? static_cast<double>(value.bits) : bits_to_float(value.bits);
+}
+
+template <typename T>
+bool compare(Opcode op, T a, T b, Lattice& out) {
+    bool result;
+    switch (op) {
+        case Opcode::Eq: result = a == b; break;
+        case Opcode::Ne: result = a != b; break;
+        case Opcode::Lt: result = a < b; break;
+        case Opcode::Le: result = a <= b; break;
+        case Opcode::Gt: result = a > b; break;
+        case Opcode::Ge: result = a >= b; break;
+        default: return false;
+    }
+    out = Lattice::constant(TypeId::Bool, result);
+    return true;
+}
+
+bool fold_int(Opcode op, int32_t a, int32_t b, Lattice& out) {
+    int64_t x = a, y = b;
+    bool traps = turd::int_division_traps(a, b);
+    int32_t result;
+    switch (op) {
+        case Opcode::Add: result = turd::wrap(x + y); break;
+        case Opcode::Sub: result = turd::wrap(x - y); break;
+        case Opcode::Mul: result = turd::wrap(x * y); break;
+        case Opcode::Div: if (traps) return false; result = a / b; break;
+        case Opcode::Mod: if (traps) return false; result = a % b; break;
+        case Opcode::FloorDiv: if (traps) return false; result = turd::int_floor_div(a, b); break;
+        case Opcode::Pow: if (turd::int_pow_traps(a, b)) return false; result = turd::int_pow(a, b); break;
+        case Opcode::Shr: result = a >> (b & 31); break;
+        default: return compare(op, a, b, out);
+    }
+    out = Lattice::constant(TypeId::Int, result);
+    return true;
+}
+
+bool fold_float(Opcode op, double a, double b, Lattice& out) {
+    double result;
+    switch (op) {
+        case Opcode::Add: result = a + b; break;
+        case Opcode::Sub: result = a - b; break;
+        case Opcode::Mul: result = a * b; break;
+        case Opcode::Div: result = a / b; break;
+        case Opcode::Mod: result = std::fmod(a, b); break;
+        case Opcode::Pow: result = std::pow(a, b); break;
+        case Opcode::FloorDiv: {
+            int32_t quotient;
+            if (!turd::float_floor_div(a, b, quotient)) return false;
+            out = Lattice::constant(TypeId::Int, quotient);
+            return true;
+        }
+        default: return compare(op, a, b, out);
+    }
+    out = Lattice::constant(TypeId::Float, float_bits(result));
+    return true;
+}
+
+// false when the instruction has no compile-time value
+bool evaluate(IRModule& module, Opcode op, const Lattice* args, uint32_t count, Lattice& out) {
+    if (count == 1) {
+        const Lattice& a = args[0];
+        switch (op) {
+            case Opcode::Copy: out = a; return true;
+            case Opcode::IntToFloat:
+                if (a.type != TypeId::Int) return false;
+                out = Lattice::constant(TypeId::Float, float_bits(static_cast<double>(a.bits)));
+                return true;
+            case Opcode::Not:
+                if (a.type != TypeId::Bool) return false;
+                out = Lattice::constant(TypeId::Bool, !a.bits);
+                return true;
+            case Opcode::Neg:
+                if (a.type == TypeId::Int) out = Lattice::constant(TypeId::Int, turd::wrap(-a.bits));
+                else if (a.type == TypeId::Float) out = Lattice::constant(TypeId::Float, float_bits(-bits_to_float(a.bits)));
+                else return false;
+                return true;
+            default:
+                return false;
+        }
+    }
+    if (count != 2) return false;
+
+    const Lattice& a = args[0];
+    const Lattice& b = args[1];
+    if (is_numeric(a.type) && is_numeric(b.type)) {
+        if (a.type == TypeId::Int && b.type == TypeId::Int) {
+            return fold_int(op, static_cast<int32_t>(a.bits), static_cast<int32_t>(b.bits), out);
+        }
+        return fold_float(op, as_float(a), as_float(b), out);
+    }
+    if (a.type != b.type) {
+        // mixed kinds only meet in dynamically typed code, where they are never equal
+        if (op == Opcode::Eq || op == Opcode::Ne) {
+            out = Lattice::constant(TypeId::Bool, op == Opcode::Ne);
+            return true;
+        }
+        return false;
+    }
+    switch (a.type) {
+        case TypeId::Bool:
+            return (op == Opcode::Eq || op == Opcode::Ne) && compare(op, a.bits, b.bits, out);
+        case TypeId::Char:
+            return compare(op, a.bits, b.bits, out);
+        case TypeId::String: {
+            const std::string& left = module.strings[a.bits];
+            const std::string& right = module.strings[b.bits];
+            if (op == Opcode::Add) {
+                out = Lattice::constant(TypeId::String, module.intern_string(left + right));
+                return true;
+            }
+            return compare(op, left, right, out);
+        }
+        default:
+            return false;
+    }
+}
+
+class Propagator {
+public:
+    Propagator(IRModule& module, IRFunction& function)
+        : module(module), function(function),
+          lattice(function.values.size()),
+          block_executable(function.blocks.size(), false),
+          edge_executable(function.blocks.size()) {
+        for (BlockId block = 0; block < function.blocks.size(); ++block) {
+            edge_executable[block].assign(function.blocks[block].succs.size(), false);
+        }
+        build_users();
+    }
+
+    void solve() {
+        mark_block(0);
+        while (!ssa_work.empty() || !block_work.empty()) {
+            while (!block_work.empty()) {
+                BlockId block = block_work.back();
+                block_work.pop_back();
+                for (ValueId value : function.blocks[block].code) visit(value);
+            }
+            while (!ssa_work.empty()) {
+                ValueId value = ssa_work.back();
+                ssa_work.pop_back();
+                if (block_executable[function.values[value].block]) visit(value);
+            }
+        }
+    }
+
+    bool rewrite() {
+        bool changed = false;
+        for (BlockId block = 0; block < function.blocks.size(); ++block) {
+            if (!block_executable[block]) continue;
+            auto& code = function.blocks[block].code;
+
+            for (ValueId value : code) {
+                IRInstruction& instruction = function.values[value];
+                const Lattice& known = lattice[value];
+                // a dynamically typed value keeps its instruction: its users were
+                // built for an Unknown operand and may not accept the concrete type
+                if (known.state != Lattice::Constant || known.type != instruction.type ||
+                    instruction.op == Opcode::Const || has_side_effects(instruction.op)) {
+                    continue;
+                }
+                instruction.op = Opcode::Const;
+                instruction.immediate = known.bits;
+                instruction.operand_count = 0;
+                changed = true;
+            }
+            // a phi that became a constant now sits among the phis
+            std::stable_partition(code.begin(), code.end(),
+                                  [&](ValueId v) { return function.values[v].op == Opcode::Phi; });
+
+            ValueId end = function.terminator(block);
+            if (end == no_value || function.values[end].op != Opcode::Branch) continue;
+            const Lattice& condition = lattice[function.operand(end, 0)];
+            if (condition.state != Lattice::Constant || condition.type != TypeId::Bool) continue;
+
+            auto& succs = function.blocks[block].succs;
+            BlockId dead = succs[condition.bits ? 1 : 0];
+            function.remove_edge(block, dead);
+            function.values[end].op = Opcode::Jump;
+            function.values[end].operand_count = 0;
+            changed = true;
+        }
+        changed |= function.remove_unreachable_blocks() != 0;
+        return changed;
+    }
+
+private:
+    void build_users() {
+        std::vector<uint32_t> counts(function.values.size() + 1, 0);
+        for (const auto& block : function.blocks) {
+            for (ValueId user : block.code) {
+                for (uint32_t i = 0; i < function.values[user].operand_count; ++i) {
+                    counts[function.operand(user, i) + 1]++;
+                }
+            }
+        }
+        for (size_t i = 1; i < counts.size(); ++i) counts[i] += counts[i - 1];
+        user_start = counts;
+        users.resize(counts.back());
+        for (const auto& block : function.blocks) {
+            for (ValueId user : block.code) {
+                for (uint32_t i = 0; i < function.values[user].operand_count; ++i) {
+                    users[counts[function.operand(user, i)]++] = user;
+                }
+            }
+        }
+    }
+
+    void mark_block(BlockId block) {
+        if (block_executable[block]) return;
+        block_executable[block] = true;
+        block_work.push_back(block);
+    }
+
+    void mark_edge(BlockId from, size_t index) {
+        if (edge_executable[from][index]) return;
+        edge_executable[from][index] = true;
+        BlockId to = function.blocks[from].succs[index];
+        if (!block_executable[to]) {
+            mark_block(to);
+            return;
+        }
+        // a new way into a block already running: only its phis can change
+        for (ValueId value : function.blocks[to].code) {
+            if (function.values[value].op != Opcode::Phi) break;
+            visit(value);
+        }
+    }
+
+    bool edge_runs(BlockId from, BlockId to) const {
+        const auto& succs = function.blocks[from].succs;
+        for (size_t i = 0; i < succs.size(); ++i) {
+            if (succs[i] == to && edge_executable[from][i]) return true;
+        }
+        return false;
+    }
+
+    void visit(ValueId value) {
+        const IRInstruction& instruction = function.values[value];
+        BlockId block = instruction.block;
+        Lattice result = Lattice::bottom();
+
+        switch (instruction.op) {
+            case Opcode::Const:
+                result = Lattice::constant(instruction.type, instruction.immediate);
+                break;
+            case Opcode::Phi: {
+                result = Lattice();
+                const auto& preds = function.blocks[block].preds;
+                for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+                    if (edge_runs(preds[i], block)) result = meet(result, lattice[function.operand(value, i)]);
+                }
+                break;
+            }
+            case Opcode::Jump:
+                mark_edge(block, 0);
+                return;
+            case Opcode::Branch: {
+                const Lattice& condition = lattice[function.operand(value, 0)];
+                if (condition.state == Lattice::Top) return;
+                if (condition.state == Lattice::Constant && condition.type == TypeId::Bool) {
+                    mark_edge(block, condition.bits ? 0 : 1);
+                } else {
+                    mark_edge(block, 0);
+                    mark_edge(block, 1);
+                }
+                return;
+            }
+            case Opcode::Undef: case Opcode::Param: case Opcode::LoadGlobal:
+            case Opcode::Call: case Opcode::Read:
+            case Opcode::NewArray: case Opcode::ArrayLength: case Opcode::LoadElement:
+                break;
+            case Opcode::Nop: case Opcode::StoreGlobal: case Opcode::Print: case Opcode::Return:
+            case Opcode::BoundsCheck: case Opcode::StoreElement:
+                return;
+            default: {
+                // pure operator: Top until every operand is known
+                Lattice args[2];
+                uint32_t count = instruction.operand_count;
+                bool pending = false, varying = false;
+                for (uint32_t i = 0; i < count && i < 2; ++i) {
+                    args[i] = lattice[function.operand(value, i)];
+                    pending |= args[i].state == Lattice::Top;
+                    varying |= args[i].state == Lattice::Bottom;
+                }
+                if (varying) break;
+                if (pending) return;
+                if (!evaluate(module, instruction.op, args, count, result)) result = Lattice::bottom();
+                break;
+            }
+        }
+
+        if (result != lattice[value]) {
+            lattice[value] = result;
+            for (uint32_t i = user_start[value]; i < user_start[value + 1]; ++i) ssa_work.push_back(users[i]);
+        }
+    }
+
+    IRModule& module;
+    IRFunction& function;
+    std::vector<Lattice> lattice;
+    std::vector<bool> block_executable;
+    std::vector<std::vector<bool>> edge_executable;     // per block, per successor slot
+    std::vector<uint32_t> user_start;                    // users of v: users[user_start[v], user_start[v + 1])
+    std::vector<ValueId> users;
+    std::vector<BlockId> block_work;
+    std::vector<ValueId> ssa_work;
+};
+
+} // namespace
+
+bool ConstantPropagation::run_on_function(IRModule& module, IRFunction& function) {
+    Propagator propagator(module, function);
+    propagator.solve();
+    return propagator.rewrite();
+}
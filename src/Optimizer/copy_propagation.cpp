@@ -0,0 +1,45 @@
+#include "ir_passes.hpp"
+
+bool CopyPropagation::run_on_function(IRModule&, IRFunction& function) {
+    std::vector<ValueId> forward(function.values.size(), no_value);
+    auto resolve = [&](ValueId value) {
+        while (forward[value] != no_value) value = forward[value];
+        return value;
+    };
+
+    // forwarding one phi can make another trivial, so repeat until nothing moves
+    bool changed = false, progress = true;
+    while (progress) {
+        progress = false;
+        for (const auto& block : function.blocks) {
+            for (ValueId value : block.code) {
+                const IRInstruction& instruction = function.values[value];
+                if (forward[value] != no_value) continue;
+
+                ValueId source = no_value;
+                if (instruction.op == Opcode::Copy) {
+                    source = resolve(function.operand(value, 0));
+                    // a dynamically typed copy of a typed value is where the
+                    // value turns dynamic; leave it for the backend
+                    if (function.values[source].type != instruction.type) continue;
+                } else if (instruction.op == Opcode::Phi) {
+                    bool trivial = true;
+                    for (uint32_t i = 0; i < instruction.operand_count && trivial; ++i) {
+                        ValueId arg = resolve(function.operand(value, i));
+                        if (arg == value || arg == source) continue;
+                        if (source == no_value) source = arg;
+                        else trivial = false;
+                    }
+                    if (!trivial || source == no_value || function.values[source].type != instruction.type) continue;
+                } else {
+                    continue;
+                }
+
+                forward[value] = source;
+                changed = progress = true;
+            }
+        }
+    }
+    if (changed) function.apply_forwarding(forward);
+    return changed;
+}
@@ -0,0 +1,45 @@
+#include "ir_passes.hpp"
+
+bool DeadCodeElimination::run_on_function(IRModule&, IRFunction& function) {
+    std::vector<bool> live(function.values.size(), false);
+    std::vector<ValueId> work;
+
+    // an instruction that can raise stays too: dropping it would drop the error
+    for (const auto& block : function.blocks) {
+        for (ValueId value : block.code) {
+            if (has_side_effects(function.values[value].op) || function.may_trap(value)) {
+                live[value] = true;
+                work.push_back(value);
+            }
+        }
+    }
+    while (!work.empty()) {
+        ValueId value = work.back();
+        work.pop_back();
+        for (uint32_t i = 0; i < function.values[value].operand_count; ++i) {
+            ValueId arg = function.operand(value, i);
+            if (!live[arg]) {
+                live[arg] = true;
+                work.push_back(arg);
+            }
+        }
+    }
+
+    bool changed = false;
+    for (auto& block : function.blocks) {
+        size_t kept = 0;
+        for (ValueId value : block.code) {
+            if (live[value]) {
+                block.code[kept++] = value;
+                continue;
+            }
+            IRInstruction& instruction = function.values[value];
+            instruction.op = Opcode::Nop;
+            instruction.block = no_block;
+            instruction.operand_count = 0;
+            changed = true;
+        }
+        block.code.resize(kept);
+    }
+    return changed;
+}
@@ -0,0 +1,175 @@
+#include "ir_passes.hpp"
+#include "../IR/dominance.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+struct ExpressionKey {
+    Opcode op;
+    TypeId type;
+    int64_t immediate;
+    ValueId left;
+    ValueId right;
+
+    bool operator==(const ExpressionKey& other) const {
+        return op == other.op && type == other.type && immediate == other.immediate &&
+               left == other.left && right == other.right;
+    }
+};
+
+struct ExpressionHash {
+    size_t operator()(const ExpressionKey& key) const {
+        size_t hash = std::hash<int64_t>()(key.immediate);
+        hash = hash * 31 + static_cast<size_t>(key.op);
+        hash = hash * 31 + static_cast<size_t>(key.type);
+        hash = hash * 31 + key.left;
+        hash = hash * 31 + key.right;
+        return hash;
+    }
+};
+
+// pure and determined by opcode, type, immediate and at most two operands
+bool is_numberable(Opcode op) {
+    switch (op) {
+        case Opcode::Const: case Opcode::IntToFloat:
+        case Opcode::Add: case Opcode::Sub: case Opcode::Mul: case Opcode::Div:
+        case Opcode::Mod: case Opcode::FloorDiv: case Opcode::Pow: case Opcode::Shr:
+        case Opcode::Neg: case Opcode::Not: case Opcode::ArrayLength:
+        case Opcode::Eq: case Opcode::Ne: case Opcode::Lt: case Opcode::Le: case Opcode::Gt: case Opcode::Ge:
+            return true;
+        default:
+            return false;
+    }
+}
+
+class ValueNumbering {
+public:
+    explicit ValueNumbering(IRFunction& function)
+        : function(function), dominators(function), forward(function.values.size(), no_value) {}
+
+    bool run() {
+        // iterative preorder walk; leaving a block pops the expressions it added
+        struct Frame {
+            BlockId block;
+            size_t next_child;
+            size_t scope_start;
+        };
+        std::vector<Frame> stack{{0, 0, scope.size()}};
+        enter(0);
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            const auto& children = dominators.children(frame.block);
+            if (frame.next_child < children.size()) {
+                BlockId child = children[frame.next_child++];
+                stack.push_back({child, 0, scope.size()});
+                enter(child);
+                continue;
+            }
+            for (size_t i = frame.scope_start; i < scope.size(); ++i) table.erase(scope[i]);
+            scope.resize(frame.scope_start);
+            stack.pop_back();
+        }
+
+        if (!changed) return false;
+        function.apply_forwarding(forward);
+        return true;
+    }
+
+private:
+    ValueId resolve(ValueId value) const {
+        while (forward[value] != no_value) value = forward[value];
+        return value;
+    }
+
+    void replace(ValueId value, ValueId with) {
+        forward[value] = with;
+        changed = true;
+    }
+
+    void enter(BlockId block) {
+        merge_phis(block);
+        known_globals.clear();
+        for (ValueId value : function.blocks[block].code) {
+            const IRInstruction& instruction = function.values[value];
+            if (forward_global(value)) continue;
+            if (!is_numberable(instruction.op) || instruction.operand_count > 2) continue;
+
+            ExpressionKey key{instruction.op, instruction.type, instruction.immediate, no_value, no_value};
+            if (instruction.operand_count > 0) key.left = resolve(function.operand(value, 0));
+            if (instruction.operand_count > 1) key.right = resolve(function.operand(value, 1));
+            if (instruction.operand_count == 2 && is_commutative(instruction.op, instruction.type) &&
+                key.right < key.left) {
+                std::swap(key.left, key.right);
+            }
+
+            auto found = table.find(key);
+            if (found != table.end()) {
+                replace(value, found->second);
+                continue;
+            }
+            scope.push_back(key);
+            table.emplace(key, value);
+        }
+    }
+
+    // within a block a global holds what was last loaded from or stored to it,
+    // until a call may have changed it; true when value was forwarded
+    bool forward_global(ValueId value) {
+        const IRInstruction& instruction = function.values[value];
+        switch (instruction.op) {
+            case Opcode::Call:
+                known_globals.clear();
+                return false;
+            case Opcode::StoreGlobal:
+                known_globals[instruction.immediate] = resolve(function.operand(value, 0));
+                return false;
+            case Opcode::LoadGlobal: {
+                auto found = known_globals.find(instruction.immediate);
+                if (found != known_globals.end() && function.values[found->second].type == instruction.type) {
+                    replace(value, found->second);
+                    return true;
+                }
+                known_globals[instruction.immediate] = value;
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    // phis in one block with the same operands in the same order are one value
+    void merge_phis(BlockId block) {
+        const auto& code = function.blocks[block].code;
+        for (size_t i = 0; i < code.size() && function.values[code[i]].op == Opcode::Phi; ++i) {
+            if (forward[code[i]] != no_value) continue;
+            for (size_t j = i + 1; j < code.size() && function.values[code[j]].op == Opcode::Phi; ++j) {
+                if (forward[code[j]] == no_value && same_phi(code[i], code[j])) replace(code[j], code[i]);
+            }
+        }
+    }
+
+    bool same_phi(ValueId a, ValueId b) const {
+        const IRInstruction& first = function.values[a];
+        const IRInstruction& second = function.values[b];
+        if (first.type != second.type || first.operand_count != second.operand_count) return false;
+        for (uint32_t i = 0; i < first.operand_count; ++i) {
+            if (resolve(function.operand(a, i)) != resolve(function.operand(b, i))) return false;
+        }
+        return true;
+    }
+
+    IRFunction& function;
+    DominatorTree dominators;
+    std::vector<ValueId> forward;
+    bool changed = false;
+    std::unordered_map<ExpressionKey, ValueId, ExpressionHash> table;
+    std::vector<ExpressionKey> scope;     // keys added per dominator tree level, innermost last
+    std::unordered_map<int64_t, ValueId> known_globals;
+};
+
+} // namespace
+
+bool GlobalValueNumbering::run_on_function(IRModule&, IRFunction& function) {
+    return ValueNumbering(function).run();
+}
@@ -0,0 +1,255 @@
+#include "inliner.hpp"
+#include "../IR/loops.hpp"
+#include <algorithm>
+
+namespace {
+
+size_t function_size(const IRFunction& function) {
+    size_t size = 0;
+    for (const auto& block : function.blocks) size += block.code.size();
+    return size - function.paramTypes.size();
+}
+
+bool returns(const IRFunction& function) {
+    for (const auto& block : function.blocks) {
+        if (!block.code.empty() && function.values[block.code.back()].op == Opcode::Return) return true;
+    }
+    return false;
+}
+
+// === Call Graph ===
+
+std::vector<std::vector<size_t>> build_call_graph(const IRModule& module) {
+    std::vector<std::vector<size_t>> callees(module.functions.size());
+    for (size_t caller = 0; caller < module.functions.size(); ++caller) {
+        const IRFunction& function = module.functions[caller];
+        for (const auto& block : function.blocks) {
+            for (ValueId value : block.code) {
+                if (function.values[value].op == Opcode::Call) {
+                    callees[caller].push_back(static_cast<size_t>(function.values[value].immediate));
+                }
+            }
+        }
+        std::sort(callees[caller].begin(), callees[caller].end());
+        callees[caller].erase(std::unique(callees[caller].begin(), callees[caller].end()), callees[caller].end());
+    }
+    return callees;
+}
+
+// Tarjan's algorithm, iteratively. Components come out callees first;
+// recursive[f] is set for every function on a cycle.
+std::vector<std::vector<size_t>> bottom_up_order(const std::vector<std::vector<size_t>>& callees,
+                                                 std::vector<bool>& recursive) {
+    constexpr size_t unvisited = SIZE_MAX;
+    size_t count = callees.size();
+    std::vector<size_t> index(count, unvisited), low(count, 0);
+    std::vector<bool> on_stack(count, false);
+    std::vector<size_t> stack;
+    std::vector<std::vector<size_t>> components;
+    recursive.assign(count, false);
+    size_t next_index = 0;
+
+    struct Frame {
+        size_t function;
+        size_t next_callee;
+    };
+    for (size_t root = 0; root < count; ++root) {
+        if (index[root] != unvisited) continue;
+        std::vector<Frame> frames{{root, 0}};
+        index[root] = low[root] = next_index++;
+        stack.push_back(root);
+        on_stack[root] = true;
+
+        while (!frames.empty()) {
+            Frame& frame = frames.back();
+            size_t function = frame.function;
+            if (frame.next_callee < callees[function].size()) {
+                size_t callee = callees[function][frame.next_callee++];
+                if (callee == function) recursive[function] = true;
+                if (index[callee] == unvisited) {
+                    index[callee] = low[callee] = next_index++;
+                    stack.push_back(callee);
+                    on_stack[callee] = true;
+                    frames.push_back({callee, 0});
+                } else if (on_stack[callee]) {
+                    low[function] = std::min(low[function], index[callee]);
+                }
+                continue;
+            }
+
+            frames.pop_back();
+            if (!frames.empty()) low[frames.back().function] = std::min(low[frames.back().function], low[function]);
+            if (low[function] != index[function]) continue;
+
+            std::vector<size_t> component;
+            size_t member;
+            do {
+                member = stack.back();
+                stack.pop_back();
+                on_stack[member] = false;
+                component.push_back(member);
+            } while (member != function);
+            if (component.size() > 1) {
+                for (size_t f : component) recursive[f] = true;
+            }
+            components.push_back(std::move(component));
+        }
+    }
+    return components;
+}
+
+// === Inlining one call ===
+// The call's block is split after the call: the part before jumps to a copy
+// of the callee's entry, every copied return jumps to the part after, and a
+// phi there merges the returned values. Returns the value replacing the call.
+ValueId inline_call(IRFunction& caller, ValueId call, const IRFunction& callee) {
+    IRInstruction site = caller.values[call];
+    std::vector<ValueId> args(caller.operands_of(call), caller.operands_of(call) + site.operand_count);
+    BlockId before = site.block;
+
+    // everything after the call moves to a new continuation block
+    BlockId after = caller.add_block();
+    auto& head = caller.blocks[before].code;
+    size_t position = std::find(head.begin(), head.end(), call) - head.begin();
+    caller.blocks[after].code.assign(head.begin() + position + 1, head.end());
+    head.resize(position);
+    for (ValueId value : caller.blocks[after].code) caller.values[value].block = after;
+    caller.blocks[after].succs = std::move(caller.blocks[before].succs);
+    caller.blocks[before].succs.clear();
+    for (BlockId succ : caller.blocks[after].succs) {
+        auto& preds = caller.blocks[succ].preds;
+        std::replace(preds.begin(), preds.end(), before, after);
+    }
+    caller.values[call].op = Opcode::Nop;
+    caller.values[call].block = no_block;
+    caller.values[call].operand_count = 0;
+
+    // a dynamically typed value crossing the call boundary is checked there, as the call would
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (caller.values[args[i]].type != callee.paramTypes[i]) {
+            args[i] = caller.append(before, Opcode::Copy, callee.paramTypes[i], {args[i]}, 0, site.line);
+        }
+    }
+
+    // blocks keep the callee's edge order, so phi operands stay in step with preds
+    std::vector<BlockId> block_map(callee.blocks.size());
+    for (BlockId block = 0; block < callee.blocks.size(); ++block) block_map[block] = caller.add_block();
+    for (BlockId block = 0; block < callee.blocks.size(); ++block) {
+        IRBlock& copy = caller.blocks[block_map[block]];
+        for (BlockId pred : callee.blocks[block].preds) copy.preds.push_back(block_map[pred]);
+        for (BlockId succ : callee.blocks[block].succs) copy.succs.push_back(block_map[succ]);
+    }
+
+    // values first, operands once every value has its copy (phis look ahead)
+    std::vector<ValueId> value_map(callee.values.size(), no_value);
+    std::vector<ValueId> copies;
+    std::vector<ValueId> returned;
+    std::vector<BlockId> returning;
+    for (BlockId block = 0; block < callee.blocks.size(); ++block) {
+        BlockId target = block_map[block];
+        for (ValueId value : callee.blocks[block].code) {
+            const IRInstruction& instruction = callee.values[value];
+            if (instruction.op == Opcode::Param) {
+                value_map[value] = args[instruction.immediate];
+                continue;
+            }
+            if (instruction.op == Opcode::Return) {
+                if (instruction.operand_count != 0) {
+                    returned.push_back(callee.operand(value, 0));
+                    returning.push_back(target);
+                }
+                caller.append(target, Opcode::Jump, TypeId::Void, {}, 0, instruction.line);
+                caller.add_edge(target, after);
+                continue;
+            }
+            ValueId copy = caller.create(instruction.op, instruction.type, {}, instruction.immediate, instruction.line);
+            caller.values[copy].block = target;
+            caller.blocks[target].code.push_back(copy);
+            value_map[value] = copy;
+            copies.push_back(value);
+        }
+    }
+    for (ValueId value : copies) {
+        std::vector<ValueId> operands(callee.operands_of(value),
+                                      callee.operands_of(value) + callee.values[value].operand_count);
+        for (ValueId& operand : operands) operand = value_map[operand];
+        caller.set_operands(value_map[value], operands);
+    }
+
+    caller.append(before, Opcode::Jump, TypeId::Void, {}, 0, site.line);
+    caller.add_edge(before, block_map[0]);
+
+    if (callee.returnType == TypeId::Void) return no_value;
+    for (size_t i = 0; i < returned.size(); ++i) {
+        returned[i] = value_map[returned[i]];
+        if (caller.values[returned[i]].type == callee.returnType) continue;
+        ValueId converted = caller.create(Opcode::Copy, callee.returnType, {returned[i]}, 0, site.line);
+        auto& code = caller.blocks[returning[i]].code;
+        code.insert(code.end() - 1, converted);
+        caller.values[converted].block = returning[i];
+        returned[i] = converted;
+    }
+    if (returned.size() == 1) return returned[0];
+    // one returned value per edge into the continuation, in pred order
+    return caller.append(after, Opcode::Phi, callee.returnType, returned, 0, site.line);
+}
+
+} // namespace
+
+bool Inliner::run(IRModule& module) {
+    std::vector<bool> recursive;
+    auto callees = build_call_graph(module);
+    auto order = bottom_up_order(callees, recursive);
+
+    std::vector<size_t> sizes(module.functions.size());
+    for (size_t f = 0; f < module.functions.size(); ++f) sizes[f] = function_size(module.functions[f]);
+
+    bool changed = false;
+    for (const auto& component : order) {
+        for (size_t caller_index : component) {
+            IRFunction& caller = module.functions[caller_index];
+
+            // weigh every call against the caller as it was, before any splitting moves them
+            DominatorTree dominators(caller);
+            LoopInfo loops(caller, dominators);
+            std::vector<ValueId> chosen;
+            size_t growth = 0;
+            for (const auto& block : caller.blocks) {
+                for (ValueId value : block.code) {
+                    const IRInstruction& instruction = caller.values[value];
+                    if (instruction.op != Opcode::Call) continue;
+                    size_t callee_index = static_cast<size_t>(instruction.immediate);
+                    const IRFunction& callee = module.functions[callee_index];
+                    if (recursive[callee_index] || !returns(callee)) continue;
+
+                    size_t budget = cost.budget;
+                    uint32_t levels = std::min(loops.depth(instruction.block), cost.max_loop_levels);
+                    for (uint32_t level = 0; level < levels; ++level) budget *= cost.loop_scale;
+                    size_t savings = 1 + instruction.operand_count;
+                    for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+                        if (caller.values[caller.operand(value, i)].op == Opcode::Const) savings += cost.constant_arg_bonus;
+                    }
+                    size_t size = sizes[callee_index];
+                    if (size > budget + savings || growth + size > cost.max_growth) continue;
+
+                    chosen.push_back(value);
+                    growth += size;
+                }
+            }
+            if (chosen.empty()) continue;
+
+            std::vector<ValueId> forward;
+            for (ValueId call : chosen) {
+                const IRFunction& callee = module.functions[caller.values[call].immediate];
+                ValueId result = inline_call(caller, call, callee);
+                forward.resize(caller.values.size(), no_value);
+                forward[call] = result;
+            }
+            caller.forward_operands(forward);
+            caller.remove_unreachable_blocks();
+            sizes[caller_index] = function_size(caller);
+            changed = true;
+        }
+    }
+    return changed;
+}
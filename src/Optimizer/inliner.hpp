@@ -0,0 +1,35 @@
+#pragma once
+#include "pass_manager.hpp"
+
+// Sizes count instructions in the callee's blocks, parameters excluded.
+struct InlineCost {
+    size_t budget = 24;             // largest callee inlined at a call outside loops
+    size_t loop_scale = 3;          // budget multiplier per enclosing loop...
+    uint32_t max_loop_levels = 2;   // ...for up to this many loops
+    size_t constant_arg_bonus = 8;  // per constant argument, since it will fold into the body
+    size_t max_growth = 1000;       // instructions inlining may add to one function
+};
+
+// === Inlining ===
+// Replaces calls with a copy of the callee's body, so the scalar passes
+// that follow can fold constant arguments into it and hoist what became
+// invariant. Functions are visited bottom-up over the call graph (Tarjan's
+// strongly connected components), so a callee already holds whatever was
+// inlined into it when its own callers weigh it. A function on a call
+// cycle, direct recursion like factorial included, is never inlined;
+// calls it makes to functions off the cycle still are.
+//
+// A call site is inlined when
+//     callee size - (call + arguments) - constant_arg_bonus * constant args
+// fits the budget, which grows loop_scale-fold per loop around the call:
+// calls in loops run the most, so that is where saving the call pays.
+class Inliner : public IRPass {
+public:
+    explicit Inliner(InlineCost cost = {}) : cost(cost) {}
+
+    const char* name() const override { return "inline"; }
+    bool run(IRModule& module) override;
+
+private:
+    InlineCost cost;
+};
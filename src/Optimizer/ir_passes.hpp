@@ -0,0 +1,107 @@
+#pragma once
+#include "pass_manager.hpp"
+
+// === Scalar Optimizations ===
+// All of them keep the module valid SSA; see IRVerifier for the rules.
+
+// Turns a function's calls to itself in tail position (a call whose result
+// is returned at once, or a void call right before a void return) into
+// jumps back to the top: the entry keeps the parameters and jumps to a new
+// loop header, whose phis take the parameters on the way in and the call's
+// arguments from every former tail call. Recursion like
+// `return sum(n - 1, acc + n);` then runs as a loop in constant stack.
+// Int recursion through one of + and *, `return n * fact(n - 1);`, gets an
+// accumulator phi as well, so it loops the same way.
+class TailRecursionElimination : public IRPass {
+public:
+    const char* name() const override { return "tailrec"; }
+    bool run(IRModule& module) override;
+
+private:
+    bool eliminate(IRFunction& function, size_t index);
+};
+
+// Sparse conditional constant propagation (Wegman-Zadeck): values proven
+// constant become Const, branches on constants become jumps, and blocks
+// that can no longer run are removed. Evaluation uses turd:: arithmetic,
+// so anything that would raise at runtime is left alone.
+class ConstantPropagation : public IRPass {
+public:
+    const char* name() const override { return "constprop"; }
+
+protected:
+    bool run_on_function(IRModule& module, IRFunction& function) override;
+};
+
+// Forwards every Copy to its source and every phi whose operands are all
+// one value (or the phi itself) to that value.
+class CopyPropagation : public IRPass {
+public:
+    const char* name() const override { return "copyprop"; }
+
+protected:
+    bool run_on_function(IRModule& module, IRFunction& function) override;
+};
+
+// Mark and sweep from the instructions with side effects: anything whose
+// value never reaches one of them is removed, dead phi cycles included.
+class DeadCodeElimination : public IRPass {
+public:
+    const char* name() const override { return "dce"; }
+
+protected:
+    bool run_on_function(IRModule& module, IRFunction& function) override;
+};
+
+// Dominator-based value numbering: walks the dominator tree with a scoped
+// hash table of pure expressions, so an expression already computed in a
+// dominating block is reused. Commutative operands are ordered first, and
+// phis merging the same values in the same block are merged too. Within
+// a block, a global load reuses the value last loaded from or stored to
+// that global when no call comes between.
+class GlobalValueNumbering : public IRPass {
+public:
+    const char* name() const override { return "gvn"; }
+
+protected:
+    bool run_on_function(IRModule& module, IRFunction& function) override;
+};
+
+// Moves loop-invariant computations into the loop's preheader, innermost
+// loops first so an invariant can bubble out through several levels.
+// Instructions that can raise (int division, dynamically typed operands)
+// are only hoisted from the header, which runs whenever the loop is
+// entered. Global loads are hoisted when the loop neither stores to that
+// global nor calls a function.
+class LoopInvariantCodeMotion : public IRPass {
+public:
+    const char* name() const override { return "licm"; }
+
+protected:
+    bool run_on_function(IRModule& module, IRFunction& function) override;
+};
+
+// Removes the array bounds checks a range analysis proves pass. Each int
+// value gets an interval, and optionally a bound below an array's length;
+// uses see those narrowed by the dominating branch conditions and passed
+// checks, so in `for (int i = 0; i < len(a); i++)` the index i is known to
+// lie in [0, len(a) - 1]. Int globals get module-wide ranges, which covers
+// loops at the top level, and a global array the entry stores only once is
+// known to be that array. len() of a constant-size array becomes a constant.
+class BoundsCheckElimination : public IRPass {
+public:
+    const char* name() const override { return "bce"; }
+    bool run(IRModule& module) override;
+};
+
+// Folds a block into its only predecessor when that predecessor jumps
+// straight to it, lets predecessors skip blocks that only jump on, turns
+// a branch with both arms on one block into a jump, and drops unreachable
+// blocks.
+class SimplifyCFG : public IRPass {
+public:
+    const char* name() const override { return "simplifycfg"; }
+
+protected:
+    bool run_on_function(IRModule& module, IRFunction& function) override;
+};
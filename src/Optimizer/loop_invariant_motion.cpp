@@ -0,0 +1,128 @@
+#include "ir_passes.hpp"
+#include "../IR/loops.hpp"
+#include <algorithm>
+
+namespace {
+
+// the one block outside the loop that enters its header, or no_block
+BlockId entering_block(const IRFunction& function, const LoopInfo& loops, size_t loop) {
+    BlockId outside = no_block;
+    for (BlockId pred : function.blocks[loops.loops()[loop].header].preds) {
+        if (loops.contains(loop, pred)) continue;
+        if (outside != no_block) return no_block;
+        outside = pred;
+    }
+    return outside;
+}
+
+// every loop gets a block of its own to hoist into, entered only on the way in
+bool insert_preheaders(IRFunction& function) {
+    DominatorTree dominators(function);
+    LoopInfo loops(function, dominators);
+    bool changed = false;
+    for (size_t loop = 0; loop < loops.loops().size(); ++loop) {
+        BlockId outside = entering_block(function, loops, loop);
+        if (outside != no_block && function.blocks[outside].succs.size() > 1) {
+            function.split_edge(outside, loops.loops()[loop].header);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+class Hoister {
+public:
+    explicit Hoister(IRFunction& function)
+        : function(function), dominators(function), loops(function, dominators),
+          in_loop(function.blocks.size(), false) {}
+
+    bool run() {
+        bool changed = false;
+        for (size_t loop = 0; loop < loops.loops().size(); ++loop) {
+            BlockId preheader = entering_block(function, loops, loop);
+            if (preheader == no_block || function.blocks[preheader].succs.size() != 1) continue;
+            changed |= hoist(loops.loops()[loop], preheader);
+        }
+        return changed;
+    }
+
+private:
+    bool hoist(const Loop& loop, BlockId preheader) {
+        for (BlockId block : loop.blocks) in_loop[block] = true;
+
+        bool calls = false;
+        std::vector<int64_t> stored;
+        for (BlockId block : loop.blocks) {
+            for (ValueId value : function.blocks[block].code) {
+                const IRInstruction& instruction = function.values[value];
+                if (instruction.op == Opcode::Call) calls = true;
+                if (instruction.op == Opcode::StoreGlobal) stored.push_back(instruction.immediate);
+            }
+        }
+        auto global_is_invariant = [&](int64_t slot) {
+            return !calls && std::find(stored.begin(), stored.end(), slot) == stored.end();
+        };
+
+        // blocks in dominator order so an invariant's operands are hoisted before it;
+        // repeat because hoisting one value can make a later one invariant
+        bool changed = false, progress = true;
+        while (progress) {
+            progress = false;
+            for (BlockId block : dominators.reverse_postorder()) {
+                if (!in_loop[block]) continue;
+                // before anything with side effects or an error left in place, the header runs exactly when the
+                // loop is entered, so an instruction that can raise may move from there
+                bool guarded = block != loop.header;
+                auto& code = function.blocks[block].code;
+                for (size_t i = 0; i < code.size();) {
+                    ValueId value = code[i];
+                    const IRInstruction& instruction = function.values[value];
+                    if (has_side_effects(instruction.op)) guarded = true;
+                    if (!is_invariant(value, global_is_invariant) || (guarded && function.may_trap(value))) {
+                        // an error raised here must still come first
+                        guarded |= function.may_trap(value);
+                        ++i;
+                        continue;
+                    }
+                    function.move_before_terminator(value, preheader);
+                    changed = progress = true;
+                }
+            }
+        }
+
+        for (BlockId block : loop.blocks) in_loop[block] = false;
+        return changed;
+    }
+
+    template <typename GlobalTest>
+    bool is_invariant(ValueId value, const GlobalTest& global_is_invariant) const {
+        const IRInstruction& instruction = function.values[value];
+        switch (instruction.op) {
+            case Opcode::Phi: case Opcode::Param: case Opcode::Undef:
+            case Opcode::NewArray:          // a new array each iteration
+            case Opcode::LoadElement:       // stays behind its check and the stores before it
+                return false;
+            case Opcode::LoadGlobal:
+                return global_is_invariant(instruction.immediate);
+            default:
+                if (has_side_effects(instruction.op)) return false;
+        }
+        for (uint32_t i = 0; i < instruction.operand_count; ++i) {
+            if (in_loop[function.values[function.operand(value, i)].block]) return false;
+        }
+        return true;
+    }
+
+    IRFunction& function;
+    DominatorTree dominators;
+    LoopInfo loops;
+    std::vector<bool> in_loop;
+};
+
+} // namespace
+
+bool LoopInvariantCodeMotion::run_on_function(IRModule&, IRFunction& function) {
+    bool changed = insert_preheaders(function);
+    // hoisting only moves instructions, so the loops found here stay valid
+    return Hoister(function).run() || changed;
+}
@@ -0,0 +1,105 @@
+#include "pass_manager.hpp"
+#include "ir_passes.hpp"
+#include "inliner.hpp"
+#include "../IR/ir_verifier.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+OptLevel parse_opt_level(const std::string& flag) {
+    std::string level = flag.rfind("-O", 0) == 0 ? flag.substr(2) : flag;
+    if (level == "0") return OptLevel::O0;
+    if (level == "1") return OptLevel::O1;
+    if (level == "2") return OptLevel::O2;
+    throw std::invalid_argument("unknown optimization level '" + flag + "', expected -O0, -O1 or -O2");
+}
+
+bool IRPass::run(IRModule& module) {
+    bool changed = false;
+    for (auto& function : module.functions) {
+        changed |= run_on_function(module, function);
+    }
+    return changed;
+}
+
+// === Pass Manager ===
+
+PassManager PassManager::for_level(OptLevel level, bool verify_each) {
+    PassManager manager(verify_each);
+    switch (level) {
+        case OptLevel::O0:
+            break;
+        case OptLevel::O1:
+            manager.add(std::make_unique<TailRecursionElimination>());
+            manager.add(std::make_unique<ConstantPropagation>());
+            manager.add(std::make_unique<CopyPropagation>());
+            manager.add(std::make_unique<BoundsCheckElimination>());
+            manager.add(std::make_unique<DeadCodeElimination>());
+            manager.add(std::make_unique<SimplifyCFG>());
+            break;
+        case OptLevel::O2:
+            // tail recursion turned into loops leaves those functions off the call
+            // cycles, so they can be inlined; inlining comes next so constant
+            // arguments reach the callee bodies; GVN before LICM leaves one copy
+            // of each invariant to hoist, and the second round merges the hoisted
+            // copies and folds what that exposed; bounds checks go last, once
+            // the loop conditions are in their final shape
+            manager.add(std::make_unique<TailRecursionElimination>());
+            manager.add(std::make_unique<Inliner>());
+            manager.add(std::make_unique<ConstantPropagation>());
+            manager.add(std::make_unique<CopyPropagation>());
+            manager.add(std::make_unique<SimplifyCFG>());
+            manager.add(std::make_unique<GlobalValueNumbering>());
+            manager.add(std::make_unique<LoopInvariantCodeMotion>());
+            manager.add(std::make_unique<GlobalValueNumbering>());
+            manager.add(std::make_unique<ConstantPropagation>());
+            manager.add(std::make_unique<BoundsCheckElimination>());
+            manager.add(std::make_unique<DeadCodeElimination>());
+            manager.add(std::make_unique<SimplifyCFG>());
+            break;
+    }
+    return manager;
+}
+
+void PassManager::add(std::unique_ptr<IRPass> pass) {
+    size_t timing = 0;
+    while (timing < timings.size() && std::strcmp(timings[timing].name, pass->name()) != 0) ++timing;
+    if (timing == timings.size()) timings.push_back({pass->name()});
+    stages.push_back({std::move(pass), timing});
+}
+
+void PassManager::run(IRModule& module) {
+    IRVerifier verifier;
+    for (auto& stage : stages) {
+        auto start = std::chrono::steady_clock::now();
+        bool changed = stage.pass->run(module);
+        auto end = std::chrono::steady_clock::now();
+
+        PassTiming& timing = timings[stage.timing];
+        timing.milliseconds += std::chrono::duration<double, std::milli>(end - start).count();
+        timing.runs++;
+        timing.changed += changed;
+
+        if (verify_each && !verifier.verify(module)) {
+            throw std::logic_error(std::string("IR invalid after ") + stage.pass->name() + ": " +
+                                   verifier.get_errors().front());
+        }
+    }
+}
+
+void PassManager::print_timings(std::ostream& out) const {
+    double total = 0.0;
+    for (const auto& timing : timings) total += timing.milliseconds;
+
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-14s %10s %6s %8s %7s\n", "pass", "ms", "%", "runs", "changed");
+    out << line;
+    for (const auto& timing : timings) {
+        std::snprintf(line, sizeof(line), "%-14s %10.3f %6.1f %8zu %7zu\n", timing.name, timing.milliseconds,
+                      total > 0 ? 100.0 * timing.milliseconds / total : 0.0, timing.runs, timing.changed);
+        out << line;
+    }
+    std::snprintf(line, sizeof(line), "%-14s %10.3f\n", "total", total);
+    out << line;
+}
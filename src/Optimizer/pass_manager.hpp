@@ -0,0 +1,61 @@
+#pragma once
+#include "../IR/ir.hpp"
+#include <memory>
+#include <ostream>
+
+enum class OptLevel {
+    O0,     // lowering only
+    O1,     // cheap cleanups: constant/copy propagation, DCE, CFG simplification
+    O2      // inlining, then O1 plus GVN and loop-invariant code motion, iterated
+};
+
+// "-O0", "-O1", "-O2" (or "0".."2"); throws std::invalid_argument otherwise
+OptLevel parse_opt_level(const std::string& flag);
+
+// === IR Passes ===
+// A pass transforms a module in place and reports whether it changed
+// anything. Most passes work one function at a time and only override
+// run_on_function; passes that look across functions override run.
+class IRPass {
+public:
+    virtual ~IRPass() = default;
+    virtual const char* name() const = 0;
+    virtual bool run(IRModule& module);
+
+protected:
+    virtual bool run_on_function(IRModule&, IRFunction&) { return false; }
+};
+
+struct PassTiming {
+    const char* name;
+    double milliseconds = 0.0;
+    size_t runs = 0;
+    size_t changed = 0;     // runs that changed the module
+};
+
+// === Pass Manager ===
+// Runs a pipeline of passes over a module, timing every pass. With
+// verify_each set, IRVerifier runs after every pass and a broken module
+// throws std::logic_error naming the pass that broke it.
+class PassManager {
+public:
+    explicit PassManager(bool verify_each = false) : verify_each(verify_each) {}
+
+    static PassManager for_level(OptLevel level, bool verify_each = false);
+
+    void add(std::unique_ptr<IRPass> pass);
+    void run(IRModule& module);
+
+    const std::vector<PassTiming>& get_timings() const { return timings; }
+    void print_timings(std::ostream& out) const;
+
+private:
+    struct Stage {
+        std::unique_ptr<IRPass> pass;
+        size_t timing;      // index into timings, shared by repeats of the same pass
+    };
+
+    bool verify_each;
+    std::vector<Stage> stages;
+    std::vector<PassTiming> timings;
+};
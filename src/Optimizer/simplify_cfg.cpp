@@ -0,0 +1,80 @@
+#include "ir_passes.hpp"
+#include <algorithm>
+
+bool SimplifyCFG::run_on_function(IRModule&, IRFunction& function) {
+    bool changed = false;
+
+    // a block that only jumps on is skipped by its predecessors; with phis in
+    // the target the incoming values would need a slot per new edge, so not then
+    for (BlockId block = 1; block < function.blocks.size(); ++block) {
+        IRBlock& empty = function.blocks[block];
+        if (empty.code.size() != 1 || empty.succs.size() != 1 || empty.preds.empty()) continue;
+        BlockId target = empty.succs[0];
+        const auto& target_code = function.blocks[target].code;
+        if (target == block || function.values[target_code.front()].op == Opcode::Phi) continue;
+
+        auto& target_preds = function.blocks[target].preds;
+        target_preds.erase(std::find(target_preds.begin(), target_preds.end(), block));
+        for (BlockId pred : empty.preds) {
+            std::replace(function.blocks[pred].succs.begin(), function.blocks[pred].succs.end(), block, target);
+            target_preds.push_back(pred);
+        }
+        empty.preds.clear();
+        empty.succs.clear();
+        changed = true;
+    }
+
+    // a branch whose arms meet at once decides nothing
+    for (BlockId block = 0; block < function.blocks.size(); ++block) {
+        ValueId end = function.terminator(block);
+        auto& succs = function.blocks[block].succs;
+        if (end == no_value || function.values[end].op != Opcode::Branch || succs[0] != succs[1]) continue;
+        function.remove_edge(block, succs[1]);
+        function.values[end].op = Opcode::Jump;
+        function.values[end].operand_count = 0;
+        changed = true;
+    }
+
+    // merge s into b when b jumps straight to s and nothing else enters s
+    std::vector<ValueId> forward(function.values.size(), no_value);
+    bool forwarded = false;
+    for (BlockId block = 0; block < function.blocks.size(); ++block) {
+        while (true) {
+            auto& succs = function.blocks[block].succs;
+            if (function.blocks[block].code.empty() || succs.size() != 1) break;
+            BlockId next = succs[0];
+            if (next == block || next == 0 || function.blocks[next].preds.size() != 1) break;
+
+            IRBlock absorbed = std::move(function.blocks[next]);
+            function.blocks[next] = IRBlock();
+            function.remove(function.terminator(block));
+
+            for (ValueId value : absorbed.code) {
+                IRInstruction& instruction = function.values[value];
+                if (instruction.op == Opcode::Phi) {
+                    // one predecessor, so one operand
+                    forward[value] = function.operand(value, 0);
+                    instruction.op = Opcode::Nop;
+                    instruction.block = no_block;
+                    instruction.operand_count = 0;
+                    forwarded = true;
+                    continue;
+                }
+                instruction.block = block;
+                function.blocks[block].code.push_back(value);
+            }
+
+            function.blocks[block].succs = absorbed.succs;
+            for (BlockId succ : absorbed.succs) {
+                auto& preds = function.blocks[succ].preds;
+                std::replace(preds.begin(), preds.end(), next, block);
+            }
+            changed = true;
+        }
+    }
+    if (forwarded) function.forward_operands(forward);
+
+    // merged blocks are left empty and unreachable
+    changed |= function.remove_unreachable_blocks() != 0;
+    return changed;
+}
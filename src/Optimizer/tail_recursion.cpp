@@ -0,0 +1,179 @@
+#include "ir_passes.hpp"
+#include <algorithm>
+
+namespace {
+
+// the call in `block` to the function itself whose result the block
+// returns straight away, or no_value
+ValueId tail_self_call(const IRFunction& function, size_t index, BlockId block) {
+    const auto& code = function.blocks[block].code;
+    if (code.size() < 2) return no_value;
+    ValueId end = code.back(), call = code[code.size() - 2];
+    const IRInstruction& ret = function.values[end];
+    const IRInstruction& instruction = function.values[call];
+    if (ret.op != Opcode::Return || instruction.op != Opcode::Call || instruction.immediate != static_cast<int64_t>(index)) {
+        return no_value;
+    }
+    bool returned = ret.operand_count == 0 ? instruction.type == TypeId::Void : function.operand(end, 0) == call;
+    return returned && instruction.type == function.returnType ? call : no_value;
+}
+
+// The call in `block` to the function itself whose int result only feeds
+// the `add` or `mul` the block returns: `ret (x op call)`. `other` is x,
+// computed before the call. Wrapping int + and * are associative and
+// commutative, so the operator can be applied on the way down instead;
+// float arithmetic is neither and stays recursive.
+struct Accumulation {
+    ValueId call = no_value;
+    ValueId other = no_value;
+    Opcode op = Opcode::Nop;
+};
+
+Accumulation accumulated_self_call(const IRFunction& function, size_t index, BlockId block) {
+    const auto& code = function.blocks[block].code;
+    if (code.size() < 3 || function.returnType != TypeId::Int) return {};
+    // constants may sit between the call and the operator: `f(n - 1) * 2`
+    size_t position = code.size() - 3;
+    while (position > 0 && function.values[code[position]].op == Opcode::Const) --position;
+    ValueId end = code.back(), result = code[code.size() - 2], call = code[position];
+    const IRInstruction& ret = function.values[end];
+    const IRInstruction& arithmetic = function.values[result];
+    const IRInstruction& instruction = function.values[call];
+    if (ret.op != Opcode::Return || ret.operand_count != 1 || function.operand(end, 0) != result) return {};
+    if ((arithmetic.op != Opcode::Add && arithmetic.op != Opcode::Mul) || arithmetic.type != TypeId::Int) return {};
+    if (instruction.op != Opcode::Call || instruction.immediate != static_cast<int64_t>(index)) return {};
+
+    ValueId left = function.operand(result, 0), right = function.operand(result, 1);
+    if (left == right || (left != call && right != call)) return {};
+    return {call, left == call ? right : left, arithmetic.op};
+}
+
+// Moves everything but the parameters out of the entry into a new block
+// the entry jumps to, which is returned. Each parameter's uses move to a
+// phi in that block; `phis` gets them in parameter order, operands unset.
+BlockId add_loop_header(IRFunction& function, std::vector<ValueId>& params, std::vector<ValueId>& phis) {
+    BlockId header = function.add_block();
+    for (ValueId value : function.blocks[0].code) {
+        if (function.values[value].op == Opcode::Param) {
+            params.push_back(value);
+        } else {
+            function.values[value].block = header;
+            function.blocks[header].code.push_back(value);
+        }
+    }
+    function.blocks[0].code = params;
+    function.blocks[header].succs = std::move(function.blocks[0].succs);
+    function.blocks[0].succs.clear();
+    for (BlockId succ : function.blocks[header].succs) {
+        auto& preds = function.blocks[succ].preds;
+        std::replace(preds.begin(), preds.end(), BlockId(0), header);
+    }
+    function.append(0, Opcode::Jump, TypeId::Void);
+    function.add_edge(0, header);
+
+    for (ValueId param : params) {
+        ValueId phi = function.append(header, Opcode::Phi, function.values[param].type);
+        function.replace_all_uses(param, phi);
+        phis.push_back(phi);
+    }
+    return header;
+}
+
+} // namespace
+
+bool TailRecursionElimination::run(IRModule& module) {
+    bool changed = false;
+    for (size_t index = 0; index < module.functions.size(); ++index) {
+        if (index != module.entry) changed |= eliminate(module.functions[index], index);
+    }
+    return changed;
+}
+
+// Tail calls to the function itself, plus, when every other return hands
+// back an int, the calls whose result feeds one associative operator: those
+// become tail calls too once an accumulator carries the pending operations.
+// `return n * fact(n - 1)` multiplies n into the accumulator and jumps back,
+// and each remaining return gives back `accumulator op value`, starting from
+// the operator's identity. All accumulated calls must share one operator.
+bool TailRecursionElimination::eliminate(IRFunction& function, size_t index) {
+    std::vector<Accumulation> sites;       // other == no_value for a plain tail call
+    bool accumulate = true;
+    for (BlockId block = 0; block < function.blocks.size(); ++block) {
+        ValueId call = tail_self_call(function, index, block);
+        Accumulation site = accumulated_self_call(function, index, block);
+        ValueId end = function.terminator(block);
+        if (call != no_value) {
+            sites.push_back({call, no_value, Opcode::Nop});
+        } else if (site.call != no_value) {
+            sites.push_back(site);
+        } else if (end != no_value && function.values[end].op == Opcode::Return) {
+            // a base case: its value is combined with the accumulator
+            accumulate = accumulate && function.values[end].operand_count == 1 &&
+                         function.values[function.operand(end, 0)].type == TypeId::Int;
+        }
+    }
+    Opcode op = Opcode::Nop;
+    for (const Accumulation& site : sites) {
+        if (site.other == no_value) continue;
+        if (op != Opcode::Nop && site.op != op) accumulate = false;
+        op = site.op;
+    }
+    if (!accumulate || op == Opcode::Nop) {
+        op = Opcode::Nop;
+        sites.erase(std::remove_if(sites.begin(), sites.end(),
+                                   [](const Accumulation& site) { return site.other != no_value; }),
+                    sites.end());
+    }
+    if (sites.empty()) return false;
+
+    std::vector<ValueId> params, phis;
+    BlockId header = add_loop_header(function, params, phis);
+    ValueId accumulator = no_value;
+    std::vector<ValueId> accumulated;
+    if (op != Opcode::Nop) {
+        ValueId identity = function.append(0, Opcode::Const, TypeId::Int, {}, op == Opcode::Mul ? 1 : 0);
+        function.move_before_terminator(identity, 0);
+        accumulator = function.append(header, Opcode::Phi, TypeId::Int);
+        accumulated.push_back(identity);
+    }
+
+    // each call becomes a jump back, its arguments the phis' incoming values
+    std::vector<std::vector<ValueId>> incoming;
+    for (ValueId param : params) incoming.push_back({param});
+    for (const Accumulation& site : sites) {
+        ValueId call = site.call;
+        BlockId block = function.values[call].block;
+        for (size_t i = 0; i < params.size(); ++i) {
+            incoming[i].push_back(function.operand(call, static_cast<uint32_t>(function.values[params[i]].immediate)));
+        }
+        int line = function.values[call].line;
+        ValueId end = function.terminator(block);
+        ValueId result = site.other != no_value ? function.operand(end, 0) : no_value;
+        function.remove(end);
+        if (result != no_value) function.remove(result);
+        function.remove(call);
+        if (site.other != no_value) {
+            // a parameter's uses have moved to its phi
+            auto param = std::find(params.begin(), params.end(), site.other);
+            ValueId other = param != params.end() ? phis[param - params.begin()] : site.other;
+            accumulated.push_back(function.append(block, op, TypeId::Int, {accumulator, other}, 0, line));
+        } else if (accumulator != no_value) {
+            accumulated.push_back(accumulator);
+        }
+        function.append(block, Opcode::Jump, TypeId::Void, {}, 0, line);
+        function.add_edge(block, header);
+    }
+    for (size_t i = 0; i < phis.size(); ++i) function.set_operands(phis[i], incoming[i]);
+    if (accumulator == no_value) return true;
+    function.set_operands(accumulator, accumulated);
+
+    for (BlockId block = 0; block < function.blocks.size(); ++block) {
+        ValueId end = function.terminator(block);
+        if (end == no_value || function.values[end].op != Opcode::Return) continue;
+        ValueId value = function.append(block, op, TypeId::Int, {accumulator, function.operand(end, 0)}, 0,
+                                        function.values[end].line);
+        function.move_before_terminator(value, block);
+        function.set_operands(end, {value});
+    }
+    return true;
+}
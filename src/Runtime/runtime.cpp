@@ -0,0 +1,492 @@
+#include "runtime.hpp"
+#include "../Support/arithmetic.hpp"
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// plain C style throughout: native executables link this without libstdc++
+
+struct TurdDynamic {
+    enum Kind : int32_t { Int, Float, Bool, Char, String } kind;
+    union {
+        int32_t integer;
+        double number;
+        turd_string text;
+    };
+};
+
+namespace {
+
+const char* error_message(int32_t error) {
+    switch (error) {
+        case TURD_DIVISION_BY_ZERO: return "division by zero";
+        case TURD_DIVISION_OVERFLOW: return "integer division overflow";
+        case TURD_ZERO_TO_NEGATIVE_POWER: return "zero raised to a negative power";
+        case TURD_FLOOR_DIVISION_RANGE: return "floor division result does not fit an int";
+        case TURD_TYPE_MISMATCH: return "operand has the wrong type";
+        case TURD_BAD_INPUT: return "input is not a value of the requested type";
+        case TURD_INDEX_OUT_OF_RANGE: return "array index out of range";
+        case TURD_ARRAY_SIZE: return "negative or too large array size";
+        default: return "unknown error";
+    }
+}
+
+const char* kind_name(const TurdDynamic* value) {
+    if (value == nullptr) return "undefined";
+    switch (value->kind) {
+        case TurdDynamic::Int: return "int";
+        case TurdDynamic::Float: return "float";
+        case TurdDynamic::Bool: return "bool";
+        case TurdDynamic::Char: return "char";
+        case TurdDynamic::String: return "string";
+    }
+    return "?";
+}
+
+[[noreturn]] void type_error(const char* expected, turd_dynamic value, int32_t line) {
+    std::fflush(stdout);
+    std::fprintf(stderr, "runtime error at line %d: expected %s, got %s\n", line, expected, kind_name(value));
+    std::exit(1);
+}
+
+// boxes and strings live until exit; programs are short-lived
+void* allocate(size_t size) {
+    static char* chunk = nullptr;
+    static size_t left = 0;
+    size = (size + 15) & ~static_cast<size_t>(15);
+    if (size > 4096) return std::malloc(size);
+    if (size > left) {
+        chunk = static_cast<char*>(std::malloc(64 * 1024));
+        left = 64 * 1024;
+    }
+    void* block = chunk;
+    chunk += size;
+    left -= size;
+    return block;
+}
+
+// === String Storage ===
+
+// the characters of long strings; every string in it starts at characters()
+struct StringBuffer {
+    uint32_t used;          // length of the longest string in the buffer
+    uint32_t capacity;      // characters it can hold, not counting a NUL after them
+
+    char* characters() { return reinterpret_cast<char*>(this + 1); }
+};
+
+StringBuffer* buffer_of(turd_string value) {
+    return reinterpret_cast<StringBuffer*>(const_cast<char*>(value->text)) - 1;
+}
+
+const char* text_of(turd_string value) {
+    return value != nullptr ? value->text : "";
+}
+
+uint32_t length_of(turd_string value) {
+    return value != nullptr ? value->length : 0;
+}
+
+// a string of `length` characters, to be written at its text, in a buffer
+// with room for `capacity` of them unless it is short
+TurdString* new_string(uint32_t length, uint32_t capacity) {
+    TurdString* string = static_cast<TurdString*>(allocate(sizeof(TurdString)));
+    string->length = length;
+    string->flags = 0;
+    if (capacity < TURD_SMALL_STRING) {
+        string->small[length] = '\0';
+        string->text = string->small;
+        return string;
+    }
+    StringBuffer* buffer = static_cast<StringBuffer*>(allocate(sizeof(StringBuffer) + capacity + 1));
+    buffer->used = length;
+    buffer->capacity = capacity;
+    buffer->characters()[length] = '\0';
+    string->text = buffer->characters();
+    string->flags = TURD_STRING_BUFFERED;
+    return string;
+}
+
+char* characters(TurdString* string) {
+    return const_cast<char*>(string->text);
+}
+
+// bytes per array element, as runtime.hpp lays them out
+size_t element_size(int32_t element) {
+    switch (element) {
+        case TURD_ELEMENT_FLOAT: return sizeof(double);
+        case TURD_ELEMENT_STRING: return sizeof(turd_string);
+        default: return sizeof(int32_t);
+    }
+}
+
+TurdDynamic* box(TurdDynamic::Kind kind) {
+    TurdDynamic* value = static_cast<TurdDynamic*>(allocate(sizeof(TurdDynamic)));
+    value->kind = kind;
+    return value;
+}
+
+// reads one line without its newline; false at end of input
+bool read_line(char* buffer, size_t size) {
+    if (std::fgets(buffer, static_cast<int>(size), stdin) == nullptr) return false;
+    size_t length = std::strlen(buffer);
+    if (length > 0 && buffer[length - 1] == '\n') buffer[--length] = '\0';
+    if (length > 0 && buffer[length - 1] == '\r') buffer[--length] = '\0';
+    return true;
+}
+
+bool only_blanks(const char* text) {
+    while (*text == ' ' || *text == '\t') ++text;
+    return *text == '\0';
+}
+
+bool is_number(const TurdDynamic* value) {
+    return value != nullptr && (value->kind == TurdDynamic::Int || value->kind == TurdDynamic::Float);
+}
+
+double as_double(const TurdDynamic* value) {
+    return value->kind == TurdDynamic::Int ? value->integer : value->number;
+}
+
+int32_t int_binary(int32_t op, int32_t a, int32_t b, int32_t line) {
+    int64_t x = a, y = b;
+    switch (op) {
+        case TURD_ADD: return turd::wrap(x + y);
+        case TURD_SUB: return turd::wrap(x - y);
+        case TURD_MUL: return turd::wrap(x * y);
+        case TURD_POW: return turd_pow_int(a, b, line);
+        case TURD_SHR: return a >> (b & 31);
+        default: break;
+    }
+    if (b == 0) turd_error(TURD_DIVISION_BY_ZERO, line);
+    if (turd::int_division_traps(a, b)) turd_error(TURD_DIVISION_OVERFLOW, line);
+    if (op == TURD_DIV) return a / b;
+    if (op == TURD_MOD) return a % b;
+    return turd::int_floor_div(a, b);
+}
+
+template <typename T>
+int32_t compare(int32_t op, T a, T b) {
+    switch (op) {
+        case TURD_EQ: return a == b;
+        case TURD_NE: return a != b;
+        case TURD_LT: return a < b;
+        case TURD_LE: return a <= b;
+        case TURD_GT: return a > b;
+        default: return a >= b;
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+void turd_runtime_init(void) {
+    static char output[1 << 16];
+    std::setvbuf(stdout, output, _IOFBF, sizeof(output));
+}
+
+void turd_runtime_exit(void) {
+    std::fflush(stdout);
+}
+
+void turd_error(int32_t error, int32_t line) {
+    std::fflush(stdout);
+    std::fprintf(stderr, "runtime error at line %d: %s\n", line, error_message(error));
+    std::exit(1);
+}
+
+// === Printing ===
+
+void turd_print_int(int32_t value) {
+    std::printf("%d", value);
+}
+
+void turd_print_float(double value) {
+    char buffer[32];
+    std::fwrite(buffer, 1, turd::format_float(value, buffer), stdout);
+}
+
+void turd_print_bool(int32_t value) {
+    std::fputs(value ? "true" : "false", stdout);
+}
+
+void turd_print_char(int32_t value) {
+    std::putchar(value);
+}
+
+void turd_print_string(turd_string value) {
+    if (value != nullptr) std::fwrite(value->text, 1, value->length, stdout);
+}
+
+void turd_print_dynamic(turd_dynamic value) {
+    if (value == nullptr) type_error("a value", value, -1);
+    switch (value->kind) {
+        case TurdDynamic::Int: turd_print_int(value->integer); break;
+        case TurdDynamic::Float: turd_print_float(value->number); break;
+        case TurdDynamic::Bool: turd_print_bool(value->integer); break;
+        case TurdDynamic::Char: turd_print_char(value->integer); break;
+        case TurdDynamic::String: turd_print_string(value->text); break;
+    }
+}
+
+void turd_print_separator(void) {
+    std::putchar(' ');
+}
+
+void turd_print_newline(void) {
+    std::putchar('\n');
+}
+
+// === Reading ===
+
+int32_t turd_read_int(int32_t line) {
+    char buffer[256];
+    if (!read_line(buffer, sizeof(buffer))) turd_error(TURD_BAD_INPUT, line);
+    char* end;
+    errno = 0;
+    long value = std::strtol(buffer, &end, 10);
+    if (end == buffer || !only_blanks(end) || errno != 0 || value < INT32_MIN || value > INT32_MAX) {
+        turd_error(TURD_BAD_INPUT, line);
+    }
+    return static_cast<int32_t>(value);
+}
+
+double turd_read_float(int32_t line) {
+    char buffer[256];
+    if (!read_line(buffer, sizeof(buffer))) turd_error(TURD_BAD_INPUT, line);
+    char* end;
+    double value = std::strtod(buffer, &end);
+    if (end == buffer || !only_blanks(end)) turd_error(TURD_BAD_INPUT, line);
+    return value;
+}
+
+int32_t turd_read_bool(int32_t line) {
+    char buffer[256];
+    if (!read_line(buffer, sizeof(buffer))) turd_error(TURD_BAD_INPUT, line);
+    if (std::strcmp(buffer, "true") == 0) return 1;
+    if (std::strcmp(buffer, "false") == 0) return 0;
+    turd_error(TURD_BAD_INPUT, line);
+}
+
+int32_t turd_read_char(int32_t line) {
+    char buffer[256];
+    if (!read_line(buffer, sizeof(buffer)) || buffer[0] == '\0') turd_error(TURD_BAD_INPUT, line);
+    return static_cast<unsigned char>(buffer[0]);
+}
+
+turd_string turd_read_string(void) {
+    size_t capacity = 128, length = 0;
+    char* text = static_cast<char*>(std::malloc(capacity));
+    int c;
+    while ((c = std::getchar()) != EOF && c != '\n') {
+        if (length + 1 == capacity) text = static_cast<char*>(std::realloc(text, capacity *= 2));
+        text[length++] = static_cast<char>(c);
+    }
+    if (length > 0 && text[length - 1] == '\r') --length;
+    turd_string value = turd_string_make(text, static_cast<uint32_t>(length));
+    std::free(text);
+    return value;
+}
+
+// === Arithmetic ===
+
+int32_t turd_pow_int(int32_t base, int32_t exponent, int32_t line) {
+    if (turd::int_pow_traps(base, exponent)) turd_error(TURD_ZERO_TO_NEGATIVE_POWER, line);
+    return turd::int_pow(base, exponent);
+}
+
+int32_t turd_floor_div_float(double a, double b, int32_t line) {
+    int32_t quotient;
+    if (!turd::float_floor_div(a, b, quotient)) turd_error(TURD_FLOOR_DIVISION_RANGE, line);
+    return quotient;
+}
+
+// === Strings ===
+
+turd_string turd_string_make(const char* text, uint32_t length) {
+    TurdString* string = new_string(length, length);
+    std::memcpy(characters(string), text, length);
+    return string;
+}
+
+turd_string turd_string_concat(turd_string a, turd_string b) {
+    uint32_t left = length_of(a), right = length_of(b);
+    if (right == 0 && a != nullptr) return a;
+    if (left == 0) return b;    // null too when both are empty, which still reads as ""
+    uint32_t length = left + right;
+
+    // a is the longest string in its buffer: b goes right after it, and the
+    // result shares the buffer with a, which still ends where it did
+    if (a->flags & TURD_STRING_BUFFERED) {
+        StringBuffer* buffer = buffer_of(a);
+        if (buffer->used == left && buffer->capacity - left >= right) {
+            std::memcpy(buffer->characters() + left, text_of(b), right);
+            buffer->characters()[length] = '\0';
+            buffer->used = length;
+            TurdString* string = static_cast<TurdString*>(allocate(sizeof(TurdString)));
+            string->text = a->text;
+            string->length = length;
+            string->flags = TURD_STRING_BUFFERED;
+            return string;
+        }
+    }
+    // room to grow, so a loop appending to the result doesn't copy it again
+    TurdString* string = new_string(length, length < TURD_SMALL_STRING || length > UINT32_MAX / 2 ? length : 2 * length);
+    std::memcpy(characters(string), text_of(a), left);
+    std::memcpy(characters(string) + left, text_of(b), right);
+    return string;
+}
+
+int32_t turd_string_compare(turd_string a, turd_string b) {
+    uint32_t left = length_of(a), right = length_of(b);
+    int order = std::memcmp(text_of(a), text_of(b), left < right ? left : right);
+    if (order != 0) return order;
+    return left < right ? -1 : left > right;
+}
+
+int32_t turd_string_equal(turd_string a, turd_string b) {
+    if (a == b) return 1;
+    uint32_t length = length_of(a);
+    if (length != length_of(b)) return 0;
+    if (a != nullptr && b != nullptr && (a->flags & b->flags & TURD_STRING_INTERNED)) return 0;
+    return std::memcmp(text_of(a), text_of(b), length) == 0;
+}
+
+void turd_string_init_literal(TurdString* literal, const char* text, uint32_t length) {
+    std::memset(literal, 0, sizeof(*literal));
+    literal->text = text;
+    literal->length = length;
+    literal->flags = TURD_STRING_INTERNED;
+}
+
+// === Dynamic Values ===
+
+turd_dynamic turd_box_int(int32_t value) {
+    TurdDynamic* boxed = box(TurdDynamic::Int);
+    boxed->integer = value;
+    return boxed;
+}
+
+turd_dynamic turd_box_float(double value) {
+    TurdDynamic* boxed = box(TurdDynamic::Float);
+    boxed->number = value;
+    return boxed;
+}
+
+turd_dynamic turd_box_bool(int32_t value) {
+    TurdDynamic* boxed = box(TurdDynamic::Bool);
+    boxed->integer = value != 0;
+    return boxed;
+}
+
+turd_dynamic turd_box_char(int32_t value) {
+    TurdDynamic* boxed = box(TurdDynamic::Char);
+    boxed->integer = value;
+    return boxed;
+}
+
+turd_dynamic turd_box_string(turd_string value) {
+    TurdDynamic* boxed = box(TurdDynamic::String);
+    boxed->text = value;
+    return boxed;
+}
+
+int32_t turd_unbox_int(turd_dynamic value, int32_t line) {
+    if (value == nullptr || value->kind != TurdDynamic::Int) type_error("int", value, line);
+    return value->integer;
+}
+
+double turd_unbox_float(turd_dynamic value, int32_t line) {
+    if (!is_number(value)) type_error("float", value, line);
+    return as_double(value);
+}
+
+int32_t turd_unbox_bool(turd_dynamic value, int32_t line) {
+    if (value == nullptr || value->kind != TurdDynamic::Bool) type_error("bool", value, line);
+    return value->integer;
+}
+
+int32_t turd_unbox_char(turd_dynamic value, int32_t line) {
+    if (value == nullptr || value->kind != TurdDynamic::Char) type_error("char", value, line);
+    return value->integer;
+}
+
+turd_string turd_unbox_string(turd_dynamic value, int32_t line) {
+    if (value == nullptr || value->kind != TurdDynamic::String) type_error("string", value, line);
+    return value->text;
+}
+
+turd_dynamic turd_dynamic_binary(int32_t op, turd_dynamic a, turd_dynamic b, int32_t line) {
+    if (is_number(a) && is_number(b)) {
+        if (a->kind == TurdDynamic::Int && b->kind == TurdDynamic::Int) {
+            return turd_box_int(int_binary(op, a->integer, b->integer, line));
+        }
+        double x = as_double(a), y = as_double(b);
+        switch (op) {
+            case TURD_ADD: return turd_box_float(x + y);
+            case TURD_SUB: return turd_box_float(x - y);
+            case TURD_MUL: return turd_box_float(x * y);
+            case TURD_DIV: return turd_box_float(x / y);
+            case TURD_MOD: return turd_box_float(std::fmod(x, y));
+            case TURD_POW: return turd_box_float(std::pow(x, y));
+            case TURD_FLOOR_DIV: return turd_box_int(turd_floor_div_float(x, y, line));
+            default: type_error("int", a->kind == TurdDynamic::Float ? a : b, line);
+        }
+    }
+    if (op == TURD_ADD && a != nullptr && b != nullptr &&
+        a->kind == TurdDynamic::String && b->kind == TurdDynamic::String) {
+        return turd_box_string(turd_string_concat(a->text, b->text));
+    }
+    bool text = op == TURD_ADD && ((a != nullptr && a->kind == TurdDynamic::String) ||
+                                   (b != nullptr && b->kind == TurdDynamic::String));
+    if (text) type_error("string", a != nullptr && a->kind == TurdDynamic::String ? b : a, line);
+    type_error("a number", is_number(a) ? b : a, line);
+}
+
+turd_dynamic turd_dynamic_negate(turd_dynamic value, int32_t line) {
+    if (!is_number(value)) type_error("a number", value, line);
+    if (value->kind == TurdDynamic::Int) return turd_box_int(turd::wrap(-static_cast<int64_t>(value->integer)));
+    return turd_box_float(-value->number);
+}
+
+int32_t turd_dynamic_compare(int32_t op, turd_dynamic a, turd_dynamic b, int32_t line) {
+    if (a == nullptr) type_error("a value", a, line);
+    if (b == nullptr) type_error("a value", b, line);
+    if (is_number(a) && is_number(b)) {
+        if (a->kind == TurdDynamic::Int && b->kind == TurdDynamic::Int) return compare(op, a->integer, b->integer);
+        return compare(op, as_double(a), as_double(b));
+    }
+    if (a->kind != b->kind) {
+        if (op == TURD_EQ || op == TURD_NE) return op == TURD_NE;
+        type_error(kind_name(a), b, line);
+    }
+    switch (a->kind) {
+        case TurdDynamic::String:
+            if (op == TURD_EQ || op == TURD_NE) return compare(op, turd_string_equal(a->text, b->text), 1);
+            return compare(op, turd_string_compare(a->text, b->text), 0);
+        case TurdDynamic::Bool:
+            if (op != TURD_EQ && op != TURD_NE) type_error("an ordered value", a, line);
+            return compare(op, a->integer, b->integer);
+        default: return compare(op, a->integer, b->integer);
+    }
+}
+
+// === Arrays ===
+
+TurdArray turd_empty_array = {0, TURD_ELEMENT_INT};
+
+turd_array turd_array_new(int32_t length, int32_t element, int32_t line) {
+    if (length < 0) turd_error(TURD_ARRAY_SIZE, line);
+    size_t bytes = static_cast<size_t>(length) * element_size(element);
+    TurdArray* array = static_cast<TurdArray*>(allocate(sizeof(TurdArray) + bytes));
+    if (array == nullptr) turd_error(TURD_ARRAY_SIZE, line);
+    array->length = length;
+    array->element = static_cast<uint32_t>(element);
+    std::memset(array + 1, 0, bytes);
+    return array;
+}
+
+}
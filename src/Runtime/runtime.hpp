@@ -0,0 +1,147 @@
+#pragma once
+#include <cstdint>
+
+// === Turd Runtime ===
+// What compiled Turd code calls for anything it doesn't inline: printing,
+// reading, string operations, dynamically typed values and runtime errors.
+// The interface is plain C so generated assembly can call it with the
+// System V ABI. The same sources are linked into the compiler and archived
+// as libturd_runtime.a for native executables.
+//
+// Values travel as:
+//   int, bool, char   int32_t (bool is 0/1, char its code)
+//   float             double
+//   string            turd_string, a TurdString pointer (see Strings); null reads as ""
+//   array             turd_array, a TurdArray pointer (see Arrays); never null
+//   dynamic           turd_dynamic, used where the static type is Unknown
+//
+// Functions that can fail take the source line so the error can name it.
+
+extern "C" {
+
+typedef const struct TurdString* turd_string;
+typedef const struct TurdDynamic* turd_dynamic;
+typedef struct TurdArray* turd_array;
+
+enum TurdError : int32_t {
+    TURD_DIVISION_BY_ZERO,
+    TURD_DIVISION_OVERFLOW,         // INT_MIN / -1
+    TURD_ZERO_TO_NEGATIVE_POWER,
+    TURD_FLOOR_DIVISION_RANGE,      // float // float outside int
+    TURD_TYPE_MISMATCH,             // dynamically typed operands that don't fit
+    TURD_BAD_INPUT,                 // read() found no value of the requested type
+    TURD_INDEX_OUT_OF_RANGE,        // a[i] with i < 0 or i >= len(a)
+    TURD_ARRAY_SIZE                 // 'int a[n];' with n < 0, or too large to allocate
+};
+
+// operators a dynamically typed instruction can perform
+enum TurdOperator : int32_t {
+    TURD_ADD, TURD_SUB, TURD_MUL, TURD_DIV, TURD_MOD, TURD_FLOOR_DIV, TURD_POW, TURD_SHR,
+    TURD_EQ, TURD_NE, TURD_LT, TURD_LE, TURD_GT, TURD_GE
+};
+
+void turd_runtime_init(void);
+void turd_runtime_exit(void);      // flushes output
+[[noreturn]] void turd_error(int32_t error, int32_t line);
+
+// === Printing ===
+// print(a, b) writes its values separated by one space, then a newline
+void turd_print_int(int32_t value);
+void turd_print_float(double value);
+void turd_print_bool(int32_t value);
+void turd_print_char(int32_t value);
+void turd_print_string(turd_string value);
+void turd_print_dynamic(turd_dynamic value);
+void turd_print_separator(void);
+void turd_print_newline(void);
+
+// === Reading ===
+// read() consumes one line of stdin; numbers may be surrounded by blanks
+int32_t turd_read_int(int32_t line);
+double turd_read_float(int32_t line);
+int32_t turd_read_bool(int32_t line);         // "true" or "false"
+int32_t turd_read_char(int32_t line);         // first character of the line
+turd_string turd_read_string(void);           // "" at end of input
+
+// === Arithmetic ===
+int32_t turd_pow_int(int32_t base, int32_t exponent, int32_t line);
+int32_t turd_floor_div_float(double a, double b, int32_t line);
+
+// === Strings ===
+// A string never changes once made. Its characters are the `length` bytes
+// at `text`, which need not be NUL-terminated: strings grown by appending
+// share one buffer.
+//   - Short strings, up to TURD_SMALL_STRING - 1 bytes, keep their
+//     characters in `small`, so one allocation holds everything.
+//   - Longer ones point into a growable buffer. `a + b` appends b in place
+//     when a is the longest string in its buffer and there is room; the
+//     buffer doubles otherwise. `s = s + x` in a loop then copies each
+//     character a constant number of times, not once per iteration.
+//   - Literals are interned by the compiler: one read-only object per
+//     distinct text, with its length filled in. Two interned strings are
+//     equal exactly when their pointers are.
+enum TurdStringFlags : uint32_t {
+    TURD_STRING_INTERNED = 1,       // a literal; no other interned string has its text
+    TURD_STRING_BUFFERED = 2        // `text` starts a growable buffer's characters
+};
+
+#define TURD_SMALL_STRING 32
+
+struct TurdString {
+    const char* text;
+    uint32_t length;
+    uint32_t flags;
+    char small[TURD_SMALL_STRING];
+};
+
+turd_string turd_string_make(const char* text, uint32_t length);    // copies the characters
+turd_string turd_string_concat(turd_string a, turd_string b);
+int32_t turd_string_compare(turd_string a, turd_string b);   // <0, 0, >0 like strcmp
+int32_t turd_string_equal(turd_string a, turd_string b);     // 1 or 0
+// fills in a literal whose characters outlive it, interned, for
+// a compiler that keeps its pool in memory rather than in the executable
+void turd_string_init_literal(struct TurdString* literal, const char* text, uint32_t length);
+
+// === Dynamic Values ===
+turd_dynamic turd_box_int(int32_t value);
+turd_dynamic turd_box_float(double value);
+turd_dynamic turd_box_bool(int32_t value);
+turd_dynamic turd_box_char(int32_t value);
+turd_dynamic turd_box_string(turd_string value);
+
+// unboxing to a type the value doesn't have is TURD_TYPE_MISMATCH, except int to float
+int32_t turd_unbox_int(turd_dynamic value, int32_t line);
+double turd_unbox_float(turd_dynamic value, int32_t line);
+int32_t turd_unbox_bool(turd_dynamic value, int32_t line);
+int32_t turd_unbox_char(turd_dynamic value, int32_t line);
+turd_string turd_unbox_string(turd_dynamic value, int32_t line);
+
+// arithmetic follows the static rules: int op int stays int, a float makes
+// both float, '+' on two strings concatenates; comparisons of different
+// kinds are unequal and cannot be ordered
+turd_dynamic turd_dynamic_binary(int32_t op, turd_dynamic a, turd_dynamic b, int32_t line);
+turd_dynamic turd_dynamic_negate(turd_dynamic value, int32_t line);
+int32_t turd_dynamic_compare(int32_t op, turd_dynamic a, turd_dynamic b, int32_t line);
+
+// === Arrays ===
+// A fixed number of unboxed elements right after the header, so element i
+// of an int array is the int32_t at byte 8 + 4 * i. Elements are stored as
+// the values above: int32_t for int, bool and char, double for float,
+// turd_string for string. A new array is zeroed, which reads as 0, 0.0,
+// false, '\0' and "". `length` never changes; compiled code checks indices
+// against it inline and raises TURD_INDEX_OUT_OF_RANGE itself.
+enum TurdElement : uint32_t {
+    TURD_ELEMENT_INT, TURD_ELEMENT_FLOAT, TURD_ELEMENT_BOOL, TURD_ELEMENT_CHAR, TURD_ELEMENT_STRING
+};
+
+struct TurdArray {
+    int32_t length;
+    uint32_t element;       // a TurdElement
+};
+
+// what an array variable holds before anything is assigned to it
+extern struct TurdArray turd_empty_array;
+
+turd_array turd_array_new(int32_t length, int32_t element, int32_t line);
+
+}
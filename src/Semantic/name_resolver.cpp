@@ -0,0 +1,142 @@
+#include "name_resolver.hpp"
+
+void NameResolver::resolve(ProgramNode& program) {
+    diagnostics.clear();
+    visit(program);
+}
+
+void NameResolver::report(const std::string& message, const ASTNode& at) {
+    diagnostics.push_back({"Name error at line " + std::to_string(at.line) + ", column " +
+                           std::to_string(at.column) + ": " + message, at.line, at.column});
+}
+
+SymbolRef NameResolver::declare_variable(const std::string& name, const std::string& type, const ASTNode& at) {
+    SymbolRef ref{frame.kind, static_cast<int>(frame.types->size())};
+    if (symbols.declare(names.intern(name), ref, type, at.line, at.column) == nullptr) {
+        report("'" + name + "' is already declared in this scope", at);
+        return {};
+    }
+    frame.types->push_back(type_from_name(type));
+    return ref;
+}
+
+void NameResolver::scoped_body(std::vector<ASTNodePTR>& statements) {
+    symbols.push_scope();
+    walk(statements);
+    symbols.pop_scope();
+}
+
+// === Handlers ===
+
+void NameResolver::visit_program(ProgramNode& node) {
+    node.globalTypes.clear();
+    frame = {SymbolKind::Global, &node.globalTypes};
+    symbols.push_scope();
+
+    int builtin = 0;
+    for (const char* name : builtin_names) {
+        symbols.declare(names.intern(name), {SymbolKind::Builtin, builtin++}, "", 0, 0);
+    }
+
+    // hoist every function so calls can precede definitions and recurse
+    int function_index = 0;
+    for (const auto& child : node.children) {
+        if (child->type != NodeType::Function) continue;
+        auto& function = static_cast<FunctionNode&>(*child);
+        SymbolRef ref{SymbolKind::Function, function_index++};
+        if (symbols.declare(names.intern(function.name), ref, function.returnType,
+                            function.line, function.column) == nullptr) {
+            report("function '" + function.name + "' is already declared", function);
+        }
+    }
+
+    walk(node.children);
+    symbols.pop_scope();
+}
+
+void NameResolver::visit_function(FunctionNode& node) {
+    Frame outer = frame;
+    node.localTypes.clear();
+    frame = {SymbolKind::Local, &node.localTypes};
+    symbols.push_scope();
+
+    for (auto& parameter : node.parameters) {
+        parameter->symbol = declare_variable(parameter->name, parameter->type, *parameter);
+    }
+    // the body shares the parameters' scope, so redeclaring one is an error
+    walk(node.body);
+
+    symbols.pop_scope();
+    frame = outer;
+}
+
+void NameResolver::visit_declaration(DeclarationNode& node) {
+    // the initializer is resolved first: in 'int x = x;' the right x is the outer one
+    walk(node.size);
+    walk(node.initializer);
+    node.symbol = declare_variable(node.name, node.type, node);
+}
+
+void NameResolver::visit_assignment(AssignmentNode& node) {
+    walk(node.index);
+    walk(node.expression);
+
+    const Symbol* symbol = symbols.lookup(names.intern(node.name));
+    if (symbol == nullptr) {
+        report("assignment to undeclared variable '" + node.name + "'", node);
+    } else if (symbol->ref.kind != SymbolKind::Local && symbol->ref.kind != SymbolKind::Global) {
+        report("cannot assign to function '" + node.name + "'", node);
+    } else {
+        node.symbol = symbol->ref;
+    }
+}
+
+void NameResolver::visit_if(IfNode& node) {
+    walk(node.condition);
+    scoped_body(node.body);
+    scoped_body(node.elseBody);
+}
+
+void NameResolver::visit_while(WhileNode& node) {
+    walk(node.condition);
+    scoped_body(node.body);
+}
+
+void NameResolver::visit_block(BlockNode& node) {
+    scoped_body(node.statements);
+}
+
+void NameResolver::visit_variable(VariableNode& node) {
+    const Symbol* symbol = symbols.lookup(names.intern(node.name));
+    if (symbol == nullptr) {
+        report("undeclared variable '" + node.name + "'", node);
+    } else if (symbol->ref.kind != SymbolKind::Local && symbol->ref.kind != SymbolKind::Global) {
+        report("'" + node.name + "' is a function, not a variable", node);
+    } else {
+        node.symbol = symbol->ref;
+    }
+}
+
+void NameResolver::visit_function_call(FunctionCallNode& node) {
+    const Symbol* symbol = symbols.lookup(names.intern(node.name));
+    if (symbol == nullptr) {
+        report("call to undeclared function '" + node.name + "'", node);
+    } else if (symbol->ref.kind != SymbolKind::Function && symbol->ref.kind != SymbolKind::Builtin) {
+        report("'" + node.name + "' is a variable, not a function", node);
+    } else {
+        node.symbol = symbol->ref;
+    }
+
+    // read(x) is how a script introduces x when it has no declaration
+    bool is_read = node.symbol.kind == SymbolKind::Builtin && node.name == "read";
+    for (auto& argument : node.arguments) {
+        if (is_read && argument->type == NodeType::Variable) {
+            auto& variable = static_cast<VariableNode&>(*argument);
+            if (symbols.lookup(names.intern(variable.name)) == nullptr) {
+                variable.symbol = declare_variable(variable.name, "string", variable);
+                continue;
+            }
+        }
+        walk(argument);
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "../SynParser/ast_visitor.hpp"
+#include "symbol_table.hpp"
+
+// === Name Resolution ===
+// Binds every use of a name to its declaration and records the result as
+// a SymbolRef on the node:
+//  - parameters and locals get frame slots, numbered per function
+//  - top-level declarations get global slots (a function body sees the
+//    globals declared before it)
+//  - functions are hoisted, so calls may precede the definition
+//  - read(x) declares x as a string when it isn't declared yet
+// Per-slot declared types end up in FunctionNode::localTypes and
+// ProgramNode::globalTypes ('var' and untyped parameters as Unknown).
+class NameResolver : public ASTWalker<NameResolver> {
+public:
+    void resolve(ProgramNode& program);
+
+    const std::vector<Diagnostic>& get_diagnostics() const { return diagnostics; }
+    bool has_errors() const { return !diagnostics.empty(); }
+
+    // === Walker handlers ===
+    void visit_program(ProgramNode& node);
+    void visit_function(FunctionNode& node);
+    void visit_declaration(DeclarationNode& node);
+    void visit_assignment(AssignmentNode& node);
+    void visit_if(IfNode& node);
+    void visit_while(WhileNode& node);
+    void visit_block(BlockNode& node);
+    void visit_variable(VariableNode& node);
+    void visit_function_call(FunctionCallNode& node);
+
+    static constexpr const char* builtin_names[] = {"print", "read", "len"};
+
+private:
+    // where new declarations get their slots
+    struct Frame {
+        SymbolKind kind;                    // Local or Global
+        std::vector<TypeId>* types;         // declared type per slot
+    };
+
+    void scoped_body(std::vector<ASTNodePTR>& statements);
+    SymbolRef declare_variable(const std::string& name, const std::string& type, const ASTNode& at);
+    void report(const std::string& message, const ASTNode& at);
+
+    StringInterner names;
+    SymbolTable symbols;
+    Frame frame{SymbolKind::Global, nullptr};
+    std::vector<Diagnostic> diagnostics;
+};
@@ -0,0 +1,152 @@
+#include "symbol_table.hpp"
+#include "../Support/hash.hpp"
+
+// === Flat Map ===
+
+FlatMap::FlatMap(size_t capacity) {
+    size_t size = 16;
+    int bits = 4;
+    while (size < capacity) {
+        size <<= 1;
+        bits++;
+    }
+    keys.assign(size, empty_key);
+    values.assign(size, -1);
+    shift = 32 - bits;
+}
+
+size_t FlatMap::slot_for(uint32_t key) const {
+    return static_cast<uint32_t>(key * 2654435769u) >> shift;
+}
+
+const int32_t* FlatMap::find(uint32_t key) const {
+    size_t mask = keys.size() - 1;
+    for (size_t slot = slot_for(key);; slot = (slot + 1) & mask) {
+        if (keys[slot] == key) return &values[slot];
+        if (keys[slot] == empty_key) return nullptr;
+    }
+}
+
+int32_t& FlatMap::insert(uint32_t key, int32_t value) {
+    // keep the load factor under 3/4 so probe runs stay short
+    if ((count + 1) * 4 > keys.size() * 3) {
+        grow();
+    }
+
+    size_t mask = keys.size() - 1;
+    size_t slot = slot_for(key);
+    while (keys[slot] != key && keys[slot] != empty_key) {
+        slot = (slot + 1) & mask;
+    }
+    if (keys[slot] == empty_key) {
+        keys[slot] = key;
+        count++;
+    }
+    values[slot] = value;
+    return values[slot];
+}
+
+void FlatMap::grow() {
+    std::vector<uint32_t> old_keys = std::move(keys);
+    std::vector<int32_t> old_values = std::move(values);
+
+    keys.assign(old_keys.size() * 2, empty_key);
+    values.assign(old_keys.size() * 2, -1);
+    shift--;
+    count = 0;
+
+    for (size_t i = 0; i < old_keys.size(); ++i) {
+        if (old_keys[i] != empty_key) {
+            insert(old_keys[i], old_values[i]);
+        }
+    }
+}
+
+// === String Interner ===
+
+StringInterner::StringInterner() : table(64, no_name) {}
+
+uint64_t StringInterner::hash(std::string_view text) {
+    return fnv1a_hash(text.data(), text.size());
+}
+
+NameId StringInterner::find(std::string_view text) const {
+    uint64_t h = hash(text);
+    size_t mask = table.size() - 1;
+    for (size_t slot = h & mask;; slot = (slot + 1) & mask) {
+        NameId id = table[slot];
+        if (id == no_name) return no_name;
+        if (hashes[id] == h && names[id] == text) return id;
+    }
+}
+
+NameId StringInterner::intern(std::string_view text) {
+    uint64_t h = hash(text);
+    size_t mask = table.size() - 1;
+    size_t slot = h & mask;
+    for (;; slot = (slot + 1) & mask) {
+        NameId id = table[slot];
+        if (id == no_name) break;
+        if (hashes[id] == h && names[id] == text) return id;
+    }
+
+    NameId id = static_cast<NameId>(names.size());
+    names.emplace_back(text);
+    hashes.push_back(h);
+    table[slot] = id;
+
+    if (names.size() * 4 > table.size() * 3) {
+        grow();
+    }
+    return id;
+}
+
+void StringInterner::grow() {
+    table.assign(table.size() * 2, no_name);
+    size_t mask = table.size() - 1;
+    for (NameId id = 0; id < names.size(); ++id) {
+        size_t slot = hashes[id] & mask;
+        while (table[slot] != no_name) {
+            slot = (slot + 1) & mask;
+        }
+        table[slot] = id;
+    }
+}
+
+// === Symbol Table ===
+
+void SymbolTable::push_scope() {
+    scope_marks.push_back(undo_log.size());
+}
+
+void SymbolTable::pop_scope() {
+    size_t mark = scope_marks.back();
+    scope_marks.pop_back();
+
+    while (undo_log.size() > mark) {
+        const Undo& undo = undo_log.back();
+        current.insert(undo.name, undo.previous);
+        undo_log.pop_back();
+    }
+}
+
+const Symbol* SymbolTable::declare(NameId name, SymbolRef ref, const std::string& type, int line, int column) {
+    int depth = static_cast<int>(scope_marks.size());
+    const int32_t* binding = current.find(name);
+    int32_t previous = binding ? *binding : -1;
+
+    if (previous >= 0 && symbol_depth[previous] == depth) {
+        return nullptr;
+    }
+
+    undo_log.push_back({name, previous});
+    symbols.push_back({name, ref, type, line, column});
+    symbol_depth.push_back(depth);
+    current.insert(name, static_cast<int32_t>(symbols.size() - 1));
+    return &symbols.back();
+}
+
+const Symbol* SymbolTable::lookup(NameId name) const {
+    const int32_t* binding = current.find(name);
+    return binding && *binding >= 0 ? &symbols[*binding] : nullptr;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "../SynParser/syntax_parser.hpp"
+#include <cstdint>
+#include <string_view>
+
+using NameId = uint32_t;
+constexpr NameId no_name = UINT32_MAX;
+
+// === Flat Map ===
+// Open addressing (linear probing, power of two capacity) from a 32-bit
+// key to a 32-bit value. Keys and values sit in two flat arrays, so a
+// lookup is a multiply, a shift and usually a single cache line
+class FlatMap {
+public:
+    explicit FlatMap(size_t capacity = 64);
+
+    const int32_t* find(uint32_t key) const;
+    int32_t& insert(uint32_t key, int32_t value); // overwrites an existing value
+    size_t size() const { return count; }
+
+private:
+    size_t slot_for(uint32_t key) const;
+    void grow();
+
+    static constexpr uint32_t empty_key = UINT32_MAX;
+
+    std::vector<uint32_t> keys;
+    std::vector<int32_t> values;
+    size_t count = 0;
+    int shift;                  // 32 - log2(capacity), for Fibonacci hashing
+};
+
+// === String Interner ===
+// Hands out one dense NameId per distinct string. Comparing names after
+// interning is an integer compare
+class StringInterner {
+public:
+    StringInterner();
+
+    NameId intern(std::string_view text);
+    NameId find(std::string_view text) const;   // no_name if never interned
+    const std::string& name(NameId id) const { return names[id]; }
+
+private:
+    static uint64_t hash(std::string_view text);
+    void grow();
+
+    std::vector<std::string> names;
+    std::vector<uint64_t> hashes;   // per id, so growing never rehashes strings
+    std::vector<NameId> table;      // open addressing over ids, no_name = empty
+};
+
+// === Symbol Table ===
+struct Symbol {
+    NameId name;
+    SymbolRef ref;
+    std::string type;   // declared type, "" when untyped
+    int line;
+    int column;
+};
+
+// Lexically scoped bindings from NameId to Symbol. Declaring records the
+// binding it shadows in an undo log; pop_scope() replays the log back to
+// the scope's mark, so leaving a scope costs O(names it declared) no
+// matter how many names are visible
+class SymbolTable {
+public:
+    void push_scope();
+    void pop_scope();
+
+    // nullptr if the name is already declared in the innermost scope.
+    // Returned pointers stay valid until the next declare()
+    const Symbol* declare(NameId name, SymbolRef ref, const std::string& type, int line, int column);
+    const Symbol* lookup(NameId name) const;
+
+private:
+    struct Undo {
+        NameId name;
+        int32_t previous;   // binding index, -1 when the name was unbound
+    };
+
+    FlatMap current;                        // name -> index into symbols
+    std::vector<Symbol> symbols;            // every declaration, in order
+    std::vector<int> symbol_depth;          // scope depth each symbol was declared at
+    std::vector<Undo> undo_log;
+    std::vector<size_t> scope_marks;        // undo_log size at each push_scope
+};
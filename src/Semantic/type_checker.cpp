@@ -0,0 +1,395 @@
+#include "type_checker.hpp"
+#include "../SynParser/ast_visitor.hpp"
+#include "../Support/thread_pool.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace {
+
+bool is_numeric(TypeId type) {
+    return type == TypeId::Int || type == TypeId::Float;
+}
+
+// value may be stored into target: same type, int widening to float, or
+// unknown. An array only goes where the same array type is expected: the
+// backends keep arrays as typed buffers with no boxed form
+bool assignable(TypeId target, TypeId value) {
+    if (is_array(target) || is_array(value)) return target == value;
+    return target == value || target == TypeId::Unknown || value == TypeId::Unknown ||
+           (target == TypeId::Float && value == TypeId::Int);
+}
+
+// sizes and indices
+bool is_integral(TypeId type) {
+    return type == TypeId::Int || type == TypeId::Unknown;
+}
+
+// Checks one body (a function's, or the top-level statements). Expression
+// handlers return the expression's type; statement handlers return Void
+class BodyChecker : public ASTVisitor<BodyChecker, TypeId> {
+public:
+    BodyChecker(const std::vector<FunctionSignature>& signatures, std::vector<TypeId>& globals,
+                std::vector<TypeId>* locals, TypeId returnType, std::vector<Diagnostic>& diagnostics)
+        : signatures(signatures), globals(globals), locals(locals),
+          returnType(returnType), diagnostics(diagnostics) {}
+
+    void check_all(const std::vector<ASTNodePTR>& statements) {
+        for (const auto& statement : statements) visit(*statement);
+    }
+
+    // === Statements ===
+    TypeId visit_program(ProgramNode&) { return TypeId::Void; }
+    TypeId visit_function(FunctionNode&) { return TypeId::Void; }  // checked as its own body
+    TypeId visit_parameter(ParameterNode&) { return TypeId::Void; }
+
+    TypeId visit_declaration(DeclarationNode& node) {
+        TypeId* slot = slot_for(node.symbol);
+        TypeId declared = type_from_name(node.type);
+
+        if (node.size) {
+            TypeId size = visit(*node.size);
+            if (!is_integral(size)) {
+                report(std::string("array size must be an int, got ") + typeIdToString(size), *node.size);
+            }
+        }
+        if (node.initializer) {
+            TypeId value = visit(*node.initializer);
+            if (node.type == "var") {
+                declared = value;
+            } else if (!assignable(declared, value)) {
+                report("cannot initialize " + node.type + " '" + node.name + "' with a " +
+                       typeIdToString(value), node);
+            }
+        }
+        if (slot) *slot = declared;
+        return TypeId::Void;
+    }
+
+    TypeId visit_assignment(AssignmentNode& node) {
+        if (node.index) return assign_element(node);
+
+        TypeId value = visit(*node.expression);
+        TypeId* slot = slot_for(node.symbol);
+        if (slot && !assignable(*slot, value)) {
+            report("cannot assign a " + std::string(typeIdToString(value)) + " to " +
+                   typeIdToString(*slot) + " '" + node.name + "'", node);
+        }
+        return TypeId::Void;
+    }
+
+    TypeId visit_if(IfNode& node) {
+        expect_condition(*node.condition, "if");
+        check_all(node.body);
+        check_all(node.elseBody);
+        return TypeId::Void;
+    }
+
+    TypeId visit_while(WhileNode& node) {
+        expect_condition(*node.condition, "while");
+        check_all(node.body);
+        return TypeId::Void;
+    }
+
+    TypeId visit_return(ReturnNode& node) {
+        if (!node.expression) {
+            if (returnType != TypeId::Void) {
+                report(std::string("missing return value, function returns ") + typeIdToString(returnType), node);
+            }
+            return TypeId::Void;
+        }
+
+        TypeId value = visit(*node.expression);
+        if (returnType == TypeId::Void) {
+            report("returning a value from a function with no return type", node);
+        } else if (!assignable(returnType, value)) {
+            report(std::string("returning a ") + typeIdToString(value) + " from a function returning " +
+                   typeIdToString(returnType), node);
+        }
+        return TypeId::Void;
+    }
+
+    TypeId visit_break(BreakNode&) { return TypeId::Void; }
+
+    TypeId visit_block(BlockNode& node) {
+        check_all(node.statements);
+        return TypeId::Void;
+    }
+
+    TypeId visit_error(ErrorNode&) { return TypeId::Void; }
+
+    // === Expressions ===
+    TypeId visit_binary_op(BinaryOpNode& node) {
+        TypeId left = visit(*node.left);
+        TypeId right = visit(*node.right);
+        return node.valueType = binary_result(node, left, right);
+    }
+
+    TypeId visit_unary_op(UnaryOpNode& node) {
+        // -2147483648 parses as '-' applied to 2147483648
+        if (node.op == "-" && node.operand->type == NodeType::Literal) negated = node.operand.get();
+        TypeId operand = visit(*node.operand);
+        TypeId result = TypeId::Unknown;
+
+        if (node.op == "!") {
+            if (operand != TypeId::Bool && operand != TypeId::Unknown) {
+                report(std::string("'!' needs a bool, got ") + typeIdToString(operand), node);
+            }
+            result = TypeId::Bool;
+        } else if (is_numeric(operand) || operand == TypeId::Unknown) {
+            result = operand;
+        } else {
+            report(std::string("unary '-' needs a number, got ") + typeIdToString(operand), node);
+        }
+        return node.valueType = result;
+    }
+
+    // Ints are 32-bit everywhere, so a literal that does not fit is rejected
+    // here and later stages can convert literals without checking
+    TypeId visit_literal(LiteralNode& node) {
+        node.valueType = type_from_name(node.literalType);
+        const bool negative = negated == &node;
+        negated = nullptr;
+
+        try {
+            if (node.valueType == TypeId::Int) {
+                const long long limit = negative ? -static_cast<long long>(std::numeric_limits<int32_t>::min())
+                                                 : std::numeric_limits<int32_t>::max();
+                if (std::stoll(node.value) > limit) throw std::out_of_range(node.value);
+            } else if (node.valueType == TypeId::Float) {
+                std::stod(node.value);
+            }
+        } catch (const std::exception&) {
+            report(std::string(typeIdToString(node.valueType)) + " literal " + node.value + " is out of range", node);
+        }
+        return node.valueType;
+    }
+
+    TypeId visit_variable(VariableNode& node) {
+        TypeId* slot = slot_for(node.symbol);
+        return node.valueType = slot ? *slot : TypeId::Unknown;
+    }
+
+    TypeId visit_function_call(FunctionCallNode& node) {
+        std::vector<TypeId> arguments;
+        arguments.reserve(node.arguments.size());
+        for (const auto& argument : node.arguments) {
+            arguments.push_back(visit(*argument));
+        }
+
+        if (node.symbol.kind == SymbolKind::Builtin) {
+            if (node.name == "len") {
+                if (arguments.size() != 1 || !is_array(arguments[0])) {
+                    report("len() takes one array", node);
+                }
+                return node.valueType = TypeId::Int;
+            }
+            for (size_t i = 0; i < arguments.size(); ++i) {
+                if (is_array(arguments[i])) {
+                    report(node.name + "() cannot take an array, got " + typeIdToString(arguments[i]),
+                           *node.arguments[i]);
+                }
+            }
+            if (node.name == "read") {
+                for (const auto& argument : node.arguments) {
+                    if (argument->type != NodeType::Variable) {
+                        report("read() needs variables to read into", *argument);
+                    }
+                }
+            }
+            return node.valueType = TypeId::Void;
+        }
+        if (node.symbol.kind != SymbolKind::Function) {
+            return node.valueType = TypeId::Unknown;  // already reported by name resolution
+        }
+
+        const FunctionSignature& signature = signatures[node.symbol.index];
+        if (arguments.size() != signature.parameters.size()) {
+            report("'" + node.name + "' takes " + std::to_string(signature.parameters.size()) +
+                   " argument(s) but " + std::to_string(arguments.size()) + " were given", node);
+        } else {
+            for (size_t i = 0; i < arguments.size(); ++i) {
+                if (!assignable(signature.parameters[i], arguments[i])) {
+                    report("argument " + std::to_string(i + 1) + " of '" + node.name + "' should be " +
+                           typeIdToString(signature.parameters[i]) + ", got " + typeIdToString(arguments[i]),
+                           *node.arguments[i]);
+                }
+            }
+        }
+        return node.valueType = signature.returnType;
+    }
+
+    TypeId visit_index(IndexNode& node) {
+        TypeId array = visit(*node.array);
+        TypeId index = visit(*node.index);
+        if (!is_integral(index)) {
+            report(std::string("array index must be an int, got ") + typeIdToString(index), *node.index);
+        }
+        if (!is_array(array)) {
+            report(std::string("cannot index a ") + typeIdToString(array), node);
+            return node.valueType = TypeId::Unknown;
+        }
+        return node.valueType = element_type(array);
+    }
+
+private:
+    // a[i] = v
+    TypeId assign_element(AssignmentNode& node) {
+        TypeId index = visit(*node.index);
+        TypeId value = visit(*node.expression);
+        TypeId* slot = slot_for(node.symbol);
+        if (!is_integral(index)) {
+            report(std::string("array index must be an int, got ") + typeIdToString(index), *node.index);
+        }
+        if (!slot) return TypeId::Void;
+        if (!is_array(*slot)) {
+            report("cannot index " + std::string(typeIdToString(*slot)) + " '" + node.name + "'", node);
+        } else if (!assignable(element_type(*slot), value)) {
+            report("cannot store a " + std::string(typeIdToString(value)) + " into " +
+                   typeIdToString(*slot) + " '" + node.name + "'", node);
+        }
+        return TypeId::Void;
+    }
+
+    TypeId* slot_for(SymbolRef symbol) {
+        if (symbol.kind == SymbolKind::Local && locals) return &(*locals)[symbol.index];
+        if (symbol.kind == SymbolKind::Global) return &globals[symbol.index];
+        return nullptr;
+    }
+
+    void expect_condition(ASTNode& condition, const char* statement) {
+        TypeId type = visit(condition);
+        if (type != TypeId::Bool && type != TypeId::Unknown) {
+            report(std::string(statement) + " condition must be a bool, got " + typeIdToString(type), condition);
+        }
+    }
+
+    TypeId binary_result(const BinaryOpNode& node, TypeId left, TypeId right) {
+        const std::string& op = node.op;
+        bool unknown = left == TypeId::Unknown || right == TypeId::Unknown;
+
+        // arrays have no operators, not even ==
+        if (is_array(left) || is_array(right)) {
+            mismatch(node, left, right);
+            bool logical = op == "&&" || op == "||" || op == "==" || op == "!=" ||
+                           op == "<" || op == "<=" || op == ">" || op == ">=";
+            return logical ? TypeId::Bool : TypeId::Unknown;
+        }
+
+        if (op == "&&" || op == "||") {
+            if ((left != TypeId::Bool && left != TypeId::Unknown) ||
+                (right != TypeId::Bool && right != TypeId::Unknown)) {
+                mismatch(node, left, right);
+            }
+            return TypeId::Bool;
+        }
+
+        if (op == "==" || op == "!=") {
+            if (!unknown && left != right && !(is_numeric(left) && is_numeric(right))) {
+                mismatch(node, left, right);
+            }
+            return TypeId::Bool;
+        }
+
+        if (op == "<" || op == "<=" || op == ">" || op == ">=") {
+            bool ordered = (is_numeric(left) && is_numeric(right)) ||
+                           (left == right && (left == TypeId::Char || left == TypeId::String));
+            if (!unknown && !ordered) {
+                mismatch(node, left, right);
+            }
+            return TypeId::Bool;
+        }
+
+        // arithmetic: + - * / % ** //
+        if (op == "+" && left == TypeId::String && right == TypeId::String) {
+            return TypeId::String;
+        }
+        if (unknown) {
+            bool other_ok = (left == TypeId::Unknown || is_numeric(left) || (op == "+" && left == TypeId::String)) &&
+                            (right == TypeId::Unknown || is_numeric(right) || (op == "+" && right == TypeId::String));
+            if (!other_ok) mismatch(node, left, right);
+            return op == "//" ? TypeId::Int : TypeId::Unknown;
+        }
+        if (!is_numeric(left) || !is_numeric(right)) {
+            mismatch(node, left, right);
+            return TypeId::Unknown;
+        }
+        // '//' is integer division: the floored quotient is an int even for floats
+        if (op == "//") {
+            return TypeId::Int;
+        }
+        return left == TypeId::Float || right == TypeId::Float ? TypeId::Float : TypeId::Int;
+    }
+
+    void mismatch(const BinaryOpNode& node, TypeId left, TypeId right) {
+        report("operator '" + node.op + "' cannot be applied to " + typeIdToString(left) +
+               " and " + typeIdToString(right), node);
+    }
+
+    void report(const std::string& message, const ASTNode& at) {
+        diagnostics.push_back({"Type error at line " + std::to_string(at.line) + ", column " +
+                               std::to_string(at.column) + ": " + message, at.line, at.column});
+    }
+
+    const std::vector<FunctionSignature>& signatures;
+    std::vector<TypeId>& globals;
+    std::vector<TypeId>* locals;    // nullptr for top-level code
+    TypeId returnType;
+    std::vector<Diagnostic>& diagnostics;
+    const ASTNode* negated = nullptr;  // literal operand of the unary '-' being checked
+};
+
+} // namespace
+
+void TypeChecker::check(ProgramNode& program) {
+    diagnostics.clear();
+    signatures.clear();
+
+    // 1. signatures, in the same order NameResolver numbered the functions
+    std::vector<FunctionNode*> functions;
+    for (const auto& child : program.children) {
+        if (child->type != NodeType::Function) continue;
+        auto& function = static_cast<FunctionNode&>(*child);
+        FunctionSignature signature{{}, TypeId::Void, &function};
+        for (const auto& parameter : function.parameters) {
+            signature.parameters.push_back(type_from_name(parameter->type));
+        }
+        if (!function.returnType.empty()) {
+            signature.returnType = type_from_name(function.returnType);
+        }
+        signatures.push_back(std::move(signature));
+        functions.push_back(&function);
+    }
+
+    // 2. top-level code, which settles the types of 'var' globals
+    {
+        BodyChecker checker(signatures, program.globalTypes, nullptr, TypeId::Void, diagnostics);
+        for (const auto& child : program.children) {
+            if (child->type != NodeType::Function) checker.visit(*child);
+        }
+    }
+
+    // 3. function bodies, each with its own diagnostics so nothing is shared
+    std::vector<std::vector<Diagnostic>> function_diagnostics(functions.size());
+    auto check_function = [&](size_t i) {
+        FunctionNode& function = *functions[i];
+        BodyChecker checker(signatures, program.globalTypes, &function.localTypes,
+                            signatures[i].returnType, function_diagnostics[i]);
+        checker.check_all(function.body);
+    };
+
+    if (functions.size() < min_parallel_functions || threads == 1) {
+        for (size_t i = 0; i < functions.size(); ++i) check_function(i);
+    } else {
+        ThreadPool pool(threads);
+        pool.parallel_for(functions.size(), check_function);
+    }
+
+    for (auto& list : function_diagnostics) {
+        diagnostics.insert(diagnostics.end(), list.begin(), list.end());
+    }
+    std::stable_sort(diagnostics.begin(), diagnostics.end(), [](const Diagnostic& a, const Diagnostic& b) {
+        return a.line != b.line ? a.line < b.line : a.column < b.column;
+    });
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "../SynParser/syntax_parser.hpp"
+
+struct FunctionSignature {
+    std::vector<TypeId> parameters;     // Unknown for untyped parameters
+    TypeId returnType;                  // Void when no '-> type' is given
+    const FunctionNode* node;
+};
+
+// === Type Checking ===
+// Runs after NameResolver. Annotates every expression with its TypeId,
+// fills in the inferred types of 'var' slots and reports type errors.
+//
+// Signatures and top-level code are checked first, on the calling thread.
+// After that each function body only reads the signatures and global slot
+// types and only writes its own nodes, so bodies are checked in parallel.
+class TypeChecker {
+public:
+    explicit TypeChecker(unsigned threads = 0) : threads(threads) {}
+
+    void check(ProgramNode& program);
+
+    const std::vector<Diagnostic>& get_diagnostics() const { return diagnostics; }
+    bool has_errors() const { return !diagnostics.empty(); }
+    const std::vector<FunctionSignature>& get_signatures() const { return signatures; }
+
+private:
+    unsigned threads;
+    std::vector<FunctionSignature> signatures;  // indexed by SymbolRef::index
+    std::vector<Diagnostic> diagnostics;
+
+    // fewer functions than this are checked on the calling thread
+    static constexpr size_t min_parallel_functions = 32;
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+// === Turd Arithmetic ===
+// The one definition of what Turd's operators compute and how numbers
+// print, shared by the constant folders, the runtime and every backend so
+// an optimized program prints what the unoptimized one does:
+//  - int is 32-bit two's complement and wraps on overflow
+//  - '/' and '%' truncate toward zero, '//' floors
+//  - dividing by zero, INT_MIN / -1 and 0 ** -n are runtime errors
+//  - int ** negative exponent is 1 / a**n truncated, so 0 unless a is +-1
+namespace turd {
+
+inline int32_t wrap(int64_t value) {
+    return static_cast<int32_t>(static_cast<uint32_t>(value));
+}
+
+// true when a / b, a % b or a // b must raise instead of producing a value
+inline bool int_division_traps(int32_t a, int32_t b) {
+    return b == 0 || (a == std::numeric_limits<int32_t>::min() && b == -1);
+}
+
+inline int32_t int_floor_div(int32_t a, int32_t b) {
+    int32_t quotient = a / b;
+    if (a % b != 0 && (a < 0) != (b < 0)) --quotient;
+    return quotient;
+}
+
+inline bool int_pow_traps(int32_t base, int32_t exponent) {
+    return exponent < 0 && base == 0;
+}
+
+inline int32_t int_pow(int32_t base, int32_t exponent) {
+    if (exponent < 0) {
+        return base == 1 ? 1 : base == -1 ? ((exponent & 1) ? -1 : 1) : 0;
+    }
+    uint32_t result = 1, factor = static_cast<uint32_t>(base);
+    for (uint32_t e = static_cast<uint32_t>(exponent); e != 0; e >>= 1) {
+        if (e & 1) result *= factor;
+        factor *= factor;
+    }
+    return static_cast<int32_t>(result);
+}
+
+// float // float is an int; false when the floored quotient doesn't fit one
+inline bool float_floor_div(double a, double b, int32_t& out) {
+    double floored = std::floor(a / b);
+    if (!(floored >= std::numeric_limits<int32_t>::min() && floored <= std::numeric_limits<int32_t>::max())) {
+        return false;
+    }
+    out = static_cast<int32_t>(floored);
+    return true;
+}
+
+// === Printing ===
+
+// shortest text that reads back as the same double, always with a '.' or
+// exponent so a float never prints like an int; returns the length
+inline size_t format_float(double value, char (&buffer)[32]) {
+    for (int precision = 15; precision <= 17; ++precision) {
+        std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+        if (std::strtod(buffer, nullptr) == value) break;
+    }
+    size_t length = std::strlen(buffer);
+    if (std::strpbrk(buffer, ".en") == nullptr) {
+        std::memcpy(buffer + length, ".0", 3);
+        length += 2;
+    }
+    return length;
+}
+
+} // namespace turd
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// === FNV-1a ===
+// 64-bit FNV-1a over a byte range. Fast on short keys and stable across
+// runs and builds, so it serves both the string interner and the on-disk
+// AST cache keys. Chain ranges by passing one hash as the next seed
+inline uint64_t fnv1a_hash(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ULL) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
@@ -0,0 +1,79 @@
+#include "output_buffer.hpp"
+#include "arithmetic.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+OutputBuffer::OutputBuffer(std::ostream& out, size_t capacity)
+    : out(out), data(new char[capacity]), capacity(capacity) {}
+
+void OutputBuffer::write(std::string_view text) {
+    if (text.size() > capacity - size) {
+        flush();
+        // too big to ever fit, skip the copy
+        if (text.size() >= capacity) {
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+            return;
+        }
+    }
+    std::memcpy(data.get() + size, text.data(), text.size());
+    size += text.size();
+}
+
+void OutputBuffer::write_int(long long value) {
+    char digits[24];
+    int length = 0;
+    unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value)
+                                             : static_cast<unsigned long long>(value);
+    do {
+        digits[length++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) put('-');
+    while (length > 0) put(digits[--length]);
+}
+
+void OutputBuffer::write_json_string(std::string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    put('"');
+    for (char c : text) {
+        switch (c) {
+            case '"': write("\\\""); break;
+            case '\\': write("\\\\"); break;
+            case '\n': write("\\n"); break;
+            case '\t': write("\\t"); break;
+            case '\r': write("\\r"); break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    write("\\u00");
+                    put(hex[(c >> 4) & 0xf]);
+                    put(hex[c & 0xf]);
+                } else {
+                    put(c);
+                }
+        }
+    }
+    put('"');
+}
+
+void OutputBuffer::write_float(double value) {
+    write(format_float(value));
+}
+
+void OutputBuffer::indent(int spaces) {
+    for (int i = 0; i < spaces; ++i) put(' ');
+}
+
+void OutputBuffer::flush() {
+    if (size > 0) {
+        out.write(data.get(), static_cast<std::streamsize>(size));
+        size = 0;
+    }
+    out.flush();
+}
+
+std::string format_float(double value) {
+    char buffer[32];
+    size_t length = turd::format_float(value, buffer);
+    return std::string(buffer, length);
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+enum class DumpFormat {
+    Text,       // indented, for people
+    Json,       // one JSON document, for tools
+    Compact     // one record per line, for grep/diff
+};
+
+// === Output Buffer ===
+// Fixed-size buffer allocated once up front and handed to the stream in
+// large blocks, so dumping a million lines costs a few hundred writes
+// instead of a flush per line
+class OutputBuffer {
+public:
+    explicit OutputBuffer(std::ostream& out, size_t capacity = 1 << 16);
+    ~OutputBuffer() { flush(); }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void put(char c) {
+        if (size == capacity) flush();
+        data[size++] = c;
+    }
+    void write(std::string_view text);
+    void write_int(long long value);
+    void write_json_string(std::string_view text);   // quoted and escaped
+    void write_float(double value);                  // as format_float
+    void indent(int spaces);
+    void flush();
+
+private:
+    std::ostream& out;
+    std::unique_ptr<char[]> data;
+    size_t capacity;
+    size_t size = 0;
+};
+
+// shortest text that reads back as the same double, always with a '.' or exponent
+std::string format_float(double value);
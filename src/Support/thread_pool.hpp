@@ -0,0 +1,63 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// === Thread Pool ===
+// Fixed set of workers pulling jobs off a shared queue. wait() blocks
+// until every submitted job has finished, so one pool can be reused
+// for several rounds of work.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> job);
+    void wait();
+    unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+    // Run body(i) for i in [0, count), split into contiguous chunks so
+    // thousands of tiny items don't each pay for a queue round trip
+    template <typename Body>
+    void parallel_for(size_t count, Body body);
+
+    static unsigned default_threads();
+
+private:
+    void worker_loop();
+
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> jobs_;
+    std::mutex mutex_;
+    std::condition_variable job_ready_;
+    std::condition_variable all_done_;
+    size_t pending_ = 0;                // submitted but not yet finished
+    bool stopping_ = false;
+};
+
+template <typename Body>
+void ThreadPool::parallel_for(size_t count, Body body) {
+    if (count == 0) return;
+
+    // a few chunks per worker keeps them busy when items differ in cost
+    size_t chunks = std::min(count, static_cast<size_t>(size()) * 4);
+    size_t chunk_size = (count + chunks - 1) / chunks;
+
+    for (size_t begin = 0; begin < count; begin += chunk_size) {
+        size_t end = std::min(count, begin + chunk_size);
+        submit([&body, begin, end] {
+            for (size_t i = begin; i < end; ++i) {
+                body(i);
+            }
+        });
+    }
+    wait();
+}
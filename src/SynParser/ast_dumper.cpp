@@ -0,0 +1,326 @@
+#include "ast_dumper.hpp"
+#include <iostream>
+
+const char* nodeTypeToString(NodeType type) {
+    switch (type) {
+        case NodeType::Program: return "Program";
+        case NodeType::Function: return "Function";
+        case NodeType::Parameter: return "Parameter";
+        case NodeType::Declaration: return "Declaration";
+        case NodeType::Assignment: return "Assignment";
+        case NodeType::If: return "If";
+        case NodeType::While: return "While";
+        case NodeType::Return: return "Return";
+        case NodeType::Break: return "Break";
+        case NodeType::Block: return "Block";
+        case NodeType::BinaryOp: return "BinaryOp";
+        case NodeType::UnaryOp: return "UnaryOp";
+        case NodeType::Literal: return "Literal";
+        case NodeType::Variable: return "Variable";
+        case NodeType::FunctionCall: return "FunctionCall";
+        case NodeType::Index: return "Index";
+        case NodeType::Error: return "Error";
+    }
+    return "Unknown";
+}
+
+namespace {
+
+struct Field {
+    const char* key;
+    const std::string* value;
+};
+
+// A named child position: either one node or a list of them
+struct Slot {
+    const char* name = nullptr;
+    const ASTNodePTR* single = nullptr;
+    const std::vector<ASTNodePTR>* list = nullptr;
+    const std::vector<std::shared_ptr<ParameterNode>>* parameters = nullptr;
+
+    size_t size() const {
+        if (single) return *single ? 1 : 0;
+        if (list) return list->size();
+        return parameters ? parameters->size() : 0;
+    }
+    const ASTNode* at(size_t i) const {
+        if (single) return single->get();
+        if (list) return (*list)[i].get();
+        return (*parameters)[i].get();
+    }
+    bool is_list() const { return single == nullptr; }
+};
+
+constexpr int max_slots = 3;
+
+struct NodeShape {
+    Field fields[2];
+    int field_count = 0;
+    Slot slots[max_slots];
+    int slot_count = 0;
+};
+
+NodeShape shape_of(const ASTNode& node) {
+    NodeShape shape;
+    auto field = [&](const char* key, const std::string& value) {
+        shape.fields[shape.field_count++] = {key, &value};
+    };
+    auto single = [&](const char* name, const ASTNodePTR& child) {
+        Slot& slot = shape.slots[shape.slot_count++];
+        slot.name = name;
+        slot.single = &child;
+    };
+    auto list = [&](const char* name, const std::vector<ASTNodePTR>& children) {
+        Slot& slot = shape.slots[shape.slot_count++];
+        slot.name = name;
+        slot.list = &children;
+    };
+
+    switch (node.type) {
+        case NodeType::Program:
+            list("children", static_cast<const ProgramNode&>(node).children);
+            break;
+        case NodeType::Function: {
+            const auto& function = static_cast<const FunctionNode&>(node);
+            field("name", function.name);
+            field("returnType", function.returnType);
+            Slot& slot = shape.slots[shape.slot_count++];
+            slot.name = "parameters";
+            slot.parameters = &function.parameters;
+            list("body", function.body);
+            break;
+        }
+        case NodeType::Parameter: {
+            const auto& parameter = static_cast<const ParameterNode&>(node);
+            field("type", parameter.type);
+            field("name", parameter.name);
+            break;
+        }
+        case NodeType::Declaration: {
+            const auto& declaration = static_cast<const DeclarationNode&>(node);
+            field("type", declaration.type);
+            field("name", declaration.name);
+            single("initializer", declaration.initializer);
+            single("size", declaration.size);
+            break;
+        }
+        case NodeType::Assignment: {
+            const auto& assignment = static_cast<const AssignmentNode&>(node);
+            field("name", assignment.name);
+            single("index", assignment.index);
+            single("expression", assignment.expression);
+            break;
+        }
+        case NodeType::If: {
+            const auto& ifNode = static_cast<const IfNode&>(node);
+            single("condition", ifNode.condition);
+            list("body", ifNode.body);
+            list("else", ifNode.elseBody);
+            break;
+        }
+        case NodeType::While: {
+            const auto& whileNode = static_cast<const WhileNode&>(node);
+            single("condition", whileNode.condition);
+            list("body", whileNode.body);
+            break;
+        }
+        case NodeType::Return:
+            single("expression", static_cast<const ReturnNode&>(node).expression);
+            break;
+        case NodeType::Break:
+            break;
+        case NodeType::Block:
+            list("statements", static_cast<const BlockNode&>(node).statements);
+            break;
+        case NodeType::BinaryOp: {
+            const auto& binary = static_cast<const BinaryOpNode&>(node);
+            field("op", binary.op);
+            single("left", binary.left);
+            single("right", binary.right);
+            break;
+        }
+        case NodeType::UnaryOp: {
+            const auto& unary = static_cast<const UnaryOpNode&>(node);
+            field("op", unary.op);
+            single("operand", unary.operand);
+            break;
+        }
+        case NodeType::Literal: {
+            const auto& literal = static_cast<const LiteralNode&>(node);
+            field("value", literal.value);
+            field("literalType", literal.literalType);
+            break;
+        }
+        case NodeType::Variable:
+            field("name", static_cast<const VariableNode&>(node).name);
+            break;
+        case NodeType::FunctionCall: {
+            const auto& call = static_cast<const FunctionCallNode&>(node);
+            field("name", call.name);
+            list("arguments", call.arguments);
+            break;
+        }
+        case NodeType::Index: {
+            const auto& index = static_cast<const IndexNode&>(node);
+            single("array", index.array);
+            single("index", index.index);
+            break;
+        }
+        case NodeType::Error:
+            field("message", static_cast<const ErrorNode&>(node).message);
+            break;
+    }
+    return shape;
+}
+
+// One entry per node on the path from the root to the node being written
+struct Frame {
+    const ASTNode* node;
+    NodeShape shape;
+    int depth;
+    int slot = 0;           // slot being written
+    size_t item = 0;        // next item within that slot
+    bool slot_open = false; // slot header already written
+};
+
+class Dumper {
+public:
+    Dumper(std::ostream& out, DumpFormat format, int indent)
+        : buffer(out), format(format), base_indent(indent) {}
+
+    void run(const ASTNode& root) {
+        std::vector<Frame> stack;
+        stack.reserve(64);
+        enter(stack, root, 0, nullptr);
+
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            if (frame.slot == frame.shape.slot_count) {
+                leave(frame);
+                stack.pop_back();
+                continue;
+            }
+
+            const Slot& slot = frame.shape.slots[frame.slot];
+            if (!frame.slot_open) {
+                frame.slot_open = true;
+                open_slot(frame, slot);
+            }
+            if (frame.item < slot.size()) {
+                const ASTNode* child = slot.at(frame.item);
+                if (format == DumpFormat::Json && frame.item > 0) buffer.put(',');
+                frame.item++;
+                // enter() may grow the stack, so nothing from frame is used after it
+                int depth = frame.depth + (slot.is_list() && format == DumpFormat::Text ? 2 : 1);
+                enter(stack, *child, depth, slot.name);
+                continue;
+            }
+            close_slot(slot);
+            frame.slot++;
+            frame.item = 0;
+            frame.slot_open = false;
+        }
+        if (format == DumpFormat::Json) buffer.put('\n');
+    }
+
+private:
+    void enter(std::vector<Frame>& stack, const ASTNode& node, int depth, const char* slot_name) {
+        Frame frame{&node, shape_of(node), depth};
+
+        switch (format) {
+            case DumpFormat::Text:
+                buffer.indent(base_indent + depth * 2);
+                // list items sit under their slot header, single children are labelled inline
+                if (slot_name && stack.back().shape.slots[stack.back().slot].single) {
+                    buffer.write(slot_name);
+                    buffer.write(": ");
+                }
+                buffer.write(nodeTypeToString(node.type));
+                for (int i = 0; i < frame.shape.field_count; ++i) {
+                    buffer.put(' ');
+                    buffer.write(frame.shape.fields[i].key);
+                    buffer.put('=');
+                    buffer.write_json_string(*frame.shape.fields[i].value);
+                }
+                write_location(node, " [", "]\n");
+                break;
+            case DumpFormat::Json:
+                buffer.write("{\"kind\":\"");
+                buffer.write(nodeTypeToString(node.type));
+                buffer.write("\",\"line\":");
+                buffer.write_int(node.line);
+                buffer.write(",\"column\":");
+                buffer.write_int(node.column);
+                for (int i = 0; i < frame.shape.field_count; ++i) {
+                    buffer.write(",\"");
+                    buffer.write(frame.shape.fields[i].key);
+                    buffer.write("\":");
+                    buffer.write_json_string(*frame.shape.fields[i].value);
+                }
+                break;
+            case DumpFormat::Compact:
+                buffer.write_int(depth);
+                buffer.put(' ');
+                buffer.write(nodeTypeToString(node.type));
+                write_location(node, " ", "");
+                buffer.put(' ');
+                buffer.write(slot_name ? slot_name : "-");
+                for (int i = 0; i < frame.shape.field_count; ++i) {
+                    buffer.put(' ');
+                    buffer.write(frame.shape.fields[i].key);
+                    buffer.put('=');
+                    buffer.write_json_string(*frame.shape.fields[i].value);
+                }
+                buffer.put('\n');
+                break;
+        }
+        stack.push_back(frame);
+    }
+
+    void leave(const Frame&) {
+        if (format == DumpFormat::Json) buffer.put('}');
+    }
+
+    void open_slot(const Frame& frame, const Slot& slot) {
+        if (format == DumpFormat::Json) {
+            buffer.write(",\"");
+            buffer.write(slot.name);
+            buffer.write("\":");
+            if (slot.is_list()) buffer.put('[');
+            else if (slot.size() == 0) buffer.write("null");
+        } else if (format == DumpFormat::Text && slot.is_list() && slot.size() > 0) {
+            buffer.indent(base_indent + (frame.depth + 1) * 2);
+            buffer.write(slot.name);
+            buffer.write(":\n");
+        }
+    }
+
+    void close_slot(const Slot& slot) {
+        if (format == DumpFormat::Json && slot.is_list()) buffer.put(']');
+    }
+
+    void write_location(const ASTNode& node, const char* before, const char* after) {
+        buffer.write(before);
+        buffer.write_int(node.line);
+        buffer.put(':');
+        buffer.write_int(node.column);
+        buffer.write(after);
+    }
+
+    OutputBuffer buffer;
+    DumpFormat format;
+    int base_indent;
+};
+
+} // namespace
+
+void dump_ast(const ASTNode& root, DumpFormat format, std::ostream& out, int indent) {
+    Dumper dumper(out, format, indent);
+    dumper.run(root);
+}
+
+void SyntaxParser::print_ast(const ASTNodePTR& node, int indent) const {
+    if (node) {
+        dump_ast(*node, DumpFormat::Text, std::cout, indent);
+    }
+}
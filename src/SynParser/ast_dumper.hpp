@@ -0,0 +1,16 @@
+#pragma once
+#include "syntax_parser.hpp"
+#include "../Support/output_buffer.hpp"
+
+const char* nodeTypeToString(NodeType type);
+
+/**
+ * Dump a tree through one preallocated buffer. Traversal uses an explicit
+ * stack, so arbitrarily deep trees can't overflow the call stack
+ * @param root subtree to dump
+ * @param format Text (indented), Json (single document) or Compact
+ *               ("depth Type line:col slot key=value..." per node)
+ * @param out destination stream
+ * @param indent extra indentation for the Text format
+ */
+void dump_ast(const ASTNode& root, DumpFormat format, std::ostream& out, int indent = 0);
@@ -0,0 +1,109 @@
+#pragma once
+#include "syntax_parser.hpp"
+
+// === Static Dispatch Visitor ===
+// CRTP visitor over the node kinds in NodeType. visit() switches on
+// ASTNode::type and static_casts to the concrete node, then calls the
+// matching handler on Derived directly, so there are no virtual calls and
+// the handlers can be inlined into the dispatch.
+//
+// Exhaustiveness is checked at compile time twice over:
+//  - the dispatch switch has no default, and the build turns -Wswitch into
+//    an error, so a NodeType added without a case here won't compile
+//  - ASTVisitor declares no handlers itself, so a Derived missing one of
+//    visit_program ... visit_error won't compile either
+//
+//     struct Counter : ASTVisitor<Counter, int> {
+//         int visit_literal(LiteralNode&) { return 1; }
+//         ...one handler per node kind...
+//     };
+template <typename Derived, typename R = void>
+class ASTVisitor {
+public:
+    R visit(ASTNode& node) {
+        switch (node.type) {
+            case NodeType::Program:      return self().visit_program(static_cast<ProgramNode&>(node));
+            case NodeType::Function:     return self().visit_function(static_cast<FunctionNode&>(node));
+            case NodeType::Parameter:    return self().visit_parameter(static_cast<ParameterNode&>(node));
+            case NodeType::Declaration:  return self().visit_declaration(static_cast<DeclarationNode&>(node));
+            case NodeType::Assignment:   return self().visit_assignment(static_cast<AssignmentNode&>(node));
+            case NodeType::If:           return self().visit_if(static_cast<IfNode&>(node));
+            case NodeType::While:        return self().visit_while(static_cast<WhileNode&>(node));
+            case NodeType::Return:       return self().visit_return(static_cast<ReturnNode&>(node));
+            case NodeType::Break:        return self().visit_break(static_cast<BreakNode&>(node));
+            case NodeType::Block:        return self().visit_block(static_cast<BlockNode&>(node));
+            case NodeType::BinaryOp:     return self().visit_binary_op(static_cast<BinaryOpNode&>(node));
+            case NodeType::UnaryOp:      return self().visit_unary_op(static_cast<UnaryOpNode&>(node));
+            case NodeType::Literal:      return self().visit_literal(static_cast<LiteralNode&>(node));
+            case NodeType::Variable:     return self().visit_variable(static_cast<VariableNode&>(node));
+            case NodeType::FunctionCall: return self().visit_function_call(static_cast<FunctionCallNode&>(node));
+            case NodeType::Index:        return self().visit_index(static_cast<IndexNode&>(node));
+            case NodeType::Error:        return self().visit_error(static_cast<ErrorNode&>(node));
+        }
+        // only reachable with a corrupted type tag
+        __builtin_unreachable();
+    }
+
+    R visit(const ASTNodePTR& node) { return visit(*node); }
+
+protected:
+    Derived& self() { return static_cast<Derived&>(*this); }
+};
+
+// === Walker ===
+// Visitor whose default handlers just walk into every child, for passes
+// that only care about a few node kinds. Derived hides the handlers it
+// needs and calls the ASTWalker version to keep descending.
+template <typename Derived>
+class ASTWalker : public ASTVisitor<Derived, void> {
+public:
+    using ASTVisitor<Derived, void>::visit;
+
+    void visit_program(ProgramNode& node) { walk(node.children); }
+    void visit_function(FunctionNode& node) {
+        for (auto& parameter : node.parameters) this->visit(*parameter);
+        walk(node.body);
+    }
+    void visit_parameter(ParameterNode&) {}
+    void visit_declaration(DeclarationNode& node) {
+        walk(node.size);
+        walk(node.initializer);
+    }
+    void visit_assignment(AssignmentNode& node) {
+        walk(node.index);
+        walk(node.expression);
+    }
+    void visit_if(IfNode& node) {
+        walk(node.condition);
+        walk(node.body);
+        walk(node.elseBody);
+    }
+    void visit_while(WhileNode& node) {
+        walk(node.condition);
+        walk(node.body);
+    }
+    void visit_return(ReturnNode& node) { walk(node.expression); }
+    void visit_break(BreakNode&) {}
+    void visit_block(BlockNode& node) { walk(node.statements); }
+    void visit_binary_op(BinaryOpNode& node) {
+        walk(node.left);
+        walk(node.right);
+    }
+    void visit_unary_op(UnaryOpNode& node) { walk(node.operand); }
+    void visit_literal(LiteralNode&) {}
+    void visit_variable(VariableNode&) {}
+    void visit_function_call(FunctionCallNode& node) { walk(node.arguments); }
+    void visit_index(IndexNode& node) {
+        walk(node.array);
+        walk(node.index);
+    }
+    void visit_error(ErrorNode&) {}
+
+protected:
+    void walk(const ASTNodePTR& node) {
+        if (node) this->visit(*node);
+    }
+    void walk(const std::vector<ASTNodePTR>& nodes) {
+        for (const auto& node : nodes) walk(node);
+    }
+};
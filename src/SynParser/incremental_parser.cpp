@@ -0,0 +1,174 @@
+#include "incremental_parser.hpp"
+#include "ast_visitor.hpp"
+#include <algorithm>
+
+namespace {
+
+// Moves the nodes of a reused item to where its tokens are now. The edit
+// lies before the item, so every line moves by the same amount, while
+// columns only move on the line the item starts on
+class LocationShift : public ASTWalker<LocationShift> {
+public:
+    LocationShift(int first_line, int line_delta, int column_delta)
+        : first_line(first_line), line_delta(line_delta), column_delta(column_delta) {}
+
+    void visit_program(ProgramNode& node) { shift(node); ASTWalker::visit_program(node); }
+    void visit_function(FunctionNode& node) { shift(node); ASTWalker::visit_function(node); }
+    void visit_parameter(ParameterNode& node) { shift(node); }
+    void visit_declaration(DeclarationNode& node) { shift(node); ASTWalker::visit_declaration(node); }
+    void visit_assignment(AssignmentNode& node) { shift(node); ASTWalker::visit_assignment(node); }
+    void visit_if(IfNode& node) { shift(node); ASTWalker::visit_if(node); }
+    void visit_while(WhileNode& node) { shift(node); ASTWalker::visit_while(node); }
+    void visit_return(ReturnNode& node) { shift(node); ASTWalker::visit_return(node); }
+    void visit_break(BreakNode& node) { shift(node); }
+    void visit_block(BlockNode& node) { shift(node); ASTWalker::visit_block(node); }
+    void visit_binary_op(BinaryOpNode& node) { shift(node); ASTWalker::visit_binary_op(node); }
+    void visit_unary_op(UnaryOpNode& node) { shift(node); ASTWalker::visit_unary_op(node); }
+    void visit_literal(LiteralNode& node) { shift(node); }
+    void visit_variable(VariableNode& node) { shift(node); }
+    void visit_function_call(FunctionCallNode& node) { shift(node); ASTWalker::visit_function_call(node); }
+    void visit_index(IndexNode& node) { shift(node); ASTWalker::visit_index(node); }
+    void visit_error(ErrorNode& node) { shift(node); }
+
+private:
+    void shift(ASTNode& node) const {
+        if (node.line == first_line) node.column += column_delta;
+        node.line += line_delta;
+    }
+
+    int first_line;
+    int line_delta;
+    int column_delta;
+};
+
+} // namespace
+
+IncrementalParser::Item IncrementalParser::parse_item(const std::vector<Token>& tokens, TokenRange range) {
+    SyntaxParser parser(tokens, range.begin, range.end);
+    auto slice_program = std::static_pointer_cast<ProgramNode>(parser.parse_program());
+    return Item{range, tokens[range.begin].line, tokens[range.begin].column,
+                std::move(slice_program->children), parser.get_diagnostics()};
+}
+
+/**
+ * Bring a reused item's locations in line with the new token stream
+ * @return false when the item has diagnostics and moved. Their messages
+ *         spell out the old locations, so the caller parses it again
+ */
+bool IncrementalParser::relocate(Item& item, const std::vector<Token>& tokens) {
+    const Token& first = tokens[item.range.begin];
+    if (first.line == item.line && first.column == item.column) return true;
+    if (!item.diagnostics.empty()) return false;
+
+    LocationShift shift(item.line, first.line - item.line, first.column - item.column);
+    for (const auto& node : item.nodes) shift.visit(*node);
+    item.line = first.line;
+    item.column = first.column;
+    return true;
+}
+
+ASTNodePTR IncrementalParser::parse(const std::vector<Token>& tokens) {
+    program = std::make_shared<ProgramNode>();
+    if (!tokens.empty()) {
+        program->line = tokens.front().line;
+        program->column = tokens.front().column;
+    }
+
+    items.clear();
+    for (const TokenRange& range : ParallelParser::split_top_level(tokens)) {
+        items.push_back(parse_item(tokens, range));
+    }
+
+    reused = 0;
+    reparsed = items.size();
+    rebuild_program();
+    return program;
+}
+
+/**
+ * Reparse after an edit. Items that end before the edit are kept as is.
+ * From the first touched item the new tokens are re-split until an item
+ * boundary lines up with an old boundary past the edit; from there on the
+ * old items are kept, their ranges shifted by the edit's size and their
+ * node locations moved to match
+ * @param tokens the full token stream after the edit
+ * @param edit which tokens changed
+ * @return the same ProgramNode handle, with updated children
+ */
+ASTNodePTR IncrementalParser::reparse(const std::vector<Token>& tokens, const TokenEdit& edit) {
+    if (!program) {
+        return parse(tokens);
+    }
+    if (!tokens.empty()) {
+        program->line = tokens.front().line;
+        program->column = tokens.front().column;
+    }
+
+    size_t token_end = tokens.size();
+    if (token_end > 0 && tokens.back().type == TokenType::END_OF_FILE) {
+        token_end--;
+    }
+    const std::ptrdiff_t delta = static_cast<std::ptrdiff_t>(edit.new_end) -
+                                 static_cast<std::ptrdiff_t>(edit.old_end);
+
+    // first item the edit can affect. One ending right at the edit counts,
+    // since appending 'else { ... }' to an if changes that item
+    auto first = std::lower_bound(items.begin(), items.end(), edit.start,
+        [](const Item& item, size_t start) { return item.range.end < start; });
+    size_t first_index = first - items.begin();
+    size_t pos = first_index < items.size() ? items[first_index].range.begin
+               : items.empty() ? 0 : items.back().range.end;
+
+    std::vector<Item> fresh;
+    size_t resync = items.size();  // old item the new split lines back up with
+
+    for (size_t old_index = first_index; pos < token_end;) {
+        size_t item_end = ParallelParser::next_item_end(tokens, pos, token_end);
+        fresh.push_back(parse_item(tokens, {pos, item_end}));
+        pos = item_end;
+
+        if (pos < edit.new_end) {
+            continue;
+        }
+
+        // past the edit, so the same position in the old stream is pos - delta
+        size_t old_pos = static_cast<size_t>(static_cast<std::ptrdiff_t>(pos) - delta);
+        while (old_index < items.size() && items[old_index].range.begin < old_pos) {
+            old_index++;
+        }
+        if (old_index < items.size() && items[old_index].range.begin == old_pos) {
+            resync = old_index;
+            break;
+        }
+    }
+
+    // shift the untouched tail, then splice the freshly parsed items in
+    size_t moved_with_errors = 0;
+    for (size_t i = resync; i < items.size(); ++i) {
+        items[i].range.begin = static_cast<size_t>(static_cast<std::ptrdiff_t>(items[i].range.begin) + delta);
+        items[i].range.end = static_cast<size_t>(static_cast<std::ptrdiff_t>(items[i].range.end) + delta);
+        if (!relocate(items[i], tokens)) {
+            items[i] = parse_item(tokens, items[i].range);
+            moved_with_errors++;
+        }
+    }
+
+    reparsed = fresh.size() + moved_with_errors;
+    reused = items.size() - (resync - first_index) - moved_with_errors;
+
+    items.erase(items.begin() + first_index, items.begin() + resync);
+    items.insert(items.begin() + first_index,
+                 std::make_move_iterator(fresh.begin()), std::make_move_iterator(fresh.end()));
+
+    rebuild_program();
+    return program;
+}
+
+void IncrementalParser::rebuild_program() {
+    program->children.clear();
+    diagnostics.clear();
+    for (const Item& item : items) {
+        program->children.insert(program->children.end(), item.nodes.begin(), item.nodes.end());
+        diagnostics.insert(diagnostics.end(), item.diagnostics.begin(), item.diagnostics.end());
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "parallel_parser.hpp"
+
+// Token-level description of an edit: tokens [start, old_end) of the
+// previous stream were replaced by tokens [start, new_end) of the new one
+struct TokenEdit {
+    size_t start;
+    size_t old_end;
+    size_t new_end;
+};
+
+// === Incremental Parser ===
+// Keeps the top-level items (functions, global statements) of the last
+// parse along with their token ranges. After an edit only the items the
+// edit touches are re-split and reparsed; every other item keeps the exact
+// same node handles, so caches keyed on those nodes stay valid.
+//
+// Items after an edit that moved them get their node locations updated
+// in place. One that also has diagnostics is parsed again, since its
+// messages name the old locations.
+class IncrementalParser {
+public:
+    ASTNodePTR parse(const std::vector<Token>& tokens);
+    ASTNodePTR reparse(const std::vector<Token>& tokens, const TokenEdit& edit);
+
+    ASTNodePTR get_program() const { return program; }
+    const std::vector<Diagnostic>& get_diagnostics() const { return diagnostics; }
+    bool has_errors() const { return !diagnostics.empty(); }
+
+    // items carried over untouched / parsed again by the last reparse
+    size_t reused_items() const { return reused; }
+    size_t reparsed_items() const { return reparsed; }
+
+private:
+    struct Item {
+        TokenRange range;
+        int line;                               // location of the first token
+        int column;
+        std::vector<ASTNodePTR> nodes;          // usually one, more or none after recovery
+        std::vector<Diagnostic> diagnostics;
+    };
+
+    static Item parse_item(const std::vector<Token>& tokens, TokenRange range);
+    static bool relocate(Item& item, const std::vector<Token>& tokens);
+    void rebuild_program();
+
+    std::shared_ptr<ProgramNode> program;
+    std::vector<Item> items;
+    std::vector<Diagnostic> diagnostics;
+    size_t reused = 0;
+    size_t reparsed = 0;
+};
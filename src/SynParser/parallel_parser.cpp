@@ -0,0 +1,114 @@
+#include "parallel_parser.hpp"
+#include "../Support/thread_pool.hpp"
+
+ParallelParser::ParallelParser(const std::vector<Token>& tokens, unsigned threads)
+    : tokens(tokens), threads(threads) {}
+
+/**
+ * Find where the top-level item starting at begin ends. An item ends at a
+ * ';' or at the '}' that brings the nesting back to zero, unless an 'else'
+ * follows. No grammar knowledge is needed beyond that, so the scan is a
+ * single linear pass that never allocates
+ * @param tokens token stream
+ * @param begin first token of the item
+ * @param end scan limit (normally the END_OF_FILE index)
+ * @return one past the item's last token
+ */
+size_t ParallelParser::next_item_end(const std::vector<Token>& tokens, size_t begin, size_t end) {
+    int braces = 0;
+    int parens = 0;
+
+    for (size_t i = begin; i < end; ++i) {
+        bool closes_item = false;
+
+        switch (tokens[i].type) {
+            case TokenType::LEFT_BRACE:
+                braces++;
+                break;
+            case TokenType::RIGHT_BRACE:
+                // a stray '}' at the top level is its own (erroneous) item
+                closes_item = braces <= 1 && parens == 0;
+                braces = braces > 0 ? braces - 1 : 0;
+                break;
+            case TokenType::LEFT_PAREN:
+                parens++;
+                break;
+            case TokenType::RIGHT_PAREN:
+                parens = parens > 0 ? parens - 1 : 0;
+                break;
+            case TokenType::SEMICOLON:
+                closes_item = braces == 0 && parens == 0;
+                break;
+            default:
+                break;
+        }
+
+        if (closes_item && (i + 1 >= end || tokens[i + 1].type != TokenType::KEY_ELSE)) {
+            return i + 1;
+        }
+    }
+
+    // whatever is left (e.g. a statement missing its ';') is the last item
+    return end;
+}
+
+/**
+ * Find the boundaries of every top-level function and global statement
+ * @param tokens full token stream, END_OF_FILE last
+ * @return one range per top-level item, in source order
+ */
+std::vector<TokenRange> ParallelParser::split_top_level(const std::vector<Token>& tokens) {
+    std::vector<TokenRange> slices;
+    size_t end = tokens.size();
+    if (end > 0 && tokens.back().type == TokenType::END_OF_FILE) {
+        end--;
+    }
+
+    for (size_t begin = 0; begin < end;) {
+        size_t item_end = next_item_end(tokens, begin, end);
+        slices.push_back({begin, item_end});
+        begin = item_end;
+    }
+    return slices;
+}
+
+ASTNodePTR ParallelParser::parse_program() {
+    auto programNode = std::make_shared<ProgramNode>();
+    if (!tokens.empty()) {
+        programNode->line = tokens.front().line;
+        programNode->column = tokens.front().column;
+    }
+
+    std::vector<TokenRange> slices = split_top_level(tokens);
+
+    // each slot is written by exactly one task, so no locking is needed
+    std::vector<std::vector<ASTNodePTR>> results(slices.size());
+    std::vector<std::vector<Diagnostic>> slice_diagnostics(slices.size());
+
+    auto parse_slice = [&](size_t i) {
+        SyntaxParser parser(tokens, slices[i].begin, slices[i].end);
+        auto slice_program = std::static_pointer_cast<ProgramNode>(parser.parse_program());
+        results[i] = std::move(slice_program->children);
+        slice_diagnostics[i] = parser.get_diagnostics();
+    };
+
+    if (slices.size() < min_parallel_slices || threads == 1) {
+        for (size_t i = 0; i < slices.size(); ++i) {
+            parse_slice(i);
+        }
+    } else {
+        ThreadPool pool(threads);
+        pool.parallel_for(slices.size(), parse_slice);
+    }
+
+    diagnostics.clear();
+    for (size_t i = 0; i < slices.size(); ++i) {
+        for (auto& child : results[i]) {
+            programNode->children.push_back(std::move(child));
+        }
+        for (auto& diagnostic : slice_diagnostics[i]) {
+            diagnostics.push_back(std::move(diagnostic));
+        }
+    }
+    return programNode;
+}
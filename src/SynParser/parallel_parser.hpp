@@ -0,0 +1,34 @@
+#pragma once
+#include "syntax_parser.hpp"
+
+// Half-open range of token indices [begin, end)
+struct TokenRange {
+    size_t begin;
+    size_t end;
+};
+
+// === Parallel Parser ===
+// Splits the token stream into top-level functions and global statements
+// with a brace-matching pre-scan, parses each slice with its own
+// SyntaxParser on a thread pool, then stitches the results back into a
+// single ProgramNode in source order
+class ParallelParser {
+public:
+    explicit ParallelParser(const std::vector<Token>& tokens, unsigned threads = 0);
+
+    ASTNodePTR parse_program();
+
+    const std::vector<Diagnostic>& get_diagnostics() const { return diagnostics; }
+    bool has_errors() const { return !diagnostics.empty(); }
+
+    static std::vector<TokenRange> split_top_level(const std::vector<Token>& tokens);
+    static size_t next_item_end(const std::vector<Token>& tokens, size_t begin, size_t end);
+
+private:
+    const std::vector<Token>& tokens;
+    unsigned threads;
+    std::vector<Diagnostic> diagnostics;
+
+    // below this many slices the pool costs more than it saves
+    static constexpr size_t min_parallel_slices = 64;
+};
@@ -2,51 +2,59 @@
 #include <iostream>
 #include <stdexcept>
 
-// Helper function to convert TokenType to string
-std::string tokenTypeToString(TokenType type) {
+TypeId type_from_name(const std::string& name) {
+    if (name.size() > 2 && name.compare(name.size() - 2, 2, "[]") == 0) {
+        return array_of(type_from_name(name.substr(0, name.size() - 2)));
+    }
+    if (name == "int") return TypeId::Int;
+    if (name == "float") return TypeId::Float;
+    if (name == "string") return TypeId::String;
+    if (name == "bool") return TypeId::Bool;
+    if (name == "char") return TypeId::Char;
+    return TypeId::Unknown;
+}
+
+const char* typeIdToString(TypeId type) {
     switch (type) {
-        case TokenType::IDENTIFIER: return "IDENTIFIER";
-        case TokenType::INT_LIT: return "INT_LIT";
-        case TokenType::FLOAT_LIT: return "FLOAT_LIT";
-        case TokenType::STR_LIT: return "STR_LIT";
-        case TokenType::KEY_IF: return "KEY_IF";
-        case TokenType::KEY_ELSE: return "KEY_ELSE";
-        case TokenType::KEY_WHILE: return "KEY_WHILE";
-        case TokenType::KEY_FOR: return "KEY_FOR";
-        case TokenType::KEY_PRINT: return "KEY_PRINT";
-        case TokenType::KEY_READ: return "KEY_READ";
-        case TokenType::DATATYPE_INT: return "DATATYPE_INT";
-        case TokenType::DATATYPE_FLOAT: return "DATATYPE_FLOAT";
-        case TokenType::DATATYPE_STRING: return "DATATYPE_STRING";
-        case TokenType::LEFT_PAREN: return "LEFT_PAREN";
-        case TokenType::RIGHT_PAREN: return "RIGHT_PAREN";
-        case TokenType::LEFT_BRACE: return "LEFT_BRACE";
-        case TokenType::RIGHT_BRACE: return "RIGHT_BRACE";
-        case TokenType::LEFT_BRACKET: return "LEFT_BRACKET";
-        case TokenType::RIGHT_BRACKET: return "RIGHT_BRACKET";
-        case TokenType::SEMICOLON: return "SEMICOLON";
-        case TokenType::COLON: return "COLON";
-        case TokenType::COMMA: return "COMMA";
-        case TokenType::ASSIGN_OP: return "ASSIGN_OP";
-        case TokenType::EQUAL_OP: return "EQUAL_OP";
-        case TokenType::NOT_EQUAL_OP: return "NOT_EQUAL_OP";
-        case TokenType::LESSER_OP: return "LESSER_OP";
-        case TokenType::LEQUAL_OP: return "LEQUAL_OP";
-        case TokenType::GREATER_OP: return "GREATER_OP";
-        case TokenType::GEQUAL_OP: return "GEQUAL_OP";
-        case TokenType::ADD_OP: return "ADD_OP";
-        case TokenType::SUB_OP: return "SUB_OP";
-        case TokenType::MUL_OP: return "MUL_OP";
-        case TokenType::DIV_OP: return "DIV_OP";
-        case TokenType::MOD_OP: return "MOD_OP";
-        case TokenType::POW_OP: return "POW_OP";
-        case TokenType::AND_OP: return "AND_OP";
-        case TokenType::OR_OP: return "OR_OP";
-        case TokenType::NOT_OP: return "NOT_OP";
-        case TokenType::INT_DIV_OP: return "INT_DIV_OP";
-        case TokenType::END_OF_FILE: return "END_OF_FILE";
-        case TokenType::UNKNOWN: return "UNKNOWN";
-        default: return "UNKNOWN";
+        case TypeId::Unknown: return "unknown";
+        case TypeId::Void: return "void";
+        case TypeId::Int: return "int";
+        case TypeId::Float: return "float";
+        case TypeId::String: return "string";
+        case TypeId::Bool: return "bool";
+        case TypeId::Char: return "char";
+        case TypeId::IntArray: return "int[]";
+        case TypeId::FloatArray: return "float[]";
+        case TypeId::StringArray: return "string[]";
+        case TypeId::BoolArray: return "bool[]";
+        case TypeId::CharArray: return "char[]";
+    }
+    return "unknown";
+}
+
+bool is_array(TypeId type) {
+    return element_type(type) != TypeId::Unknown;
+}
+
+TypeId element_type(TypeId array) {
+    switch (array) {
+        case TypeId::IntArray: return TypeId::Int;
+        case TypeId::FloatArray: return TypeId::Float;
+        case TypeId::StringArray: return TypeId::String;
+        case TypeId::BoolArray: return TypeId::Bool;
+        case TypeId::CharArray: return TypeId::Char;
+        default: return TypeId::Unknown;
+    }
+}
+
+TypeId array_of(TypeId element) {
+    switch (element) {
+        case TypeId::Int: return TypeId::IntArray;
+        case TypeId::Float: return TypeId::FloatArray;
+        case TypeId::String: return TypeId::StringArray;
+        case TypeId::Bool: return TypeId::BoolArray;
+        case TypeId::Char: return TypeId::CharArray;
+        default: return TypeId::Unknown;
     }
 }
 
@@ -54,6 +62,20 @@ std::string tokenTypeToString(TokenType type) {
 SyntaxParser::SyntaxParser(const std::vector<Token> &tokens)
     : tokens(tokens), current(0) {}
 
+SyntaxParser::SyntaxParser(const std::vector<Token> &tokens, size_t begin, size_t end)
+    : tokens(tokens.begin() + begin, tokens.begin() + end), current(0) {
+    // a slice that runs to the end of the file ends at the real END_OF_FILE,
+    // so errors there name the same place a full parse does. Any other
+    // slice gets its own, on its last token
+    if (end < tokens.size() && tokens[end].type == TokenType::END_OF_FILE) {
+        this->tokens.push_back(tokens[end]);
+        return;
+    }
+    int line = this->tokens.empty() ? -1 : this->tokens.back().line;
+    int column = this->tokens.empty() ? -1 : this->tokens.back().column;
+    this->tokens.emplace_back("", TokenType::END_OF_FILE, line, column);
+}
+
 // === Utility Functions ===
 const Token& SyntaxParser::peek() const {
     if (current >= tokens.size()) {
@@ -63,6 +85,14 @@ const Token& SyntaxParser::peek() const {
     return tokens[current];
 }
 
+const Token& SyntaxParser::peek_next() const {
+    if (current + 1 >= tokens.size()) {
+        static Token eofToken{"", TokenType::END_OF_FILE, -1, -1};
+        return eofToken;
+    }
+    return tokens[current + 1];
+}
+
 const Token& SyntaxParser::advance() {
     if (!isAtEnd()) {
         current++;
@@ -102,15 +132,687 @@ void SyntaxParser::setSourceLocation(ASTNodePTR node, const Token& token) const
 }
 
 [[noreturn]] void SyntaxParser::error(const std::string& msg, int line, int column) {
-    throw std::runtime_error("Parse error at line " + std::to_string(line) +
-                            ", column " + std::to_string(column) + ": " + msg);
+    throw ParseError("Parse error at line " + std::to_string(line) +
+                     ", column " + std::to_string(column) + ": " + msg, line, column);
+}
+
+// === Panic-mode Recovery ===
+
+bool SyntaxParser::is_type_token(TokenType type) {
+    switch (type) {
+        case TokenType::DATATYPE_INT:
+        case TokenType::DATATYPE_FLOAT:
+        case TokenType::DATATYPE_STRING:
+        case TokenType::DATATYPE_BOOL:
+        case TokenType::DATATYPE_CHAR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool SyntaxParser::starts_statement(TokenType type) {
+    switch (type) {
+        case TokenType::KEY_FUNCTION:
+        case TokenType::KEY_VAR:
+        case TokenType::KEY_IF:
+        case TokenType::KEY_WHILE:
+        case TokenType::KEY_FOR:
+        case TokenType::KEY_RETURN:
+        case TokenType::KEY_PRINT:
+        case TokenType::KEY_READ:
+            return true;
+        default:
+            return is_type_token(type);
+    }
+}
+
+/**
+ * Record a parse error and skip ahead so parsing can resume
+ * @param err the error that aborted the current statement
+ * @param start token index the failed statement began at
+ * @return an ErrorNode standing in for the failed statement
+ */
+ASTNodePTR SyntaxParser::recover(const ParseError& err, size_t start) {
+    diagnostics.push_back({err.what(), err.line, err.column});
+
+    auto node = std::make_shared<ErrorNode>(err.what());
+    node->line = err.line;
+    node->column = err.column;
+
+    // guarantee progress, otherwise a stray token would be reported forever
+    if (current == start && !isAtEnd()) {
+        advance();
+    }
+    synchronize();
+    return node;
 }
 
+/**
+ * Skip tokens until the start of the next statement. A ';' at the
+ * current nesting level is consumed, a '}' closing the enclosing block
+ * is left for the block to match, and parens/braces opened while skipping
+ * are skipped as a whole so a broken if/while header doesn't leak its body
+ */
+void SyntaxParser::synchronize() {
+    int depth = 0;
+    int parens = 0;
+
+    while (!isAtEnd()) {
+        TokenType type = peek().type;
+
+        if (type == TokenType::LEFT_PAREN) {
+            parens++;
+        } else if (type == TokenType::RIGHT_PAREN && parens > 0) {
+            parens--;
+        }
+
+        if (depth == 0 && parens == 0) {
+            if (type == TokenType::SEMICOLON) {
+                advance();
+                return;
+            }
+            if (type == TokenType::RIGHT_BRACE || starts_statement(type)) {
+                return;
+            }
+        }
+
+        if (type == TokenType::LEFT_BRACE) {
+            depth++;
+        } else if (type == TokenType::RIGHT_BRACE) {
+            depth--;
+            if (depth == 0) {
+                advance();
+                return;
+            }
+        }
+        advance();
+    }
+}
+
+// === Grammar Rules ===
+
 ASTNodePTR SyntaxParser::parse_program() {
     auto programNode = std::make_shared<ProgramNode>();
-    std::cout << "Parsing program..." << std::endl;
-    std::cout << "Total tokens: " << tokens.size() << std::endl;
-    std::cout << "Current token: " << peek().lexeme << " (" << tokenTypeToString(peek().type) << ")" << std::endl;
+    if (!tokens.empty()) {
+        setSourceLocation(programNode, tokens.front());
+    }
+
+    while (!isAtEnd()) {
+        size_t start = current;
+        try {
+            if (check(TokenType::KEY_FUNCTION)) {
+                programNode->children.push_back(parse_function());
+            } else if (check(TokenType::RIGHT_BRACE)) {
+                error("Unexpected '}' outside of a block", peek().line, peek().column);
+            } else {
+                programNode->children.push_back(parse_statement());
+            }
+        } catch (const ParseError& err) {
+            programNode->children.push_back(recover(err, start));
+        }
+    }
     return programNode;
 }
 
+ASTNodePTR SyntaxParser::parse_function() {
+    auto functionNode = std::make_shared<FunctionNode>();
+    setSourceLocation(functionNode, peek());
+    match(TokenType::KEY_FUNCTION);
+
+    const Token& name = peek();
+    match(TokenType::IDENTIFIER);
+    functionNode->name = name.lexeme;
+
+    match(TokenType::LEFT_PAREN);
+    functionNode->parameters = parse_parameter_list();
+    match(TokenType::RIGHT_PAREN);
+
+    // optional return type: -> type
+    if (check(TokenType::SUB_OP) && peek_next().type == TokenType::GREATER_OP) {
+        advance();
+        advance();
+        if (!is_type_token(peek().type)) {
+            error("Expected return type but found " + tokenTypeToString(peek().type),
+                  peek().line, peek().column);
+        }
+        functionNode->returnType = parse_type();
+    }
+
+    auto block = std::static_pointer_cast<BlockNode>(parse_block());
+    functionNode->body = std::move(block->statements);
+    return functionNode;
+}
+
+std::vector<std::shared_ptr<ParameterNode>> SyntaxParser::parse_parameter_list() {
+    std::vector<std::shared_ptr<ParameterNode>> parameters;
+    if (check(TokenType::RIGHT_PAREN)) {
+        return parameters;
+    }
+
+    do {
+        parameters.push_back(parse_parameter());
+    } while (consume(TokenType::COMMA));
+    return parameters;
+}
+
+std::shared_ptr<ParameterNode> SyntaxParser::parse_parameter() {
+    auto parameterNode = std::make_shared<ParameterNode>();
+    setSourceLocation(parameterNode, peek());
+
+    // the type is optional: function f(n) and function f(int n) are both valid
+    if (is_type_token(peek().type)) {
+        parameterNode->type = parse_type();
+    }
+
+    const Token& name = peek();
+    match(TokenType::IDENTIFIER);
+    parameterNode->name = name.lexeme;
+
+    // an array parameter may also be written C style: function f(int a[])
+    if (check(TokenType::LEFT_BRACKET)) {
+        if (parameterNode->type.empty() || parameterNode->type.back() == ']') {
+            error("'[]' needs an element type", peek().line, peek().column);
+        }
+        advance();
+        match(TokenType::RIGHT_BRACKET);
+        parameterNode->type += "[]";
+    }
+    return parameterNode;
+}
+
+std::string SyntaxParser::parse_type() {
+    std::string type = advance().lexeme;
+    if (check(TokenType::LEFT_BRACKET) && peek_next().type == TokenType::RIGHT_BRACKET) {
+        advance();
+        advance();
+        type += "[]";
+    }
+    return type;
+}
+
+ASTNodePTR SyntaxParser::parse_statement() {
+    switch (peek().type) {
+        case TokenType::KEY_VAR:
+            return parse_declaration();
+        case TokenType::KEY_IF:
+            return parse_if();
+        case TokenType::KEY_WHILE:
+            return parse_while();
+        case TokenType::KEY_FOR:
+            return parse_for();
+        case TokenType::KEY_RETURN:
+            return parse_return();
+        case TokenType::KEY_BREAK:
+            return parse_break();
+        case TokenType::LEFT_BRACE:
+            return parse_block();
+        case TokenType::KEY_FUNCTION:
+            error("Functions can only be declared at the top level", peek().line, peek().column);
+        case TokenType::IDENTIFIER:
+            if (peek_next().type == TokenType::ASSIGN_OP) {
+                return parse_assignment();
+            }
+            if (peek_next().type == TokenType::LEFT_BRACKET) {
+                if (auto assignment = parse_element_assignment()) return assignment;
+            }
+            if (peek_next().type == TokenType::INC_OP || peek_next().type == TokenType::DEC_OP) {
+                auto increment = parse_increment();
+                match(TokenType::SEMICOLON);
+                return increment;
+            }
+            return parse_expression_statement();
+        default:
+            if (is_type_token(peek().type)) {
+                return parse_declaration();
+            }
+            return parse_expression_statement();
+    }
+}
+
+ASTNodePTR SyntaxParser::parse_declaration() {
+    auto declarationNode = std::make_shared<DeclarationNode>();
+    setSourceLocation(declarationNode, peek());
+
+    // 'var' leaves the type to be inferred from the initializer
+    if (consume(TokenType::KEY_VAR)) {
+        declarationNode->type = "var";
+    } else {
+        declarationNode->type = parse_type();
+    }
+
+    const Token& name = peek();
+    match(TokenType::IDENTIFIER);
+    declarationNode->name = name.lexeme;
+
+    // 'int a[n];' makes a new array of n elements; 'int a[] = b;' names an existing one
+    if (check(TokenType::LEFT_BRACKET)) {
+        const Token& bracket = advance();
+        if (declarationNode->type == "var" || declarationNode->type.back() == ']') {
+            error("'[]' needs an element type", bracket.line, bracket.column);
+        }
+        declarationNode->type += "[]";
+        if (!check(TokenType::RIGHT_BRACKET)) {
+            declarationNode->size = parse_expression();
+        }
+        match(TokenType::RIGHT_BRACKET);
+    }
+
+    if (!declarationNode->size && consume(TokenType::ASSIGN_OP)) {
+        declarationNode->initializer = parse_expression();
+    } else if (declarationNode->type == "var") {
+        error("'var' declaration of '" + declarationNode->name + "' needs an initializer",
+              peek().line, peek().column);
+    } else if (!declarationNode->size && declarationNode->type.back() == ']') {
+        error("array '" + declarationNode->name + "' needs a size or an initializer",
+              peek().line, peek().column);
+    }
+
+    match(TokenType::SEMICOLON);
+    return declarationNode;
+}
+
+ASTNodePTR SyntaxParser::parse_assignment() {
+    auto assignmentNode = std::make_shared<AssignmentNode>();
+    setSourceLocation(assignmentNode, peek());
+
+    assignmentNode->name = advance().lexeme;
+    match(TokenType::ASSIGN_OP);
+    assignmentNode->expression = parse_expression();
+    match(TokenType::SEMICOLON);
+    return assignmentNode;
+}
+
+/**
+ * Parse 'a[i] = v;'. When the brackets turn out to start an expression
+ * statement instead ('a[i];'), nothing is consumed and nullptr comes back
+ */
+ASTNodePTR SyntaxParser::parse_element_assignment() {
+    size_t start = current;
+    auto assignmentNode = std::make_shared<AssignmentNode>();
+    setSourceLocation(assignmentNode, peek());
+
+    assignmentNode->name = advance().lexeme;
+    match(TokenType::LEFT_BRACKET);
+    assignmentNode->index = parse_expression();
+    match(TokenType::RIGHT_BRACKET);
+    if (!consume(TokenType::ASSIGN_OP)) {
+        current = start;
+        return nullptr;
+    }
+    assignmentNode->expression = parse_expression();
+    match(TokenType::SEMICOLON);
+    return assignmentNode;
+}
+
+ASTNodePTR SyntaxParser::parse_if() {
+    auto ifNode = std::make_shared<IfNode>();
+    setSourceLocation(ifNode, peek());
+    match(TokenType::KEY_IF);
+
+    match(TokenType::LEFT_PAREN);
+    ifNode->condition = parse_expression();
+    match(TokenType::RIGHT_PAREN);
+    ifNode->body = parse_body();
+
+    if (consume(TokenType::KEY_ELSE)) {
+        if (check(TokenType::KEY_IF)) {
+            ifNode->elseBody.push_back(parse_if());
+        } else {
+            ifNode->elseBody = parse_body();
+        }
+    }
+    return ifNode;
+}
+
+ASTNodePTR SyntaxParser::parse_while() {
+    auto whileNode = std::make_shared<WhileNode>();
+    setSourceLocation(whileNode, peek());
+    match(TokenType::KEY_WHILE);
+
+    match(TokenType::LEFT_PAREN);
+    whileNode->condition = parse_expression();
+    match(TokenType::RIGHT_PAREN);
+    whileNode->body = parse_loop_body();
+    return whileNode;
+}
+
+/**
+ * Parse 'for (init; condition; update) body'. There is no ForNode: the
+ * loop is desugared into the equivalent
+ *
+ *     { init; while (condition) { { body } update; } }
+ *
+ * so every later phase handles one loop form. The outer block scopes
+ * the init declaration to the loop and the inner one keeps the body's
+ * declarations away from the update. A missing condition is 'true'
+ */
+ASTNodePTR SyntaxParser::parse_for() {
+    const Token& keyword = peek();
+    auto scope = std::make_shared<BlockNode>();
+    auto loop = std::make_shared<WhileNode>();
+    setSourceLocation(scope, keyword);
+    setSourceLocation(loop, keyword);
+    match(TokenType::KEY_FOR);
+    match(TokenType::LEFT_PAREN);
+
+    if (is_type_token(peek().type) || check(TokenType::KEY_VAR)) {
+        scope->statements.push_back(parse_declaration());  // consumes the ';'
+    } else {
+        if (!check(TokenType::SEMICOLON)) {
+            scope->statements.push_back(parse_for_clause());
+        }
+        match(TokenType::SEMICOLON);
+    }
+
+    if (check(TokenType::SEMICOLON)) {
+        loop->condition = std::make_shared<LiteralNode>("true", "bool");
+        setSourceLocation(loop->condition, peek());
+    } else {
+        loop->condition = parse_expression();
+    }
+    match(TokenType::SEMICOLON);
+
+    ASTNodePTR update;
+    if (!check(TokenType::RIGHT_PAREN)) {
+        update = parse_for_clause();
+    }
+    match(TokenType::RIGHT_PAREN);
+
+    auto body = std::make_shared<BlockNode>();
+    setSourceLocation(body, peek());
+    body->statements = parse_loop_body();
+    loop->body.push_back(body);
+    if (update) {
+        loop->body.push_back(update);
+    }
+
+    scope->statements.push_back(loop);
+    return scope;
+}
+
+/**
+ * Parse 'x++' or 'x--' as the assignment 'x = x + 1' / 'x = x - 1'
+ */
+ASTNodePTR SyntaxParser::parse_increment() {
+    const Token& name = peek();
+    match(TokenType::IDENTIFIER);
+    const Token& op = advance();
+
+    auto variable = std::make_shared<VariableNode>(name.lexeme);
+    setSourceLocation(variable, name);
+    auto one = std::make_shared<LiteralNode>("1", "int");
+    setSourceLocation(one, op);
+    auto sum = std::make_shared<BinaryOpNode>(op.type == TokenType::INC_OP ? "+" : "-", variable, one);
+    setSourceLocation(sum, op);
+
+    auto assignmentNode = std::make_shared<AssignmentNode>();
+    setSourceLocation(assignmentNode, name);
+    assignmentNode->name = name.lexeme;
+    assignmentNode->expression = sum;
+    return assignmentNode;
+}
+
+ASTNodePTR SyntaxParser::parse_for_clause() {
+    if (check(TokenType::IDENTIFIER)) {
+        TokenType next = peek_next().type;
+        if (next == TokenType::INC_OP || next == TokenType::DEC_OP) {
+            return parse_increment();
+        }
+        if (next == TokenType::ASSIGN_OP) {
+            auto assignmentNode = std::make_shared<AssignmentNode>();
+            setSourceLocation(assignmentNode, peek());
+            assignmentNode->name = advance().lexeme;
+            match(TokenType::ASSIGN_OP);
+            assignmentNode->expression = parse_expression();
+            return assignmentNode;
+        }
+    }
+    return parse_expression();
+}
+
+ASTNodePTR SyntaxParser::parse_return() {
+    auto returnNode = std::make_shared<ReturnNode>();
+    setSourceLocation(returnNode, peek());
+    match(TokenType::KEY_RETURN);
+
+    if (!check(TokenType::SEMICOLON)) {
+        returnNode->expression = parse_expression();
+    }
+    match(TokenType::SEMICOLON);
+    return returnNode;
+}
+
+ASTNodePTR SyntaxParser::parse_break() {
+    auto breakNode = std::make_shared<BreakNode>();
+    setSourceLocation(breakNode, peek());
+    if (loop_depth == 0) {
+        error("'break' outside of a loop", peek().line, peek().column);
+    }
+    match(TokenType::KEY_BREAK);
+    match(TokenType::SEMICOLON);
+    return breakNode;
+}
+
+/**
+ * Parse '{' statement* '}'. A statement that fails to parse is replaced
+ * by an ErrorNode and the block carries on with the next statement
+ */
+ASTNodePTR SyntaxParser::parse_block() {
+    auto blockNode = std::make_shared<BlockNode>();
+    setSourceLocation(blockNode, peek());
+    match(TokenType::LEFT_BRACE);
+
+    while (!check(TokenType::RIGHT_BRACE) && !isAtEnd()) {
+        size_t start = current;
+        try {
+            blockNode->statements.push_back(parse_statement());
+        } catch (const ParseError& err) {
+            blockNode->statements.push_back(recover(err, start));
+        }
+    }
+
+    match(TokenType::RIGHT_BRACE);
+    return blockNode;
+}
+
+std::vector<ASTNodePTR> SyntaxParser::parse_body() {
+    if (check(TokenType::LEFT_BRACE)) {
+        return std::move(std::static_pointer_cast<BlockNode>(parse_block())->statements);
+    }
+    return {parse_statement()};
+}
+
+std::vector<ASTNodePTR> SyntaxParser::parse_loop_body() {
+    ++loop_depth;
+    try {
+        auto body = parse_body();
+        --loop_depth;
+        return body;
+    } catch (...) {
+        --loop_depth;
+        throw;
+    }
+}
+
+ASTNodePTR SyntaxParser::parse_expression_statement() {
+    auto expression = parse_expression();
+    match(TokenType::SEMICOLON);
+    return expression;
+}
+
+// === Expressions ===
+
+ASTNodePTR SyntaxParser::parse_expression() {
+    return parse_logical_or();
+}
+
+ASTNodePTR SyntaxParser::parse_logical_or() {
+    auto left = parse_logical_and();
+    while (check(TokenType::OR_OP)) {
+        const Token& op = advance();
+        auto node = std::make_shared<BinaryOpNode>(op.lexeme, left, parse_logical_and());
+        setSourceLocation(node, op);
+        left = node;
+    }
+    return left;
+}
+
+ASTNodePTR SyntaxParser::parse_logical_and() {
+    auto left = parse_equality();
+    while (check(TokenType::AND_OP)) {
+        const Token& op = advance();
+        auto node = std::make_shared<BinaryOpNode>(op.lexeme, left, parse_equality());
+        setSourceLocation(node, op);
+        left = node;
+    }
+    return left;
+}
+
+ASTNodePTR SyntaxParser::parse_equality() {
+    auto left = parse_comparison();
+    while (check(TokenType::EQUAL_OP) || check(TokenType::NOT_EQUAL_OP)) {
+        const Token& op = advance();
+        auto node = std::make_shared<BinaryOpNode>(op.lexeme, left, parse_comparison());
+        setSourceLocation(node, op);
+        left = node;
+    }
+    return left;
+}
+
+ASTNodePTR SyntaxParser::parse_comparison() {
+    auto left = parse_term();
+    while (check(TokenType::LESSER_OP) || check(TokenType::LEQUAL_OP) ||
+           check(TokenType::GREATER_OP) || check(TokenType::GEQUAL_OP)) {
+        const Token& op = advance();
+        auto node = std::make_shared<BinaryOpNode>(op.lexeme, left, parse_term());
+        setSourceLocation(node, op);
+        left = node;
+    }
+    return left;
+}
+
+ASTNodePTR SyntaxParser::parse_term() {
+    auto left = parse_factor();
+    while (check(TokenType::ADD_OP) || check(TokenType::SUB_OP)) {
+        const Token& op = advance();
+        auto node = std::make_shared<BinaryOpNode>(op.lexeme, left, parse_factor());
+        setSourceLocation(node, op);
+        left = node;
+    }
+    return left;
+}
+
+ASTNodePTR SyntaxParser::parse_factor() {
+    auto left = parse_unary();
+    while (check(TokenType::MUL_OP) || check(TokenType::DIV_OP) ||
+           check(TokenType::MOD_OP) || check(TokenType::INT_DIV_OP)) {
+        const Token& op = advance();
+        auto node = std::make_shared<BinaryOpNode>(op.lexeme, left, parse_unary());
+        setSourceLocation(node, op);
+        left = node;
+    }
+    return left;
+}
+
+ASTNodePTR SyntaxParser::parse_unary() {
+    if (check(TokenType::SUB_OP) || check(TokenType::NOT_OP)) {
+        const Token& op = advance();
+        auto node = std::make_shared<UnaryOpNode>(op.lexeme, parse_unary());
+        setSourceLocation(node, op);
+        return node;
+    }
+    return parse_power();
+}
+
+// '**' binds tighter than unary minus on its left and is right associative
+ASTNodePTR SyntaxParser::parse_power() {
+    auto base = parse_postfix();
+    if (check(TokenType::POW_OP)) {
+        const Token& op = advance();
+        auto node = std::make_shared<BinaryOpNode>(op.lexeme, base, parse_unary());
+        setSourceLocation(node, op);
+        return node;
+    }
+    return base;
+}
+
+ASTNodePTR SyntaxParser::parse_postfix() {
+    auto expression = parse_primary();
+    while (check(TokenType::LEFT_BRACKET)) {
+        const Token& bracket = advance();
+        auto node = std::make_shared<IndexNode>(expression, parse_expression());
+        setSourceLocation(node, bracket);
+        match(TokenType::RIGHT_BRACKET);
+        expression = node;
+    }
+    return expression;
+}
+
+ASTNodePTR SyntaxParser::parse_primary() {
+    const Token& token = peek();
+
+    switch (token.type) {
+        case TokenType::INT_LIT:
+        case TokenType::FLOAT_LIT:
+        case TokenType::STR_LIT:
+        case TokenType::CHAR_LIT:
+        case TokenType::KEY_TRUE:
+        case TokenType::KEY_FALSE: {
+            static const char* literalTypes[] = {"int", "float", "string", "char", "bool"};
+            int index = token.type == TokenType::INT_LIT ? 0
+                      : token.type == TokenType::FLOAT_LIT ? 1
+                      : token.type == TokenType::STR_LIT ? 2
+                      : token.type == TokenType::CHAR_LIT ? 3 : 4;
+            auto node = std::make_shared<LiteralNode>(token.lexeme, literalTypes[index]);
+            setSourceLocation(node, token);
+            advance();
+            return node;
+        }
+        case TokenType::IDENTIFIER:
+            if (peek_next().type == TokenType::LEFT_PAREN) {
+                return parse_function_call();
+            } else {
+                auto node = std::make_shared<VariableNode>(token.lexeme);
+                setSourceLocation(node, token);
+                advance();
+                return node;
+            }
+        case TokenType::KEY_PRINT:
+        case TokenType::KEY_READ:
+            // print and read are builtins that parse like ordinary calls
+            return parse_function_call();
+        case TokenType::LEFT_PAREN: {
+            advance();
+            auto expression = parse_expression();
+            match(TokenType::RIGHT_PAREN);
+            return expression;
+        }
+        default:
+            error("Expected expression but found " + tokenTypeToString(token.type) +
+                  (token.lexeme.empty() ? "" : " '" + token.lexeme + "'"), token.line, token.column);
+    }
+}
+
+ASTNodePTR SyntaxParser::parse_function_call() {
+    auto callNode = std::make_shared<FunctionCallNode>(advance().lexeme);
+    setSourceLocation(callNode, tokens[current - 1]);
+
+    match(TokenType::LEFT_PAREN);
+    callNode->arguments = parse_argument_list();
+    match(TokenType::RIGHT_PAREN);
+    return callNode;
+}
+
+std::vector<ASTNodePTR> SyntaxParser::parse_argument_list() {
+    std::vector<ASTNodePTR> arguments;
+    if (check(TokenType::RIGHT_PAREN)) {
+        return arguments;
+    }
+
+    do {
+        arguments.push_back(parse_expression());
+    } while (consume(TokenType::COMMA));
+    return arguments;
+}
+
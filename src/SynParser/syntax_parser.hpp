@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <stdexcept>
 
 // === Node Type Identification ===
 enum class NodeType {
@@ -14,14 +15,61 @@ enum class NodeType {
     If,
     While,
     Return,
+    Break,
     Block,
     BinaryOp,
     UnaryOp,
     Literal,
     Variable,
-    FunctionCall
+    FunctionCall,
+    Index,
+    Error
 };
 
+// === Name Resolution ===
+// Where a name lives, filled in by NameResolver so later phases index
+// straight into frames instead of looking names up again
+enum class SymbolKind : unsigned char {
+    Unresolved,
+    Local,      // slot in the enclosing function's frame
+    Global,     // slot in the program's globals
+    Function,   // index among the program's functions, in source order
+    Builtin     // print, read, len
+};
+
+struct SymbolRef {
+    SymbolKind kind = SymbolKind::Unresolved;
+    int index = -1;
+};
+
+// === Types ===
+// Compact static type of a value, filled in by TypeChecker. Unknown is
+// left where the type depends on runtime values (untyped parameters), so
+// backends fall back to dynamically checked operations only there.
+// Arrays are always statically typed: an array never meets Unknown
+enum class TypeId : unsigned char {
+    Unknown,
+    Void,
+    Int,
+    Float,
+    String,
+    Bool,
+    Char,
+    IntArray,
+    FloatArray,
+    StringArray,
+    BoolArray,
+    CharArray
+};
+
+constexpr size_t type_count = static_cast<size_t>(TypeId::CharArray) + 1;
+
+TypeId type_from_name(const std::string& name);    // "int" -> Int, "int[]" -> IntArray, "var"/"" -> Unknown
+const char* typeIdToString(TypeId type);
+bool is_array(TypeId type);
+TypeId element_type(TypeId array);      // Int for IntArray; Unknown for a non-array
+TypeId array_of(TypeId element);        // IntArray for Int; Unknown where there is no such array
+
 // === AST Base ===
 struct ASTNode {
     NodeType type;
@@ -38,6 +86,7 @@ using ASTNodePTR = std::shared_ptr<ASTNode>;
 // === Program ===
 struct ProgramNode final : ASTNode {
     std::vector<ASTNodePTR> children; // functions, globals, etc.
+    std::vector<TypeId> globalTypes; // type per global slot, declared or inferred
 
     ProgramNode() : ASTNode(NodeType::Program) {}
 };
@@ -46,6 +95,7 @@ struct ProgramNode final : ASTNode {
 struct ParameterNode final : ASTNode {
     std::string type;
     std::string name;
+    SymbolRef symbol;
 
     ParameterNode() : ASTNode(NodeType::Parameter) {}
     ParameterNode(const std::string& t, const std::string& n)
@@ -58,6 +108,7 @@ struct FunctionNode final : ASTNode {
     std::string returnType;
     std::vector<std::shared_ptr<ParameterNode>> parameters;
     std::vector<ASTNodePTR> body;
+    std::vector<TypeId> localTypes; // type per frame slot, parameters first, declared or inferred
 
     FunctionNode() : ASTNode(NodeType::Function) {}
 };
@@ -69,16 +120,20 @@ protected:
 };
 
 struct DeclarationNode final : StatementNode {
-    std::string type;
+    std::string type;       // "int[]" for an array
     std::string name;
     ASTNodePTR initializer; // may be nullptr
+    ASTNodePTR size;        // element count of a new array ('int a[n];'), otherwise nullptr
+    SymbolRef symbol;
 
     DeclarationNode() : StatementNode(NodeType::Declaration) {}
 };
 
 struct AssignmentNode final : StatementNode {
     std::string name;
+    ASTNodePTR index;       // 'a[i] = v' stores into element i of array a; nullptr otherwise
     ASTNodePTR expression;
+    SymbolRef symbol;
 
     AssignmentNode() : StatementNode(NodeType::Assignment) {}
 };
@@ -104,6 +159,11 @@ struct ReturnNode final : StatementNode {
     ReturnNode() : StatementNode(NodeType::Return) {}
 };
 
+// leaves the innermost enclosing while or for loop
+struct BreakNode final : StatementNode {
+    BreakNode() : StatementNode(NodeType::Break) {}
+};
+
 struct BlockNode final : StatementNode {
     std::vector<ASTNodePTR> statements;
 
@@ -112,6 +172,8 @@ struct BlockNode final : StatementNode {
 
 // === Expressions ===
 struct ExpressionNode : ASTNode {
+    TypeId valueType = TypeId::Unknown;
+
 protected:
     ExpressionNode(NodeType t) : ASTNode(t) {}
 };
@@ -146,6 +208,7 @@ struct LiteralNode final : ExpressionNode {
 
 struct VariableNode final : ExpressionNode {
     std::string name;
+    SymbolRef symbol;
 
     VariableNode() : ExpressionNode(NodeType::Variable) {}
     VariableNode(const std::string& n) : ExpressionNode(NodeType::Variable), name(n) {}
@@ -154,25 +217,68 @@ struct VariableNode final : ExpressionNode {
 struct FunctionCallNode final : ExpressionNode {
     std::string name;
     std::vector<ASTNodePTR> arguments;
+    SymbolRef symbol;
 
     FunctionCallNode() : ExpressionNode(NodeType::FunctionCall) {}
     FunctionCallNode(const std::string& n) : ExpressionNode(NodeType::FunctionCall), name(n) {}
 };
 
+// a[i]: element i of an array, bounds checked
+struct IndexNode final : ExpressionNode {
+    ASTNodePTR array;
+    ASTNodePTR index;
+
+    IndexNode() : ExpressionNode(NodeType::Index) {}
+    IndexNode(ASTNodePTR array, ASTNodePTR index)
+        : ExpressionNode(NodeType::Index), array(array), index(index) {}
+};
+
+// === Error Recovery ===
+// Stands in for a statement or declaration that failed to parse,
+// so the rest of the tree keeps its shape after recovery
+struct ErrorNode final : ASTNode {
+    std::string message;
+
+    ErrorNode() : ASTNode(NodeType::Error) {}
+    ErrorNode(const std::string& msg) : ASTNode(NodeType::Error), message(msg) {}
+};
+
+struct Diagnostic {
+    std::string message;
+    int line;
+    int column;
+};
+
+class ParseError : public std::runtime_error {
+public:
+    ParseError(const std::string& msg, int line, int column)
+        : std::runtime_error(msg), line(line), column(column) {}
+
+    int line;
+    int column;
+};
+
 // === Parser ===
 class SyntaxParser {
 public:
     SyntaxParser(const std::vector<Token> &tokens);
+    SyntaxParser(const std::vector<Token> &tokens, size_t begin, size_t end); // parse tokens[begin, end) only
 
     ASTNodePTR parse_program();
     void print_ast(const ASTNodePTR& node, int indent = 0) const;
 
+    const std::vector<Diagnostic>& get_diagnostics() const { return diagnostics; }
+    bool has_errors() const { return !diagnostics.empty(); }
+
 private:
     std::vector<Token> tokens;
     size_t current;
+    int loop_depth = 0;                  // loops enclosing the statement being parsed, for 'break'
+    std::vector<Diagnostic> diagnostics; // every error recovered from, in source order
 
     // utility functions
     const Token& peek() const;          // take a gander at the next token
+    const Token& peek_next() const;     // one token past peek()
     const Token& advance();             // move forward
     bool check(TokenType type) const;   // check if current token matches type
     bool isAtEnd() const;               // check if we've reached the end
@@ -181,15 +287,29 @@ private:
     void setSourceLocation(ASTNodePTR node, const Token& token) const; // set line/column info
     [[noreturn]] static void error(const std::string& msg, int line, int column); // output any errors
 
+    // Panic-mode recovery
+    ASTNodePTR recover(const ParseError& err, size_t start); // record the error and skip to a safe point
+    void synchronize();                                       // discard tokens up to the next statement boundary
+    static bool is_type_token(TokenType type);
+    static bool starts_statement(TokenType type);
+
     // Grammar rules
     ASTNodePTR parse_function();
     ASTNodePTR parse_statement();
     ASTNodePTR parse_declaration();
     ASTNodePTR parse_assignment();
+    ASTNodePTR parse_element_assignment();  // a[i] = v;, or nullptr with nothing consumed
     ASTNodePTR parse_if();
     ASTNodePTR parse_while();
+    ASTNodePTR parse_for();
+    ASTNodePTR parse_increment();           // x++ / x--, without the ';'
+    ASTNodePTR parse_for_clause();          // init or update of a for header, without the ';'
     ASTNodePTR parse_return();
+    ASTNodePTR parse_break();
     ASTNodePTR parse_block();
+    ASTNodePTR parse_expression_statement();
+    std::vector<ASTNodePTR> parse_body(); // block or single statement after if/else/while
+    std::vector<ASTNodePTR> parse_loop_body(); // parse_body() where 'break' is allowed
 
     // Expression parsing with precedence
     ASTNodePTR parse_expression();
@@ -200,10 +320,13 @@ private:
     ASTNodePTR parse_term();
     ASTNodePTR parse_factor();
     ASTNodePTR parse_unary();
+    ASTNodePTR parse_power();
+    ASTNodePTR parse_postfix();             // primary followed by any number of [index]
     ASTNodePTR parse_primary();
     ASTNodePTR parse_function_call();
 
     // Helper functions
+    std::string parse_type();               // a type name, with '[]' for an array type
     std::shared_ptr<ParameterNode> parse_parameter();
     std::vector<std::shared_ptr<ParameterNode>> parse_parameter_list();
     std::vector<ASTNodePTR> parse_argument_list();
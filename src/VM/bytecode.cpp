@@ -0,0 +1,267 @@
+#include "bytecode.hpp"
+#include "../Support/output_buffer.hpp"
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+const char* bytecodeOpToString(BytecodeOp op) {
+    static const char* const names[] = {
+#define TURD_BYTECODE_NAME(name) #name,
+#define TURD_TYPED_NAME(name, generic, type) #name,
+#define TURD_GUARDED_NAME(name, generic, type) #name "Guarded",
+        TURD_BYTECODE_OPS(TURD_BYTECODE_NAME)
+        TURD_TYPED_OPS(TURD_TYPED_NAME)
+        TURD_TYPED_OPS(TURD_GUARDED_NAME)
+#undef TURD_GUARDED_NAME
+#undef TURD_TYPED_NAME
+#undef TURD_BYTECODE_NAME
+    };
+    return names[static_cast<size_t>(op)];
+}
+
+BytecodeOp typed_op(BytecodeOp generic, TypeId operands) {
+    bool comparison = generic >= BytecodeOp::Eq && generic <= BytecodeOp::Ge;
+    bool equality = generic == BytecodeOp::Eq || generic == BytecodeOp::Ne;
+    bool as_int = operands == TypeId::Int || (operands == TypeId::Char && comparison) ||
+                  (operands == TypeId::Bool && equality);
+    if (!as_int && operands != TypeId::Float) return generic;
+    TypeId type = as_int ? TypeId::Int : TypeId::Float;
+#define TURD_TYPED_MATCH(name, generic_op, operand_type) \
+    if (generic == BytecodeOp::generic_op && type == TypeId::operand_type) return BytecodeOp::name;
+    TURD_TYPED_OPS(TURD_TYPED_MATCH)
+#undef TURD_TYPED_MATCH
+    return generic;
+}
+
+BytecodeOp generic_op(BytecodeOp op) {
+    switch (op) {
+#define TURD_GENERIC_CASE(name, generic, type) \
+    case BytecodeOp::name:                     \
+    case BytecodeOp::name##Guarded:            \
+        return BytecodeOp::generic;
+        TURD_TYPED_OPS(TURD_GENERIC_CASE)
+#undef TURD_GENERIC_CASE
+        default:
+            return op;
+    }
+}
+
+// === Constant Pool ===
+
+uint32_t BytecodeModule::add_constant(Value value) {
+    if (value.is_string()) {
+        turd_string text = value.as_string();
+        return add_string(text != nullptr ? std::string(text->text, text->length) : std::string());
+    }
+
+    auto [it, inserted] = scalar_constants.emplace(value.raw(), static_cast<uint32_t>(constants.size()));
+    if (inserted) constants.push_back(value);
+    return it->second;
+}
+
+uint32_t BytecodeModule::add_string(const std::string& text) {
+    auto [it, inserted] = string_constants.emplace(text, static_cast<uint32_t>(constants.size()));
+    if (inserted) {
+        literals.push_back(text);
+        interned.emplace_back();
+        turd_string_init_literal(&interned.back(), literals.back().data(), static_cast<uint32_t>(text.size()));
+        constants.push_back(Value::make_string(&interned.back()));
+    }
+    return it->second;
+}
+
+size_t BytecodeModule::instruction_count() const {
+    size_t count = 0;
+    for (const auto& function : functions) count += function.code.size();
+    return count;
+}
+
+// === Disassembly ===
+
+namespace {
+
+void write_register(OutputBuffer& buffer, uint16_t reg) {
+    buffer.put('r');
+    buffer.write_int(reg);
+}
+
+void write_value(OutputBuffer& buffer, const Value& value) {
+    switch (value.kind()) {
+        case ValueKind::Int: buffer.write_int(value.as_int()); break;
+        case ValueKind::Float: buffer.write_float(value.as_float()); break;
+        case ValueKind::Bool: buffer.write(value.as_int() ? "true" : "false"); break;
+        case ValueKind::Array: buffer.write("array"); break;       // never a constant
+        case ValueKind::String: {
+            turd_string text = value.as_string();
+            buffer.write_json_string(text != nullptr ? std::string_view(text->text, text->length) : std::string_view());
+            break;
+        }
+        case ValueKind::Char:
+            if (std::isprint(value.as_int()) && value.as_int() != '\'' && value.as_int() != '\\') {
+                buffer.put('\'');
+                buffer.put(static_cast<char>(value.as_int()));
+                buffer.put('\'');
+            } else {
+                buffer.write_int(value.as_int());
+            }
+            break;
+    }
+}
+
+void write_padded(OutputBuffer& buffer, const char* text, size_t width) {
+    size_t length = std::strlen(text);
+    buffer.write(text);
+    for (; length < width; ++length) buffer.put(' ');
+}
+
+void write_target(OutputBuffer& buffer, size_t pc, const Instruction& instruction) {
+    buffer.write("-> ");
+    buffer.write_int(static_cast<long long>(pc) + 1 + instruction.bc());
+}
+
+void disassemble_function(OutputBuffer& buffer, const BytecodeModule& module, const BytecodeFunction& function) {
+    buffer.write("function ");
+    buffer.write(function.name);
+    buffer.write(" (");
+    buffer.write_int(function.params);
+    buffer.write(" param(s), ");
+    buffer.write_int(function.frame_size);
+    buffer.write(" register(s)) -> ");
+    buffer.write(typeIdToString(function.returnType));
+    buffer.put('\n');
+
+    for (size_t pc = 0; pc < function.code.size(); ++pc) {
+        const Instruction& instruction = function.code[pc];
+        char index[32];
+        std::snprintf(index, sizeof(index), "%5zu  ", pc);
+        buffer.write(index);
+        write_padded(buffer, bytecodeOpToString(instruction.op), 19);   // the longest name and a space
+
+        switch (instruction.op) {
+            case BytecodeOp::LoadK:
+                write_register(buffer, instruction.a);
+                buffer.write(", k");
+                buffer.write_int(instruction.bc());
+                buffer.write("  ; ");
+                write_value(buffer, module.constants[instruction.bc()]);
+                break;
+            case BytecodeOp::LoadGlobal:
+                write_register(buffer, instruction.a);
+                buffer.write(", g");
+                buffer.write_int(instruction.bc());
+                break;
+            case BytecodeOp::StoreGlobal:
+                buffer.put('g');
+                buffer.write_int(instruction.bc());
+                buffer.write(", ");
+                write_register(buffer, instruction.a);
+                break;
+            case BytecodeOp::Move:
+            case BytecodeOp::ArrayLength:
+            case BytecodeOp::Neg:
+            case BytecodeOp::Not:
+            case BytecodeOp::IntToFloat:
+                write_register(buffer, instruction.a);
+                buffer.write(", ");
+                write_register(buffer, instruction.b);
+                break;
+            case BytecodeOp::NewArray:
+            case BytecodeOp::Cast:
+                write_register(buffer, instruction.a);
+                buffer.write(", ");
+                write_register(buffer, instruction.b);
+                buffer.write(", ");
+                buffer.write(typeIdToString(static_cast<TypeId>(instruction.c)));
+                break;
+            case BytecodeOp::Jump:
+                write_target(buffer, pc, instruction);
+                break;
+            case BytecodeOp::JumpIfFalse:
+            case BytecodeOp::JumpIfTrue:
+                write_register(buffer, instruction.a);
+                buffer.write(", ");
+                write_target(buffer, pc, instruction);
+                break;
+            case BytecodeOp::Call:
+            case BytecodeOp::TailCall:
+                write_register(buffer, instruction.a);
+                buffer.write(", @");
+                buffer.write(module.functions[instruction.b].name);
+                buffer.write(", ");
+                buffer.write_int(instruction.c);
+                buffer.write(" arg(s)");
+                break;
+            case BytecodeOp::Return:
+                write_register(buffer, instruction.a);
+                break;
+            case BytecodeOp::ReturnVoid:
+                break;
+            case BytecodeOp::Print:
+                write_register(buffer, instruction.a);
+                buffer.write(", ");
+                buffer.write_int(instruction.b);
+                buffer.write(" value(s)");
+                break;
+            case BytecodeOp::Read:
+                write_register(buffer, instruction.a);
+                buffer.write(", ");
+                buffer.write(typeIdToString(static_cast<TypeId>(instruction.b)));
+                break;
+            case BytecodeOp::AddIntK:
+            case BytecodeOp::SubIntK:
+            case BytecodeOp::MulIntK:
+                write_register(buffer, instruction.a);
+                buffer.write(", ");
+                write_register(buffer, instruction.b);
+                buffer.write(", k");
+                buffer.write_int(instruction.c);
+                buffer.write("  ; ");
+                write_value(buffer, module.constants[instruction.c]);
+                break;
+            case BytecodeOp::IncInt:
+                write_register(buffer, instruction.a);
+                buffer.write(instruction.sb() < 0 ? ", " : ", +");
+                buffer.write_int(instruction.sb());
+                break;
+            case BytecodeOp::JumpIfEqInt: case BytecodeOp::JumpIfNeInt: case BytecodeOp::JumpIfLtInt:
+            case BytecodeOp::JumpIfLeInt: case BytecodeOp::JumpIfGtInt: case BytecodeOp::JumpIfGeInt:
+                write_register(buffer, instruction.a);
+                buffer.write(", ");
+                write_register(buffer, instruction.b);
+                buffer.write(", -> ");
+                buffer.write_int(static_cast<long long>(pc) + 1 + instruction.sc());
+                break;
+            case BytecodeOp::Add: case BytecodeOp::Sub: case BytecodeOp::Mul: case BytecodeOp::Div:
+            case BytecodeOp::Mod: case BytecodeOp::FloorDiv: case BytecodeOp::Pow: case BytecodeOp::Shr:
+            case BytecodeOp::Eq: case BytecodeOp::Ne: case BytecodeOp::Lt: case BytecodeOp::Le:
+            case BytecodeOp::Gt: case BytecodeOp::Ge:
+            case BytecodeOp::LoadElement: case BytecodeOp::StoreElement:
+            case BytecodeOp::LoadElementInt: case BytecodeOp::StoreElementInt:
+            case BytecodeOp::StoreElementIntInc:
+#define TURD_TYPED_CASE(name, generic, type) case BytecodeOp::name: case BytecodeOp::name##Guarded:
+            TURD_TYPED_OPS(TURD_TYPED_CASE)
+#undef TURD_TYPED_CASE
+                write_register(buffer, instruction.a);
+                buffer.write(", ");
+                write_register(buffer, instruction.b);
+                buffer.write(", ");
+                write_register(buffer, instruction.c);
+                break;
+        }
+        buffer.put('\n');
+    }
+}
+
+} // namespace
+
+void disassemble(const BytecodeModule& module, std::ostream& out) {
+    OutputBuffer buffer(out);
+    buffer.write_int(static_cast<long long>(module.constants.size()));
+    buffer.write(" constant(s), ");
+    buffer.write_int(static_cast<long long>(module.globals.size()));
+    buffer.write(" global(s)\n");
+    for (const auto& function : module.functions) {
+        buffer.put('\n');
+        disassemble_function(buffer, module, function);
+    }
+}
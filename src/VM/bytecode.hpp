@@ -0,0 +1,162 @@
+#pragma once
+#include "value.hpp"
+#include <deque>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// === Register Bytecode ===
+// Compact code for the VM (see vm.hpp). Every instruction is 8 bytes: an
+// opcode and three 16-bit operands a, b and c. Operands name registers of
+// the current frame unless noted; "bc" is b and c read together as one
+// 32-bit field, signed for jump offsets, which count from the instruction
+// after the jump. "sb" and "sc" are b and c read as signed 16-bit values.
+//
+// The list is an X-macro so the opcode enum, the names in disassembly and
+// the VM's computed-goto table can never disagree on the order.
+#define TURD_BYTECODE_OPS(X)                                                                  \
+    X(Move)         /* r[a] = r[b] */                                                         \
+    X(LoadK)        /* r[a] = constants[bc] */                                                \
+    X(LoadGlobal)   /* r[a] = globals[bc] */                                                  \
+    X(StoreGlobal)  /* globals[bc] = r[a] */                                                  \
+    X(Add)          /* r[a] = r[b] + r[c]; also string concatenation */                       \
+    X(Sub)                                                                                    \
+    X(Mul)                                                                                    \
+    X(Div)                                                                                    \
+    X(Mod)                                                                                    \
+    X(FloorDiv)                                                                               \
+    X(Pow)                                                                                    \
+    X(Shr)                                                                                    \
+    X(Eq)           /* r[a] = r[b] == r[c] */                                                 \
+    X(Ne)                                                                                     \
+    X(Lt)                                                                                     \
+    X(Le)                                                                                     \
+    X(Gt)                                                                                     \
+    X(Ge)                                                                                     \
+    X(Neg)          /* r[a] = -r[b] */                                                        \
+    X(Not)          /* r[a] = !r[b] */                                                        \
+    X(IntToFloat)   /* r[a] = (float) r[b] */                                                 \
+    X(Cast)         /* r[a] = r[b] checked against TypeId c, an int widening to float */      \
+    X(Jump)         /* pc += bc */                                                            \
+    X(JumpIfFalse)  /* if (!r[a]) pc += bc */                                                 \
+    X(JumpIfTrue)   /* if (r[a]) pc += bc */                                                  \
+    X(Call)         /* r[a] = functions[b](r[a], ..., r[a + c - 1]) */                        \
+    X(TailCall)     /* return functions[b](r[a], ..., r[a + c - 1]), run in this frame */     \
+    X(Return)       /* return r[a] */                                                         \
+    X(ReturnVoid)                                                                             \
+    X(Print)        /* print(r[a], ..., r[a + b - 1]) */                                      \
+    X(Read)         /* r[a] = a value of TypeId b read from stdin */                          \
+    X(NewArray)     /* r[a] = a zeroed array of TypeId c with int length r[b] */              \
+    X(ArrayLength)  /* r[a] = len(r[b]) */                                                    \
+    X(LoadElement)  /* r[a] = r[b][r[c]], any element type; r[c] is an int, bounds checked */ \
+    X(StoreElement) /* r[a][r[b]] = r[c], converted to the element type, bounds checked */    \
+    X(LoadElementInt)  /* LoadElement of an int array */                                      \
+    X(StoreElementInt) /* StoreElement of an int value into an int array */                   \
+    /* superinstructions, made only by fuse_superinstructions; int operands */               \
+    X(AddIntK)      /* r[a] = r[b] + constants[c] */                                          \
+    X(SubIntK)      /* r[a] = r[b] - constants[c] */                                          \
+    X(MulIntK)      /* r[a] = r[b] * constants[c] */                                          \
+    X(IncInt)       /* r[a] += sb, a local's 'i++', 'i--' or 'i = i + 2' */                    \
+    X(StoreElementIntInc) /* StoreElementInt, then r[b] += 1: 'a[i] = v; i++' */              \
+    X(JumpIfEqInt)  /* if (r[a] == r[b]) pc += sc */                                          \
+    X(JumpIfNeInt)                                                                            \
+    X(JumpIfLtInt)                                                                            \
+    X(JumpIfLeInt)                                                                            \
+    X(JumpIfGtInt)                                                                            \
+    X(JumpIfGeInt)
+
+// Typed forms of the generic three-register ops, as (name, generic op, operand type).
+// Each comes twice:
+//   name          emitted by the compiler where both operands' static
+//                 types are known; it trusts them and checks nothing
+//   nameGuarded   written over a generic op by the VM once it has seen
+//                 the operand kinds (quickening); it checks them first and
+//                 turns back into the generic op when they don't match
+// The Int forms also serve chars and bools, whose payloads compare the same way.
+#define TURD_TYPED_OPS(X)                                                                     \
+    X(AddInt, Add, Int) X(SubInt, Sub, Int) X(MulInt, Mul, Int)                               \
+    X(DivInt, Div, Int) X(ModInt, Mod, Int)                                                   \
+    X(EqInt, Eq, Int) X(NeInt, Ne, Int) X(LtInt, Lt, Int)                                     \
+    X(LeInt, Le, Int) X(GtInt, Gt, Int) X(GeInt, Ge, Int)                                     \
+    X(AddFloat, Add, Float) X(SubFloat, Sub, Float) X(MulFloat, Mul, Float)                   \
+    X(DivFloat, Div, Float)                                                                   \
+    X(EqFloat, Eq, Float) X(NeFloat, Ne, Float) X(LtFloat, Lt, Float)                         \
+    X(LeFloat, Le, Float) X(GtFloat, Gt, Float) X(GeFloat, Ge, Float)
+
+enum class BytecodeOp : uint8_t {
+#define TURD_BYTECODE_ENUM(name) name,
+#define TURD_TYPED_ENUM(name, generic, type) name,
+#define TURD_GUARDED_ENUM(name, generic, type) name##Guarded,
+    TURD_BYTECODE_OPS(TURD_BYTECODE_ENUM)
+    TURD_TYPED_OPS(TURD_TYPED_ENUM)
+    TURD_TYPED_OPS(TURD_GUARDED_ENUM)
+#undef TURD_GUARDED_ENUM
+#undef TURD_TYPED_ENUM
+#undef TURD_BYTECODE_ENUM
+};
+
+#define TURD_BYTECODE_COUNT(...) +1
+constexpr size_t bytecode_op_count =
+    0 TURD_BYTECODE_OPS(TURD_BYTECODE_COUNT) TURD_TYPED_OPS(TURD_BYTECODE_COUNT) TURD_TYPED_OPS(TURD_BYTECODE_COUNT);
+#undef TURD_BYTECODE_COUNT
+
+const char* bytecodeOpToString(BytecodeOp op);
+
+// the typed form of a generic op for operands of one static type, or the op itself
+BytecodeOp typed_op(BytecodeOp generic, TypeId operands);
+// the generic op a typed or guarded one stands for; any other op is itself
+BytecodeOp generic_op(BytecodeOp op);
+
+struct Instruction {
+    BytecodeOp op;
+    uint8_t deopts = 0;     // times a guarded form fell back here; quickening gives up at a limit
+    uint16_t a = 0;
+    uint16_t b = 0;
+    uint16_t c = 0;
+
+    int32_t bc() const { return static_cast<int32_t>(b | (static_cast<uint32_t>(c) << 16)); }
+    void set_bc(int32_t value) {
+        b = static_cast<uint16_t>(value);
+        c = static_cast<uint16_t>(static_cast<uint32_t>(value) >> 16);
+    }
+    int16_t sb() const { return static_cast<int16_t>(b); }
+    int16_t sc() const { return static_cast<int16_t>(c); }
+};
+static_assert(sizeof(Instruction) == 8, "instructions are packed into 8 bytes");
+
+struct BytecodeFunction {
+    std::string name;
+    TypeId returnType = TypeId::Void;
+    std::vector<TypeId> paramTypes;
+    uint16_t params = 0;            // arrive in r0 .. r[params - 1]
+    uint16_t frame_size = 0;        // registers: parameters, then locals, then temporaries
+    std::vector<Instruction> code;
+    std::vector<int32_t> lines;     // source line per instruction, for runtime errors
+    uint32_t hotness = 0;           // calls and loop back-edges run by the interpreter, for the JIT
+};
+
+// One program. Constants of every function share one pool; string
+// constants are the module's interned literals, one TurdString per
+// distinct text, which live as long as the module does.
+class BytecodeModule {
+public:
+    std::vector<BytecodeFunction> functions;    // in SymbolRef::index order, then the entry
+    size_t entry = 0;                           // top-level code
+    std::vector<TypeId> globals;
+    std::vector<Value> constants;
+
+    uint32_t add_constant(Value value);         // deduplicated
+    uint32_t add_string(const std::string& text);
+
+    size_t instruction_count() const;
+
+private:
+    std::deque<std::string> literals;           // a deque never moves what it already holds
+    std::deque<TurdString> interned;            // literals[i]'s string object
+    std::unordered_map<std::string, uint32_t> string_constants;
+    std::unordered_map<uint64_t, uint32_t> scalar_constants;        // by raw bits
+};
+
+// one line per instruction, with constants and jump targets spelled out
+void disassemble(const BytecodeModule& module, std::ostream& out);
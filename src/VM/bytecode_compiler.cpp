@@ -0,0 +1,696 @@
+#include "bytecode_compiler.hpp"
+#include "../SynParser/ast_visitor.hpp"
+#include "../Support/arithmetic.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+constexpr int no_register = -1;
+
+BytecodeOp binary_op(const std::string& op) {
+    if (op == "+") return BytecodeOp::Add;
+    if (op == "-") return BytecodeOp::Sub;
+    if (op == "*") return BytecodeOp::Mul;
+    if (op == "/") return BytecodeOp::Div;
+    if (op == "%") return BytecodeOp::Mod;
+    if (op == "//") return BytecodeOp::FloorDiv;
+    if (op == "**") return BytecodeOp::Pow;
+    if (op == ">>") return BytecodeOp::Shr;
+    if (op == "==") return BytecodeOp::Eq;
+    if (op == "!=") return BytecodeOp::Ne;
+    if (op == "<") return BytecodeOp::Lt;
+    if (op == "<=") return BytecodeOp::Le;
+    if (op == ">") return BytecodeOp::Gt;
+    if (op == ">=") return BytecodeOp::Ge;
+    throw std::runtime_error("cannot compile operator '" + op + "'");
+}
+
+TypeId static_type(const ASTNode& node) {
+    switch (node.type) {
+        case NodeType::BinaryOp:
+        case NodeType::UnaryOp:
+        case NodeType::Literal:
+        case NodeType::Variable:
+        case NodeType::FunctionCall:
+        case NodeType::Index:
+            return static_cast<const ExpressionNode&>(node).valueType;
+        default:
+            return TypeId::Void;
+    }
+}
+
+// true when control never runs off the end of body; folding has already
+// dropped whatever followed a return or break
+bool terminates(const std::vector<ASTNodePTR>& body) {
+    if (body.empty()) return false;
+    const ASTNode& last = *body.back();
+    switch (last.type) {
+        case NodeType::Return:
+        case NodeType::Break:
+            return true;
+        case NodeType::Block:
+            return terminates(static_cast<const BlockNode&>(last).statements);
+        case NodeType::If: {
+            const auto& node = static_cast<const IfNode&>(last);
+            return terminates(node.body) && terminates(node.elseBody);
+        }
+        default:
+            return false;
+    }
+}
+
+bool is_true_literal(const ASTNode& node) {
+    return node.type == NodeType::Literal && static_cast<const LiteralNode&>(node).literalType == "bool" &&
+           static_cast<const LiteralNode&>(node).value == "true";
+}
+
+// === Accumulator Introduction ===
+
+bool is_call_to(const ASTNode& node, size_t function) {
+    if (node.type != NodeType::FunctionCall) return false;
+    const auto& call = static_cast<const FunctionCallNode&>(node);
+    return call.symbol.kind == SymbolKind::Function && static_cast<size_t>(call.symbol.index) == function;
+}
+
+// `x op f(...)` with op + or * on ints, f being `function`: the call, and x
+// in `other`; nullptr otherwise. In `f(...) op x` x runs after the call, so
+// only a literal or a local, which the call can't change, may move before it
+FunctionCallNode* accumulated_call(ASTNode& expression, size_t function, ASTNode*& other) {
+    if (expression.type != NodeType::BinaryOp) return nullptr;
+    auto& node = static_cast<BinaryOpNode&>(expression);
+    if ((node.op != "*" && node.op != "+") || static_type(*node.left) != TypeId::Int ||
+        static_type(*node.right) != TypeId::Int) {
+        return nullptr;
+    }
+    if (is_call_to(*node.right, function)) {
+        other = node.left.get();
+        return static_cast<FunctionCallNode*>(node.right.get());
+    }
+    const ASTNode& right = *node.right;
+    bool stable = right.type == NodeType::Literal ||
+                  (right.type == NodeType::Variable &&
+                   static_cast<const VariableNode&>(right).symbol.kind == SymbolKind::Local);
+    if (stable && is_call_to(*node.left, function)) {
+        other = node.right.get();
+        return static_cast<FunctionCallNode*>(node.left.get());
+    }
+    return nullptr;
+}
+
+void collect_returns(const std::vector<ASTNodePTR>& body, std::vector<ReturnNode*>& returns) {
+    for (const auto& statement : body) {
+        switch (statement->type) {
+            case NodeType::Return:
+                returns.push_back(static_cast<ReturnNode*>(statement.get()));
+                break;
+            case NodeType::If:
+                collect_returns(static_cast<IfNode&>(*statement).body, returns);
+                collect_returns(static_cast<IfNode&>(*statement).elseBody, returns);
+                break;
+            case NodeType::While:
+                collect_returns(static_cast<WhileNode&>(*statement).body, returns);
+                break;
+            case NodeType::Block:
+                collect_returns(static_cast<BlockNode&>(*statement).statements, returns);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Compiles one body into one BytecodeFunction. Expression handlers leave
+// their value in `target` when it is set and return the register holding
+// it; statement handlers return no_register.
+class FunctionCompiler : public ASTVisitor<FunctionCompiler, int> {
+public:
+    FunctionCompiler(BytecodeModule& module, size_t index, const std::vector<TypeId>& slotTypes)
+        : module(module), function(module.functions[index]), index(index), slotTypes(slotTypes),
+          first_temporary(static_cast<int>(slotTypes.size())), next_temporary(first_temporary) {}
+
+    void compile(const std::vector<ASTNodePTR>& body) {
+        plan_accumulator(body);
+        if (accumulator != no_register) {
+            load_constant(accumulator, Value::make_int(accumulate == BytecodeOp::MulInt ? 1 : 0));
+            loop_start = function.code.size();
+        }
+        for (const auto& statement : body) statement_of(*statement);
+        if (terminates(body)) {
+            // nothing falls off the end
+        } else if (function.returnType == TypeId::Void) {
+            emit(BytecodeOp::ReturnVoid);
+        } else {
+            // falling off the end returns the type's zero, as native code returns its undef
+            int value = temporary();
+            load_constant(value, zero_value(function.returnType));
+            return_value(value);
+        }
+        if (max_registers > std::numeric_limits<uint16_t>::max()) {
+            throw std::runtime_error("function '" + function.name + "' needs too many registers");
+        }
+        function.frame_size = static_cast<uint16_t>(std::max(max_registers, first_temporary));
+    }
+
+    // === Statements ===
+    int visit_program(ProgramNode&) { return no_register; }
+    int visit_function(FunctionNode&) { return no_register; }     // compiled as its own function
+    int visit_parameter(ParameterNode&) { return no_register; }
+
+    int visit_declaration(DeclarationNode& node) {
+        line = node.line;
+        if (node.size) {
+            int mark = next_temporary;
+            int length = converted(*node.size, TypeId::Int, no_register);
+            int array = register_of(node.symbol);
+            if (array == no_register) array = temporary();
+            emit(BytecodeOp::NewArray, array, length, static_cast<int>(slot_type(node.symbol)));
+            if (node.symbol.kind == SymbolKind::Global) emit_bc(BytecodeOp::StoreGlobal, array, node.symbol.index);
+            next_temporary = mark;
+        } else if (node.initializer) {
+            store(node.symbol, *node.initializer);
+        } else {
+            int value = register_of(node.symbol);
+            if (value == no_register) value = temporary();
+            load_constant(value, zero_value(slot_type(node.symbol)));
+            if (node.symbol.kind == SymbolKind::Global) emit_bc(BytecodeOp::StoreGlobal, value, node.symbol.index);
+        }
+        return no_register;
+    }
+
+    int visit_assignment(AssignmentNode& node) {
+        line = node.line;
+        if (node.index) {
+            store_element(node);
+        } else {
+            store(node.symbol, *node.expression);
+        }
+        return no_register;
+    }
+
+    int visit_if(IfNode& node) {
+        line = node.line;
+        size_t to_else = branch_if_false(*node.condition);
+        body_of(node.body);
+        if (node.elseBody.empty()) {
+            patch(to_else);
+        } else if (terminates(node.body)) {
+            patch(to_else);
+            body_of(node.elseBody);
+        } else {
+            size_t to_end = emit_bc(BytecodeOp::Jump, 0, 0);
+            patch(to_else);
+            body_of(node.elseBody);
+            patch(to_end);
+        }
+        return no_register;
+    }
+
+    // jump to the test at the bottom; the test jumps back while it holds.
+    // 'while (true)' has no test, only the jump back
+    int visit_while(WhileNode& node) {
+        line = node.line;
+        bool forever = is_true_literal(*node.condition);
+        size_t to_test = forever ? 0 : emit_bc(BytecodeOp::Jump, 0, 0);
+        size_t body = function.code.size();
+        breaks.emplace_back();
+        body_of(node.body);
+
+        line = node.line;
+        if (forever) {
+            patch(emit_bc(BytecodeOp::Jump, 0, 0), body);
+        } else {
+            patch(to_test);
+            int mark = next_temporary;
+            int condition = condition_of(*node.condition);
+            patch(emit_bc(BytecodeOp::JumpIfTrue, condition, 0), body);
+            next_temporary = mark;
+        }
+
+        for (size_t jump : breaks.back()) patch(jump);
+        breaks.pop_back();
+        return no_register;
+    }
+
+    int visit_return(ReturnNode& node) {
+        line = node.line;
+        if (!node.expression) {
+            emit(BytecodeOp::ReturnVoid);
+            return no_register;
+        }
+        if (accumulator != no_register) {
+            ASTNode* other = nullptr;
+            FunctionCallNode* call = accumulated_call(*node.expression, index, other);
+            if (call) {
+                int value = value_of(*other, no_register);
+                emit(accumulate, accumulator, accumulator, value, node.line);
+                loop_back(*call);
+            } else if (is_call_to(*node.expression, index)) {
+                loop_back(static_cast<FunctionCallNode&>(*node.expression));
+            } else {
+                return_value(converted(*node.expression, function.returnType, no_register));
+            }
+            return no_register;
+        }
+        if (node.expression->type == NodeType::FunctionCall) {
+            auto& call = static_cast<FunctionCallNode&>(*node.expression);
+            if (call.symbol.kind == SymbolKind::Function &&
+                module.functions[call.symbol.index].returnType == function.returnType) {
+                tail_call(call);
+                return no_register;
+            }
+        }
+        int value = converted(*node.expression, function.returnType, no_register);
+        emit(BytecodeOp::Return, value);
+        return no_register;
+    }
+
+    int visit_break(BreakNode& node) {
+        line = node.line;
+        breaks.back().push_back(emit_bc(BytecodeOp::Jump, 0, 0));
+        return no_register;
+    }
+
+    int visit_block(BlockNode& node) {
+        body_of(node.statements);
+        return no_register;
+    }
+
+    int visit_error(ErrorNode& node) {
+        throw std::runtime_error("cannot compile a tree with errors (line " + std::to_string(node.line) + ")");
+    }
+
+    // === Expressions ===
+    int visit_binary_op(BinaryOpNode& node) {
+        if (node.op == "&&" || node.op == "||") return short_circuit(node);
+
+        // statically typed operands get the typed op; an int meeting a float
+        // is widened first, as native code does
+        BytecodeOp generic = binary_op(node.op);
+        TypeId left_type = static_type(*node.left), right_type = static_type(*node.right);
+        TypeId operands = left_type == right_type ? left_type : TypeId::Unknown;
+        if ((left_type == TypeId::Int && right_type == TypeId::Float) ||
+            (left_type == TypeId::Float && right_type == TypeId::Int)) {
+            operands = TypeId::Float;
+        }
+        BytecodeOp op = typed_op(generic, operands);
+        TypeId widen_to = op != generic && operands == TypeId::Float ? TypeId::Float : TypeId::Unknown;
+
+        int mark = next_temporary;
+        int left = converted(*node.left, widen_to, no_register);
+        int right = converted(*node.right, widen_to, no_register);
+        next_temporary = mark;
+        int result = target_or_temporary();
+        emit(op, result, left, right, node.line);
+        return result;
+    }
+
+    int visit_unary_op(UnaryOpNode& node) {
+        int mark = next_temporary;
+        int operand;
+        BytecodeOp op = BytecodeOp::Neg;
+        if (node.op == "!") {
+            operand = condition_of(*node.operand);
+            op = BytecodeOp::Not;
+        } else {
+            operand = value_of(*node.operand, no_register);
+        }
+        next_temporary = mark;
+        int result = target_or_temporary();
+        emit(op, result, operand, 0, node.line);
+        return result;
+    }
+
+    int visit_literal(LiteralNode& node) {
+        int result = target_or_temporary();
+        load_constant(result, literal_value(node));
+        return result;
+    }
+
+    int visit_variable(VariableNode& node) {
+        if (node.symbol.kind == SymbolKind::Local) {
+            int slot = node.symbol.index;
+            if (target != no_register && target != slot) emit(BytecodeOp::Move, target, slot);
+            return target != no_register ? target : slot;
+        }
+        if (node.symbol.kind != SymbolKind::Global) {
+            throw std::runtime_error("use of an unresolved name at line " + std::to_string(node.line));
+        }
+        int result = target_or_temporary();
+        emit_bc(BytecodeOp::LoadGlobal, result, node.symbol.index, node.line);
+        return result;
+    }
+
+    // int arrays get the op the JIT inlines; the element is checked either way
+    int visit_index(IndexNode& node) {
+        int mark = next_temporary;
+        int array = value_of(*node.array, no_register);
+        int index = converted(*node.index, TypeId::Int, no_register);
+        next_temporary = mark;
+        int result = target_or_temporary();
+        BytecodeOp op = node.valueType == TypeId::Int ? BytecodeOp::LoadElementInt : BytecodeOp::LoadElement;
+        emit(op, result, array, index, node.line);
+        return result;
+    }
+
+    int visit_function_call(FunctionCallNode& node) {
+        int wanted = target;
+        int mark = next_temporary;
+        int base = next_temporary;
+
+        if (node.symbol.kind == SymbolKind::Builtin) {
+            if (node.name == "len") {
+                int array = value_of(*node.arguments[0], no_register);
+                next_temporary = mark;
+                int result = target_or_temporary();
+                emit(BytecodeOp::ArrayLength, result, array, 0, node.line);
+                return result;
+            }
+            if (node.name == "read") {
+                for (const auto& argument : node.arguments) read_into(static_cast<const VariableNode&>(*argument));
+                next_temporary = mark;
+                return no_register;
+            }
+            for (const auto& argument : node.arguments) converted(*argument, TypeId::Unknown, temporary());
+            emit(BytecodeOp::Print, base, static_cast<int>(node.arguments.size()), 0, node.line);
+            next_temporary = mark;
+            return no_register;
+        }
+        if (node.symbol.kind != SymbolKind::Function) {
+            throw std::runtime_error("call to unresolved function '" + node.name + "'");
+        }
+
+        // the result comes back in the first argument register, which exists even with no
+        // arguments; a target on top of the temporaries can be that register itself
+        const BytecodeFunction& callee = module.functions[node.symbol.index];
+        if (wanted != no_register && wanted >= first_temporary && wanted == next_temporary - 1) {
+            base = mark = wanted;
+        }
+        next_temporary = base;
+        temporary();
+        next_temporary = base;
+        for (size_t i = 0; i < node.arguments.size(); ++i) {
+            converted(*node.arguments[i], callee.paramTypes[i], temporary());
+        }
+        emit(BytecodeOp::Call, base, node.symbol.index, static_cast<int>(node.arguments.size()), node.line);
+        next_temporary = mark;
+        if (wanted != no_register && wanted != base) {
+            emit(BytecodeOp::Move, wanted, base);
+            return wanted;
+        }
+        return temporary();     // base itself
+    }
+
+private:
+    // === Emission ===
+    size_t emit(BytecodeOp op, int a = 0, int b = 0, int c = 0, int at = -1) {
+        Instruction instruction{op};
+        instruction.a = static_cast<uint16_t>(a);
+        instruction.b = static_cast<uint16_t>(b);
+        instruction.c = static_cast<uint16_t>(c);
+        function.code.push_back(instruction);
+        function.lines.push_back(at < 0 ? line : at);
+        return function.code.size() - 1;
+    }
+
+    size_t emit_bc(BytecodeOp op, int a, int32_t bc, int at = -1) {
+        size_t index = emit(op, a, 0, 0, at);
+        function.code[index].set_bc(bc);
+        return index;
+    }
+
+    // points the jump at `to`, by default the next instruction to be emitted
+    void patch(size_t jump, size_t to = SIZE_MAX) {
+        if (to == SIZE_MAX) to = function.code.size();
+        function.code[jump].set_bc(static_cast<int32_t>(to) - static_cast<int32_t>(jump) - 1);
+    }
+
+    void load_constant(int reg, Value value) {
+        emit_bc(BytecodeOp::LoadK, reg, static_cast<int32_t>(module.add_constant(value)));
+    }
+
+    // === Registers ===
+    int temporary() {
+        int reg = next_temporary++;
+        max_registers = std::max(max_registers, next_temporary);
+        return reg;
+    }
+
+    // where an expression handler puts its result: the requested register or a fresh one
+    int target_or_temporary() {
+        int reg = target != no_register ? target : temporary();
+        target = no_register;
+        return reg;
+    }
+
+    // evaluates node, into `into` when it is set; the register holding the result
+    int value_of(ASTNode& node, int into) {
+        int saved = target;
+        target = into;
+        int result = visit(node);
+        target = saved;
+        return result;
+    }
+
+    // value_of, converted to `to` the way native code would convert it
+    int converted(ASTNode& node, TypeId to, int into) {
+        TypeId from = static_type(node);
+        bool widen = to == TypeId::Float && from == TypeId::Int;
+        bool check = from == TypeId::Unknown && to != TypeId::Unknown && to != TypeId::Void;
+        if (!widen && !check) return value_of(node, into);
+
+        int mark = next_temporary;
+        int value = value_of(node, no_register);
+        next_temporary = mark;
+        int result = into != no_register ? into : temporary();
+        if (widen) {
+            emit(BytecodeOp::IntToFloat, result, value);
+        } else {
+            emit(BytecodeOp::Cast, result, value, static_cast<int>(to));
+        }
+        return result;
+    }
+
+    int condition_of(ASTNode& node) {
+        return converted(node, TypeId::Bool, no_register);
+    }
+
+    size_t branch_if_false(ASTNode& condition) {
+        int mark = next_temporary;
+        int value = condition_of(condition);
+        next_temporary = mark;
+        return emit_bc(BytecodeOp::JumpIfFalse, value, 0);
+    }
+
+    // a && b: b only runs when a is true, and a itself is the result on the short path.
+    // The result is built in a temporary, since `target` may be one of the operands
+    int short_circuit(BinaryOpNode& node) {
+        int wanted = target;
+        target = no_register;
+        int result = temporary();
+        int mark = next_temporary;
+        converted(*node.left, TypeId::Bool, result);
+        size_t skip = emit_bc(node.op == "&&" ? BytecodeOp::JumpIfFalse : BytecodeOp::JumpIfTrue, result, 0, node.line);
+        next_temporary = mark;
+        converted(*node.right, TypeId::Bool, result);
+        next_temporary = mark;
+        patch(skip);
+        if (wanted != no_register) {
+            emit(BytecodeOp::Move, wanted, result);
+            next_temporary = result;
+            return wanted;
+        }
+        return result;
+    }
+
+    // === Variables ===
+    TypeId slot_type(SymbolRef symbol) const {
+        if (symbol.kind == SymbolKind::Local) return slotTypes[symbol.index];
+        if (symbol.kind == SymbolKind::Global) return module.globals[symbol.index];
+        return TypeId::Unknown;
+    }
+
+    int register_of(SymbolRef symbol) const {
+        return symbol.kind == SymbolKind::Local ? symbol.index : no_register;
+    }
+
+    void store(SymbolRef symbol, ASTNode& value) {
+        if (symbol.kind == SymbolKind::Local) {
+            converted(value, slot_type(symbol), symbol.index);
+        } else if (symbol.kind == SymbolKind::Global) {
+            int reg = converted(value, slot_type(symbol), no_register);
+            emit_bc(BytecodeOp::StoreGlobal, reg, symbol.index);
+        } else {
+            throw std::runtime_error("assignment to an unresolved name at line " + std::to_string(line));
+        }
+    }
+
+    // a[i] = v: the array, the index, then the value, and the check last, as in native code
+    void store_element(AssignmentNode& node) {
+        int mark = next_temporary;
+        int array = register_of(node.symbol);
+        if (node.symbol.kind == SymbolKind::Global) {
+            array = temporary();
+            emit_bc(BytecodeOp::LoadGlobal, array, node.symbol.index);
+        } else if (array == no_register) {
+            throw std::runtime_error("assignment to an unresolved name at line " + std::to_string(line));
+        }
+        int index = converted(*node.index, TypeId::Int, no_register);
+        TypeId element = element_type(slot_type(node.symbol));
+        int value = converted(*node.expression, element, no_register);
+        BytecodeOp op = element == TypeId::Int ? BytecodeOp::StoreElementInt : BytecodeOp::StoreElement;
+        emit(op, array, index, value, node.line);
+        next_temporary = mark;
+    }
+
+    void read_into(const VariableNode& variable) {
+        TypeId type = slot_type(variable.symbol);
+        if (type == TypeId::Unknown) type = TypeId::String;
+        int reg = register_of(variable.symbol);
+        if (reg == no_register) reg = temporary();
+        emit(BytecodeOp::Read, reg, static_cast<int>(type), 0, variable.line);
+        if (variable.symbol.kind == SymbolKind::Global) emit_bc(BytecodeOp::StoreGlobal, reg, variable.symbol.index);
+    }
+
+    Value literal_value(const LiteralNode& node) {
+        switch (type_from_name(node.literalType)) {
+            case TypeId::Int: return Value::make_int(turd::wrap(std::stoll(node.value)));
+            case TypeId::Float: return Value::make_float(std::stod(node.value));
+            case TypeId::Bool: return Value::make_bool(node.value == "true");
+            case TypeId::Char:
+                return Value::make_char(node.value.empty() ? 0 : static_cast<unsigned char>(node.value[0]));
+            case TypeId::String: return module.constants[module.add_string(node.value)];
+            case TypeId::Unknown:
+            case TypeId::Void:
+            case TypeId::IntArray: case TypeId::FloatArray: case TypeId::StringArray:
+            case TypeId::BoolArray: case TypeId::CharArray:
+                break;
+        }
+        throw std::runtime_error("literal without a type at line " + std::to_string(node.line));
+    }
+
+    // === Statements ===
+    // temporaries live for one statement
+    void statement_of(ASTNode& statement) {
+        int mark = next_temporary;
+        value_of(statement, no_register);
+        next_temporary = mark;
+    }
+
+    void body_of(const std::vector<ASTNodePTR>& body) {
+        for (const auto& statement : body) statement_of(*statement);
+    }
+
+    // 'return f(...)' with nothing to convert: the arguments go on top of the
+    // frame as for a call, and f takes the frame over, so recursion through
+    // tail calls runs in constant stack
+    void tail_call(FunctionCallNode& node) {
+        const BytecodeFunction& callee = module.functions[node.symbol.index];
+        int mark = next_temporary;
+        for (size_t i = 0; i < node.arguments.size(); ++i) {
+            converted(*node.arguments[i], callee.paramTypes[i], temporary());
+        }
+        emit(BytecodeOp::TailCall, mark, node.symbol.index, static_cast<int>(node.arguments.size()), node.line);
+        next_temporary = mark;
+    }
+
+    // Recursion through one associative int operator runs as a loop: when
+    // every return that calls the function itself is `x op f(...)` (or a
+    // plain tail call), x goes into an accumulator starting at op's
+    // identity, the call becomes a jump back to the top, and every other
+    // return hands back `accumulator op value`. So `return n * fact(n - 1)`
+    // runs in constant stack, as it does in native code.
+    void plan_accumulator(const std::vector<ASTNodePTR>& body) {
+        if (function.returnType != TypeId::Int) return;
+        std::vector<ReturnNode*> returns;
+        collect_returns(body, returns);
+        const std::string* op = nullptr;
+        for (ReturnNode* node : returns) {
+            ASTNode* other = nullptr;
+            if (!node->expression || !accumulated_call(*node->expression, index, other)) continue;
+            const std::string& found = static_cast<BinaryOpNode&>(*node->expression).op;
+            if (op && *op != found) return;
+            op = &found;
+        }
+        if (!op) return;
+        accumulate = typed_op(binary_op(*op), TypeId::Int);
+        accumulator = temporary();      // above every statement's temporaries for the whole body
+    }
+
+    void return_value(int value) {
+        if (accumulator != no_register) {
+            int result = temporary();
+            emit(accumulate, result, accumulator, value);
+            value = result;
+        }
+        emit(BytecodeOp::Return, value);
+    }
+
+    // a call to the function itself under an accumulator: the arguments,
+    // all computed before any parameter changes, become the parameters
+    void loop_back(FunctionCallNode& node) {
+        int mark = next_temporary;
+        std::vector<int> values;
+        for (size_t i = 0; i < node.arguments.size(); ++i) {
+            values.push_back(converted(*node.arguments[i], function.paramTypes[i], temporary()));
+        }
+        for (size_t i = 0; i < values.size(); ++i) emit(BytecodeOp::Move, static_cast<int>(i), values[i]);
+        patch(emit_bc(BytecodeOp::Jump, 0, 0, node.line), loop_start);
+        next_temporary = mark;
+    }
+
+    BytecodeModule& module;
+    BytecodeFunction& function;
+    const size_t index;
+    const std::vector<TypeId>& slotTypes;
+
+    const int first_temporary;
+    int next_temporary;
+    int max_registers = 0;
+    int target = no_register;       // where the expression being compiled should leave its value
+    int line = -1;                  // line of the statement being compiled
+    std::vector<std::vector<size_t>> breaks;   // per enclosing loop, jumps to patch to its exit
+
+    int accumulator = no_register;      // see plan_accumulator
+    BytecodeOp accumulate = BytecodeOp::AddInt;
+    size_t loop_start = 0;
+};
+
+} // namespace
+
+BytecodeModule BytecodeCompiler::compile(ProgramNode& program) {
+    BytecodeModule module;
+    module.globals = program.globalTypes;
+
+    // headers first, so calls see every callee's signature
+    std::vector<FunctionNode*> sources;
+    for (const auto& child : program.children) {
+        if (child->type != NodeType::Function) continue;
+        auto& node = static_cast<FunctionNode&>(*child);
+        BytecodeFunction function;
+        function.name = node.name;
+        function.returnType = node.returnType.empty() ? TypeId::Void : type_from_name(node.returnType);
+        function.params = static_cast<uint16_t>(node.parameters.size());
+        function.paramTypes.assign(node.localTypes.begin(), node.localTypes.begin() + node.parameters.size());
+        module.functions.push_back(std::move(function));
+        sources.push_back(&node);
+    }
+
+    for (size_t i = 0; i < sources.size(); ++i) {
+        FunctionCompiler(module, i, sources[i]->localTypes).compile(sources[i]->body);
+    }
+
+    // top-level statements, in order, as the entry function
+    std::vector<ASTNodePTR> statements;
+    for (const auto& child : program.children) {
+        if (child->type != NodeType::Function) statements.push_back(child);
+    }
+    module.entry = module.functions.size();
+    module.functions.emplace_back();
+    module.functions.back().name = "<top-level>";
+
+    static const std::vector<TypeId> no_slots;
+    FunctionCompiler(module, module.entry, no_slots).compile(statements);
+    return module;
+}
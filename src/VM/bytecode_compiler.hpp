@@ -0,0 +1,24 @@
+#pragma once
+#include "bytecode.hpp"
+
+// === Bytecode Compiler ===
+// Translates a resolved, type-checked and error-free tree straight into
+// register bytecode in one walk, with no IR in between, so a script
+// starts running as soon as it is checked.
+//
+// A function's frame is its parameters and locals at their NameResolver
+// slot numbers, followed by temporaries allocated as a stack per
+// statement. An expression computes into the register its consumer asks
+// for where it can: 'x = a + b' is one Add into x, and reading a local
+// needs no instruction at all. Call arguments go to consecutive registers
+// at the top of the caller's frame, which become the callee's first
+// registers, so a call copies nothing. A while loop tests its condition
+// at the bottom, one jump per iteration.
+//
+// Static types decide the conversions native code would do: ints widen
+// where a float is expected, and a dynamically typed value gets a Cast
+// where a typed one is needed (assignments, arguments, returns, conditions).
+class BytecodeCompiler {
+public:
+    BytecodeModule compile(ProgramNode& program);   // throws std::runtime_error on trees with errors
+};
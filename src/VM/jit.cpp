@@ -0,0 +1,506 @@
+#include "jit.hpp"
+#include <cstring>
+#include <stdexcept>
+#if TURD_VM_JIT
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// === Executable Memory ===
+
+#if TURD_VM_JIT
+ExecutableMemory::ExecutableMemory(const std::vector<uint8_t>& code) {
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    length = (code.size() + page - 1) / page * page;
+    void* mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) throw std::runtime_error("cannot map memory for compiled code");
+    std::memcpy(mapping, code.data(), code.size());
+    if (mprotect(mapping, length, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mapping, length);
+        throw std::runtime_error("cannot make compiled code executable");
+    }
+    base = mapping;
+    used = code.size();
+}
+
+ExecutableMemory::~ExecutableMemory() {
+    if (base) munmap(base, length);
+}
+#else
+ExecutableMemory::ExecutableMemory(const std::vector<uint8_t>&) {
+    throw std::runtime_error("no JIT on this platform");
+}
+
+ExecutableMemory::~ExecutableMemory() = default;
+#endif
+
+namespace {
+
+// === x86-64 Encoding ===
+// Just the instruction forms the templates use. Every VM register is a
+// memory operand [rbx + 8 * r] with a 32-bit displacement.
+
+enum Gpr : uint8_t { RAX = 0, RCX = 1, RDX = 2, RBX = 3 };
+
+// condition codes, the low nibble of jcc/setcc
+enum Condition : uint8_t {
+    Below = 0x2, AboveOrEqual = 0x3, Equal = 0x4, NotEqual = 0x5, Above = 0x7,
+    Parity = 0xA, NoParity = 0xB, Less = 0xC, GreaterOrEqual = 0xD, LessOrEqual = 0xE, Greater = 0xF,
+};
+
+class Assembler {
+public:
+    std::vector<uint8_t> code;
+
+    size_t here() const { return code.size(); }
+
+    void emit(std::initializer_list<uint8_t> bytes) { code.insert(code.end(), bytes); }
+    void emit32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) code.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+    void emit64(uint64_t value) {
+        for (int i = 0; i < 8; ++i) code.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    // ModRM for [rbx + disp32] with `reg` in the reg field
+    void slot(uint8_t reg, uint16_t vm_register) {
+        code.push_back(static_cast<uint8_t>(0x80 | (reg << 3) | RBX));
+        emit32(8u * vm_register);
+    }
+
+    void load32(Gpr reg, uint16_t r) { emit({0x8B}); slot(reg, r); }              // mov e?x, [r]
+    void load64(Gpr reg, uint16_t r) { emit({0x48, 0x8B}); slot(reg, r); }        // mov r?x, [r]
+    void store64(uint16_t r, Gpr reg) { emit({0x48, 0x89}); slot(reg, r); }       // mov [r], r?x
+    void add32(uint16_t r) { emit({0x03}); slot(RAX, r); }                        // add eax, [r]
+    void sub32(uint16_t r) { emit({0x2B}); slot(RAX, r); }                        // sub eax, [r]
+    void imul32(uint16_t r) { emit({0x0F, 0xAF}); slot(RAX, r); }                 // imul eax, [r]
+    void cmp32(uint16_t r) { emit({0x3B}); slot(RAX, r); }                        // cmp eax, [r]
+    void add_imm32(int32_t value) { emit({0x05}); emit32(static_cast<uint32_t>(value)); }   // add eax, imm
+    void sub_imm32(int32_t value) { emit({0x2D}); emit32(static_cast<uint32_t>(value)); }   // sub eax, imm
+    void imul_imm32(int32_t value) { emit({0x69, 0xC0}); emit32(static_cast<uint32_t>(value)); }   // imul eax, eax, imm
+    void add_slot_imm32(uint16_t r, int32_t value) {                              // add dword [r], imm
+        emit({0x81});
+        slot(0, r);
+        emit32(static_cast<uint32_t>(value));
+    }
+    void test_slot32(uint16_t r) { emit({0x83}); slot(7, r); emit({0x00}); }     // cmp dword [r], 0
+
+    void mov_imm64(Gpr reg, uint64_t value) { emit({0x48, static_cast<uint8_t>(0xB8 + reg)}); emit64(value); }
+    void mov_imm32(Gpr reg, uint32_t value) { emit({static_cast<uint8_t>(0xB8 + reg)}); emit32(value); }
+    void or_tag() { emit({0x4C, 0x09, 0xF0}); }                                   // or rax, r14
+    void or_rax_rcx() { emit({0x48, 0x09, 0xC8}); }
+    void setcc(Condition condition, Gpr reg) { emit({0x0F, static_cast<uint8_t>(0x90 + condition), static_cast<uint8_t>(0xC0 + reg)}); }
+    void movzx_eax_al() { emit({0x0F, 0xB6, 0xC0}); }
+    void and_al_cl() { emit({0x20, 0xC8}); }
+    void or_al_cl() { emit({0x08, 0xC8}); }
+    void test_eax() { emit({0x85, 0xC0}); }
+    // clears the tag, leaving a string or array value's pointer
+    void payload(Gpr reg) {
+        emit({0x48, 0xC1, static_cast<uint8_t>(0xE0 + reg), 16});     // shl reg, 16
+        emit({0x48, 0xC1, static_cast<uint8_t>(0xE8 + reg), 16});     // shr reg, 16
+    }
+
+    // SSE on xmm0: prefix 0F op [r]
+    void sse(uint8_t prefix, uint8_t op, uint16_t r) { emit({prefix, 0x0F, op}); slot(0, r); }
+
+    // tag check for two int operands: (([b] ^ tag) | ([c] ^ tag)) >> 32 == 0, else jump
+    size_t unless_ints(uint16_t b, uint16_t c) {
+        load64(RAX, b);
+        load64(RDX, c);
+        emit({0x4C, 0x31, 0xF0});           // xor rax, r14
+        emit({0x4C, 0x31, 0xF2});           // xor rdx, r14
+        emit({0x48, 0x09, 0xD0});           // or rax, rdx
+        emit({0x48, 0xC1, 0xE8, 0x20});     // shr rax, 32
+        return jcc_forward(NotEqual);
+    }
+
+    // tag check for two float operands: both top halves below the int tag, else jump to either
+    std::pair<size_t, size_t> unless_floats(uint16_t b, uint16_t c) {
+        load64(RAX, b);
+        load64(RDX, c);
+        emit({0x48, 0xC1, 0xE8, 0x30});     // shr rax, 48
+        emit({0x48, 0xC1, 0xEA, 0x30});     // shr rdx, 48
+        emit({0x3D});                       // cmp eax, int tag
+        emit32(static_cast<uint32_t>(Value::make_int(0).raw() >> 48));
+        size_t first = jcc_forward(AboveOrEqual);
+        emit({0x81, 0xFA});                 // cmp edx, int tag
+        emit32(static_cast<uint32_t>(Value::make_int(0).raw() >> 48));
+        return {first, jcc_forward(AboveOrEqual)};
+    }
+
+    // rel32 jumps; the returned position is patched once the target is known
+    size_t jcc_forward(Condition condition) {
+        emit({0x0F, static_cast<uint8_t>(0x80 + condition)});
+        emit32(0);
+        return here() - 4;
+    }
+    size_t jmp_forward() {
+        emit({0xE9});
+        emit32(0);
+        return here() - 4;
+    }
+    void patch(size_t at, size_t target) {
+        uint32_t rel = static_cast<uint32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(at + 4));
+        std::memcpy(&code[at], &rel, sizeof(rel));
+    }
+    void patch_here(size_t at) { patch(at, here()); }
+
+    void call(const void* function) {
+        mov_imm64(RAX, reinterpret_cast<uint64_t>(function));
+        emit({0xFF, 0xD0});                 // call rax
+    }
+
+    void prologue(uint64_t int_tag) {
+        emit({0x53, 0x41, 0x54, 0x41, 0x56});   // push rbx, r12, r14: rsp is 16-byte aligned again
+        emit({0x49, 0x89, 0xFC});               // mov r12, rdi (vm)
+        emit({0x48, 0x89, 0xF3});               // mov rbx, rsi (regs)
+        emit({0x49, 0xBE});                     // mov r14, int tag
+        emit64(int_tag);
+        emit({0xFF, 0xE2});                     // jmp rdx (the starting instruction)
+    }
+    void epilogue() {
+        emit({0x41, 0x5E, 0x41, 0x5C, 0x5B, 0xC3});     // pop r14, r12, rbx; ret
+    }
+};
+
+Condition int_condition(BytecodeOp op) {
+    switch (op) {
+        case BytecodeOp::EqInt: case BytecodeOp::EqIntGuarded: case BytecodeOp::JumpIfEqInt: return Equal;
+        case BytecodeOp::NeInt: case BytecodeOp::NeIntGuarded: case BytecodeOp::JumpIfNeInt: return NotEqual;
+        case BytecodeOp::LtInt: case BytecodeOp::LtIntGuarded: case BytecodeOp::JumpIfLtInt: return Less;
+        case BytecodeOp::LeInt: case BytecodeOp::LeIntGuarded: case BytecodeOp::JumpIfLeInt: return LessOrEqual;
+        case BytecodeOp::GtInt: case BytecodeOp::GtIntGuarded: case BytecodeOp::JumpIfGtInt: return Greater;
+        default: return GreaterOrEqual;
+    }
+}
+
+// === Templates ===
+
+class FunctionJit {
+public:
+    FunctionJit(const BytecodeModule& module, const BytecodeFunction& function, const JitHelpers& helpers)
+        : module(module), function(function), helpers(helpers) {}
+
+    // the machine code and each instruction's offset in it
+    std::pair<std::vector<uint8_t>, std::vector<uint32_t>> compile() {
+        as.prologue(Value::make_int(0).raw());
+        std::vector<uint32_t> starts(function.code.size() + 1);
+        for (size_t pc = 0; pc < function.code.size(); ++pc) {
+            starts[pc] = static_cast<uint32_t>(as.here());
+            instruction(pc);
+        }
+        starts[function.code.size()] = static_cast<uint32_t>(as.here());
+        leave();
+        for (const auto& [at, target] : jumps) as.patch(at, starts[target]);
+
+        // one stub per instruction handed to the interpreter
+        std::vector<size_t> stubs(function.code.size(), 0);
+        for (const auto& [at, pc] : exits) {
+            if (!stubs[pc]) {
+                stubs[pc] = as.here();
+                as.mov_imm64(RAX, reinterpret_cast<uint64_t>(&function.code[pc]));
+                as.epilogue();
+            }
+            as.patch(at, stubs[pc]);
+        }
+        return {std::move(as.code), std::move(starts)};
+    }
+
+private:
+    void instruction(size_t pc) {
+        const Instruction& in = function.code[pc];
+        switch (in.op) {
+            case BytecodeOp::Move:
+                as.load64(RAX, in.b);
+                as.store64(in.a, RAX);
+                break;
+            case BytecodeOp::LoadK:
+                as.mov_imm64(RAX, module.constants[in.bc()].raw());
+                as.store64(in.a, RAX);
+                break;
+            case BytecodeOp::LoadGlobal:
+                as.mov_imm64(RCX, reinterpret_cast<uint64_t>(helpers.globals + in.bc()));
+                as.emit({0x48, 0x8B, 0x01});    // mov rax, [rcx]
+                as.store64(in.a, RAX);
+                break;
+            case BytecodeOp::StoreGlobal:
+                as.mov_imm64(RCX, reinterpret_cast<uint64_t>(helpers.globals + in.bc()));
+                as.load64(RAX, in.a);
+                as.emit({0x48, 0x89, 0x01});    // mov [rcx], rax
+                break;
+
+            case BytecodeOp::AddInt: case BytecodeOp::SubInt: case BytecodeOp::MulInt:
+                int_arithmetic(in);
+                break;
+            case BytecodeOp::AddIntGuarded: case BytecodeOp::SubIntGuarded: case BytecodeOp::MulIntGuarded:
+                guarded_int(pc, [&] { int_arithmetic(in); });
+                break;
+            case BytecodeOp::EqInt: case BytecodeOp::NeInt: case BytecodeOp::LtInt:
+            case BytecodeOp::LeInt: case BytecodeOp::GtInt: case BytecodeOp::GeInt:
+                int_comparison(in);
+                break;
+            case BytecodeOp::EqIntGuarded: case BytecodeOp::NeIntGuarded: case BytecodeOp::LtIntGuarded:
+            case BytecodeOp::LeIntGuarded: case BytecodeOp::GtIntGuarded: case BytecodeOp::GeIntGuarded:
+                guarded_int(pc, [&] { int_comparison(in); });
+                break;
+            case BytecodeOp::AddIntK:
+            case BytecodeOp::SubIntK:
+            case BytecodeOp::MulIntK: {
+                int32_t constant = module.constants[in.c].as_int();
+                as.load32(RAX, in.b);
+                if (in.op == BytecodeOp::AddIntK) {
+                    as.add_imm32(constant);
+                } else if (in.op == BytecodeOp::SubIntK) {
+                    as.sub_imm32(constant);
+                } else {
+                    as.imul_imm32(constant);
+                }
+                as.or_tag();
+                as.store64(in.a, RAX);
+                break;
+            }
+            case BytecodeOp::IncInt:
+                // the tag sits above the low 32 bits, so the add wraps without touching it
+                as.add_slot_imm32(in.a, in.sb());
+                break;
+
+            // results of SSE arithmetic on canonical NaNs are canonical, so no folding is needed
+            case BytecodeOp::AddFloat: case BytecodeOp::SubFloat:
+            case BytecodeOp::MulFloat: case BytecodeOp::DivFloat:
+                float_arithmetic(in);
+                break;
+            case BytecodeOp::AddFloatGuarded: case BytecodeOp::SubFloatGuarded:
+            case BytecodeOp::MulFloatGuarded: case BytecodeOp::DivFloatGuarded:
+                guarded_float(pc, [&] { float_arithmetic(in); });
+                break;
+            case BytecodeOp::EqFloat: case BytecodeOp::NeFloat: case BytecodeOp::LtFloat:
+            case BytecodeOp::LeFloat: case BytecodeOp::GtFloat: case BytecodeOp::GeFloat:
+                float_comparison(in);
+                break;
+            case BytecodeOp::EqFloatGuarded: case BytecodeOp::NeFloatGuarded: case BytecodeOp::LtFloatGuarded:
+            case BytecodeOp::LeFloatGuarded: case BytecodeOp::GtFloatGuarded: case BytecodeOp::GeFloatGuarded:
+                guarded_float(pc, [&] { float_comparison(in); });
+                break;
+            case BytecodeOp::IntToFloat:
+                as.sse(0xF2, 0x2A, in.b);       // cvtsi2sd xmm0, dword [b]
+                as.sse(0xF2, 0x11, in.a);       // movsd [a], xmm0
+                break;
+            case BytecodeOp::Not:
+                as.load32(RAX, in.b);
+                as.test_eax();
+                as.setcc(Equal, RAX);
+                bool_result(in.a);
+                break;
+
+            case BytecodeOp::Jump:
+                jump_to(as.jmp_forward(), pc + 1 + in.bc());
+                break;
+            case BytecodeOp::JumpIfFalse:
+            case BytecodeOp::JumpIfTrue:
+                as.test_slot32(in.a);
+                jump_to(as.jcc_forward(in.op == BytecodeOp::JumpIfTrue ? NotEqual : Equal), pc + 1 + in.bc());
+                break;
+            case BytecodeOp::JumpIfEqInt: case BytecodeOp::JumpIfNeInt: case BytecodeOp::JumpIfLtInt:
+            case BytecodeOp::JumpIfLeInt: case BytecodeOp::JumpIfGtInt: case BytecodeOp::JumpIfGeInt:
+                as.load32(RAX, in.a);
+                as.cmp32(in.b);
+                jump_to(as.jcc_forward(int_condition(in.op)), pc + 1 + in.sc());
+                break;
+
+            case BytecodeOp::Call:
+                as.emit({0x4C, 0x89, 0xE7});    // mov rdi, r12
+                as.emit({0x48, 0x89, 0xDE});    // mov rsi, rbx
+                as.mov_imm32(RDX, in.a);
+                as.mov_imm32(RCX, in.b);
+                as.call(reinterpret_cast<const void*>(helpers.call));
+                as.emit({0x48, 0x89, 0xC3});    // mov rbx, rax
+                break;
+            case BytecodeOp::TailCall:
+                if (&module.functions[in.b] == &function) {
+                    for (uint16_t i = 0; i < in.c; ++i) {
+                        as.load64(RAX, in.a + i);
+                        as.store64(i, RAX);
+                    }
+                    jump_to(as.jmp_forward(), 0);
+                } else {
+                    exits.emplace_back(as.jmp_forward(), pc);
+                }
+                break;
+            case BytecodeOp::Return:
+                as.load64(RAX, in.a);
+                as.store64(0, RAX);
+                leave();
+                break;
+            case BytecodeOp::ReturnVoid:
+                leave();
+                break;
+
+            case BytecodeOp::ArrayLength:
+                as.load64(RCX, in.b);
+                as.payload(RCX);
+                as.emit({0x8B, 0x01});          // mov eax, [rcx]
+                as.or_tag();
+                as.store64(in.a, RAX);
+                break;
+            case BytecodeOp::LoadElementInt:
+                checked_element(pc, in.b, in.c);
+                as.emit({0x8B, 0x44, 0x81, 0x08});  // mov eax, [rcx + 4 * rax + 8]
+                as.or_tag();
+                as.store64(in.a, RAX);
+                break;
+            case BytecodeOp::StoreElementInt:
+            case BytecodeOp::StoreElementIntInc:
+                checked_element(pc, in.a, in.b);
+                as.load32(RDX, in.c);
+                as.emit({0x89, 0x54, 0x81, 0x08});  // mov [rcx + 4 * rax + 8], edx
+                if (in.op == BytecodeOp::StoreElementIntInc) as.add_slot_imm32(in.b, 1);
+                break;
+
+            case BytecodeOp::Add: case BytecodeOp::Sub: case BytecodeOp::Mul: case BytecodeOp::Div:
+            case BytecodeOp::Mod: case BytecodeOp::FloorDiv: case BytecodeOp::Pow: case BytecodeOp::Shr:
+            case BytecodeOp::Eq: case BytecodeOp::Ne: case BytecodeOp::Lt: case BytecodeOp::Le:
+            case BytecodeOp::Gt: case BytecodeOp::Ge:
+            case BytecodeOp::NewArray: case BytecodeOp::LoadElement: case BytecodeOp::StoreElement:
+            case BytecodeOp::DivInt: case BytecodeOp::ModInt:
+            case BytecodeOp::DivIntGuarded: case BytecodeOp::ModIntGuarded:
+            case BytecodeOp::Neg:
+            case BytecodeOp::Cast:
+            case BytecodeOp::Print:
+            case BytecodeOp::Read:
+                call_instruction(pc);
+                break;
+        }
+    }
+
+    void int_arithmetic(const Instruction& in) {
+        as.load32(RAX, in.b);
+        switch (in.op) {
+            case BytecodeOp::AddInt: case BytecodeOp::AddIntGuarded: as.add32(in.c); break;
+            case BytecodeOp::SubInt: case BytecodeOp::SubIntGuarded: as.sub32(in.c); break;
+            default: as.imul32(in.c); break;
+        }
+        as.or_tag();
+        as.store64(in.a, RAX);
+    }
+
+    void int_comparison(const Instruction& in) {
+        as.load32(RAX, in.b);
+        as.cmp32(in.c);
+        as.setcc(int_condition(in.op), RAX);
+        bool_result(in.a);
+    }
+
+    void float_arithmetic(const Instruction& in) {
+        uint8_t op;
+        switch (generic_op(in.op)) {
+            case BytecodeOp::Add: op = 0x58; break;     // addsd
+            case BytecodeOp::Sub: op = 0x5C; break;     // subsd
+            case BytecodeOp::Mul: op = 0x59; break;     // mulsd
+            default: op = 0x5E; break;                  // divsd
+        }
+        as.sse(0xF2, 0x10, in.b);       // movsd xmm0, [b]
+        as.sse(0xF2, op, in.c);
+        as.sse(0xF2, 0x11, in.a);       // movsd [a], xmm0
+    }
+
+    // ucomisd leaves ZF, PF and CF all set for an unordered pair, so a NaN
+    // makes every comparison but != false, as in C
+    void float_comparison(const Instruction& in) {
+        BytecodeOp op = generic_op(in.op);
+        bool swap = op == BytecodeOp::Lt || op == BytecodeOp::Le;
+        as.sse(0xF2, 0x10, swap ? in.c : in.b);
+        as.sse(0x66, 0x2E, swap ? in.b : in.c);     // ucomisd xmm0, [other]
+        switch (op) {
+            case BytecodeOp::Eq:
+                as.setcc(Equal, RAX);
+                as.setcc(NoParity, RCX);
+                as.and_al_cl();
+                break;
+            case BytecodeOp::Ne:
+                as.setcc(NotEqual, RAX);
+                as.setcc(Parity, RCX);
+                as.or_al_cl();
+                break;
+            case BytecodeOp::Lt: case BytecodeOp::Gt: as.setcc(Above, RAX); break;
+            default: as.setcc(AboveOrEqual, RAX); break;
+        }
+        bool_result(in.a);
+    }
+
+    // al holds 0 or 1
+    void bool_result(uint16_t into) {
+        as.movzx_eax_al();
+        as.mov_imm64(RCX, Value::make_bool(false).raw());
+        as.or_rax_rcx();
+        as.store64(into, RAX);
+    }
+
+    // a quickened op: the inline form when the operands are of the kind it
+    // was quickened for, a deoptimizing exit to the interpreter otherwise
+    template <typename Fast>
+    void guarded_int(size_t pc, Fast fast) {
+        const Instruction& in = function.code[pc];
+        exits.emplace_back(as.unless_ints(in.b, in.c), pc);
+        fast();
+    }
+    template <typename Fast>
+    void guarded_float(size_t pc, Fast fast) {
+        const Instruction& in = function.code[pc];
+        auto [first, second] = as.unless_floats(in.b, in.c);
+        exits.emplace_back(first, pc);
+        exits.emplace_back(second, pc);
+        fast();
+    }
+
+    // rcx = the array in register `array`, rax = the index in register
+    // `index`, known to be in range; out of range, the interpreter's
+    // version of the instruction raises the error and never returns
+    void checked_element(size_t pc, uint16_t array, uint16_t index) {
+        as.load64(RCX, array);
+        as.payload(RCX);
+        as.load32(RAX, index);
+        as.emit({0x3B, 0x01});              // cmp eax, [rcx]: unsigned, so negative is out of range
+        size_t in_range = as.jcc_forward(Below);
+        call_instruction(pc);
+        as.patch_here(in_range);
+    }
+
+    // returns from the compiled code with nullptr: the function is done
+    void leave() {
+        as.emit({0x31, 0xC0});          // xor eax, eax
+        as.epilogue();
+    }
+
+    void call_instruction(size_t pc) {
+        as.emit({0x4C, 0x89, 0xE7});    // mov rdi, r12
+        as.emit({0x48, 0x89, 0xDE});    // mov rsi, rbx
+        as.emit({0x48, 0xBA});          // mov rdx, pc
+        as.emit64(reinterpret_cast<uint64_t>(&function.code[pc]));
+        as.mov_imm32(RCX, static_cast<uint32_t>(function.lines[pc]));
+        as.call(reinterpret_cast<const void*>(helpers.instruction));
+    }
+
+    void jump_to(size_t at, int64_t target) { jumps.emplace_back(at, static_cast<size_t>(target)); }
+
+    const BytecodeModule& module;
+    const BytecodeFunction& function;
+    const JitHelpers& helpers;
+    Assembler as;
+    std::vector<std::pair<size_t, size_t>> jumps;     // rel32 position, target instruction
+    std::vector<std::pair<size_t, size_t>> exits;     // rel32 position, instruction left to the interpreter
+};
+
+} // namespace
+
+const CompiledFunction* BaselineJit::compile(const BytecodeModule& module, const BytecodeFunction& function) {
+    if (!TURD_VM_JIT) return nullptr;
+    auto [code, starts] = FunctionJit(module, function, helpers).compile();
+    functions.push_back(std::make_unique<CompiledFunction>(code, std::move(starts)));
+    return functions.back().get();
+}
+
+size_t BaselineJit::code_bytes() const {
+    size_t total = 0;
+    for (const auto& compiled : functions) total += compiled->size();
+    return total;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "bytecode.hpp"
+#include <memory>
+
+// The JIT emits x86-64 System V code; elsewhere every function stays in
+// the interpreter.
+#if defined(__x86_64__) && defined(__linux__)
+#define TURD_VM_JIT 1
+#else
+#define TURD_VM_JIT 0
+#endif
+
+class VM;
+
+// Compiled code for one function. It runs the function on the VM's own
+// frame, regs pointing at r0, from the machine code at `start` onwards, and
+// leaves the result in r0 as the interpreter would; the VM pointer is
+// handed to the helpers it calls. It returns nullptr once the function has
+// returned, or the instruction the interpreter has to resume at: one whose
+// guard failed (deoptimization), or a tail call to another function.
+using JitCode = const Instruction* (*)(VM* vm, Value* regs, const void* start);
+
+// What compiled code needs from the VM it runs in: the slow paths it
+// calls out to, and where the globals live.
+struct JitHelpers {
+    // one instruction the template doesn't inline, run with the interpreter's semantics
+    void (*instruction)(VM* vm, Value* regs, const Instruction* pc, int32_t line);
+    // a call; returns the caller's regs, which move if the callee grew the stack
+    Value* (*call)(VM* vm, Value* regs, uint32_t first_argument, uint32_t function);
+    Value* globals;
+};
+
+// One mmapped block of machine code. It is writable while the code is
+// copied in and executable afterwards, never both (W^X).
+class ExecutableMemory {
+public:
+    ExecutableMemory(const std::vector<uint8_t>& code);     // throws std::runtime_error if mapping fails
+    ~ExecutableMemory();
+    ExecutableMemory(const ExecutableMemory&) = delete;
+    ExecutableMemory& operator=(const ExecutableMemory&) = delete;
+
+    const void* entry() const { return base; }
+    size_t size() const { return used; }     // the code, not the whole pages
+
+private:
+    void* base = nullptr;
+    size_t length = 0;
+    size_t used = 0;
+};
+
+// One function's machine code, and where each of its instructions starts
+// in it. No register state is kept between instructions, so the code can
+// be entered at any of them: at the first on a call, or at a loop header
+// when the interpreter hands a running frame over (on-stack replacement).
+class CompiledFunction {
+public:
+    CompiledFunction(const std::vector<uint8_t>& code, std::vector<uint32_t> starts)
+        : memory(code), starts(std::move(starts)) {}
+
+    // runs from instruction pc; see JitCode for what comes back
+    const Instruction* run(VM* vm, Value* regs, size_t pc) const {
+        auto code = reinterpret_cast<JitCode>(const_cast<void*>(memory.entry()));
+        return code(vm, regs, static_cast<const uint8_t*>(memory.entry()) + starts[pc]);
+    }
+    size_t size() const { return memory.size(); }
+
+private:
+    ExecutableMemory memory;
+    std::vector<uint32_t> starts;       // offset of each instruction's machine code
+};
+
+// === Baseline JIT ===
+// A template compiler: each instruction becomes a fixed snippet of
+// machine code, in bytecode order, with the frame kept exactly as the
+// interpreter lays it out. Registers stay in memory at regs[r]; rbx holds
+// regs, r12 the VM and r14 the int tag, so a typed int add is a load, an
+// add, an or and a store. Statically typed int and float arithmetic,
+// comparisons, fused branches, moves, constants, globals, array lengths
+// and int array elements (behind an inline bounds check) are inline.
+// Quickened ops are inline behind their guard, and a failed guard leaves
+// the compiled code for the interpreter at that instruction, which
+// reverts the quickening as usual. Everything else (the generic ops,
+// division's checks, casts, print, read, new arrays, elements of other
+// types) calls helpers.instruction with the source line, so it fails
+// exactly as the interpreter does. Calls go through helpers.call, which
+// runs the callee compiled or not; a tail call to the function itself
+// jumps back to its start.
+class BaselineJit {
+public:
+    explicit BaselineJit(JitHelpers helpers) : helpers(helpers) {}
+
+    // nullptr where the JIT isn't available; lives as long as the JIT
+    const CompiledFunction* compile(const BytecodeModule& module, const BytecodeFunction& function);
+
+    size_t code_bytes() const;
+
+private:
+    JitHelpers helpers;
+    std::vector<std::unique_ptr<CompiledFunction>> functions;
+};
@@ -0,0 +1,336 @@
+#include "peephole.hpp"
+#include <limits>
+
+namespace {
+
+constexpr int no_register = -1;
+constexpr int64_t no_target = -1;
+
+bool fits_int16(int64_t value) {
+    return value >= std::numeric_limits<int16_t>::min() && value <= std::numeric_limits<int16_t>::max();
+}
+
+// === Register Access ===
+
+// calls read(r) for every register the instruction reads
+template <typename Read>
+void for_each_read(const Instruction& instruction, Read read) {
+    switch (instruction.op) {
+        case BytecodeOp::Move:
+        case BytecodeOp::Neg:
+        case BytecodeOp::Not:
+        case BytecodeOp::IntToFloat:
+        case BytecodeOp::Cast:
+        case BytecodeOp::NewArray:
+        case BytecodeOp::ArrayLength:
+        case BytecodeOp::AddIntK:
+        case BytecodeOp::SubIntK:
+        case BytecodeOp::MulIntK:
+            read(instruction.b);
+            break;
+        case BytecodeOp::StoreGlobal:
+        case BytecodeOp::JumpIfFalse:
+        case BytecodeOp::JumpIfTrue:
+        case BytecodeOp::Return:
+        case BytecodeOp::IncInt:
+            read(instruction.a);
+            break;
+        case BytecodeOp::Add: case BytecodeOp::Sub: case BytecodeOp::Mul: case BytecodeOp::Div:
+        case BytecodeOp::Mod: case BytecodeOp::FloorDiv: case BytecodeOp::Pow: case BytecodeOp::Shr:
+        case BytecodeOp::Eq: case BytecodeOp::Ne: case BytecodeOp::Lt: case BytecodeOp::Le:
+        case BytecodeOp::Gt: case BytecodeOp::Ge:
+        case BytecodeOp::LoadElement: case BytecodeOp::LoadElementInt:
+#define TURD_TYPED_CASE(name, generic, type) case BytecodeOp::name: case BytecodeOp::name##Guarded:
+        TURD_TYPED_OPS(TURD_TYPED_CASE)
+#undef TURD_TYPED_CASE
+            read(instruction.b);
+            read(instruction.c);
+            break;
+        case BytecodeOp::JumpIfEqInt: case BytecodeOp::JumpIfNeInt: case BytecodeOp::JumpIfLtInt:
+        case BytecodeOp::JumpIfLeInt: case BytecodeOp::JumpIfGtInt: case BytecodeOp::JumpIfGeInt:
+            read(instruction.a);
+            read(instruction.b);
+            break;
+        case BytecodeOp::StoreElement:
+        case BytecodeOp::StoreElementInt:
+        case BytecodeOp::StoreElementIntInc:
+            read(instruction.a);
+            read(instruction.b);
+            read(instruction.c);
+            break;
+        case BytecodeOp::Call:
+        case BytecodeOp::TailCall:
+            for (int i = 0; i < instruction.c; ++i) read(instruction.a + i);
+            break;
+        case BytecodeOp::Print:
+            for (int i = 0; i < instruction.b; ++i) read(instruction.a + i);
+            break;
+        case BytecodeOp::LoadK:
+        case BytecodeOp::LoadGlobal:
+        case BytecodeOp::Jump:
+        case BytecodeOp::ReturnVoid:
+        case BytecodeOp::Read:
+            break;
+    }
+}
+
+// the register the instruction writes, or no_register
+int written(const Instruction& instruction) {
+    switch (instruction.op) {
+        case BytecodeOp::StoreElementIntInc:
+            return instruction.b;
+        case BytecodeOp::StoreGlobal:
+        case BytecodeOp::Jump:
+        case BytecodeOp::JumpIfFalse:
+        case BytecodeOp::JumpIfTrue:
+        case BytecodeOp::Return:
+        case BytecodeOp::ReturnVoid:
+        case BytecodeOp::TailCall:
+        case BytecodeOp::Print:
+        case BytecodeOp::StoreElement:
+        case BytecodeOp::StoreElementInt:
+        case BytecodeOp::JumpIfEqInt: case BytecodeOp::JumpIfNeInt: case BytecodeOp::JumpIfLtInt:
+        case BytecodeOp::JumpIfLeInt: case BytecodeOp::JumpIfGtInt: case BytecodeOp::JumpIfGeInt:
+            return no_register;
+        default:
+            return instruction.a;
+    }
+}
+
+// the instruction index a jump goes to, or no_target
+int64_t jump_target(const Instruction& instruction, size_t pc) {
+    switch (instruction.op) {
+        case BytecodeOp::Jump:
+        case BytecodeOp::JumpIfFalse:
+        case BytecodeOp::JumpIfTrue:
+            return static_cast<int64_t>(pc) + 1 + instruction.bc();
+        case BytecodeOp::JumpIfEqInt: case BytecodeOp::JumpIfNeInt: case BytecodeOp::JumpIfLtInt:
+        case BytecodeOp::JumpIfLeInt: case BytecodeOp::JumpIfGtInt: case BytecodeOp::JumpIfGeInt:
+            return static_cast<int64_t>(pc) + 1 + instruction.sc();
+        default:
+            return no_target;
+    }
+}
+
+bool falls_through(BytecodeOp op) {
+    return op != BytecodeOp::Jump && op != BytecodeOp::Return && op != BytecodeOp::ReturnVoid &&
+           op != BytecodeOp::TailCall;
+}
+
+// === Liveness ===
+// live_out[pc][r]: register r may be read after instruction pc before it is
+// written again. Iterated backwards to a fixed point; functions are small.
+std::vector<std::vector<bool>> live_out(const BytecodeFunction& function) {
+    size_t n = function.code.size();
+    std::vector<std::vector<bool>> live_in(n, std::vector<bool>(function.frame_size));
+    std::vector<std::vector<bool>> out(n, std::vector<bool>(function.frame_size));
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t pc = n; pc-- > 0;) {
+            const Instruction& instruction = function.code[pc];
+            std::vector<bool> live(function.frame_size);
+            auto merge = [&](int64_t successor) {
+                if (successor < 0 || static_cast<size_t>(successor) >= n) return;
+                const auto& in = live_in[successor];
+                for (size_t r = 0; r < live.size(); ++r) live[r] = live[r] || in[r];
+            };
+            if (falls_through(instruction.op)) merge(static_cast<int64_t>(pc) + 1);
+            merge(jump_target(instruction, pc));
+            out[pc] = live;
+
+            int def = written(instruction);
+            if (def != no_register) live[def] = false;
+            for_each_read(instruction, [&](int reg) { live[reg] = true; });
+            if (live != live_in[pc]) {
+                live_in[pc] = std::move(live);
+                changed = true;
+            }
+        }
+    }
+    return out;
+}
+
+// === Fusion ===
+
+struct Slot {
+    Instruction instruction;
+    int32_t line;
+    int64_t target;         // absolute, in the unfused numbering
+    bool removed = false;
+};
+
+// the fused branch for a typed int comparison, taken when the comparison is `when`
+BytecodeOp compare_branch(BytecodeOp compare, bool when) {
+    switch (compare) {
+        case BytecodeOp::EqInt: return when ? BytecodeOp::JumpIfEqInt : BytecodeOp::JumpIfNeInt;
+        case BytecodeOp::NeInt: return when ? BytecodeOp::JumpIfNeInt : BytecodeOp::JumpIfEqInt;
+        case BytecodeOp::LtInt: return when ? BytecodeOp::JumpIfLtInt : BytecodeOp::JumpIfGeInt;
+        case BytecodeOp::LeInt: return when ? BytecodeOp::JumpIfLeInt : BytecodeOp::JumpIfGtInt;
+        case BytecodeOp::GtInt: return when ? BytecodeOp::JumpIfGtInt : BytecodeOp::JumpIfLeInt;
+        case BytecodeOp::GeInt: return when ? BytecodeOp::JumpIfGeInt : BytecodeOp::JumpIfLtInt;
+        default: return compare;
+    }
+}
+
+class FunctionFuser {
+public:
+    FunctionFuser(const BytecodeModule& module, BytecodeFunction& function) : module(module), function(function) {}
+
+    size_t run() {
+        size_t n = function.code.size();
+        if (n < 2) return 0;
+        auto live = live_out(function);
+        slots.reserve(n);
+        std::vector<bool> is_target(n + 1);
+        for (size_t pc = 0; pc < n; ++pc) {
+            int64_t target = jump_target(function.code[pc], pc);
+            slots.push_back({function.code[pc], function.lines[pc], target});
+            if (target != no_target) is_target[target] = true;
+        }
+
+        size_t fused = 0;
+        for (size_t pc = 0; pc + 1 < n; ++pc) {
+            if (is_target[pc + 1]) continue;
+            Slot& first = slots[pc];
+            Slot& second = slots[pc + 1];
+            int passed = written(first.instruction);
+            if (passed == no_register) continue;
+            bool dead = !live[pc + 1][passed] || written(second.instruction) == passed;
+            if (dead && (fuse_compare_branch(first, second) || fuse_constant(first, second))) {
+                first.removed = true;
+                ++fused;
+                ++pc;
+            }
+        }
+
+        // a store passes no register on, and the IncInt after it is usually
+        // one fused above, so this pairs each store with the next kept slot
+        for (size_t pc = 0; pc < n; ++pc) {
+            if (slots[pc].removed) continue;
+            size_t next = pc + 1;
+            while (next < n && slots[next].removed && !is_target[next]) ++next;
+            if (next == n || is_target[next]) continue;
+            if (fuse_store_step(slots[pc], slots[next])) {
+                slots[pc].removed = true;
+                ++fused;
+                pc = next;
+            }
+        }
+        if (fused) close_up();
+        return fused;
+    }
+
+private:
+    // LtInt t, x, y; JumpIfTrue t  ->  JumpIfLtInt x, y
+    bool fuse_compare_branch(const Slot& first, Slot& second) {
+        BytecodeOp op = second.instruction.op;
+        if (op != BytecodeOp::JumpIfTrue && op != BytecodeOp::JumpIfFalse) return false;
+        if (second.instruction.a != first.instruction.a || !fits_int16(second.instruction.bc())) return false;
+        BytecodeOp branch = compare_branch(first.instruction.op, op == BytecodeOp::JumpIfTrue);
+        if (branch == first.instruction.op) return false;
+
+        second.instruction = Instruction{branch};
+        second.instruction.a = first.instruction.b;
+        second.instruction.b = first.instruction.c;
+        return true;
+    }
+
+    // LoadK t, k; AddInt d, x, t  ->  AddIntK d, x, k, or IncInt d, k when d is x;
+    // SubInt and MulInt likewise, without the IncInt
+    bool fuse_constant(const Slot& first, Slot& second) {
+        const Instruction& load = first.instruction;
+        Instruction& arithmetic = second.instruction;
+        if (load.op != BytecodeOp::LoadK || load.bc() > std::numeric_limits<uint16_t>::max()) return false;
+        if (arithmetic.b == arithmetic.c) return false;
+        BytecodeOp fused;
+        switch (arithmetic.op) {
+            case BytecodeOp::AddInt: fused = BytecodeOp::AddIntK; break;
+            case BytecodeOp::SubInt: fused = BytecodeOp::SubIntK; break;
+            case BytecodeOp::MulInt: fused = BytecodeOp::MulIntK; break;
+            default: return false;
+        }
+        const Value& constant = module.constants[load.bc()];
+        if (!constant.is_int()) return false;
+
+        bool add = arithmetic.op == BytecodeOp::AddInt;
+        bool commutes = arithmetic.op != BytecodeOp::SubInt;
+        uint16_t other;
+        if (arithmetic.c == load.a) {
+            other = arithmetic.b;
+        } else if (commutes && arithmetic.b == load.a) {
+            other = arithmetic.c;
+        } else {
+            return false;
+        }
+
+        int64_t step = add ? constant.as_int() : -static_cast<int64_t>(constant.as_int());
+        if (fused != BytecodeOp::MulIntK && arithmetic.a == other && fits_int16(step)) {
+            arithmetic = Instruction{BytecodeOp::IncInt};
+            arithmetic.a = other;
+            arithmetic.b = static_cast<uint16_t>(step);
+        } else {
+            uint16_t result = arithmetic.a;
+            arithmetic = Instruction{fused};
+            arithmetic.a = result;
+            arithmetic.b = other;
+            arithmetic.c = static_cast<uint16_t>(load.bc());
+        }
+        return true;
+    }
+
+    // StoreElementInt a, i, v; IncInt i, +1  ->  StoreElementIntInc a, i, v
+    bool fuse_store_step(const Slot& first, Slot& second) {
+        const Instruction& store = first.instruction;
+        const Instruction& step = second.instruction;
+        if (store.op != BytecodeOp::StoreElementInt || step.op != BytecodeOp::IncInt) return false;
+        if (step.a != store.b || step.sb() != 1) return false;
+
+        second.instruction = store;
+        second.instruction.op = BytecodeOp::StoreElementIntInc;
+        second.line = first.line;       // a bounds error reports the store's line
+        return true;
+    }
+
+    // drops the removed slots and points every jump at its target's new index;
+    // a jump to a removed slot lands on the fused instruction that replaced it
+    void close_up() {
+        std::vector<int64_t> new_index(slots.size() + 1);
+        int64_t next = 0;
+        for (size_t pc = 0; pc < slots.size(); ++pc) {
+            new_index[pc] = next;
+            if (!slots[pc].removed) ++next;
+        }
+        new_index[slots.size()] = next;
+
+        function.code.clear();
+        function.lines.clear();
+        for (size_t pc = 0; pc < slots.size(); ++pc) {
+            Slot& slot = slots[pc];
+            if (slot.removed) continue;
+            if (slot.target != no_target) {
+                int64_t offset = new_index[slot.target] - (new_index[pc] + 1);
+                if (slot.instruction.op == BytecodeOp::Jump || slot.instruction.op == BytecodeOp::JumpIfFalse ||
+                    slot.instruction.op == BytecodeOp::JumpIfTrue) {
+                    slot.instruction.set_bc(static_cast<int32_t>(offset));
+                } else {
+                    slot.instruction.c = static_cast<uint16_t>(offset);     // only shrinks, still fits
+                }
+            }
+            function.code.push_back(slot.instruction);
+            function.lines.push_back(slot.line);
+        }
+    }
+
+    const BytecodeModule& module;
+    BytecodeFunction& function;
+    std::vector<Slot> slots;
+};
+
+} // namespace
+
+size_t fuse_superinstructions(BytecodeModule& module) {
+    size_t fused = 0;
+    for (auto& function : module.functions) fused += FunctionFuser(module, function).run();
+    return fused;
+}
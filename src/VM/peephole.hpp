@@ -0,0 +1,22 @@
+#pragma once
+#include "bytecode.hpp"
+
+// === Superinstructions ===
+// A peephole pass over compiled bytecode that fuses the instruction pairs
+// `Compiler run --profile-pairs` found most often in our test programs
+// into one instruction each:
+//
+//   LtInt t, x, y; JumpIfTrue t        ->  JumpIfLtInt x, y    (every int comparison,
+//                                                               either branch sense)
+//   LoadK t, k; AddInt d, x, t         ->  AddIntK d, x, k     (and SubInt)
+//   ... where d is x and k is small    ->  IncInt d, k         ('i++' and friends)
+//   LoadK t, k; MulInt d, x, t         ->  MulIntK d, x, k
+//   StoreElementInt a, i, v; IncInt i, +1
+//                                      ->  StoreElementIntInc a, i, v   ('a[i] = v; i++')
+//
+// A pair fuses only when its second instruction is no jump target and the
+// register passed between the two, if any, is dead afterwards, by a
+// liveness pass over each function. Only the statically typed ops take part: a fused
+// instruction has no guard to fall back from. Jumps are renumbered as the
+// code closes up. Returns the number of pairs fused.
+size_t fuse_superinstructions(BytecodeModule& module);
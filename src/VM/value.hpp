@@ -0,0 +1,110 @@
+#pragma once
+#include "../Runtime/runtime.hpp"
+#include "../SynParser/syntax_parser.hpp"
+#include <cstdint>
+#include <cstring>
+
+// === VM Values ===
+// What a VM register, global or constant holds, NaN-boxed into 64 bits so
+// a register is one machine word. An untyped parameter still carries its
+// kind at runtime, the way a turd_dynamic does in native code, but the
+// kind lives in the bits instead of next to them.
+//
+// A float is stored as its own IEEE double. Every other kind sits in the
+// NaN space no double uses once NaNs are canonicalized: the top 16 bits
+// are the kind's tag, the low 48 the payload.
+//
+//   0x0000 .. 0xFFF8   float (every NaN is folded to 0x7FF8/0xFFF8 0000 0000 0000)
+//   0xFFF9             int, 32 bits zero-extended
+//   0xFFFA             bool, 0 or 1
+//   0xFFFB             char code
+//   0xFFFC             string, a turd_string pointer; user-space pointers fit in 48 bits
+//   0xFFFD             array, a turd_array pointer; its elements are unboxed, as in native code
+//
+// Kind tests are compares on the top bits, and the int fast path checks
+// two operands with one xor/or/shift.
+enum class ValueKind : uint8_t { Int, Float, Bool, Char, String, Array };
+
+class Value {
+public:
+    Value() = default;      // int 0
+
+    static Value make_int(int32_t value) { return Value(tag_bits(IntTag) | static_cast<uint32_t>(value)); }
+    static Value make_float(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        // a NaN keeps its sign and loses its payload, so it can't look like a tag
+        if (value != value) bits &= 0xFFF8'0000'0000'0000;
+        return Value(bits);
+    }
+    static Value make_bool(bool value) { return Value(tag_bits(BoolTag) | value); }
+    static Value make_char(int32_t value) { return Value(tag_bits(CharTag) | static_cast<uint32_t>(value)); }
+    static Value make_string(turd_string value) {
+        return Value(tag_bits(StringTag) | reinterpret_cast<uintptr_t>(value));
+    }
+    static Value make_array(turd_array value) {
+        return Value(tag_bits(ArrayTag) | reinterpret_cast<uintptr_t>(value));
+    }
+
+    ValueKind kind() const {
+        static constexpr ValueKind tagged[] = {ValueKind::Int, ValueKind::Bool, ValueKind::Char, ValueKind::String,
+                                               ValueKind::Array};
+        uint64_t tag = bits >> 48;
+        return tag < IntTag ? ValueKind::Float : tagged[tag - IntTag];
+    }
+    bool is_int() const { return bits >> 48 == IntTag; }
+    bool is_float() const { return bits >> 48 < IntTag; }
+    bool is_string() const { return bits >> 48 == StringTag; }
+    bool is_number() const { return bits >> 48 <= IntTag; }
+
+    // payloads; only meaningful for the matching kind
+    int32_t as_int() const { return static_cast<int32_t>(bits); }      // int, bool and char alike
+    double as_float() const {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    turd_string as_string() const { return reinterpret_cast<turd_string>(bits & PayloadMask); }
+    turd_array as_array() const { return reinterpret_cast<turd_array>(bits & PayloadMask); }
+    double as_double() const { return is_int() ? as_int() : as_float(); }
+
+    // both int: the tag matches and the upper payload half is zero, in one test
+    static bool both_int(Value a, Value b) {
+        return ((a.bits ^ tag_bits(IntTag)) | (b.bits ^ tag_bits(IntTag))) >> 32 == 0;
+    }
+
+    uint64_t raw() const { return bits; }   // equal raw bits mean the same kind and payload
+
+private:
+    static constexpr uint64_t IntTag = 0xFFF9;
+    static constexpr uint64_t BoolTag = 0xFFFA;
+    static constexpr uint64_t CharTag = 0xFFFB;
+    static constexpr uint64_t StringTag = 0xFFFC;
+    static constexpr uint64_t ArrayTag = 0xFFFD;
+    static constexpr uint64_t PayloadMask = (uint64_t(1) << 48) - 1;
+
+    static constexpr uint64_t tag_bits(uint64_t tag) { return tag << 48; }
+    explicit Value(uint64_t bits) : bits(bits) {}
+
+    uint64_t bits = tag_bits(IntTag);
+};
+static_assert(sizeof(Value) == 8, "VM values are NaN-boxed into one word");
+
+// the value a variable of a static type starts out with: 0, 0.0, false, '\0', ""
+// or the empty array
+inline Value zero_value(TypeId type) {
+    switch (type) {
+        case TypeId::Float: return Value::make_float(0.0);
+        case TypeId::Bool: return Value::make_bool(false);
+        case TypeId::Char: return Value::make_char(0);
+        case TypeId::String: return Value::make_string(nullptr);     // reads as ""
+        case TypeId::IntArray: case TypeId::FloatArray: case TypeId::StringArray:
+        case TypeId::BoolArray: case TypeId::CharArray:
+            return Value::make_array(&turd_empty_array);
+        case TypeId::Int:
+        case TypeId::Unknown:
+        case TypeId::Void:
+            break;
+    }
+    return Value::make_int(0);
+}
@@ -0,0 +1,787 @@
+#include "vm.hpp"
+#include "../Support/arithmetic.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+// a generic op whose guarded forms have failed this often stays generic
+constexpr uint8_t max_deopts = 4;
+
+turd_dynamic box(const Value& value) {
+    switch (value.kind()) {
+        case ValueKind::Int: return turd_box_int(value.as_int());
+        case ValueKind::Float: return turd_box_float(value.as_float());
+        case ValueKind::Bool: return turd_box_bool(value.as_int());
+        case ValueKind::Char: return turd_box_char(value.as_int());
+        case ValueKind::String: return turd_box_string(value.as_string());
+        case ValueKind::Array: break;       // arrays are statically typed, never boxed
+    }
+    return nullptr;
+}
+
+// === Slow Paths ===
+// Out of line so the dispatch loop only carries the int fast paths. The
+// runtime's dynamic operations define what every other combination does;
+// the ones handled here are exactly those it returns a value for.
+
+[[noreturn]] __attribute__((noinline)) void binary_error(int32_t op, const Value& a, const Value& b, int32_t line) {
+    turd_dynamic_binary(op, box(a), box(b), line);
+    std::abort();   // the runtime has reported the error and exited
+}
+
+int32_t int_binary(int32_t op, int32_t a, int32_t b, int32_t line) {
+    int64_t x = a, y = b;
+    switch (op) {
+        case TURD_ADD: return turd::wrap(x + y);
+        case TURD_SUB: return turd::wrap(x - y);
+        case TURD_MUL: return turd::wrap(x * y);
+        case TURD_POW: return turd_pow_int(a, b, line);
+        case TURD_SHR: return a >> (b & 31);
+        default: break;
+    }
+    if (b == 0) turd_error(TURD_DIVISION_BY_ZERO, line);
+    if (turd::int_division_traps(a, b)) turd_error(TURD_DIVISION_OVERFLOW, line);
+    if (op == TURD_DIV) return a / b;
+    if (op == TURD_MOD) return a % b;
+    return turd::int_floor_div(a, b);
+}
+
+__attribute__((noinline)) Value slow_binary(int32_t op, const Value& a, const Value& b, int32_t line) {
+    if (a.is_number() && b.is_number()) {
+        if (Value::both_int(a, b)) {
+            return Value::make_int(int_binary(op, a.as_int(), b.as_int(), line));
+        }
+        double x = a.as_double(), y = b.as_double();
+        switch (op) {
+            case TURD_ADD: return Value::make_float(x + y);
+            case TURD_SUB: return Value::make_float(x - y);
+            case TURD_MUL: return Value::make_float(x * y);
+            case TURD_DIV: return Value::make_float(x / y);
+            case TURD_MOD: return Value::make_float(std::fmod(x, y));
+            case TURD_POW: return Value::make_float(std::pow(x, y));
+            case TURD_FLOOR_DIV: return Value::make_int(turd_floor_div_float(x, y, line));
+            default: break;
+        }
+    } else if (op == TURD_ADD && a.is_string() && b.is_string()) {
+        return Value::make_string(turd_string_concat(a.as_string(), b.as_string()));
+    }
+    binary_error(op, a, b, line);
+}
+
+template <typename T>
+bool compare(int32_t op, T a, T b) {
+    switch (op) {
+        case TURD_EQ: return a == b;
+        case TURD_NE: return a != b;
+        case TURD_LT: return a < b;
+        case TURD_LE: return a <= b;
+        case TURD_GT: return a > b;
+        default: return a >= b;
+    }
+}
+
+__attribute__((noinline)) bool slow_compare(int32_t op, const Value& a, const Value& b, int32_t line) {
+    if (a.is_number() && b.is_number()) {
+        if (Value::both_int(a, b)) return compare(op, a.as_int(), b.as_int());
+        return compare(op, a.as_double(), b.as_double());
+    }
+    bool equality = op == TURD_EQ || op == TURD_NE;
+    if (a.kind() == b.kind()) {
+        if (a.is_string() && equality) return compare(op, turd_string_equal(a.as_string(), b.as_string()), 1);
+        if (a.is_string()) return compare(op, turd_string_compare(a.as_string(), b.as_string()), 0);
+        if (a.kind() == ValueKind::Char || equality) return compare(op, a.as_int(), b.as_int());
+    } else if (equality) {
+        return op == TURD_NE;
+    }
+    turd_dynamic_compare(op, box(a), box(b), line);
+    std::abort();
+}
+
+__attribute__((noinline)) Value slow_negate(const Value& value, int32_t line) {
+    if (value.is_float()) return Value::make_float(-value.as_float());
+    if (value.is_int()) return Value::make_int(turd::wrap(-static_cast<int64_t>(value.as_int())));
+    turd_dynamic_negate(box(value), line);
+    std::abort();
+}
+
+// a value checked against a static type, as native code unboxes a dynamic one
+__attribute__((noinline)) Value cast(const Value& value, TypeId type, int32_t line) {
+    switch (type) {
+        case TypeId::Int:
+            if (!value.is_int()) turd_unbox_int(box(value), line);
+            return value;
+        case TypeId::Float:
+            if (value.is_int()) return Value::make_float(value.as_int());
+            if (!value.is_float()) turd_unbox_float(box(value), line);
+            return value;
+        case TypeId::Bool:
+            if (value.kind() != ValueKind::Bool) turd_unbox_bool(box(value), line);
+            return value;
+        case TypeId::Char:
+            if (value.kind() != ValueKind::Char) turd_unbox_char(box(value), line);
+            return value;
+        case TypeId::String:
+            if (!value.is_string()) turd_unbox_string(box(value), line);
+            return value;
+        case TypeId::Unknown:
+        case TypeId::Void:
+        case TypeId::IntArray: case TypeId::FloatArray: case TypeId::StringArray:
+        case TypeId::BoolArray: case TypeId::CharArray:
+            break;
+    }
+    return value;
+}
+
+void print(const Value* values, uint16_t count) {
+    for (uint16_t i = 0; i < count; ++i) {
+        if (i) turd_print_separator();
+        const Value& value = values[i];
+        switch (value.kind()) {
+            case ValueKind::Int: turd_print_int(value.as_int()); break;
+            case ValueKind::Float: turd_print_float(value.as_float()); break;
+            case ValueKind::Bool: turd_print_bool(value.as_int()); break;
+            case ValueKind::Char: turd_print_char(value.as_int()); break;
+            case ValueKind::String: turd_print_string(value.as_string()); break;
+            case ValueKind::Array: break;       // print() takes no arrays
+        }
+    }
+    turd_print_newline();
+}
+
+Value read(TypeId type, int32_t line) {
+    switch (type) {
+        case TypeId::Int: return Value::make_int(turd_read_int(line));
+        case TypeId::Float: return Value::make_float(turd_read_float(line));
+        case TypeId::Bool: return Value::make_bool(turd_read_bool(line));
+        case TypeId::Char: return Value::make_char(turd_read_char(line));
+        case TypeId::String:
+        case TypeId::Unknown:
+        case TypeId::Void:
+        case TypeId::IntArray: case TypeId::FloatArray: case TypeId::StringArray:
+        case TypeId::BoolArray: case TypeId::CharArray:
+            break;
+    }
+    return Value::make_string(turd_read_string());
+}
+
+// === Arrays ===
+// The runtime's layout, so arrays are the same objects native code uses.
+
+int32_t runtime_element(TypeId array) {
+    switch (element_type(array)) {
+        case TypeId::Float: return TURD_ELEMENT_FLOAT;
+        case TypeId::Bool: return TURD_ELEMENT_BOOL;
+        case TypeId::Char: return TURD_ELEMENT_CHAR;
+        case TypeId::String: return TURD_ELEMENT_STRING;
+        default: return TURD_ELEMENT_INT;
+    }
+}
+
+template <typename T>
+T* elements(turd_array array) {
+    return reinterpret_cast<T*>(array + 1);
+}
+
+// unsigned, so a negative index is out of range too
+inline void check_index(turd_array array, int32_t index, int32_t line) {
+    if (static_cast<uint32_t>(index) >= static_cast<uint32_t>(array->length)) {
+        turd_error(TURD_INDEX_OUT_OF_RANGE, line);
+    }
+}
+
+Value load_element(turd_array array, int32_t index) {
+    switch (array->element) {
+        case TURD_ELEMENT_FLOAT: return Value::make_float(elements<double>(array)[index]);
+        case TURD_ELEMENT_STRING: return Value::make_string(elements<turd_string>(array)[index]);
+        case TURD_ELEMENT_BOOL: return Value::make_bool(elements<int32_t>(array)[index] != 0);
+        case TURD_ELEMENT_CHAR: return Value::make_char(elements<int32_t>(array)[index]);
+        default: return Value::make_int(elements<int32_t>(array)[index]);
+    }
+}
+
+// the compiler has converted the value to the element type already
+void store_element(turd_array array, int32_t index, const Value& value) {
+    switch (array->element) {
+        case TURD_ELEMENT_FLOAT: elements<double>(array)[index] = value.as_float(); break;
+        case TURD_ELEMENT_STRING: elements<turd_string>(array)[index] = value.as_string(); break;
+        default: elements<int32_t>(array)[index] = value.as_int(); break;
+    }
+}
+
+int32_t turd_operator(BytecodeOp generic) {
+    switch (generic) {
+        case BytecodeOp::Add: return TURD_ADD;
+        case BytecodeOp::Sub: return TURD_SUB;
+        case BytecodeOp::Mul: return TURD_MUL;
+        case BytecodeOp::Div: return TURD_DIV;
+        case BytecodeOp::Mod: return TURD_MOD;
+        case BytecodeOp::FloorDiv: return TURD_FLOOR_DIV;
+        case BytecodeOp::Pow: return TURD_POW;
+        case BytecodeOp::Shr: return TURD_SHR;
+        case BytecodeOp::Eq: return TURD_EQ;
+        case BytecodeOp::Ne: return TURD_NE;
+        case BytecodeOp::Lt: return TURD_LT;
+        case BytecodeOp::Le: return TURD_LE;
+        case BytecodeOp::Gt: return TURD_GT;
+        default: return TURD_GE;
+    }
+}
+
+std::vector<Value> initial_globals(const BytecodeModule& module) {
+    std::vector<Value> globals;
+    globals.reserve(module.globals.size());
+    for (TypeId type : module.globals) globals.push_back(zero_value(type));
+    return globals;
+}
+
+} // namespace
+
+VM::VM(BytecodeModule& module)
+    : module(module), globals(initial_globals(module)), stack(1 << 16),
+      jit(JitHelpers{&VM::jit_instruction, &VM::jit_call, globals.data()}),
+      compiled(module.functions.size(), nullptr) {}
+
+void VM::run() {
+    frames.clear();
+    BytecodeFunction& entry = module.functions[module.entry];
+    if (pair_counts.empty()) {
+        execute<false>(entry, 0, entry.code.data());
+    } else {
+        execute<true>(entry, 0, entry.code.data());
+    }
+}
+
+// one extra row for the "pair" ending in the first instruction, which
+// report_pairs skips. Compiled code isn't counted, so the JIT is off.
+void VM::profile_pairs() {
+    pair_counts.assign((bytecode_op_count + 1) * bytecode_op_count, 0);
+    jit_threshold = jit_off;
+}
+
+size_t VM::compiled_functions() const {
+    size_t count = 0;
+    for (const CompiledFunction* code : compiled) count += code != nullptr;
+    return count;
+}
+
+// === JIT ===
+
+// Compiled code nests on the native stack, one level per compiled call;
+// past max_native_depth, calls stay in the interpreter, whose frames live
+// in `frames` and `stack`, so deep recursion can't overflow it.
+const CompiledFunction* VM::compiled_code(uint32_t index) {
+    if (!compiled[index]) {
+        BytecodeFunction& function = module.functions[index];
+        if (jit_threshold == jit_off || ++function.hotness < jit_threshold) return nullptr;
+        compiled[index] = jit.compile(module, function);
+    }
+    return native_depth < max_native_depth ? compiled[index] : nullptr;
+}
+
+// the back-edge that made the function hot has been counted already
+const CompiledFunction* VM::loop_code(BytecodeFunction& function) {
+    if (jit_threshold == jit_off || native_depth >= max_native_depth) return nullptr;
+    const CompiledFunction*& code = compiled[&function - module.functions.data()];
+    if (!code) code = jit.compile(module, function);
+    return code;
+}
+
+Instruction* VM::run_compiled(uint32_t index, const CompiledFunction& code, Value* regs, size_t pc) {
+    ++native_depth;
+    auto resume = const_cast<Instruction*>(code.run(this, regs, pc));
+    --native_depth;
+    if (resume && resume->op != BytecodeOp::TailCall) {
+        // The guarded instruction reverts itself when the interpreter runs
+        // it, so code compiled again later won't fail the same guard.
+        ++deopt_exits;
+        compiled[index] = nullptr;
+        module.functions[index].hotness = 0;
+    }
+    return resume;
+}
+
+Value* VM::jit_call(VM* vm, Value* regs, uint32_t first_argument, uint32_t function) {
+    size_t base = static_cast<size_t>(regs - vm->stack.data());
+    size_t callee_base = base + first_argument;
+    BytecodeFunction& callee = vm->module.functions[function];
+    Instruction* start = callee.code.data();
+    if (const CompiledFunction* code = vm->compiled_code(function)) {
+        start = vm->run_compiled(function, *code, vm->frame_at(callee_base, callee.frame_size), 0);
+    }
+    if (start) vm->execute<false>(callee, callee_base, start);
+    return vm->stack.data() + base;
+}
+
+// the interpreter's semantics for what the JIT leaves out of line
+void VM::jit_instruction(VM*, Value* regs, const Instruction* pc, int32_t line) {
+    Value& result = regs[pc->a];
+    BytecodeOp op = generic_op(pc->op);
+    switch (op) {
+        case BytecodeOp::Add: case BytecodeOp::Sub: case BytecodeOp::Mul: case BytecodeOp::Div:
+        case BytecodeOp::Mod: case BytecodeOp::FloorDiv: case BytecodeOp::Pow: case BytecodeOp::Shr:
+            result = slow_binary(turd_operator(op), regs[pc->b], regs[pc->c], line);
+            break;
+        case BytecodeOp::Eq: case BytecodeOp::Ne: case BytecodeOp::Lt:
+        case BytecodeOp::Le: case BytecodeOp::Gt: case BytecodeOp::Ge:
+            result = Value::make_bool(slow_compare(turd_operator(op), regs[pc->b], regs[pc->c], line));
+            break;
+        case BytecodeOp::Neg:
+            result = slow_negate(regs[pc->b], line);
+            break;
+        case BytecodeOp::Cast:
+            result = cast(regs[pc->b], static_cast<TypeId>(pc->c), line);
+            break;
+        case BytecodeOp::Print:
+            print(&result, pc->b);
+            break;
+        case BytecodeOp::Read:
+            result = read(static_cast<TypeId>(pc->b), line);
+            break;
+        case BytecodeOp::NewArray:
+            result = Value::make_array(
+                turd_array_new(regs[pc->b].as_int(), runtime_element(static_cast<TypeId>(pc->c)), line));
+            break;
+        case BytecodeOp::ArrayLength:
+            result = Value::make_int(regs[pc->b].as_array()->length);
+            break;
+        case BytecodeOp::LoadElement:
+        case BytecodeOp::LoadElementInt: {
+            turd_array array = regs[pc->b].as_array();
+            check_index(array, regs[pc->c].as_int(), line);
+            result = load_element(array, regs[pc->c].as_int());
+            break;
+        }
+        case BytecodeOp::StoreElement:
+        case BytecodeOp::StoreElementInt:
+        case BytecodeOp::StoreElementIntInc: {
+            turd_array array = result.as_array();
+            check_index(array, regs[pc->b].as_int(), line);
+            store_element(array, regs[pc->b].as_int(), regs[pc->c]);
+            if (op == BytecodeOp::StoreElementIntInc) {
+                regs[pc->b] = Value::make_int(turd::wrap(static_cast<int64_t>(regs[pc->b].as_int()) + 1));
+            }
+            break;
+        }
+        default:
+            std::abort();   // the JIT inlines every other op
+    }
+}
+
+void VM::report_pairs(std::ostream& out, size_t top) const {
+    std::vector<std::pair<uint64_t, size_t>> pairs;
+    uint64_t total = 0;
+    for (size_t i = 0; i < bytecode_op_count * bytecode_op_count; ++i) {
+        if (!pair_counts[i]) continue;
+        pairs.emplace_back(pair_counts[i], i);
+        total += pair_counts[i];
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    if (pairs.size() > top) pairs.resize(top);
+
+    out << total << " instruction pair(s) executed\n";
+    for (const auto& [count, index] : pairs) {
+        char line[96];
+        std::snprintf(line, sizeof(line), "%12llu %6.2f%%  %s -> %s\n", static_cast<unsigned long long>(count),
+                      100.0 * static_cast<double>(count) / static_cast<double>(total),
+                      bytecodeOpToString(static_cast<BytecodeOp>(index / bytecode_op_count)),
+                      bytecodeOpToString(static_cast<BytecodeOp>(index % bytecode_op_count)));
+        out << line;
+    }
+}
+
+Value* VM::grow_stack(size_t base, size_t registers) {
+    size_t size = stack.size();
+    while (size < base + registers) size *= 2;
+    stack.resize(size);
+    return stack.data() + base;
+}
+
+// === Dispatch Loop ===
+// pc, the frame's registers and the constant pool live in locals so they
+// stay in machine registers; only calls and returns touch `frames`.
+template <bool profile>
+void VM::execute(BytecodeFunction& entry, size_t base, Instruction* start) {
+    BytecodeFunction* function = &entry;
+    Instruction* pc = start;
+    const Value* constants = module.constants.data();
+    Value* regs = frame_at(base, entry.frame_size);
+    size_t depth = frames.size();   // the frames of whoever called this execute()
+    uint64_t* pairs = pair_counts.data();
+    size_t previous = bytecode_op_count;
+
+#define COUNT_PAIR()                                                                            \
+    do {                                                                                        \
+        if constexpr (profile) {                                                                \
+            size_t op = static_cast<size_t>(pc->op);                                            \
+            ++pairs[previous * bytecode_op_count + op];                                         \
+            previous = op;                                                                      \
+        }                                                                                       \
+    } while (0)
+
+#define LINE() (function->lines[pc - function->code.data()])
+#define R(field) regs[pc->field]
+
+#define INT_OPERANDS() Value::both_int(R(b), R(c))
+#define FLOAT_OPERANDS() (R(b).is_float() && R(c).is_float())
+
+// A generic op rewrites itself into the guarded typed form for the kinds
+// it sees and runs that instead, until its guards have failed too often.
+#define QUICKEN(form)                                                                           \
+    do {                                                                                        \
+        pc->op = BytecodeOp::form##Guarded;                                                     \
+        DISPATCH();                                                                             \
+    } while (0)
+#define GENERIC_BINARY(name, turd_op, int_form, float_form)                                     \
+    CASE(name) {                                                                                \
+        if (pc->deopts < max_deopts) {                                                          \
+            if (INT_OPERANDS()) QUICKEN(int_form);                                              \
+            if (FLOAT_OPERANDS()) QUICKEN(float_form);                                          \
+        }                                                                                       \
+        R(a) = slow_binary(turd_op, R(b), R(c), LINE());                                        \
+        NEXT();                                                                                 \
+    }
+#define GENERIC_COMPARISON(name, turd_op)                                                       \
+    CASE(name) {                                                                                \
+        if (pc->deopts < max_deopts) {                                                          \
+            if (INT_OPERANDS()) QUICKEN(name##Int);                                             \
+            if (FLOAT_OPERANDS()) QUICKEN(name##Float);                                         \
+        }                                                                                       \
+        R(a) = Value::make_bool(slow_compare(turd_op, R(b), R(c), LINE()));                     \
+        NEXT();                                                                                 \
+    }
+// ops with no typed forms keep an inline int path
+#define BINARY(name, turd_op, fast)                                                             \
+    CASE(name) {                                                                                \
+        if (INT_OPERANDS()) {                                                                   \
+            int64_t x = R(b).as_int(), y = R(c).as_int();                                       \
+            fast;                                                                               \
+        } else {                                                                                \
+            R(a) = slow_binary(turd_op, R(b), R(c), LINE());                                    \
+        }                                                                                       \
+        NEXT();                                                                                 \
+    }
+// a typed op and its guarded twin; x and y are the operand payloads as T
+#define TYPED(name, generic, operands, T, load, compute)                                        \
+    CASE(name) {                                                                                \
+        T x = R(b).load(), y = R(c).load();                                                     \
+        compute;                                                                                \
+        NEXT();                                                                                 \
+    }                                                                                           \
+    CASE(name##Guarded) {                                                                       \
+        if (operands()) {                                                                       \
+            T x = R(b).load(), y = R(c).load();                                                 \
+            compute;                                                                            \
+            NEXT();                                                                             \
+        }                                                                                       \
+        pc->op = BytecodeOp::generic;                                                           \
+        ++pc->deopts;                                                                           \
+        DISPATCH();                                                                             \
+    }
+#define COMPARE_BRANCH(name, symbol)                                                            \
+    CASE(name) {                                                                                \
+        if (R(a).as_int() symbol R(b).as_int()) JUMP(pc->sc());                                 \
+        NEXT();                                                                                 \
+    }
+#define TYPED_INT(name, generic, result) TYPED(name, generic, INT_OPERANDS, int64_t, as_int, R(a) = result)
+#define TYPED_FLOAT(name, generic, result) TYPED(name, generic, FLOAT_OPERANDS, double, as_float, R(a) = result)
+
+#if TURD_VM_COMPUTED_GOTO
+    static const void* const labels[] = {
+#define TURD_VM_LABEL(name) &&op_##name,
+#define TURD_VM_TYPED_LABEL(name, generic, type) &&op_##name,
+#define TURD_VM_GUARDED_LABEL(name, generic, type) &&op_##name##Guarded,
+        TURD_BYTECODE_OPS(TURD_VM_LABEL)
+        TURD_TYPED_OPS(TURD_VM_TYPED_LABEL)
+        TURD_TYPED_OPS(TURD_VM_GUARDED_LABEL)
+#undef TURD_VM_GUARDED_LABEL
+#undef TURD_VM_TYPED_LABEL
+#undef TURD_VM_LABEL
+    };
+#define CASE(name) op_##name:
+#define DISPATCH()                                                                              \
+    do {                                                                                        \
+        COUNT_PAIR();                                                                           \
+        goto *labels[static_cast<size_t>(pc->op)];                                              \
+    } while (0)
+    DISPATCH();
+#else
+#define CASE(name) case BytecodeOp::name:
+#define DISPATCH() goto dispatch
+dispatch:
+    COUNT_PAIR();
+    switch (pc->op) {
+#endif
+#define NEXT() do { ++pc; DISPATCH(); } while (0)
+// a taken jump; going backwards closes a loop iteration, which counts
+// towards the JIT, and a hot loop carries on in compiled code
+#define JUMP(offset)                                                                            \
+    do {                                                                                        \
+        int32_t distance = (offset);                                                            \
+        pc += 1 + distance;                                                                     \
+        if (distance < 0 && ++function->hotness >= jit_threshold) goto enter_loop;              \
+        DISPATCH();                                                                             \
+    } while (0)
+#define RETURN_TO_CALLER()                                                                      \
+    do {                                                                                        \
+        if (frames.size() == depth) return;                                                     \
+        const Frame& caller = frames.back();                                                    \
+        function = caller.function;                                                             \
+        pc = caller.return_pc;                                                                  \
+        base = caller.base;                                                                     \
+        frames.pop_back();                                                                      \
+        regs = stack.data() + base;                                                             \
+        DISPATCH();                                                                             \
+    } while (0)
+
+    CASE(Move) {
+        R(a) = R(b);
+        NEXT();
+    }
+    CASE(LoadK) {
+        R(a) = constants[pc->bc()];
+        NEXT();
+    }
+    CASE(LoadGlobal) {
+        R(a) = globals[pc->bc()];
+        NEXT();
+    }
+    CASE(StoreGlobal) {
+        globals[pc->bc()] = R(a);
+        NEXT();
+    }
+
+    GENERIC_BINARY(Add, TURD_ADD, AddInt, AddFloat)
+    GENERIC_BINARY(Sub, TURD_SUB, SubInt, SubFloat)
+    GENERIC_BINARY(Mul, TURD_MUL, MulInt, MulFloat)
+    GENERIC_BINARY(Div, TURD_DIV, DivInt, DivFloat)
+    CASE(Mod) {
+        if (pc->deopts < max_deopts && INT_OPERANDS()) QUICKEN(ModInt);
+        R(a) = slow_binary(TURD_MOD, R(b), R(c), LINE());
+        NEXT();
+    }
+    BINARY(FloorDiv, TURD_FLOOR_DIV, R(a) = Value::make_int(int_binary(TURD_FLOOR_DIV, x, y, LINE())))
+    BINARY(Pow, TURD_POW, R(a) = Value::make_int(turd_pow_int(x, y, LINE())))
+    BINARY(Shr, TURD_SHR, R(a) = Value::make_int(static_cast<int32_t>(x) >> (y & 31)))
+
+    GENERIC_COMPARISON(Eq, TURD_EQ)
+    GENERIC_COMPARISON(Ne, TURD_NE)
+    GENERIC_COMPARISON(Lt, TURD_LT)
+    GENERIC_COMPARISON(Le, TURD_LE)
+    GENERIC_COMPARISON(Gt, TURD_GT)
+    GENERIC_COMPARISON(Ge, TURD_GE)
+
+    TYPED_INT(AddInt, Add, Value::make_int(turd::wrap(x + y)))
+    TYPED_INT(SubInt, Sub, Value::make_int(turd::wrap(x - y)))
+    TYPED_INT(MulInt, Mul, Value::make_int(turd::wrap(x * y)))
+    TYPED_INT(DivInt, Div, Value::make_int(int_binary(TURD_DIV, x, y, LINE())))
+    TYPED_INT(ModInt, Mod, Value::make_int(int_binary(TURD_MOD, x, y, LINE())))
+    TYPED_INT(EqInt, Eq, Value::make_bool(x == y))
+    TYPED_INT(NeInt, Ne, Value::make_bool(x != y))
+    TYPED_INT(LtInt, Lt, Value::make_bool(x < y))
+    TYPED_INT(LeInt, Le, Value::make_bool(x <= y))
+    TYPED_INT(GtInt, Gt, Value::make_bool(x > y))
+    TYPED_INT(GeInt, Ge, Value::make_bool(x >= y))
+
+    TYPED_FLOAT(AddFloat, Add, Value::make_float(x + y))
+    TYPED_FLOAT(SubFloat, Sub, Value::make_float(x - y))
+    TYPED_FLOAT(MulFloat, Mul, Value::make_float(x * y))
+    TYPED_FLOAT(DivFloat, Div, Value::make_float(x / y))
+    TYPED_FLOAT(EqFloat, Eq, Value::make_bool(x == y))
+    TYPED_FLOAT(NeFloat, Ne, Value::make_bool(x != y))
+    TYPED_FLOAT(LtFloat, Lt, Value::make_bool(x < y))
+    TYPED_FLOAT(LeFloat, Le, Value::make_bool(x <= y))
+    TYPED_FLOAT(GtFloat, Gt, Value::make_bool(x > y))
+    TYPED_FLOAT(GeFloat, Ge, Value::make_bool(x >= y))
+
+    // superinstructions (see peephole.hpp)
+    CASE(AddIntK) {
+        R(a) = Value::make_int(turd::wrap(static_cast<int64_t>(R(b).as_int()) + constants[pc->c].as_int()));
+        NEXT();
+    }
+    CASE(SubIntK) {
+        R(a) = Value::make_int(turd::wrap(static_cast<int64_t>(R(b).as_int()) - constants[pc->c].as_int()));
+        NEXT();
+    }
+    CASE(MulIntK) {
+        R(a) = Value::make_int(turd::wrap(static_cast<int64_t>(R(b).as_int()) * constants[pc->c].as_int()));
+        NEXT();
+    }
+    CASE(IncInt) {
+        R(a) = Value::make_int(turd::wrap(static_cast<int64_t>(R(a).as_int()) + pc->sb()));
+        NEXT();
+    }
+    CASE(StoreElementIntInc) {
+        turd_array array = R(a).as_array();
+        int32_t index = R(b).as_int();
+        check_index(array, index, LINE());
+        elements<int32_t>(array)[index] = R(c).as_int();
+        R(b) = Value::make_int(turd::wrap(static_cast<int64_t>(index) + 1));
+        NEXT();
+    }
+    COMPARE_BRANCH(JumpIfEqInt, ==)
+    COMPARE_BRANCH(JumpIfNeInt, !=)
+    COMPARE_BRANCH(JumpIfLtInt, <)
+    COMPARE_BRANCH(JumpIfLeInt, <=)
+    COMPARE_BRANCH(JumpIfGtInt, >)
+    COMPARE_BRANCH(JumpIfGeInt, >=)
+
+    CASE(Neg) {
+        if (R(b).is_int()) {
+            R(a) = Value::make_int(turd::wrap(-static_cast<int64_t>(R(b).as_int())));
+        } else {
+            R(a) = slow_negate(R(b), LINE());
+        }
+        NEXT();
+    }
+    CASE(Not) {
+        R(a) = Value::make_bool(!R(b).as_int());
+        NEXT();
+    }
+    CASE(IntToFloat) {
+        R(a) = Value::make_float(R(b).as_int());
+        NEXT();
+    }
+    CASE(Cast) {
+        R(a) = cast(R(b), static_cast<TypeId>(pc->c), LINE());
+        NEXT();
+    }
+
+    CASE(Jump) {
+        JUMP(pc->bc());
+    }
+    CASE(JumpIfFalse) {
+        if (!R(a).as_int()) JUMP(pc->bc());
+        NEXT();
+    }
+    CASE(JumpIfTrue) {
+        if (R(a).as_int()) JUMP(pc->bc());
+        NEXT();
+    }
+
+    CASE(Call) {
+        BytecodeFunction& callee = module.functions[pc->b];
+        size_t callee_base = base + pc->a;
+        Instruction* start = callee.code.data();
+        if (const CompiledFunction* code = compiled_code(pc->b)) {
+            // compiled code that deoptimizes leaves the rest of the call to the interpreter
+            start = run_compiled(pc->b, *code, frame_at(callee_base, callee.frame_size), 0);
+            if (!start) {
+                regs = stack.data() + base;
+                NEXT();
+            }
+        }
+        frames.push_back({function, pc + 1, base});
+        base = callee_base;
+        regs = frame_at(base, callee.frame_size);
+        function = &callee;
+        pc = start;
+        DISPATCH();
+    }
+    CASE(TailCall) {
+        // the callee takes this frame over: the arguments move down to r0,
+        // and its result goes back to this frame's caller
+        uint32_t index = pc->b;
+        BytecodeFunction& callee = module.functions[index];
+        for (uint16_t i = 0; i < pc->c; ++i) regs[i] = regs[pc->a + i];
+        regs = frame_at(base, callee.frame_size);
+        function = &callee;
+        pc = callee.code.data();
+        if (const CompiledFunction* code = compiled_code(index)) {
+            pc = run_compiled(index, *code, regs, 0);
+            if (!pc) RETURN_TO_CALLER();
+            regs = stack.data() + base;
+        }
+        DISPATCH();
+    }
+    CASE(Return) {
+        // the callee's r0 is the caller's result register
+        regs[0] = R(a);
+        RETURN_TO_CALLER();
+    }
+    CASE(ReturnVoid) {
+        RETURN_TO_CALLER();
+    }
+
+    CASE(Print) {
+        print(&R(a), pc->b);
+        NEXT();
+    }
+    CASE(Read) {
+        R(a) = read(static_cast<TypeId>(pc->b), LINE());
+        NEXT();
+    }
+
+    CASE(NewArray) {
+        R(a) = Value::make_array(turd_array_new(R(b).as_int(), runtime_element(static_cast<TypeId>(pc->c)), LINE()));
+        NEXT();
+    }
+    CASE(ArrayLength) {
+        R(a) = Value::make_int(R(b).as_array()->length);
+        NEXT();
+    }
+    CASE(LoadElement) {
+        turd_array array = R(b).as_array();
+        int32_t index = R(c).as_int();
+        check_index(array, index, LINE());
+        R(a) = load_element(array, index);
+        NEXT();
+    }
+    CASE(StoreElement) {
+        turd_array array = R(a).as_array();
+        int32_t index = R(b).as_int();
+        check_index(array, index, LINE());
+        store_element(array, index, R(c));
+        NEXT();
+    }
+    CASE(LoadElementInt) {
+        turd_array array = R(b).as_array();
+        int32_t index = R(c).as_int();
+        check_index(array, index, LINE());
+        R(a) = Value::make_int(elements<int32_t>(array)[index]);
+        NEXT();
+    }
+    CASE(StoreElementInt) {
+        turd_array array = R(a).as_array();
+        int32_t index = R(b).as_int();
+        check_index(array, index, LINE());
+        elements<int32_t>(array)[index] = R(c).as_int();
+        NEXT();
+    }
+
+    // on-stack replacement at the loop header pc, which compiled code can be entered at
+enter_loop:
+    if (const CompiledFunction* code = loop_code(*function)) {
+        ++osr_entries;
+        auto index = static_cast<uint32_t>(function - module.functions.data());
+        pc = run_compiled(index, *code, regs, static_cast<size_t>(pc - function->code.data()));
+        if (!pc) RETURN_TO_CALLER();
+        regs = stack.data() + base;
+    }
+    DISPATCH();
+
+#if !TURD_VM_COMPUTED_GOTO
+    }
+#endif
+
+#undef RETURN_TO_CALLER
+#undef JUMP
+#undef NEXT
+#undef DISPATCH
+#undef COUNT_PAIR
+#undef CASE
+#undef TYPED_FLOAT
+#undef TYPED_INT
+#undef COMPARE_BRANCH
+#undef TYPED
+#undef BINARY
+#undef GENERIC_COMPARISON
+#undef GENERIC_BINARY
+#undef QUICKEN
+#undef FLOAT_OPERANDS
+#undef INT_OPERANDS
+#undef R
+#undef LINE
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "jit.hpp"
+
+// Dispatch is threaded through a table of label addresses (GCC's "labels
+// as values") wherever the compiler has it: every handler ends in its own
+// indirect jump to the next one, which the branch predictor can learn per
+// opcode. Defining TURD_VM_SWITCH_DISPATCH, or a compiler without the
+// extension, falls back to one switch in a loop.
+#if defined(__GNUC__) && !defined(TURD_VM_SWITCH_DISPATCH)
+#define TURD_VM_COMPUTED_GOTO 1
+#else
+#define TURD_VM_COMPUTED_GOTO 0
+#endif
+
+// === Bytecode VM ===
+// Runs a BytecodeModule in-process. Every frame's registers sit in one
+// flat stack of Values: a call's frame starts at its first argument
+// register in the caller's frame, so arguments are already in place and
+// the result is written back where the caller expects it. A second array
+// holds one small record per active call (function, return address,
+// frame base).
+//
+// Operators do what native code does, with the same runtime library
+// behind them: prints, reads, string concatenation and every runtime
+// error go through Runtime/runtime.hpp, so a program prints the same
+// text, and fails with the same message, whichever way it is run. An int
+// or float fast path handles arithmetic inline; operand kinds that can
+// only fail are handed to the runtime, which reports the error and exits.
+//
+// Generic arithmetic and comparisons quicken: the first time one runs on
+// two ints or two floats it overwrites itself with the guarded typed form
+// (see TURD_TYPED_OPS), so later runs skip the kind dispatch. The module's
+// code is rewritten in place, which is why the VM takes it mutably.
+//
+// Every call and every backward jump adds to the running function's
+// hotness. A call to a function past the JIT threshold compiles it with
+// the BaselineJit first (see jit.hpp), and from then on calls run the
+// machine code on the same frame. Compiled code calls back into the VM,
+// so interpreted and compiled frames nest freely.
+//
+// A loop that gets hot while its function is still being interpreted,
+// such as a top-level `while (true)` that is never called at all, moves
+// to compiled code on its back-edge: the function is compiled and entered
+// at the loop header with the frame as it is (on-stack replacement). When
+// a guard in compiled code fails, the frame goes back to the interpreter
+// at the guarded instruction, and the function's code is thrown away to
+// be recompiled from the reverted bytecode once it is hot again.
+//
+// 'return f(...)' is a TailCall: f runs in the returning function's frame
+// and returns to its caller, so tail recursion, mutual or not, needs no
+// new frame. Compiled code turns a tail call to its own function into a
+// jump to its start, and hands any other back to the interpreter loop,
+// which makes it without growing the native stack.
+class VM {
+public:
+    static constexpr uint32_t default_jit_threshold = 1000;
+    static constexpr uint32_t jit_off = UINT32_MAX;
+    static constexpr uint32_t max_native_depth = 2000;      // compiled calls nested at once
+
+    explicit VM(BytecodeModule& module);
+
+    // calls plus back-edges before a function is compiled; 0 compiles
+    // every function on its first call, jit_off never compiles
+    void set_jit_threshold(uint32_t threshold) { jit_threshold = TURD_VM_JIT ? threshold : jit_off; }
+    size_t compiled_functions() const;
+    size_t compiled_bytes() const { return jit.code_bytes(); }
+    size_t loop_entries() const { return osr_entries; }         // on-stack replacements
+    size_t deoptimizations() const { return deopt_exits; }
+
+    // runs the top-level code to the end; output is left in stdout's buffer
+    void run();
+
+    // Makes run() count every pair of instructions executed back to back,
+    // the data for choosing superinstructions (see peephole.hpp). The
+    // counting is compiled into a second copy of the dispatch loop, so a
+    // VM that doesn't profile pays nothing for it.
+    void profile_pairs();
+    void report_pairs(std::ostream& out, size_t top) const;     // the `top` most frequent pairs
+
+    // entry points for compiled code (see JitHelpers)
+    static void jit_instruction(VM* vm, Value* regs, const Instruction* pc, int32_t line);
+    static Value* jit_call(VM* vm, Value* regs, uint32_t first_argument, uint32_t function);
+
+private:
+    // what a return restores: the caller's function, where it continues and its r0 in the stack
+    struct Frame {
+        BytecodeFunction* function;
+        Instruction* return_pc;
+        size_t base;
+    };
+
+    // runs entry from start, with its r0 at stack[base], until it returns
+    template <bool profile>
+    void execute(BytecodeFunction& entry, size_t base, Instruction* start);
+    Value* grow_stack(size_t base, size_t registers);     // the frame at base, after growing
+    Value* frame_at(size_t base, size_t registers) {
+        return base + registers > stack.size() ? grow_stack(base, registers) : stack.data() + base;
+    }
+    const CompiledFunction* compiled_code(uint32_t function);  // counts a call; compiles once hot; nullptr if not compiled
+    const CompiledFunction* loop_code(BytecodeFunction& function);  // after a hot back-edge; compiles if needed
+    // runs compiled code from pc; nullptr once the function returned, else where to interpret on
+    Instruction* run_compiled(uint32_t function, const CompiledFunction& code, Value* regs, size_t pc);
+
+    BytecodeModule& module;
+    std::vector<Value> globals;
+    std::vector<Value> stack;
+    std::vector<Frame> frames;
+    std::vector<uint64_t> pair_counts;      // [first * bytecode_op_count + second]; empty unless profiling
+    uint32_t jit_threshold = TURD_VM_JIT ? default_jit_threshold : jit_off;
+    BaselineJit jit;
+    std::vector<const CompiledFunction*> compiled;      // per function; nullptr while interpreted
+    uint32_t native_depth = 0;
+    size_t osr_entries = 0;
+    size_t deopt_exits = 0;
+};
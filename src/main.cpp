@@ -1,8 +1,30 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
 #include "Lexer/lexer.hpp"
 #include "SynParser/syntax_parser.hpp"
+#include "SynParser/ast_dumper.hpp"
+#include "SynParser/parallel_parser.hpp"
+#include "SynParser/incremental_parser.hpp"
+#include "Cache/ast_cache.hpp"
+#include "Semantic/name_resolver.hpp"
+#include "Semantic/type_checker.hpp"
+#include "Optimizer/constant_folder.hpp"
+#include "IR/ir_lowering.hpp"
+#include "IR/ir_verifier.hpp"
+#include "IR/ir_dumper.hpp"
+#include "Optimizer/pass_manager.hpp"
+#include "Backend/x86_64_codegen.hpp"
+#include "Backend/native_toolchain.hpp"
+#include "VM/bytecode_compiler.hpp"
+#include "VM/peephole.hpp"
+#include "VM/vm.hpp"
 
 void create_test_file(const std::string& filename, const std::string& content) {
     std::ofstream file(filename);
@@ -15,9 +37,342 @@ void create_test_file(const std::string& filename, const std::string& content) {
     }
 }
 
-int main() {
+// one line per node with its location, so two parses can be compared as text
+std::string compact_dump(const ASTNode& root) {
+    std::ostringstream out;
+    dump_ast(root, DumpFormat::Compact, out);
+    return out.str();
+}
+
+std::vector<std::string> messages(const std::vector<Diagnostic>& diagnostics) {
+    std::vector<std::string> result;
+    for (const auto& diagnostic : diagnostics) result.push_back(diagnostic.message);
+    return result;
+}
+
+// the tokens that differ between two versions of a file, as an editor would
+// report them: everything between the common prefix and the common suffix.
+// Prefix tokens must not have moved; suffix tokens may have
+TokenEdit diff_tokens(const std::vector<Token>& before, const std::vector<Token>& after) {
+    auto same = [](const Token& a, const Token& b) { return a.type == b.type && a.lexeme == b.lexeme; };
+    size_t start = 0;
+    while (start < before.size() && start < after.size() && same(before[start], after[start]) &&
+           before[start].line == after[start].line && before[start].column == after[start].column) {
+        start++;
+    }
+    size_t old_end = before.size(), new_end = after.size();
+    while (old_end > start && new_end > start && same(before[old_end - 1], after[new_end - 1])) {
+        old_end--;
+        new_end--;
+    }
+    return {start, old_end, new_end};
+}
+
+// Checks that text is one well-formed JSON value and counts the objects that
+// have a "kind" key, which is one per node in an AST dump
+class JsonChecker {
+public:
+    explicit JsonChecker(const std::string& text) : text(text) {}
+
+    bool check() {
+        bool ok = value();
+        skip_blanks();
+        return ok && pos == text.size();
+    }
+    size_t nodes() const { return kinds; }
+    size_t array_items() const { return top_items; }   // entries of a top-level array
+
+private:
+    bool value(int depth = 0) {
+        skip_blanks();
+        if (pos >= text.size()) return false;
+        char c = text[pos];
+        if (c == '{') return object(depth);
+        if (c == '[') return array(depth);
+        if (c == '"') return string();
+        for (const char* word : {"true", "false", "null"}) {
+            if (text.compare(pos, std::strlen(word), word) == 0) {
+                pos += std::strlen(word);
+                return true;
+            }
+        }
+        size_t start = pos;
+        if (text[pos] == '-') pos++;
+        while (pos < text.size() && (std::isdigit(static_cast<unsigned char>(text[pos])) ||
+                                     text[pos] == '.' || text[pos] == 'e' || text[pos] == 'E' ||
+                                     text[pos] == '+' || text[pos] == '-')) {
+            pos++;
+        }
+        return pos > start && std::isdigit(static_cast<unsigned char>(text[pos - 1]));
+    }
+
+    bool object(int depth) {
+        pos++;
+        skip_blanks();
+        if (pos < text.size() && text[pos] == '}') return ++pos, true;
+        while (true) {
+            skip_blanks();
+            size_t key = pos;
+            if (!string()) return false;
+            if (text.compare(key, 6, "\"kind\"") == 0) kinds++;
+            skip_blanks();
+            if (pos >= text.size() || text[pos++] != ':' || !value(depth + 1)) return false;
+            skip_blanks();
+            if (pos >= text.size()) return false;
+            if (text[pos] == '}') return ++pos, true;
+            if (text[pos++] != ',') return false;
+        }
+    }
+
+    bool array(int depth) {
+        pos++;
+        skip_blanks();
+        if (pos < text.size() && text[pos] == ']') return ++pos, true;
+        while (true) {
+            if (!value(depth + 1)) return false;
+            if (depth == 0) top_items++;
+            skip_blanks();
+            if (pos >= text.size()) return false;
+            if (text[pos] == ']') return ++pos, true;
+            if (text[pos++] != ',') return false;
+        }
+    }
+
+    bool string() {
+        if (pos >= text.size() || text[pos] != '"') return false;
+        for (pos++; pos < text.size(); pos++) {
+            unsigned char c = static_cast<unsigned char>(text[pos]);
+            if (c == '"') return ++pos, true;
+            if (c < 0x20) return false;
+            if (c == '\\' && ++pos >= text.size()) return false;
+        }
+        return false;
+    }
+
+    void skip_blanks() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) pos++;
+    }
+
+    const std::string& text;
+    size_t pos = 0;
+    size_t kinds = 0;
+    size_t top_items = 0;
+};
+
+// lexes, parses, checks and folds one source file; reports every problem
+// on stderr and returns nullptr when there was one. With a cache_directory
+// the parsed tree comes from the AST cache when it has a current entry, and
+// a tree that parsed cleanly is stored for the next run
+std::shared_ptr<ProgramNode> check_source(const std::string& filename, const std::string& cache_directory = "") {
+    std::shared_ptr<ProgramNode> ast;
+    std::vector<Diagnostic> parse_errors;
+    if (!cache_directory.empty()) {
+        if (MappedAST mapped = ASTCache(cache_directory).load(filename)) {
+            ast = std::static_pointer_cast<ProgramNode>(mapped.image().materialize());
+        }
+    }
+    if (!ast) {
+        Lexer lexer(filename);
+        SyntaxParser parser(lexer.tokenize());
+        ast = std::static_pointer_cast<ProgramNode>(parser.parse_program());
+        parse_errors = parser.get_diagnostics();
+        if (!cache_directory.empty() && parse_errors.empty()) ASTCache(cache_directory).store(filename, *ast);
+    }
+
+    NameResolver resolver;
+    TypeChecker checker;
+    if (parse_errors.empty()) {
+        resolver.resolve(*ast);
+        if (!resolver.has_errors()) checker.check(*ast);
+    }
+    bool failed = false;
+    const std::vector<Diagnostic>* phases[] = {&parse_errors, &resolver.get_diagnostics(), &checker.get_diagnostics()};
+    for (const auto* diagnostics : phases) {
+        for (const auto& diagnostic : *diagnostics) {
+            std::cerr << filename << ": " << diagnostic.message << std::endl;
+            failed = true;
+        }
+    }
+    if (failed) return nullptr;
+    ConstantFolder().fold(*ast);
+    return ast;
+}
+
+// check_source, then lowers and optimizes the tree; false when there was a problem
+bool compile_to_ir(const std::string& filename, OptLevel opt_level, IRModule& module,
+                   const std::string& cache_directory = "") {
+    auto ast = check_source(filename, cache_directory);
+    if (!ast) return false;
+    module = IRLowering().lower(*ast);
+    IRVerifier verifier;
+    if (!verifier.verify(module)) {
+        for (const auto& error : verifier.get_errors()) std::cerr << filename << ": " << error << std::endl;
+        return false;
+    }
+    PassManager::for_level(opt_level, false).run(module);
+    return true;
+}
+
+// Compiler build <source> [-o <output>] [-O0|-O1|-O2] [-S] [--stats] [--ast-cache <dir>]
+// compiles to a native executable, or with -S to assembly only;
+// --stats reports how well registers were allocated, --ast-cache reuses
+// parsed trees kept in <dir>
+int build_native(int argc, char** argv) {
+    std::string source, output, cache_directory;
+    bool assembly_only = false;
+    bool print_stats = false;
+    OptLevel opt_level = OptLevel::O1;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "-o" && i + 1 < argc) output = argv[++i];
+            else if (arg == "-S") assembly_only = true;
+            else if (arg == "--stats") print_stats = true;
+            else if (arg == "--ast-cache" && i + 1 < argc) cache_directory = argv[++i];
+            else if (arg.rfind("-O", 0) == 0) opt_level = parse_opt_level(arg);
+            else if (source.empty() && arg[0] != '-') source = arg;
+            else throw std::runtime_error("unexpected argument '" + arg + "'");
+        }
+        if (source.empty()) throw std::runtime_error("usage: Compiler build <source> [-o <output>] [-O<n>] [-S] [--stats] [--ast-cache <dir>]");
+        if (output.empty()) {
+            size_t dot = source.rfind('.');
+            output = source.substr(0, dot == std::string::npos || dot < source.rfind('/') + 1 ? source.size() : dot);
+            if (assembly_only) output += ".s";
+            else if (output == source) output += ".out";
+        }
+
+        IRModule module;
+        if (!compile_to_ir(source, opt_level, module, cache_directory)) return 1;
+        X86CodeGen codegen;
+        std::string assembly = codegen.generate(module);
+        if (print_stats) {
+            std::cout << "Register allocation:" << std::endl;
+            codegen.get_stats().print(std::cout);
+        }
+        if (assembly_only) {
+            std::ofstream file(output);
+            file << assembly;
+            if (!file) throw std::runtime_error("cannot write " + output);
+        } else {
+            NativeToolchain().link(assembly, output);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Compiler run <source> [--disassemble] [--no-fuse] [--profile-pairs]
+//                       [--no-jit | --jit-threshold <n>] [--ast-cache <dir>]
+// compiles to bytecode and runs it in-process. --disassemble lists the
+// bytecode on stderr first, --no-fuse leaves out superinstructions,
+// --profile-pairs reports the most frequent instruction pairs on stderr
+// after the run, and the JIT options set when functions are compiled to
+// machine code (0 compiles every function on its first call). --ast-cache
+// is the same as for build
+int run_bytecode(int argc, char** argv) {
+    const char* usage = "usage: Compiler run <source> [--disassemble] [--no-fuse] [--profile-pairs] "
+                        "[--no-jit | --jit-threshold <n>] [--ast-cache <dir>]";
+    std::string source, cache_directory;
+    bool print_bytecode = false;
+    bool fuse = true;
+    bool profile = false;
+    uint32_t jit_threshold = VM::default_jit_threshold;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--disassemble") print_bytecode = true;
+            else if (arg == "--no-fuse") fuse = false;
+            else if (arg == "--profile-pairs") profile = true;
+            else if (arg == "--no-jit") jit_threshold = VM::jit_off;
+            else if (arg == "--jit-threshold" && i + 1 < argc) jit_threshold = static_cast<uint32_t>(std::stoul(argv[++i]));
+            else if (arg == "--ast-cache" && i + 1 < argc) cache_directory = argv[++i];
+            else if (source.empty() && arg[0] != '-') source = arg;
+            else throw std::runtime_error("unexpected argument '" + arg + "'");
+        }
+        if (source.empty()) throw std::runtime_error(usage);
+
+        auto ast = check_source(source, cache_directory);
+        if (!ast) return 1;
+        BytecodeModule module = BytecodeCompiler().compile(*ast);
+        if (fuse) fuse_superinstructions(module);
+        if (print_bytecode) disassemble(module, std::cerr);
+
+        turd_runtime_init();
+        VM vm(module);
+        vm.set_jit_threshold(jit_threshold);
+        if (profile) vm.profile_pairs();
+        vm.run();
+        turd_runtime_exit();
+        if (profile) vm.report_pairs(std::cerr, 20);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Compiler dump <source> [--tokens] [--format text|json|compact]
+// prints the parsed tree, or with --tokens the token stream, on stdout;
+// parse errors go to stderr and the tree is printed with its error nodes
+int dump_source(int argc, char** argv) {
+    const char* usage = "usage: Compiler dump <source> [--tokens] [--format text|json|compact]";
+    std::string source;
+    bool tokens_only = false;
+    DumpFormat format = DumpFormat::Text;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--tokens") tokens_only = true;
+            else if (arg == "--format" && i + 1 < argc) {
+                std::string name = argv[++i];
+                if (name == "text") format = DumpFormat::Text;
+                else if (name == "json") format = DumpFormat::Json;
+                else if (name == "compact") format = DumpFormat::Compact;
+                else throw std::runtime_error("unknown dump format '" + name + "', expected text, json or compact");
+            }
+            else if (source.empty() && arg[0] != '-') source = arg;
+            else throw std::runtime_error("unexpected argument '" + arg + "'");
+        }
+        if (source.empty()) throw std::runtime_error(usage);
+
+        Lexer lexer(source);
+        std::vector<Token> tokens = lexer.tokenize();
+        if (tokens_only) {
+            dump_tokens(tokens, format, std::cout);
+        } else {
+            SyntaxParser parser(tokens);
+            auto ast = parser.parse_program();
+            for (const auto& diagnostic : parser.get_diagnostics()) {
+                std::cerr << source << ": " << diagnostic.message << std::endl;
+            }
+            dump_ast(*ast, format, std::cout);
+        }
+        if (format == DumpFormat::Json) std::cout << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "build") return build_native(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "run") return run_bytecode(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "dump") return dump_source(argc, argv);
+
+    // -O0 prints the IR as lowered; the default -O1 and -O2 optimize it first
+    OptLevel opt_level = OptLevel::O1;
+    for (int i = 1; i < argc; ++i) {
+        try {
+            opt_level = parse_opt_level(argv[i]);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
 
-    
     // test 1: basic tokens and string literals
     create_test_file("test1.txt", R"(
         int x = 42;
@@ -92,10 +447,35 @@ int main() {
         float just_decimal = .789;
         )");
 
+    // Test 7: loops for the optimizer: invariants, redundancy and constants
+    create_test_file("test7.txt", R"(
+        int scale = 3;
+        function sum_to(int n, int k) -> int {
+            int total = 0;
+            for (int i = 0; i < n; i++) {
+                int step = k * scale + 1;
+                total = total + step + k * scale;
+            }
+            return total;
+        }
+
+        int limit = 4 * 5;
+        int count = 0;
+        while (count < limit) {
+            if (limit > 10) {
+                count++;
+            } else {
+                print("never");
+            }
+        }
+        print(sum_to(count, 2));
+    )");
+
     // Run tests on each file
     std::vector<std::string> test_files = {
         "test1.txt", "test2.txt", "test3.txt", 
-        "test4.txt", "test5.txt", "test6.txt"
+        "test4.txt", "test5.txt", "test6.txt",
+        "test7.txt"
     };
 
     for (const auto& filename : test_files) {
@@ -113,13 +493,243 @@ int main() {
             std::cout << "\nParsing syntax..." << std::endl;
             SyntaxParser parser(tokens);
             auto ast = parser.parse_program();
-            std::cout << "AST successfully created." << std::endl;
-            
+            if (parser.has_errors()) {
+                std::cout << "AST created with " << parser.get_diagnostics().size() << " error(s):" << std::endl;
+                for (const auto& diagnostic : parser.get_diagnostics()) {
+                    std::cout << "  " << diagnostic.message << std::endl;
+                }
+            } else {
+                std::cout << "AST successfully created." << std::endl;
+            }
+            parser.print_ast(ast);
+            // resolution and folding rewrite the tree, so keep the parse for the parallel check below
+            const std::string sequential_dump = compact_dump(*ast);
+
+            NameResolver resolver;
+            resolver.resolve(static_cast<ProgramNode&>(*ast));
+            std::cout << "Name resolution: " << resolver.get_diagnostics().size() << " error(s)" << std::endl;
+            for (const auto& diagnostic : resolver.get_diagnostics()) {
+                std::cout << "  " << diagnostic.message << std::endl;
+            }
+
+            TypeChecker checker;
+            checker.check(static_cast<ProgramNode&>(*ast));
+            std::cout << "Type checking: " << checker.get_diagnostics().size() << " error(s)" << std::endl;
+            for (const auto& diagnostic : checker.get_diagnostics()) {
+                std::cout << "  " << diagnostic.message << std::endl;
+            }
+
+            if (!parser.has_errors() && !resolver.has_errors() && !checker.has_errors()) {
+                ConstantFolder folder;
+                folder.fold(static_cast<ProgramNode&>(*ast));
+                const FoldStats& stats = folder.get_stats();
+                std::cout << "Constant folding: " << stats.folded << " folded, " << stats.simplified
+                          << " simplified, " << stats.branches_removed << " branch(es) removed" << std::endl;
+
+                IRModule module = IRLowering().lower(static_cast<ProgramNode&>(*ast));
+                IRVerifier verifier;
+                bool valid = verifier.verify(module);
+                for (const auto& error : verifier.get_errors()) {
+                    std::cout << "  " << error << std::endl;
+                }
+                if (valid) {
+                    PassManager passes = PassManager::for_level(opt_level, true);
+                    passes.run(module);
+                    std::cout << "\nIR passes:" << std::endl;
+                    passes.print_timings(std::cout);
+                }
+                std::cout << "\nSSA IR (" << (valid ? "verified" : "INVALID") << "):" << std::endl;
+                dump_ir(module, std::cout);
+            }
+
+            // the sliced parse must agree with the sequential one
+            ParallelParser parallel(tokens);
+            auto parallel_ast = std::static_pointer_cast<ProgramNode>(parallel.parse_program());
+            bool same_tree = compact_dump(*parallel_ast) == sequential_dump;
+            bool same_errors = messages(parallel.get_diagnostics()) == messages(parser.get_diagnostics());
+            std::cout << "Parallel parse: " << parallel_ast->children.size() << " top-level node(s), "
+                      << parallel.get_diagnostics().size() << " error(s), "
+                      << (same_tree && same_errors ? "matches sequential parse"
+                          : !same_tree ? "TREE MISMATCH with sequential parse" : "DIAGNOSTICS MISMATCH with sequential parse")
+                      << std::endl;
         } catch (const std::exception& e) {
             std::cerr << "Error processing " << filename << ": " << e.what() << std::endl;
         }
     }
 
+    // Test AST cache: the first pass stores each tree, the second maps it back without parsing
+    std::cout << "\n" << std::string(50, '=') << std::endl;
+    std::cout << "TESTING AST CACHE" << std::endl;
+    std::cout << std::string(50, '=') << std::endl;
+
+    // a fresh directory outside the working tree, so pass 1 always parses
+    const std::filesystem::path cache_directory = std::filesystem::temp_directory_path() / "turd_harness_cache";
+    std::filesystem::remove_all(cache_directory);
+    ASTCache cache(cache_directory.string());
+    for (int pass = 1; pass <= 2; ++pass) {
+        for (const auto& filename : test_files) {
+            try {
+                if (MappedAST mapped = cache.load(filename)) {
+                    ASTImage image = mapped.image();
+                    std::cout << "Pass " << pass << " " << filename << ": cache hit, "
+                              << image.header().node_count << " nodes, "
+                              << image.root().list(0).size() << " top-level" << std::endl;
+                    continue;
+                }
+
+                Lexer lexer(filename);
+                SyntaxParser parser(lexer.tokenize());
+                auto ast = std::static_pointer_cast<ProgramNode>(parser.parse_program());
+                bool stored = cache.store(filename, *ast);
+                std::cout << "Pass " << pass << " " << filename << ": parsed, "
+                          << (stored ? "stored in cache" : "cache write failed") << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "Error caching " << filename << ": " << e.what() << std::endl;
+            }
+        }
+    }
+    std::filesystem::remove_all(cache_directory);
+
+    // Test the machine-readable dumps of test7: the JSON must parse and hold
+    // one object per node, and the compact form one line per node or token
+    std::cout << "\n" << std::string(50, '=') << std::endl;
+    std::cout << "TESTING DUMP FORMATS" << std::endl;
+    std::cout << std::string(50, '=') << std::endl;
+    try {
+        Lexer lexer("test7.txt");
+        std::vector<Token> tokens = lexer.tokenize();
+        SyntaxParser parser(tokens);
+        auto ast = std::static_pointer_cast<ProgramNode>(parser.parse_program());
+        std::vector<uint8_t> image = serialize_ast(*ast);
+        const size_t nodes = ASTImage(image.data(), image.size()).header().node_count;
+
+        auto render = [](auto&& dump) {
+            std::ostringstream out;
+            dump(out);
+            return out.str();
+        };
+        const std::string ast_json = render([&](std::ostream& out) { dump_ast(*ast, DumpFormat::Json, out); });
+        const std::string ast_compact = render([&](std::ostream& out) { dump_ast(*ast, DumpFormat::Compact, out); });
+        const std::string token_json = render([&](std::ostream& out) { dump_tokens(tokens, DumpFormat::Json, out); });
+        const std::string token_compact = render([&](std::ostream& out) { dump_tokens(tokens, DumpFormat::Compact, out); });
+        std::cout << "AST as JSON:\n" << ast_json << "\n\nAST compact:\n" << ast_compact;
+        std::cout << "\nTokens as JSON:\n" << token_json << "\n\nTokens compact:\n" << token_compact << std::endl;
+
+        auto lines = [](const std::string& text) { return static_cast<size_t>(std::count(text.begin(), text.end(), '\n')); };
+        JsonChecker ast_checker(ast_json), token_checker(token_json);
+        bool ast_json_ok = ast_checker.check() && ast_checker.nodes() == nodes;
+        bool token_json_ok = token_checker.check() && token_checker.array_items() == tokens.size();
+        std::cout << nodes << " nodes: JSON " << (ast_json_ok ? "parses with every node" : "BROKEN")
+                  << ", compact " << (lines(ast_compact) == nodes ? "has one line per node" : "LINE COUNT MISMATCH")
+                  << std::endl;
+        std::cout << tokens.size() << " tokens: JSON " << (token_json_ok ? "parses with every token" : "BROKEN")
+                  << ", compact " << (lines(token_compact) == tokens.size() ? "has one line per token" : "LINE COUNT MISMATCH")
+                  << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error dumping test7.txt: " << e.what() << std::endl;
+    }
+
+    // Test incremental parsing: after every edit the reparsed tree, locations
+    // included, and its diagnostics must match a full parse of the new text
+    std::cout << "\n" << std::string(50, '=') << std::endl;
+    std::cout << "TESTING INCREMENTAL PARSING" << std::endl;
+    std::cout << std::string(50, '=') << std::endl;
+
+    const std::vector<std::pair<std::string, std::string>> versions = {
+        {"original", R"(
+        int scale = 3;
+        function twice(int n) -> int {
+            return n * 2;
+        }
+        int x = twice(scale); print(x);
+        function broken(int a) -> int {
+            return a + ;
+        }
+        print(broken(x));
+    )"},
+        {"add lines inside twice()", R"(
+        int scale = 3;
+        function twice(int n) -> int {
+            int m = n;
+
+            return m * 2;
+        }
+        int x = twice(scale); print(x);
+        function broken(int a) -> int {
+            return a + ;
+        }
+        print(broken(x));
+    )"},
+        {"widen a statement sharing its line", R"(
+        int scale = 3;
+        function twice(int n) -> int {
+            int m = n;
+
+            return m * 2;
+        }
+        int x = twice(scale + 100); print(x);
+        function broken(int a) -> int {
+            return a + ;
+        }
+        print(broken(x));
+    )"},
+        {"fix broken()", R"(
+        int scale = 3;
+        function twice(int n) -> int {
+            int m = n;
+
+            return m * 2;
+        }
+        int x = twice(scale + 100); print(x);
+        function broken(int a) -> int {
+            return a + 1;
+        }
+        print(broken(x));
+    )"},
+        {"remove the first line", R"(
+        function twice(int n) -> int {
+            int m = n;
+
+            return m * 2;
+        }
+        int x = twice(100); print(x);
+        function broken(int a) -> int {
+            return a + 1;
+        }
+        print(broken(x));
+    )"},
+    };
+
+    try {
+        IncrementalParser incremental;
+        std::vector<Token> previous;
+        for (const auto& [what, text] : versions) {
+            create_test_file("edit.txt", text);
+            Lexer lexer("edit.txt");
+            std::vector<Token> tokens = lexer.tokenize();
+
+            auto program = previous.empty() ? incremental.parse(tokens)
+                                            : incremental.reparse(tokens, diff_tokens(previous, tokens));
+            SyntaxParser full(tokens);
+            auto expected = full.parse_program();
+
+            bool same_tree = compact_dump(*program) == compact_dump(*expected);
+            bool same_errors = messages(incremental.get_diagnostics()) == messages(full.get_diagnostics());
+            std::cout << what << ": " << incremental.reused_items() << " reused, "
+                      << incremental.reparsed_items() << " reparsed, "
+                      << incremental.get_diagnostics().size() << " error(s), "
+                      << (same_tree && same_errors ? "matches full parse"
+                          : !same_tree ? "TREE MISMATCH with full parse" : "DIAGNOSTICS MISMATCH with full parse")
+                      << std::endl;
+            for (const auto& diagnostic : incremental.get_diagnostics()) {
+                std::cout << "  " << diagnostic.message << std::endl;
+            }
+            previous = std::move(tokens);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error in incremental parsing: " << e.what() << std::endl;
+    }
+
     // Test error cases
     std::cout << "\n" << std::string(50, '=') << std::endl;
     std::cout << "TESTING ERROR CASES" << std::endl;
@@ -147,6 +757,228 @@ int main() {
         }
     }
 
+    // Test parser recovery: every broken statement should be reported in one pass
+    create_test_file("error4.txt", R"(
+        int x = ;
+        float y = 2.5
+        if (x > ) {
+            print("unreachable");
+        }
+        function ok(int a) -> int {
+            return a + ;
+            int b = a * 2;
+            return b;
+        }
+        string s = "still parsed";
+    )");
+
+    std::cout << "\nTesting parser recovery: error4.txt" << std::endl;
+    try {
+        Lexer lexer("error4.txt");
+        SyntaxParser parser(lexer.tokenize());
+        auto ast = std::static_pointer_cast<ProgramNode>(parser.parse_program());
+        std::cout << "Recovered " << parser.get_diagnostics().size() << " error(s), "
+                  << ast->children.size() << " top-level node(s):" << std::endl;
+        for (const auto& diagnostic : parser.get_diagnostics()) {
+            std::cout << "  " << diagnostic.message << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Unexpected error: " << e.what() << std::endl;
+    }
+
+    // Test the native backend: build test7 into an executable and run it
+    std::cout << "\n" << std::string(50, '=') << std::endl;
+    std::cout << "TESTING NATIVE BACKEND" << std::endl;
+    std::cout << std::string(50, '=') << std::endl;
+    try {
+        IRModule module;
+        if (compile_to_ir("test7.txt", opt_level, module)) {
+            X86CodeGen codegen;
+            std::string assembly = codegen.generate(module);
+            std::cout << "Generated " << assembly.size() << " bytes of assembly for test7.txt" << std::endl;
+            codegen.get_stats().print(std::cout);
+            NativeToolchain toolchain;
+            toolchain.link(assembly, "./test7.out");
+            std::cout << "Linked test7.out against " << toolchain.runtime_library() << ", running it:" << std::endl;
+            std::cout.flush();
+            int status = std::system("./test7.out");
+            std::cout << "Exit status " << status << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Native build skipped: " << e.what() << std::endl;
+    }
+
+    // Test the bytecode VM: run test7 in-process, no toolchain needed
+    std::cout << "\n" << std::string(50, '=') << std::endl;
+    std::cout << "TESTING BYTECODE VM" << std::endl;
+    std::cout << std::string(50, '=') << std::endl;
+    try {
+        if (auto ast = check_source("test7.txt")) {
+            BytecodeModule module = BytecodeCompiler().compile(*ast);
+            size_t fused = fuse_superinstructions(module);
+            std::cout << "Compiled test7.txt to " << module.instruction_count() << " instruction(s), "
+                      << module.constants.size() << " constant(s), " << fused << " pair(s) fused:" << std::endl;
+            disassemble(module, std::cout);
+            std::cout << "Running it:" << std::endl;
+            VM(module).run();
+            turd_runtime_exit();
+
+            std::cout << "Running it again with every function JIT-compiled:" << std::endl;
+            VM compiled(module);
+            compiled.set_jit_threshold(0);
+            compiled.run();
+            turd_runtime_exit();
+            std::cout << compiled.compiled_functions() << " function(s) compiled to "
+                      << compiled.compiled_bytes() << " byte(s) of machine code, "
+                      << compiled.loop_entries() << " loop(s) entered mid-run, "
+                      << compiled.deoptimizations() << " deoptimization(s)" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Unexpected error: " << e.what() << std::endl;
+    }
+
+    // Test accumulator loops: recursion through + and * must give the same
+    // results as a loop as it did as recursion
+    std::cout << "\n" << std::string(50, '=') << std::endl;
+    std::cout << "TESTING ACCUMULATOR LOOPS" << std::endl;
+    std::cout << std::string(50, '=') << std::endl;
+    create_test_file("test8.txt", R"(
+        function factorial(int n) -> int {
+            if (n <= 1) {
+                return 1;
+            }
+            return n * factorial(n - 1);
+        }
+        function triangle(int n) -> int {
+            if (n == 0) {
+                return 0;
+            }
+            return triangle(n - 1) + n;
+        }
+        function fib(int n) -> int {
+            if (n < 2) {
+                return n;
+            }
+            return fib(n - 1) + fib(n - 2);
+        }
+        print(factorial(10), factorial(20), triangle(10000), fib(20));
+    )");
+    try {
+        auto self_calls = [](const IRModule& module) {
+            size_t calls = 0;
+            for (size_t index = 0; index < module.functions.size(); ++index) {
+                for (const IRInstruction& instruction : module.functions[index].values) {
+                    calls += instruction.op == Opcode::Call && instruction.immediate == static_cast<int64_t>(index);
+                }
+            }
+            return calls;
+        };
+        IRModule lowered, optimized;
+        if (compile_to_ir("test8.txt", OptLevel::O0, lowered) && compile_to_ir("test8.txt", OptLevel::O1, optimized)) {
+            std::cout << "Recursive calls: " << self_calls(lowered) << " as lowered, "
+                      << self_calls(optimized) << " at -O1" << std::endl;
+        }
+        if (auto ast = check_source("test8.txt")) {
+            BytecodeModule module = BytecodeCompiler().compile(*ast);
+            std::cout << "Bytecode VM:" << std::endl;
+            VM(module).run();
+            turd_runtime_exit();
+        }
+
+        // the untransformed -O0 build is the reference for the -O1 one
+        NativeToolchain toolchain;
+        std::string outputs[2];
+        OptLevel levels[2] = {OptLevel::O0, OptLevel::O1};
+        for (int i = 0; i < 2; ++i) {
+            IRModule module;
+            if (!compile_to_ir("test8.txt", levels[i], module)) break;
+            toolchain.link(X86CodeGen().generate(module), "./test8.out");
+            std::cout.flush();
+            int status = std::system("./test8.out > test8.log");
+            std::ifstream log("test8.log");
+            outputs[i] = "exit status " + std::to_string(status) + "\n";
+            outputs[i].append(std::istreambuf_iterator<char>(log), std::istreambuf_iterator<char>());
+        }
+        std::cout << "Native -O0:" << std::endl << outputs[0];
+        std::cout << "Native -O1 " << (outputs[0] == outputs[1] ? "matches" : "DIFFERS") << std::endl;
+    } catch (const std::exception& e) {
+        std::cout << "Native build skipped: " << e.what() << std::endl;
+    }
+
+    // Test arrays: the bounds checks the range analysis proves are dropped,
+    // and every backend still agrees
+    std::cout << "\n" << std::string(50, '=') << std::endl;
+    std::cout << "TESTING ARRAYS" << std::endl;
+    std::cout << std::string(50, '=') << std::endl;
+    create_test_file("test9.txt", R"(
+        function sum(int[] a) -> int {
+            int total = 0;
+            for (int i = 0; i < len(a); i++) {
+                total = total + a[i];
+            }
+            return total;
+        }
+        function reversed(int[] a) -> int[] {
+            int r[len(a)];
+            for (int i = len(a) - 1; i >= 0; i--) {
+                r[len(a) - 1 - i] = a[i];
+            }
+            return r;
+        }
+        int squares[8];
+        for (int i = 0; i < 8; i++) {
+            squares[i] = i * i;
+        }
+        int[] back = reversed(squares);
+        float halves[3];
+        halves[2] = 1.5;
+        string names[2];
+        names[1] = "turd";
+        print(sum(squares), back[0], len(back), halves[2], names[1]);
+    )");
+    try {
+        auto bounds_checks = [](const IRModule& module) {
+            size_t checks = 0;
+            for (const IRFunction& function : module.functions) {
+                for (const IRBlock& block : function.blocks) {
+                    for (ValueId value : block.code) checks += function.values[value].op == Opcode::BoundsCheck;
+                }
+            }
+            return checks;
+        };
+        for (const char* filename : {"test5.txt", "test9.txt"}) {
+            IRModule lowered, optimized;
+            if (compile_to_ir(filename, OptLevel::O0, lowered) && compile_to_ir(filename, OptLevel::O1, optimized)) {
+                std::cout << filename << " bounds checks: " << bounds_checks(lowered) << " as lowered, "
+                          << bounds_checks(optimized) << " at -O1" << std::endl;
+            }
+        }
+        if (auto ast = check_source("test9.txt")) {
+            BytecodeModule module = BytecodeCompiler().compile(*ast);
+            std::cout << "Bytecode VM:" << std::endl;
+            VM(module).run();
+            turd_runtime_exit();
+        }
+
+        NativeToolchain toolchain;
+        std::string outputs[2];
+        OptLevel levels[2] = {OptLevel::O0, OptLevel::O1};
+        for (int i = 0; i < 2; ++i) {
+            IRModule module;
+            if (!compile_to_ir("test9.txt", levels[i], module)) break;
+            toolchain.link(X86CodeGen().generate(module), "./test9.out");
+            std::cout.flush();
+            int status = std::system("./test9.out > test9.log 2>&1");
+            std::ifstream log("test9.log");
+            outputs[i] = "exit status " + std::to_string(status) + "\n";
+            outputs[i].append(std::istreambuf_iterator<char>(log), std::istreambuf_iterator<char>());
+        }
+        std::cout << "Native -O0:" << std::endl << outputs[0];
+        std::cout << "Native -O1 " << (outputs[0] == outputs[1] ? "matches" : "DIFFERS") << std::endl;
+    } catch (const std::exception& e) {
+        std::cout << "Native build skipped: " << e.what() << std::endl;
+    }
+
     return 0;
 }
 